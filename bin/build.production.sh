@@ -4,5 +4,6 @@ g++ -std=c++17 \
     -lssl \
     -lcrypto \
     -lcurl \
-    -lz libs/miniz/miniz.c src/*.cpp \
+    -lz \
+    -pthread libs/miniz/miniz.c src/*.cpp \
     -o build/bittrack
\ No newline at end of file
@@ -0,0 +1,21 @@
+#ifndef BODY_HPP
+#define BODY_HPP
+
+#include <cstddef>
+#include <functional>
+
+// Streaming callbacks for request and response bodies, kept apart from
+// http.hpp so headers reached while http.hpp is still being read can use them
+
+// Produces the next part of a request body: fills up to size bytes of buffer,
+// sets written, and returns false to abort the transfer; written 0 ends the body
+using HttpBodySource = std::function<bool(char *buffer, std::size_t size, std::size_t &written)>;
+
+// Restarts a request body from its first byte so it can be sent again after a
+// redirect or an authentication retry; returns false when it cannot
+using HttpBodyRewind = std::function<bool()>;
+
+// Takes the next part of a response body as it arrives; returns false to abort the transfer
+using HttpBodySink = std::function<bool(const char *data, std::size_t size)>;
+
+#endif
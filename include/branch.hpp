@@ -29,6 +29,9 @@ void renameBranch(
 void printBranchInfo(const std::string &branch_name);
 bool isBranchExists(const std::string &branch_name);
 std::string getBranchLastCommitHash(const std::string &branch_name);
+void restoreFilesFromCommit(
+    const std::string &commit_hash,
+    const std::string &current_commit);
 void insertCommitRecordToHistory(
     const std::string &commit_hash,
     const std::string &branch_name);
@@ -46,9 +49,5 @@ std::vector<std::string> getCommitsChain(
     const std::string &from_commit,
     const std::string &to_commit);
 bool applyCommitDuringRebase(const std::string &commit_hash);
-bool attemptAutomaticMerge(
-    const std::filesystem::path &first_file,
-    const std::filesystem::path &second_file,
-    const std::string &target_path);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,34 @@
+#ifndef CLONE_HPP
+#define CLONE_HPP
+
+#include <cerrno>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/fs.h>
+#endif
+
+// How file content is duplicated, from cheapest to most expensive
+enum class CloneMethod
+{
+  REFLINK,    // share extents copy-on-write (btrfs, XFS)
+  COPY_RANGE, // copy inside the kernel without passing through user space
+  READ_WRITE  // copy through a user space buffer
+};
+
+bool cloneFile(
+    const std::string &from,
+    const std::string &to);
+CloneMethod getCloneMethod(
+    dev_t from_device,
+    dev_t to_device);
+
+#endif
@@ -1,31 +1,34 @@
 #ifndef COMMIT_HPP
 #define COMMIT_HPP
 
+#include <algorithm>
 #include <chrono>
 #include <ctime>
 #include <filesystem>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <map>
 #include <set>
 #include <sstream>
 #include <string>
+#include <fcntl.h>
 #include <unistd.h>
 #include <unordered_map>
 #include <vector>
 
 #include "branch.hpp"
 #include "error.hpp"
+#include "graph.hpp"
 #include "hash.hpp"
+#include "object.hpp"
 #include "remote.hpp"
 #include "stage.hpp"
 
 void commitChanges(
     const std::string &author,
     const std::string &message);
-void storeSnapshot(
-    const std::string &file_path,
-    const std::string &commit_hash);
+std::string storeSnapshot(const std::string &file_path);
 void createCommitLog(
     const std::string &author,
     const std::string &message,
@@ -33,7 +36,11 @@ void createCommitLog(
     const std::string &commit_hash);
 std::string getCurrentCommit();
 std::string getLastCommit(const std::string &branch_name = "");
+std::string getHistoryPath();
+std::vector<std::pair<std::string, std::string>> readCommitHistory();
+bool writeCommitHistory(const std::vector<std::pair<std::string, std::string>> &history);
 std::string getCommitParent(const std::string &commit_hash);
+std::vector<std::string> getCommitParents(const std::string &commit_hash);
 std::string generateCommitHash(
     const std::string &author,
     const std::string &message,
@@ -41,5 +48,6 @@ std::string generateCommitHash(
 std::string getCurrentTimestamp();
 std::string getCurrentUser();
 std::vector<std::string> getCommitFiles(const std::string &commit_hash);
+std::map<std::string, std::string> getCommitTree(const std::string &commit_hash);
 
 #endif
@@ -8,10 +8,12 @@
 #include <set>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "branch.hpp"
 #include "commit.hpp"
+#include "config.hpp"
 #include "stage.hpp"
 
 // Types of lines in a diff
@@ -79,12 +81,19 @@ void printDiff(const DiffResult &result);
 bool isBinaryFile(const std::string &file_path); // TODO: move to utils
 std::vector<std::string> readFileLines(
     const std::string &file_path);
+int getDiffContextLines();
 std::vector<DiffHunk> computeHunks(
     const std::vector<std::string> &old_lines,
-    const std::vector<std::string> &new_lines);
+    const std::vector<std::string> &new_lines,
+    int context_lines = 3);
 std::vector<DiffLine> computeDiffLines(
     const std::vector<std::string> &old_lines,
     const std::vector<std::string> &new_lines);
+// For each line of old_lines, the index of the line of new_lines it is kept
+// as by a minimal edit script, or -1 when it is deleted
+std::vector<int> computeLineMatches(
+    const std::vector<std::string> &old_lines,
+    const std::vector<std::string> &new_lines);
 void printDiffLine(
     const DiffLine &line,
     const std::string &prefix = "");
@@ -1,6 +1,8 @@
 #ifndef ERROR_HPP
 #define ERROR_HPP
 
+#include <cerrno>
+#include <cstring>
 #include <exception>
 #include <filesystem>
 #include <fstream>
@@ -0,0 +1,68 @@
+#ifndef FSMONITOR_HPP
+#define FSMONITOR_HPP
+
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <dirent.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+#include "error.hpp"
+#include "ignore.hpp"
+
+// Answer from the monitor daemon to a change query
+struct FsMonitorChanges
+{
+  std::string token;              // token to pass to the next query
+  bool full_scan;                 // the changes since the previous token are unknown
+  std::vector<std::string> paths; // changed paths, directories carry a trailing /
+
+  FsMonitorChanges() : full_scan(true) {}
+};
+
+// What the last status computed while the monitor was running
+struct FsMonitorState
+{
+  std::string token;                  // monitor token taken before that status scanned
+  std::string head;                   // commit that status compared against
+  std::string index_digest;           // digest of the index as that status left it
+  std::vector<std::string> untracked; // untracked files that status reported
+};
+
+std::string getFsMonitorSocketPath();
+std::string getFsMonitorStatePath();
+bool isFsMonitorRunning();
+void startFsMonitor();
+void stopFsMonitor();
+void printFsMonitorStatus();
+void runFsMonitorDaemon();
+bool queryFsMonitor(
+    const std::string &since_token,
+    FsMonitorChanges &changes);
+bool loadFsMonitorState(FsMonitorState &state);
+bool saveFsMonitorState(const FsMonitorState &state);
+
+#endif
@@ -3,14 +3,35 @@
 
 #include <curl/curl.h>
 #include <iostream>
+#include <map>
+#include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <regex>
 
 #include "config.hpp"
 #include "error.hpp"
+#include "hash.hpp"
+#include "http.hpp"
+#include "json.hpp"
 #include "../include/tag.hpp"
 
+// State of a recursive tree listing parsed as it arrives
+struct GithubTreeListing
+{
+  std::vector<std::pair<std::string, std::string>> *files; // path, sha pairs of the blobs
+  bool in_tree;                                            // inside the top-level tree array
+  bool found_tree;                                         // the tree array was seen
+  bool truncated;                                          // GitHub cut the listing short
+  std::string path;                                        // path of the entry being read
+  std::string sha;                                         // sha of the entry being read
+  std::string type;                                        // type of the entry being read
+  std::string message;                                     // top-level message of an error response
+
+  GithubTreeListing() : files(nullptr), in_tree(false), found_tree(false), truncated(false) {}
+};
+
 bool isGithubRemote(const std::string &url);
 std::string extractInfoFromGithubUrl(
     const std::string &url,
@@ -38,6 +59,13 @@ void setGithubCommitMapping(
     const std::string &github_commit);
 std::string getGithubCommitForBittrack(
     const std::string &bittrack_commit);
+std::unordered_map<std::string, std::string> getGithubBlobMapping(
+    const std::string &username,
+    const std::string &repo_name);
+void addGithubBlobMappings(
+    const std::string &username,
+    const std::string &repo_name,
+    const std::vector<std::pair<std::string, std::string>> &blobs);
 std::string getLatestGithubCommit(
     const std::string &token,
     const std::string &username,
@@ -98,16 +126,24 @@ bool extractFilesFromGithubCommit(
     const std::string &commit_sha,
     const std::string &commit_data,
     std::vector<std::string> &downloaded_files);
-std::string getGithubTreeData(
+// Handles one event of a git/trees listing, collecting its blob entries
+bool onGithubTreeEvent(
+    GithubTreeListing &listing,
+    JsonEvent event,
+    const std::string &key,
+    const std::string &value,
+    std::size_t depth);
+bool getGithubTreeFiles(
     const std::string &token,
     const std::string &username,
     const std::string &repo_name,
-    const std::string &tree_sha);
+    const std::string &tree_sha,
+    std::vector<std::pair<std::string, std::string>> &files);
 bool downloadFilesFromGithubTree(
     const std::string &token,
     const std::string &username,
     const std::string &repo_name,
-    const std::string &tree_data,
+    const std::vector<std::pair<std::string, std::string>> &files,
     std::vector<std::string> &downloaded_files);
 std::string getGithubBlobContent(
     const std::string &token,
@@ -120,6 +156,10 @@ bool pushTagToGithub(
     const std::string &username,
     const std::string &repo_name,
     const std::string &tag_name);
+// Collects the (name, sha) pair of each tag in a git/refs/tags response
+bool parseGithubTagRefs(
+    const std::string &response_data,
+    std::vector<std::pair<std::string, std::string>> &tags);
 bool pullTagsFromGithub(
     const std::string &token,
     const std::string &username,
@@ -0,0 +1,84 @@
+#ifndef GRAPH_HPP
+#define GRAPH_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <queue>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "error.hpp"
+#include "hash.hpp"
+
+// A commit appended to the commit-graph tail since the graph file was written
+struct GraphTailCommit
+{
+  std::string key;               // graph key of the commit
+  std::vector<uint32_t> parents; // graph positions of its parents
+  uint32_t generation;           // one more than its highest parent, 1 for roots
+  int64_t timestamp;             // commit time in seconds since the epoch
+
+  GraphTailCommit() : generation(0), timestamp(0) {}
+};
+
+// Read-only view of the commit-graph file mapped into memory, followed by the
+// commits of the tail file; tail commits take the positions after the file's
+struct CommitGraph
+{
+  const unsigned char *data;                           // start of the mapping, null when no graph is loaded
+  std::size_t size;                                    // length of the mapping in bytes
+  uint32_t count;                                      // number of commits in the graph, tail included
+  uint32_t file_count;                                 // number of commits in the mapped file
+  std::size_t edges_offset;                            // offset of the extra parent list used by octopus merges
+  std::vector<GraphTailCommit> tail;                   // commits read from the tail file
+  std::unordered_map<std::string, uint32_t> tail_keys; // graph key of each tail commit to its position
+
+  CommitGraph() : data(nullptr), size(0), count(0), file_count(0), edges_offset(0) {}
+  ~CommitGraph();
+  CommitGraph(const CommitGraph &) = delete;
+  CommitGraph &operator=(const CommitGraph &) = delete;
+};
+
+std::string getCommitGraphPath();
+std::string getCommitGraphTailPath();
+bool writeCommitGraph();
+// Adds a commit and its ancestors missing from the graph to the tail file,
+// folding the tail into the graph file once it grows past a limit
+bool updateCommitGraph(const std::string &commit_hash);
+bool loadCommitGraph(CommitGraph &graph);
+int64_t findGraphCommit(
+    const CommitGraph &graph,
+    const std::string &commit_hash);
+std::string getGraphCommitHash(
+    const CommitGraph &graph,
+    uint32_t position);
+uint32_t getGraphGeneration(
+    const CommitGraph &graph,
+    uint32_t position);
+int64_t getGraphTimestamp(
+    const CommitGraph &graph,
+    uint32_t position);
+std::vector<uint32_t> getGraphParents(
+    const CommitGraph &graph,
+    uint32_t position);
+bool graphIsAncestor(
+    const std::string &ancestor,
+    const std::string &descendant);
+std::string graphMergeBase(
+    const std::string &commit1,
+    const std::string &commit2);
+
+#endif
@@ -10,8 +10,15 @@
 #include <iostream>
 #include <sstream>
 #include <vector>
+#include <algorithm>
 #include <openssl/evp.h>
 #include <openssl/sha.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "parallel.hpp"
 
 std::string toHexString(unsigned char *hash, std::size_t length);
 std::string generateCommitHash(
@@ -20,6 +27,9 @@ std::string generateCommitHash(
     const std::unordered_map<std::string, std::string> &fileHashes);
 std::string calculateFileHash(const std::string &file_path);
 std::string sha256Hash(const std::string &input);
+std::string gitBlobHash(const std::string &content);
+std::string gitBlobHashFile(const std::string &file_path);
 std::string hashFile(const std::string &file_path);
+std::vector<std::string> hashFilesParallel(const std::vector<std::string> &file_paths);
 
 #endif
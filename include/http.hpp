@@ -0,0 +1,47 @@
+#ifndef HTTP_HPP
+#define HTTP_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <curl/curl.h>
+
+#include "body.hpp"
+#include "config.hpp"
+#include "error.hpp"
+#include "utils.hpp"
+
+// A request for the shared HTTP transport
+struct HttpRequest
+{
+  std::string method;               // GET, POST, PUT, PATCH or DELETE
+  std::string url;                  // absolute URL
+  std::vector<std::string> headers; // header lines sent with the request
+  std::string body;                 // request body, sent when not empty
+  HttpBodySource body_source;       // streams the body instead, read while the request is sent
+  int64_t body_size;                // length of body_source, -1 when unknown and sent chunked
+  HttpBodyRewind body_rewind;       // restarts body_source, unset when it cannot be resent
+  HttpBodySink body_sink;           // receives the response body instead of HttpResponse::body
+
+  HttpRequest() : method("GET"), body_size(-1) {}
+};
+
+// What came back for one request
+struct HttpResponse
+{
+  CURLcode result;  // transport outcome, CURLE_OK when a response arrived
+  long status;      // HTTP status code, 0 when there was none
+  std::string body; // response body, empty when the request had a body_sink
+
+  HttpResponse() : result(CURLE_FAILED_INIT), status(0) {}
+};
+
+unsigned int getHttpConcurrency();
+void resetHttpConcurrency();
+HttpResponse httpPerform(const HttpRequest &request);
+std::vector<HttpResponse> httpPerformAll(const std::vector<HttpRequest> &requests);
+
+#endif
@@ -1,26 +1,36 @@
 #ifndef IGNORE_HPP
 #define IGNORE_HPP
 
-#include <regex>
-#include <string>
-#include <vector>
-
-#include "error.hpp"
 #include <algorithm>
 #include <cctype>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <sstream>
+#include <string>
+#include <vector>
+
+#include "error.hpp"
+
+// How a compiled ignore pattern is matched against a path
+enum class IgnoreMatchKind
+{
+  LITERAL, // the pattern has no wildcards left and is matched by string search
+  GLOB     // wildcards are matched by the glob matcher
+};
 
 struct IgnorePattern
 {
   std::string pattern;
-  bool is_negation;  // true if pattern starts with !
-  bool is_directory; // true if pattern ends with /
-  std::regex regex_pattern;
+  bool is_negation;     // true if pattern starts with !
+  bool is_directory;    // true if pattern ends with /
+  bool is_anchored;     // true if pattern starts with /, so it only matches from the repository root
+  IgnoreMatchKind kind; // matcher chosen when the pattern is compiled
+  std::string body;     // lower-cased pattern without the anchor and redundant leading wildcards
 
-  IgnorePattern(const std::string &p) : pattern(p), is_negation(false), is_directory(false)
+  IgnorePattern(const std::string &p) : pattern(p), is_negation(false), is_directory(false), is_anchored(false), kind(IgnoreMatchKind::LITERAL)
   {
     if (pattern.empty())
     {
@@ -33,28 +43,17 @@ struct IgnorePattern
       pattern = pattern.substr(1); // remove the !
     }
 
-    is_directory = (pattern.back() == '/');
+    is_directory = !pattern.empty() && (pattern.back() == '/');
     if (is_directory)
     {
       pattern = pattern.substr(0, pattern.length() - 1); // remove trailing /
     }
 
-    // convert Git pattern to regex
-    std::string regex_str = convertGitPatternToRegex(pattern);
-    try
-    {
-      regex_pattern = std::regex(regex_str, std::regex_constants::icase);
-    }
-    catch (const std::regex_error &)
-    {
-      // If regex compilation fails, use simple string matching
-      regex_str = ".*" + std::regex_replace(pattern, std::regex("\\*"), ".*") + ".*";
-      regex_pattern = std::regex(regex_str, std::regex_constants::icase);
-    }
+    compile();
   }
 
 private:
-  std::string convertGitPatternToRegex(const std::string &git_pattern);
+  void compile();
 };
 
 std::vector<std::string> readBitignore(const std::string &filePath);
@@ -62,7 +61,16 @@ std::vector<IgnorePattern> parseIgnorePatterns(const std::vector<std::string> &r
 bool isFileIgnoredByIgnorePatterns(
     const std::string &filePath,
     const std::vector<IgnorePattern> &patterns);
+std::shared_ptr<const std::vector<IgnorePattern>> getIgnorePatterns();
+void resetIgnorePatterns();
 bool shouldIgnoreFile(const std::string &file_path);
+bool shouldIgnoreFile(
+    const std::string &file_path,
+    const std::vector<IgnorePattern> &patterns);
+bool shouldIgnoreDirectory(const std::string &dir_path);
+bool shouldIgnoreDirectory(
+    const std::string &dir_path,
+    const std::vector<IgnorePattern> &patterns);
 std::string normalizePath(const std::string &path);
 bool matchesPattern(
     const std::string &filePath,
@@ -0,0 +1,60 @@
+#ifndef INDEX_HPP
+#define INDEX_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+#include "error.hpp"
+#include "hash.hpp"
+
+// A single path recorded in the binary index
+struct IndexEntry
+{
+  std::string hash; // blob hash of the recorded content, empty for a staged deletion
+  int64_t mtime_ns; // modification time in nanoseconds
+  uint64_t size;    // file size in bytes
+  uint64_t inode;   // inode number
+  uint32_t mode;    // file type and permission bits
+  bool staged;      // part of the staging area rather than only cached stat data
+
+  IndexEntry() : mtime_ns(0), size(0), inode(0), mode(0), staged(false) {}
+};
+
+std::string getIndexPath();
+std::map<std::string, IndexEntry> loadIndex();
+bool saveIndex(const std::map<std::string, IndexEntry> &index);
+std::string getIndexDigest();
+bool readFileStat(
+    const std::string &file_path,
+    IndexEntry &entry);
+void setFileStat(
+    const struct stat &file_stat,
+    IndexEntry &entry);
+bool isStatUnchanged(
+    const IndexEntry &cached,
+    const IndexEntry &current);
+std::string getCachedFileHash(
+    const std::string &file_path,
+    std::map<std::string, IndexEntry> &index,
+    bool &index_changed);
+std::map<std::string, std::string> getCachedFileHashes(
+    const std::vector<std::string> &file_paths,
+    std::map<std::string, IndexEntry> &index,
+    bool &index_changed);
+std::map<std::string, std::string> getCachedFileHashes(
+    const std::vector<std::string> &file_paths,
+    const std::vector<IndexEntry> &file_stats,
+    std::map<std::string, IndexEntry> &index,
+    bool &index_changed);
+void resetStagedEntries(std::map<std::string, IndexEntry> &index);
+bool clearStagingArea();
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef JSON_HPP
+#define JSON_HPP
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// What a JSON parser found
+enum class JsonEvent
+{
+  OBJECT_START,
+  OBJECT_END,
+  ARRAY_START,
+  ARRAY_END,
+  STRING,
+  NUMBER,
+  LITERAL // true, false or null
+};
+
+// Receives each event as soon as its token is complete. key is the member
+// name the value sits under ("" inside arrays and at the root), value the
+// unescaped string or the number or literal text, and depth the number of
+// containers around the value. Returning false stops the parser
+using JsonHandler = std::function<bool(
+    JsonEvent event,
+    const std::string &key,
+    const std::string &value,
+    std::size_t depth)>;
+
+// Receives a streamed string value a piece at a time, already unescaped.
+// Returning false stops the parser
+using JsonChunkHandler = std::function<bool(const char *data, std::size_t size)>;
+
+// What the next character of the document may be
+enum class JsonState : uint8_t
+{
+  VALUE,        // a value
+  ARRAY_FIRST,  // a value or ] right after [
+  OBJECT_FIRST, // a key or } right after {
+  KEY,          // a key after a comma
+  COLON,        // the colon after a key
+  AFTER_VALUE,  // a comma or the end of the enclosing container
+  STRING,       // more string characters
+  ESCAPE,       // the character after a backslash
+  UNICODE,      // the hex digits of a \u escape
+  NUMBER,       // more number characters
+  LITERAL,      // more letters of true, false or null
+  DONE          // only whitespace
+};
+
+// Incremental JSON tokenizer: input is fed in pieces as it arrives and events
+// come out in document order, so memory is bounded by the longest token.
+// String values under stream_key are handed to chunk_handler as they arrive
+// instead, and their STRING event carries an empty value, so even a string of
+// any length never has to be held
+struct JsonParser
+{
+  JsonHandler handler;             // receives the events
+  std::string stream_key;          // member name whose string values are streamed, empty for none
+  JsonChunkHandler chunk_handler;  // receives the pieces of streamed strings
+  bool streaming;                  // the string being read goes to chunk_handler
+  JsonState state;                 // what the next character may be
+  std::string containers;          // open containers, { or [, outermost first
+  std::vector<std::string> keys;   // member name of each open container
+  std::string key;                 // member name of the value being read
+  std::string token;               // string, number or literal read so far
+  bool token_is_key;               // the string being read is a member name
+  uint32_t code_unit;              // value of the \u escape being read
+  int code_digits;                 // hex digits of that escape read so far
+  uint32_t high_surrogate;         // first half of a surrogate pair, 0 when none
+  bool stopped;                    // the handler asked to stop
+  bool failed;                     // the input is not valid JSON
+
+  JsonParser() : streaming(false), state(JsonState::VALUE), token_is_key(false), code_unit(0), code_digits(0), high_surrogate(0), stopped(false), failed(false) {}
+};
+
+bool feedJson(
+    JsonParser &parser,
+    const char *data,
+    std::size_t size);
+bool finishJson(JsonParser &parser);
+bool parseJson(
+    const std::string &json,
+    const JsonHandler &handler);
+// First string value stored under key at any depth, empty when there is none
+std::string findJsonString(
+    const std::string &json,
+    const std::string &key);
+// String value reached from the root object through the member names in path,
+// empty when there is none
+std::string getJsonString(
+    const std::string &json,
+    const std::vector<std::string> &path);
+
+#endif
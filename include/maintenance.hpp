@@ -9,6 +9,7 @@
 #include <iostream>
 #include <set>
 #include <map>
+#include <atomic>
 #include <ctime>
 #include <vector>
 #include <string>
@@ -17,8 +18,12 @@
 #include "branch.hpp"
 #include "tag.hpp"
 #include "stage.hpp"
+#include "stash.hpp"
 #include "hash.hpp"
 #include "ignore.hpp"
+#include "pack.hpp"
+#include "worktree.hpp"
+#include "index.hpp"
 
 // Statistics about the repository
 struct RepoStats
@@ -44,7 +49,10 @@ void findLargeFiles(size_t threshold = 1024 * 1024); // 1MB default
 void findDuplicateFiles();
 void optimizeRepository();
 RepoStats calculateRepositoryStats();
-std::vector<std::string> getUnreachableObjects();
+std::vector<std::string> getReachableCommits();
+std::set<std::string> getReachableObjects();
+std::vector<std::string> getUnreachableObjects(std::time_t grace_period = 0);
+std::time_t getGcGracePeriod();
 std::vector<std::string> getDuplicateFiles();
 std::string formatSize(size_t bytes);
 
@@ -8,10 +8,12 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <map>
 #include <set>
 
 #include "commit.hpp"
 #include "branch.hpp"
+#include "diff.hpp"
 #include "stage.hpp"
 #include "utils.hpp"
 #include "error.hpp"
@@ -19,11 +21,12 @@
 // Result of a merge operation
 struct MergeResult
 {
-  bool success;                              // true if merge was successful
-  bool has_conflicts;                        // true if there were conflicts
-  std::string merge_commit;                  // hash of the merge commit
-  std::vector<std::string> conflicted_files; // List of files with conflicts
-  std::string message;                       // merge message
+  bool success;                                   // true if merge was successful
+  bool has_conflicts;                             // true if there were conflicts
+  std::string merge_commit;                       // hash of the merge commit
+  std::vector<std::string> conflicted_files;      // List of files with conflicts
+  std::string message;                            // merge message
+  std::map<std::string, std::string> merged_tree; // path to blob hash of the merged files
 
   MergeResult() : success(false), has_conflicts(false) {}
 };
@@ -40,6 +43,24 @@ struct MergeConflict
       const std::string &type) : file_path(path), conflict_type(type) {}
 };
 
+// One file of a three-way merge, identified by its blob in each commit
+struct FileMerge
+{
+  std::string path;        // file path
+  std::string base_hash;   // blob in the merge base, empty when absent
+  std::string our_hash;    // blob on our side, empty when absent
+  std::string their_hash;  // blob on their side, empty when absent
+  std::string merged_hash; // blob holding the merged file, empty when it is deleted
+  bool conflicted;         // the file was left with a conflict
+  std::string message;     // what the merge did to the file
+
+  FileMerge(
+      const std::string &path,
+      const std::string &base_hash,
+      const std::string &our_hash,
+      const std::string &their_hash) : path(path), base_hash(base_hash), our_hash(our_hash), their_hash(their_hash), conflicted(false) {}
+};
+
 MergeResult mergeBranches(
     const std::string &source_branch,
     const std::string &target_branch);
@@ -50,6 +71,15 @@ MergeResult threeWayMerge(
     const std::string &base,
     const std::string &ours,
     const std::string &theirs);
+// Merge two versions of a file against their common base line by line.
+// Returns true when every change merged; otherwise merged holds the result
+// with conflict markers around the regions both sides changed differently,
+// or is empty when the content is binary
+bool mergeFileContents(
+    const std::string &base,
+    const std::string &ours,
+    const std::string &theirs,
+    std::string &merged);
 bool hasConflicts();
 void showConflicts();
 std::vector<std::string> getConflictedFiles();
@@ -75,6 +105,7 @@ bool isMergeInProgress();
 std::vector<std::string> getCommitFiles(const std::string &commit_hash);
 void createMergeCommit(
     const std::string &message,
-    const std::vector<std::string> &parents);
+    const std::vector<std::string> &parents,
+    const std::map<std::string, std::string> &tree);
 
 #endif
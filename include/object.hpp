@@ -0,0 +1,124 @@
+#ifndef OBJECT_HPP
+#define OBJECT_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+#include "../libs/miniz/miniz.h"
+#include "config.hpp"
+#include "error.hpp"
+#include "hash.hpp"
+#include "pack.hpp"
+
+struct PackFile;
+
+// Reads a blob's content a chunk at a time; loose blobs and whole packed
+// objects are inflated as they are read so memory stays bounded by the chunk
+// size, and only a packed delta is rebuilt in memory
+struct BlobReader
+{
+  std::ifstream file;                    // loose object being inflated
+  mz_stream stream;                      // inflater state for a loose or whole packed object
+  bool inflating;                        // stream is initialised and needs mz_inflateEnd
+  std::vector<unsigned char> input;      // compressed bytes read from file
+  bool is_packed;                        // content comes from a pack instead of a loose file
+  std::shared_ptr<const PackFile> pack;  // pack mapping a whole packed object is inflated from
+  const unsigned char *pack_input;       // deflated bytes of the whole packed object not yet inflated
+  uint64_t pack_remaining;               // length of pack_input
+  std::string packed;                    // content of a packed delta
+  std::size_t packed_offset;             // bytes of packed already returned
+  int64_t size;                          // content size recorded with the object, -1 for older loose objects
+  bool finished;                         // the whole content has been returned
+  bool failed;                           // the object is missing, truncated or corrupt
+
+  BlobReader() : inflating(false), is_packed(false), pack_input(nullptr), pack_remaining(0), packed_offset(0), size(-1), finished(false), failed(false)
+  {
+    std::memset(&stream, 0, sizeof(stream));
+  }
+  ~BlobReader();
+  BlobReader(const BlobReader &) = delete;
+  BlobReader &operator=(const BlobReader &) = delete;
+};
+
+// Stores a blob from content handed over a chunk at a time; the content is
+// hashed and deflated into a temporary object as it arrives, and its size is
+// recorded in the object header once it is known
+struct BlobWriter
+{
+  std::ofstream file;                // temporary object being written
+  std::string temp_path;             // path of the temporary object, empty once it is moved or removed
+  EVP_MD_CTX *digest;                // hash of the content written so far
+  mz_stream stream;                  // deflater state
+  bool deflating;                    // stream is initialised and needs mz_deflateEnd
+  std::vector<unsigned char> output; // compressed bytes on their way to file
+  uint64_t size;                     // content bytes written so far
+  bool failed;                       // compressing or writing the object failed
+  bool loose;                        // write a loose object even when the blob is already packed
+  bool created;                      // finishBlobWriter stored a new object rather than finding the blob stored
+
+  BlobWriter() : digest(nullptr), deflating(false), size(0), failed(false), loose(false), created(false)
+  {
+    std::memset(&stream, 0, sizeof(stream));
+  }
+  ~BlobWriter();
+  BlobWriter(const BlobWriter &) = delete;
+  BlobWriter &operator=(const BlobWriter &) = delete;
+};
+
+std::string getObjectsDir();
+std::string getBlobPath(const std::string &blob_hash);
+bool blobExists(const std::string &blob_hash);
+int getCompressionLevel();
+void resetCompressionLevel();
+bool openBlobWriter(BlobWriter &writer);
+bool writeBlobChunk(
+    BlobWriter &writer,
+    const unsigned char *data,
+    std::size_t size);
+// Returns the hash of the stored blob, empty when writing it failed
+std::string finishBlobWriter(BlobWriter &writer);
+std::string storeBlobFromStream(std::istream &input);
+std::string storeBlob(const std::string &content);
+std::string storeBlobFromFile(const std::string &file_path);
+bool openBlobReader(
+    const std::string &blob_hash,
+    BlobReader &reader);
+// Returns the bytes written to buffer, 0 once the content ends or reading fails
+std::size_t readBlobChunk(
+    BlobReader &reader,
+    unsigned char *buffer,
+    std::size_t size);
+bool inflateBlob(
+    const std::string &blob_hash,
+    std::ostream &output);
+std::string readBlob(const std::string &blob_hash);
+// Returns the size of a blob's content, -1 when it cannot be read; only loose
+// objects written before sizes were recorded are inflated to count it
+int64_t getBlobSize(const std::string &blob_hash);
+// Returns the Git blob SHA-1 of a stored blob, empty when it cannot be read
+std::string gitBlobHashStored(const std::string &blob_hash);
+// Writes a loose copy of a blob that may only be packed, dated modified so it
+// keeps the age it had in the pack; true once the loose copy exists
+bool loosenBlob(
+    const std::string &blob_hash,
+    std::time_t modified);
+bool restoreBlobToFile(
+    const std::string &blob_hash,
+    const std::string &file_path);
+std::vector<std::string> listBlobs();
+// Stores the per-commit snapshot directories of the old object layout as
+// blobs and removes them, returning the number of files stored
+std::size_t migrateLegacyObjects();
+
+#endif
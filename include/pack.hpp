@@ -0,0 +1,108 @@
+#ifndef PACK_HPP
+#define PACK_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../libs/miniz/miniz.h"
+#include "error.hpp"
+#include "hash.hpp"
+#include "object.hpp"
+
+// Read-only view of a pack and its index mapped into memory
+struct PackFile
+{
+  std::string pack_path;          // path of the .pack file
+  const unsigned char *pack_data; // start of the pack mapping
+  std::size_t pack_size;          // length of the pack mapping in bytes
+  const unsigned char *idx_data;  // start of the index mapping
+  std::size_t idx_size;           // length of the index mapping in bytes
+  uint32_t count;                 // number of objects in the pack
+
+  PackFile() : pack_data(nullptr), pack_size(0), idx_data(nullptr), idx_size(0), count(0) {}
+  ~PackFile();
+  PackFile(const PackFile &) = delete;
+  PackFile &operator=(const PackFile &) = delete;
+};
+
+// An object to write into a pack
+struct PackObject
+{
+  std::string hash;      // blob hash
+  std::string path_hint; // a path the blob was committed under, used to pair revisions as deltas
+};
+
+// What writing a pack produced
+struct PackStats
+{
+  std::size_t object_count; // objects written
+  std::size_t delta_count;  // objects stored as deltas against another object
+  uint64_t pack_size;       // size of the .pack and .idx files in bytes
+
+  PackStats() : object_count(0), delta_count(0), pack_size(0) {}
+};
+
+std::string getPackDir();
+std::vector<std::shared_ptr<const PackFile>> getPackFiles();
+void resetPackFiles();
+bool hasPackedObject(const std::string &blob_hash);
+// Modification time of the newest pack holding the object, 0 when none does
+std::time_t getPackedObjectTime(const std::string &blob_hash);
+bool readPackedObject(
+    const std::string &blob_hash,
+    std::string &content);
+// Finds a packed object for reading a chunk at a time: an object stored whole
+// comes back as its deflated bytes in the pack mapping, which pack keeps alive,
+// while a delta is rebuilt into content and deflated is set to null; either
+// way content_size is the size of the object's content
+bool openPackedObject(
+    const std::string &blob_hash,
+    std::shared_ptr<const PackFile> &pack,
+    const unsigned char *&deflated,
+    uint64_t &deflated_size,
+    uint64_t &content_size,
+    std::string &content);
+std::vector<std::string> listPackedObjects();
+std::string createDelta(
+    const std::string &base,
+    const std::string &target,
+    std::size_t max_size);
+bool applyDelta(
+    const std::string &base,
+    const std::string &delta,
+    std::string &result);
+// Writes the objects into one new pack that replaces every existing pack
+bool repackObjects(
+    const std::vector<PackObject> &objects,
+    PackStats &stats);
+// Writes the objects into a standalone pack, leaving the repository's packs
+// alone; objects too large to pack fail the write unless oversize is given to
+// collect them
+bool writePack(
+    const std::vector<PackObject> &objects,
+    const std::string &pack_path,
+    PackStats &stats,
+    std::vector<std::string> *oversize = nullptr);
+// Checks a pack written by another repository and indexes it next to the
+// existing packs; pack_path must be inside the pack directory
+bool installPack(
+    const std::string &pack_path,
+    PackStats &stats);
+bool verifyPackFiles(std::vector<std::string> &problems);
+
+#endif
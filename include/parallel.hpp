@@ -0,0 +1,22 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "config.hpp"
+#include "error.hpp"
+
+unsigned int getWorkerCount();
+void resetWorkerCount();
+void parallelForEach(
+    std::size_t task_count,
+    const std::function<void(std::size_t)> &task);
+
+#endif
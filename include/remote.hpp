@@ -5,6 +5,7 @@
 #include "utils.hpp"
 #include "config.hpp"
 #include "hooks.hpp"
+#include "transfer.hpp"
 
 void setRemoteOrigin(const std::string &url);
 std::string getRemoteOriginUrl();
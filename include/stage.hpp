@@ -17,6 +17,9 @@
 #include "branch.hpp"
 #include "commit.hpp"
 #include "error.hpp"
+#include "fsmonitor.hpp"
+#include "index.hpp"
+#include "worktree.hpp"
 
 void stage(const std::string &file_path);
 void unstage(const std::string &file_path);
@@ -36,6 +39,10 @@ bool isFileUnchangedFromCommit(
 void stageSingleFile(
     const std::string &file_path,
     std::unordered_map<std::string, std::string> &staged_files);
+void stageHashedFile(
+    const std::string &file_path,
+    const std::string &file_hash,
+    std::unordered_map<std::string, std::string> &staged_files);
 void stageAllFiles(std::unordered_map<std::string, std::string> &staged_files);
 
 #endif
@@ -0,0 +1,131 @@
+#ifndef TRANSFER_HPP
+#define TRANSFER_HPP
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "body.hpp"
+#include "branch.hpp"
+#include "commit.hpp"
+#include "github.hpp"
+#include "graph.hpp"
+#include "http.hpp"
+#include "merge.hpp"
+#include "object.hpp"
+#include "pack.hpp"
+
+// Port the loopback transfer server listens on when none is given
+const int TRANSFER_DEFAULT_PORT = 7418;
+
+// A branch as one side of a transfer sees it
+struct TransferRef
+{
+  std::string name;       // full ref name, refs/heads/<branch>
+  std::string old_commit; // commit the receiver is expected to have, empty for a new branch
+  std::string new_commit; // commit the ref should point at
+};
+
+// What a transfer moved
+struct TransferStats
+{
+  std::size_t commit_count; // commit logs sent or received
+  std::size_t object_count; // objects in the pack or sent beside it
+  uint64_t byte_count;      // size of the transfer stream in bytes
+
+  TransferStats() : commit_count(0), object_count(0), byte_count(0) {}
+};
+
+struct BlobWriter;
+
+// Consumes a transfer stream as it arrives, writing the pack straight to disk
+// and storing objects sent outside the pack in the object store
+struct TransferReceiver
+{
+  std::string header;                     // bytes of the fixed header seen so far
+  uint32_t version;                       // stream version named in the header
+  uint64_t pack_remaining;                // pack bytes still to come
+  std::string pack_path;                  // temporary file the pack is written to
+  std::ofstream pack;                     // open stream on pack_path
+  std::string raw_header;                 // bytes of the raw object count or next object size seen so far
+  bool raw_counted;                       // the raw object count has been read
+  uint32_t raw_objects;                   // raw objects not yet stored
+  uint64_t raw_remaining;                 // bytes of the current raw object still to come
+  std::unique_ptr<BlobWriter> raw_writer; // stores the current raw object, null between objects
+  std::size_t raw_count;                  // raw objects stored
+  std::string meta_path;                  // temporary file the refs and commit logs are written to
+  std::ofstream meta;                     // open stream on meta_path
+  uint64_t byte_count;                    // stream bytes consumed
+  bool failed;                            // the stream was malformed or could not be stored
+
+  TransferReceiver() : version(0), pack_remaining(0), raw_counted(false), raw_objects(0), raw_remaining(0), raw_count(0), byte_count(0), failed(false) {}
+  ~TransferReceiver();
+  TransferReceiver(const TransferReceiver &) = delete;
+  TransferReceiver &operator=(const TransferReceiver &) = delete;
+};
+
+bool isNativeRemote(const std::string &url);
+bool isValidTransferRef(const std::string &name);
+std::vector<TransferRef> getLocalTransferRefs();
+std::vector<std::string> findMissingCommits(
+    const std::vector<std::string> &wants,
+    const std::vector<std::string> &haves,
+    std::vector<std::string> &boundary);
+bool writeTransferStream(
+    const std::vector<TransferRef> &refs,
+    const std::vector<std::string> &commits,
+    const std::vector<std::string> &boundary,
+    const HttpBodySink &output,
+    TransferStats &stats);
+bool openTransferReceiver(TransferReceiver &receiver);
+bool feedTransferReceiver(
+    TransferReceiver &receiver,
+    const char *data,
+    std::size_t size);
+bool finishTransferReceiver(
+    TransferReceiver &receiver,
+    std::vector<TransferRef> &refs,
+    TransferStats &stats);
+bool serveTransferRequest(
+    const std::string &service,
+    const HttpBodySource &input,
+    const HttpBodySink &output);
+// rewind restarts input when an HTTP request has to be sent again
+bool callTransferService(
+    const std::string &url,
+    const std::string &service,
+    const HttpBodySource &input,
+    const HttpBodySink &output,
+    const HttpBodyRewind &rewind = nullptr);
+void runTransferServer(int port);
+bool fetchNative(
+    const std::string &remote_name,
+    const std::string &url);
+bool pullNative(
+    const std::string &remote_name,
+    const std::string &url,
+    const std::string &branch_name);
+bool pushNative(
+    const std::string &remote_name,
+    const std::string &url,
+    const std::string &branch_name);
+
+#endif
@@ -1,14 +1,41 @@
 #ifndef UTILS_HPP
 #define UTILS_HPP
 
+#include <array>
+#include <cstdint>
+#include <cstdio>
 #include <ctime>
 #include <string>
 
 #include "error.hpp"
 
+// Decoding state carried from one chunk of a base64 stream to the next
+struct Base64DecodeState
+{
+  uint32_t bits; // decoded bits that do not yet form a whole byte
+  int bit_count; // number of those bits
+
+  Base64DecodeState() : bits(0), bit_count(0) {}
+};
+
 std::string formatTimestamp(std::time_t timestamp);
+// Encodes length bytes into output, which needs room for (length + 2) / 3 * 4
+// characters; returns the number of characters written
+std::size_t base64EncodeBlock(
+    const unsigned char *input,
+    std::size_t length,
+    char *output);
 std::string base64Encode(const std::string &input);
+// Decodes length characters into output, which needs room for length * 3 / 4 + 1
+// bytes; whitespace and padding are skipped, any other invalid character fails
+bool base64DecodeBlock(
+    const char *input,
+    std::size_t length,
+    unsigned char *output,
+    std::size_t &written,
+    Base64DecodeState &state);
 std::string base64Decode(const std::string &encoded);
+std::string jsonEscape(const std::string &input);
 size_t writeCallback(void *contents, size_t size, size_t nmemb, void *userp);
 
 #endif
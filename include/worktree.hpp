@@ -0,0 +1,27 @@
+#ifndef WORKTREE_HPP
+#define WORKTREE_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "error.hpp"
+#include "ignore.hpp"
+#include "parallel.hpp"
+
+// A regular file found while walking the working tree
+struct WorkingTreeEntry
+{
+  std::string path;      // path relative to the walked root
+  struct stat file_stat; // stat data captured during the walk
+};
+
+std::vector<WorkingTreeEntry> listWorkingTreeFiles(const std::string &root = ".");
+
+#endif
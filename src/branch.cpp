@@ -1,4 +1,5 @@
 #include "../include/branch.hpp"
+#include "../include/clone.hpp"
 
 std::string getCurrentBranchName()
 {
@@ -23,91 +24,6 @@ std::vector<std::string> getBranchesList()
   return branches;
 }
 
-bool attemptAutomaticMerge(
-    const std::filesystem::path &first_file,
-    const std::filesystem::path &second_file,
-    const std::string &target_path)
-{
-  try
-  {
-    std::string first_content = ErrorHandler::safeReadFile(first_file);
-    std::string second_content = ErrorHandler::safeReadFile(second_file);
-
-    // If the first file is empty, use the second file's content
-    if (first_content.empty() && !second_content.empty())
-    {
-      return ErrorHandler::safeWriteFile(target_path, second_content);
-    }
-
-    // If the second file is empty, use the first file's content
-    else if (!first_content.empty() && second_content.empty())
-    {
-      ErrorHandler::safeWriteFile(target_path, first_content);
-      return true;
-    }
-
-    // If both files are non-empty, compare line by line after trimming
-    // whitespace
-    else if (!first_content.empty() && !second_content.empty())
-    {
-      // Split contents into lines
-      std::istringstream first_lines(first_content);
-      std::istringstream second_lines(second_content);
-
-      // Vectors to store lines
-      std::vector<std::string> first_lines_vec;
-      std::vector<std::string> second_lines_vec;
-
-      // Read lines into vectors
-      std::string line;
-      while (std::getline(first_lines, line))
-      {
-        first_lines_vec.push_back(line);
-      }
-
-      while (std::getline(second_lines, line))
-      {
-        second_lines_vec.push_back(line);
-      }
-
-      // Compare line counts
-      if (first_lines_vec.size() == second_lines_vec.size())
-      {
-        // Compare lines after trimming whitespace
-        bool identical = true;
-        for (size_t i = 0; i < first_lines_vec.size(); ++i)
-        {
-          std::string trimmed1 = first_lines_vec[i];
-          std::string trimmed2 = second_lines_vec[i];
-
-          trimmed1.erase(0, trimmed1.find_first_not_of(" \t\r\n"));
-          trimmed1.erase(trimmed1.find_last_not_of(" \t\r\n") + 1);
-          trimmed2.erase(0, trimmed2.find_first_not_of(" \t\r\n"));
-          trimmed2.erase(trimmed2.find_last_not_of(" \t\r\n") + 1);
-
-          if (trimmed1 != trimmed2)
-          {
-            identical = false;
-            break;
-          }
-        }
-
-        // If all lines are identical after trimming, write to target
-        if (identical)
-        {
-          return ErrorHandler::safeWriteFile(target_path, first_content);
-        }
-      }
-    }
-
-    return false;
-  }
-  catch (const std::exception &)
-  {
-    return false;
-  }
-}
-
 bool hasUncommittedChanges()
 {
   // Check for staged or unstaged changes
@@ -127,132 +43,145 @@ bool hasUncommittedChanges()
   return false;
 }
 
-void backupUntrackedFiles()
+static void removeEmptyParentDirectories(const std::filesystem::path &file_path)
 {
-  // Create backup directory
-  ErrorHandler::safeCreateDirectories(".bittrack/untracked_backup");
-  std::string current_branch = getCurrentBranchName();
+  // Prune directories left empty by a removed file, stopping at the repository root
+  std::error_code error;
+  for (std::filesystem::path directory = file_path.parent_path(); !directory.empty(); directory = directory.parent_path())
+  {
+    if (!std::filesystem::is_empty(directory, error) || error || !std::filesystem::remove(directory, error))
+    {
+      break;
+    }
+  }
+}
 
-  // Iterate through working directory to find untracked files
-  for (const auto &entry : ErrorHandler::safeListDirectoryFiles("."))
+void restoreFilesFromCommit(
+    const std::string &commit_hash,
+    const std::string &current_commit)
+{
+  std::string commit_log = ".bittrack/commits/" + commit_hash;
+  if (!std::filesystem::exists(commit_log))
   {
+    ErrorHandler::printError(
+        ErrorCode::FILE_NOT_FOUND,
+        "Commit snapshot not found: " + commit_hash,
+        ErrorSeverity::ERROR,
+        "restore_files_from_commit");
+    return;
+  }
+
+  // Only the delta between the two trees touches the working directory
+  std::map<std::string, std::string> current_tree;
+  if (!current_commit.empty())
+  {
+    current_tree = getCommitTree(current_commit);
+  }
+  std::map<std::string, std::string> target_tree = getCommitTree(commit_hash);
 
-    std::string file_path = entry.string();
-    if (file_path.find(".bittrack") != std::string::npos ||
-        file_path.find("build/") != std::string::npos ||
-        file_path.find(".git/") != std::string::npos ||
-        file_path.find(".DS_Store") != std::string::npos ||
-        file_path.find(".github/") != std::string::npos)
+  std::map<std::string, IndexEntry> index = loadIndex();
+  bool index_changed = false;
+
+  // delete files the target commit no longer tracks
+  for (const auto &[file_path, blob_hash] : current_tree)
+  {
+    if (target_tree.find(file_path) != target_tree.end())
     {
       continue;
     }
 
-    // Check if the file is tracked in the current commit
-    std::string current_commit = getBranchLastCommitHash(current_branch);
-    if (current_commit.empty())
+    if (std::filesystem::exists(file_path))
     {
-      continue;
+      ErrorHandler::safeRemoveFile(file_path);
+      removeEmptyParentDirectories(file_path);
     }
 
-    // Construct the path to the tracked file in the commit
-    std::string tracked_file_path = ".bittrack/objects/" + current_commit + "/" + file_path;
-    if (std::filesystem::exists(tracked_file_path))
+    auto entry = index.find(file_path);
+    if (entry != index.end() && !entry->second.staged)
     {
-      continue;
+      index.erase(entry);
+      index_changed = true;
     }
+  }
 
-    // Backup the untracked file
-    std::filesystem::path relative_path = std::filesystem::relative(file_path, ".");
-    std::filesystem::path backup_path = ".bittrack/untracked_backup" / relative_path;
-
-    // Create necessary directories in backup path
-    if (!backup_path.parent_path().empty())
+  // collect files whose blob differs between the commits
+  std::vector<std::string> changed_files;
+  std::vector<std::string> existing_files;
+  for (const auto &[file_path, blob_hash] : target_tree)
+  {
+    auto current = current_tree.find(file_path);
+    if (current != current_tree.end() && current->second == blob_hash)
     {
-      ErrorHandler::safeCreateDirectories(backup_path.parent_path());
+      continue;
     }
 
-    // Copy the untracked file to backup location
-    ErrorHandler::safeCopyFile(file_path, backup_path);
+    changed_files.push_back(file_path);
+    if (std::filesystem::exists(file_path))
+    {
+      existing_files.push_back(file_path);
+    }
   }
-}
 
-void restoreUntrackedFilesFromBackup()
-{
-  if (std::filesystem::exists(".bittrack/untracked_backup"))
+  // working files that already hold the target content are left alone
+  std::map<std::string, std::string> working_hashes = getCachedFileHashes(existing_files, index, index_changed);
+  std::map<std::string, std::string> restored_blobs;
+  for (const auto &file_path : changed_files)
   {
-    std::vector<std::filesystem::path> files = ErrorHandler::safeListDirectoryFiles(".bittrack/untracked_backup");
-
-    // Iterate through backup directory to restore untracked files
-    for (const auto &entry : files)
+    const std::string &blob_hash = target_tree[file_path];
+    auto working_hash = working_hashes.find(file_path);
+    if (working_hash != working_hashes.end())
     {
-      // restore the untracked file to its original location
-      std::filesystem::path restore_path = std::filesystem::relative(entry.string(), ".bittrack/untracked_backup");
+      if (working_hash->second == blob_hash)
+      {
+        continue;
+      }
 
-      // Create necessary directories in restore path
-      if (!restore_path.parent_path().empty())
+      // keep an untracked file that the target commit would overwrite
+      if (current_tree.find(file_path) == current_tree.end())
       {
-        ErrorHandler::safeCreateDirectories(restore_path.parent_path());
+        ErrorHandler::printError(
+            ErrorCode::UNCOMMITTED_CHANGES,
+            "Keeping untracked file that the target commit also tracks: " + file_path,
+            ErrorSeverity::WARNING,
+            "restore_files_from_commit");
+        continue;
       }
-      ErrorHandler::safeCopyFile(entry, restore_path);
     }
-    // remove the backup directory after restoration
-    ErrorHandler::safeRemoveFolder(".bittrack/untracked_backup");
-  }
-}
 
-void restoreFilesFromCommit(const std::string &commit_path)
-{
-  if (!std::filesystem::exists(commit_path))
-  {
-    ErrorHandler::printError(
-        ErrorCode::FILE_NOT_FOUND,
-        "Commit snapshot not found: " + commit_path,
-        ErrorSeverity::ERROR,
-        "restore_files_from_commit");
-    return;
-  }
-
-  // gather all tracked files from all commits
-  std::unordered_set<std::string> all_tracked_files;
-  for (const auto &entry : std::filesystem::directory_iterator(".bittrack/objects"))
-  {
-    // only consider directories (commits)
-    if (entry.is_directory())
+    // A blob needed at several paths is inflated once and cloned to the
+    // others, which costs no extra space on copy-on-write file systems
+    auto restored = restored_blobs.find(blob_hash);
+    if (restored != restored_blobs.end())
     {
-      // Iterate through files in the commit directory
-      std::string commit_dir = entry.path().string();
-      std::vector<std::filesystem::path> files = ErrorHandler::safeListDirectoryFiles(commit_dir);
-
-      // Skip if it's the target commit
-      for (const auto &file_entry : files)
+      std::filesystem::path target(file_path);
+      if (!target.parent_path().empty())
+      {
+        ErrorHandler::safeCreateDirectories(target.parent_path());
+      }
+      if (!cloneFile(restored->second, file_path) && !restoreBlobToFile(blob_hash, file_path))
       {
-        // Get the relative path of the file within the commit
-        std::filesystem::path relative_path = std::filesystem::relative(file_entry.string(), commit_dir);
-        all_tracked_files.insert(relative_path.string());
+        continue;
       }
     }
-  }
+    else if (!restoreBlobToFile(blob_hash, file_path))
+    {
+      continue;
+    }
+    restored_blobs.emplace(blob_hash, file_path);
 
-  // delete tracked files from working directory
-  for (const auto &file_path : all_tracked_files)
-  {
-    ErrorHandler::safeRemoveFile(file_path);
+    // record the new stat data so the next status does not rehash the file
+    IndexEntry &entry = index[file_path];
+    if (!entry.staged)
+    {
+      entry.hash = blob_hash;
+      readFileStat(file_path, entry);
+      index_changed = true;
+    }
   }
 
-  // restore files from the commit snapshot
-  std::vector<std::filesystem::path> files = ErrorHandler::safeListDirectoryFiles(commit_path);
-  for (const auto &entry : files)
+  if (index_changed)
   {
-    // Get the relative path of the file within the commit
-    std::filesystem::path relative_path = std::filesystem::relative(entry.string(), commit_path);
-    std::filesystem::path working_file = relative_path;
-
-    if (!working_file.parent_path().empty())
-    {
-      ErrorHandler::safeCreateDirectories(working_file.parent_path());
-    }
-    // Copy the file to the working directory
-    ErrorHandler::safeCopyFile(entry, working_file);
+    saveIndex(index);
   }
 }
 
@@ -270,38 +199,9 @@ void updateWorkingDirectory(const std::string &target_branch)
     return;
   }
 
-  std::string commit_path = ".bittrack/objects/" + target_commit;
-  bool has_untracked = false;
-
-  // Check for untracked files in the working directory
-  std::vector<std::filesystem::path> files = ErrorHandler::safeListDirectoryFiles(".");
-  for (const auto &entry : files)
-  {
-    if (entry.string().find(".bittrack") == std::string::npos &&
-        entry.string().find("build/") == std::string::npos &&
-        entry.string().find(".git/") == std::string::npos &&
-        entry.string().find(".DS_Store") == std::string::npos &&
-        entry.string().find(".github/") == std::string::npos)
-    {
-      has_untracked = true;
-      break;
-    }
-  }
-
-  // Backup untracked files if any
-  if (has_untracked)
-  {
-    backupUntrackedFiles();
-  }
-
-  // restore files from the target commit
-  restoreFilesFromCommit(commit_path);
-
-  // restore untracked files back to working directory
-  if (has_untracked)
-  {
-    restoreUntrackedFilesFromBackup();
-  }
+  // move the working directory from the checked out commit to the target,
+  // untracked files are never touched
+  restoreFilesFromCommit(target_commit, getCurrentCommit());
 }
 
 void renameBranch(
@@ -348,17 +248,6 @@ void renameBranch(
     return;
   }
 
-  // rename the branch object directory if it exists
-  std::string old_dir = ".bittrack/objects/" + old_name;
-  std::string new_dir = ".bittrack/objects/" + new_name;
-
-  // Check if old directory exists before renaming
-  if (std::filesystem::exists(old_dir))
-  {
-    // perform the directory rename operation
-    ErrorHandler::safeRename(old_dir, new_dir);
-  }
-
   // update HEAD if the current branch was renamed
   if (getCurrentBranchName() == old_name)
   {
@@ -392,27 +281,11 @@ void printBranchInfo(const std::string &branch_name)
   std::cout << "  Current: " << (branch_name == current_branch ? "Yes" : "No") << std::endl;
   std::cout << "  Last commit: " << (last_commit.empty() ? "None" : last_commit) << std::endl;
 
-  // Read full history file safely
-  std::string history_content = ErrorHandler::safeReadFile(".bittrack/commits/history");
-
-  // If file missing or failed to open, safeReadFile() already reported error
-  if (history_content.empty())
-  {
-    std::cout << "  Commits: 0" << std::endl;
-    return;
-  }
-
-  // Parse history lines
+  // Count the history records of the branch
   int commit_count = 0;
-  std::istringstream history_stream(history_content);
-  std::string line;
-
-  while (std::getline(history_stream, line))
+  for (const auto &record : readCommitHistory())
   {
-    std::istringstream iss(line);
-    std::string commit_hash, branch;
-
-    if (iss >> commit_hash >> branch && branch == branch_name)
+    if (record.second == branch_name)
     {
       commit_count++;
     }
@@ -745,26 +618,23 @@ void printBranchHistory(const std::string &branch_name)
 
   std::cout << "History for branch '" << branch_name << "':" << std::endl;
 
-  // Read the commit history file
-  std::string history_content =
-      ErrorHandler::safeReadFile(".bittrack/commits/history");
-  if (history_content.empty())
+  // Read the commit history
+  std::vector<std::pair<std::string, std::string>> history = readCommitHistory();
+  if (history.empty())
   {
     std::cout << "No commit history found." << std::endl;
     return;
   }
 
-  std::istringstream history_stream(history_content);
-  std::string line;
   bool found_branch = false;
 
-  // Display commits for the specified branch
-  while (std::getline(history_stream, line))
+  // Display commits for the specified branch, newest first
+  for (auto record = history.rbegin(); record != history.rend(); ++record)
   {
-    if (line.length() >= branch_name.length() && line.substr(line.length() - branch_name.length()) == branch_name)
+    if (record->second == branch_name)
     {
       found_branch = true;
-      std::cout << line << std::endl;
+      std::cout << record->first << " " << record->second << std::endl;
     }
   }
 
@@ -778,28 +648,10 @@ std::vector<std::string> getBranchCommits(const std::string &branch_name)
 {
   std::vector<std::string> commits;
 
-  // Retrieve all commit hashes associated with the specified branch
-  std::string history_content = ErrorHandler::safeReadFile(".bittrack/commits/history");
-  if (history_content.empty())
-  {
-    return commits; // no history found
-  }
-
-  std::istringstream history_stream(history_content);
-  std::string line;
-
-  // Read through the history file line by line
-  while (std::getline(history_stream, line))
+  // Retrieve all commit hashes associated with the specified branch, oldest first
+  for (const auto &[commit_hash, branch] : readCommitHistory())
   {
-    if (line.empty())
-    {
-      continue;
-    }
-
-    // parse the line to extract commit hash and branch name
-    std::istringstream iss(line);
-    std::string commit_hash, branch;
-    if (iss >> commit_hash >> branch && branch == branch_name)
+    if (branch == branch_name)
     {
       commits.push_back(commit_hash);
     }
@@ -863,15 +715,7 @@ void cleanupBranchCommits(const std::string &branch_name)
 
     for (const auto &commit_hash : unique_commits)
     {
-      // remove commit object directory
-      std::string commit_dir = ".bittrack/objects/" + commit_hash;
-      if (std::filesystem::exists(commit_dir))
-      {
-        ErrorHandler::safeRemoveFolder(commit_dir);
-        std::cout << "  Removed commit object: " << commit_hash << std::endl;
-      }
-
-      // remove commit log file
+      // remove commit log file, blobs are left for garbage collection
       std::string commit_log = ".bittrack/commits/" + commit_hash;
       if (std::filesystem::exists(commit_log))
       {
@@ -880,39 +724,16 @@ void cleanupBranchCommits(const std::string &branch_name)
       }
     }
 
-    // update the commit history file to remove entries for the branch
-    std::string history_file_content = ErrorHandler::safeReadFile(".bittrack/commits/history");
-    std::istringstream history_file(history_file_content);
-    std::vector<std::string> remaining_lines;
-
-    // Read through the history file line by line
-    std::string line;
-    while (std::getline(history_file, line))
+    // rewrite the commit history without the records of the branch
+    std::vector<std::pair<std::string, std::string>> remaining_records;
+    for (const auto &record : readCommitHistory())
     {
-      if (line.empty())
+      if (record.second != branch_name)
       {
-        continue;
-      }
-
-      // parse the line to extract commit hash and branch name
-      std::istringstream iss(line);
-      std::string commit_hash, branch;
-      if (iss >> commit_hash >> branch)
-      {
-        if (branch != branch_name)
-        {
-          remaining_lines.push_back(line);
-        }
+        remaining_records.push_back(record);
       }
     }
-
-    // write the updated history back to the file
-    std::ofstream out_history_file(".bittrack/commits/history");
-    for (const auto &remaining_line : remaining_lines)
-    {
-      out_history_file << remaining_line << std::endl;
-    }
-    out_history_file.close();
+    writeCommitHistory(remaining_records);
 
     std::cout << "  Removed " << branch_commits.size() << " commit records from history" << std::endl;
     std::cout << "Commit cleanup completed for branch '" << branch_name << "'" << std::endl;
@@ -933,26 +754,8 @@ std::string findCommonAncestor(
 {
   try
   {
-    // Get commits for both branches
-    std::vector<std::string> commits1 = getBranchCommits(branch1);
-    std::vector<std::string> commits2 = getBranchCommits(branch2);
-
-    if (commits1.empty() || commits2.empty())
-    {
-      return "";
-    }
-
-    // find the first common commit in both branches
-    for (const auto &commit1 : commits1)
-    {
-      // Check if commit1 exists in commits2
-      if (std::find(commits2.begin(), commits2.end(), commit1) != commits2.end())
-      {
-        return commit1;
-      }
-    }
-
-    return "";
+    // The best common ancestor of the two branch tips
+    return graphMergeBase(getBranchLastCommitHash(branch1), getBranchLastCommitHash(branch2));
   }
   catch (const std::exception &e)
   {
@@ -1018,8 +821,6 @@ bool applyCommitDuringRebase(const std::string &commit_hash)
 
     std::string line;
     std::string author, message, timestamp;
-    std::vector<std::string> files;
-    std::vector<std::string> deleted_files;
 
     // Read through the commit file line by line
     while (std::getline(file_stream, line))
@@ -1036,43 +837,29 @@ bool applyCommitDuringRebase(const std::string &commit_hash)
       {
         timestamp = line.substr(11);
       }
-      else if (line.find("Files: ") == 0)
-      {
-        std::string files_str = line.substr(7);
-        std::istringstream iss(files_str);
-        std::string file;
-        while (iss >> file)
-        {
-          files.push_back(file);
-        }
-      }
-      else if (line.find("Deleted: ") == 0)
-      {
-        std::string deleted_str = line.substr(9);
-        std::istringstream iss(deleted_str);
-        std::string file;
-        while (iss >> file)
-        {
-          deleted_files.push_back(file);
-        }
-      }
     }
 
     // apply the commit changes to the working directory
-    for (const auto &file : files)
+    std::map<std::string, std::string> commit_tree = getCommitTree(commit_hash);
+    std::map<std::string, std::string> parent_tree = getCommitTree(getCommitParent(commit_hash));
+    for (const auto &[file, blob_hash] : commit_tree)
     {
-      // Copy the file from the commit object to the working directory
-      std::string source_file = ".bittrack/objects/" + commit_hash + "/" + file;
-      std::filesystem::path file_path(file);
-      ErrorHandler::safeCreateDirectories(file_path.parent_path());
-      ErrorHandler::safeCopyFile(source_file, file);
+      // Skip files the commit did not touch
+      auto parent_entry = parent_tree.find(file);
+      if (parent_entry != parent_tree.end() && parent_entry->second == blob_hash)
+      {
+        continue;
+      }
+
+      // Copy the blob from the object store to the working directory
+      restoreBlobToFile(blob_hash, file);
       stage(file);
     }
 
     // handle deleted files
-    for (const auto &file : deleted_files)
+    for (const auto &[file, blob_hash] : parent_tree)
     {
-      if (ErrorHandler::safeRemoveFile(file))
+      if (commit_tree.find(file) == commit_tree.end() && ErrorHandler::safeRemoveFile(file))
       {
         stage(file + " (deleted)");
       }
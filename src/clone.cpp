@@ -0,0 +1,190 @@
+#include "../include/clone.hpp"
+
+// The cheapest method that worked so far, per pair of source and target file system
+static std::mutex clone_methods_mutex;
+static std::map<std::pair<dev_t, dev_t>, CloneMethod> clone_methods;
+
+CloneMethod getCloneMethod(
+    dev_t from_device,
+    dev_t to_device)
+{
+  std::lock_guard<std::mutex> lock(clone_methods_mutex);
+  auto method = clone_methods.find({from_device, to_device});
+  return method == clone_methods.end() ? CloneMethod::REFLINK : method->second;
+}
+
+static void setCloneMethod(
+    dev_t from_device,
+    dev_t to_device,
+    CloneMethod method)
+{
+  std::lock_guard<std::mutex> lock(clone_methods_mutex);
+  clone_methods[{from_device, to_device}] = method;
+}
+
+// Errors meaning the method is unavailable here, as opposed to the copy failing
+static bool isUnsupported(int error)
+{
+  return error == EOPNOTSUPP || error == ENOTTY || error == ENOSYS ||
+         error == EXDEV || error == EINVAL || error == ENOTSUP;
+}
+
+static bool reflinkFile(
+    int source,
+    int target)
+{
+#if defined(__linux__) && defined(FICLONE)
+  return ioctl(target, FICLONE, source) == 0;
+#else
+  (void)source;
+  (void)target;
+  errno = EOPNOTSUPP;
+  return false;
+#endif
+}
+
+static bool copyFileRange(
+    int source,
+    int target,
+    off_t size)
+{
+#ifdef __linux__
+  off_t copied = 0;
+  while (copied < size)
+  {
+    ssize_t result = copy_file_range(source, nullptr, target, nullptr, static_cast<size_t>(size - copied), 0);
+    if (result < 0 && errno == EINTR)
+    {
+      continue;
+    }
+    if (result <= 0)
+    {
+      // Only a failure on the first chunk can fall back to another method
+      if (result == 0 || copied > 0)
+      {
+        errno = EIO;
+      }
+      return false;
+    }
+    copied += result;
+  }
+  return true;
+#else
+  (void)source;
+  (void)target;
+  (void)size;
+  errno = EOPNOTSUPP;
+  return false;
+#endif
+}
+
+static bool readWriteFile(
+    int source,
+    int target)
+{
+  // Start over in case a kernel method gave up part way
+  if (lseek(source, 0, SEEK_SET) < 0 || lseek(target, 0, SEEK_SET) < 0 || ftruncate(target, 0) != 0)
+  {
+    return false;
+  }
+
+  std::vector<char> buffer(256 * 1024);
+  while (true)
+  {
+    ssize_t read_bytes = read(source, buffer.data(), buffer.size());
+    if (read_bytes < 0 && errno == EINTR)
+    {
+      continue;
+    }
+    if (read_bytes <= 0)
+    {
+      return read_bytes == 0;
+    }
+
+    for (ssize_t written = 0; written < read_bytes;)
+    {
+      ssize_t result = write(target, buffer.data() + written, static_cast<size_t>(read_bytes - written));
+      if (result < 0 && errno == EINTR)
+      {
+        continue;
+      }
+      if (result <= 0)
+      {
+        return false;
+      }
+      written += result;
+    }
+  }
+}
+
+bool cloneFile(
+    const std::string &from,
+    const std::string &to)
+{
+  int source = open(from.c_str(), O_RDONLY | O_CLOEXEC);
+  if (source < 0)
+  {
+    return false;
+  }
+
+  struct stat source_stat;
+  if (fstat(source, &source_stat) != 0 || !S_ISREG(source_stat.st_mode))
+  {
+    close(source);
+    return false;
+  }
+
+  // Truncating the target must never empty the source through another name
+  struct stat target_stat;
+  if (stat(to.c_str(), &target_stat) == 0 &&
+      target_stat.st_dev == source_stat.st_dev && target_stat.st_ino == source_stat.st_ino)
+  {
+    close(source);
+    errno = EINVAL;
+    return false;
+  }
+
+  int target = open(to.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, source_stat.st_mode & 07777);
+  if (target < 0 || fstat(target, &target_stat) != 0)
+  {
+    if (target >= 0)
+    {
+      close(target);
+    }
+    close(source);
+    return false;
+  }
+
+  // Try the cheapest method known to work between these file systems, and
+  // remember when one turns out to be unsupported so later files skip it
+  CloneMethod method = getCloneMethod(source_stat.st_dev, target_stat.st_dev);
+  bool copied = false;
+  if (method == CloneMethod::REFLINK)
+  {
+    copied = reflinkFile(source, target);
+    if (!copied && isUnsupported(errno))
+    {
+      method = CloneMethod::COPY_RANGE;
+      setCloneMethod(source_stat.st_dev, target_stat.st_dev, method);
+    }
+  }
+  if (!copied && method == CloneMethod::COPY_RANGE)
+  {
+    copied = copyFileRange(source, target, source_stat.st_size);
+    if (!copied && isUnsupported(errno))
+    {
+      method = CloneMethod::READ_WRITE;
+      setCloneMethod(source_stat.st_dev, target_stat.st_dev, method);
+    }
+  }
+  if (!copied && method == CloneMethod::READ_WRITE)
+  {
+    copied = readWriteFile(source, target);
+  }
+
+  // An existing target keeps its own mode unless it is set again
+  copied = copied && fchmod(target, source_stat.st_mode & 07777) == 0;
+  copied = close(target) == 0 && copied;
+  close(source);
+  return copied;
+}
@@ -1,66 +1,132 @@
 #include "../include/commit.hpp"
 
-void insertCommitRecordToHistory(
-    const std::string &last_commit_hash,
-    const std::string &new_branch_name)
+// First line of an append-only history journal; files without it are the
+// legacy newest-first format and are converted on the next append
+static const std::string HISTORY_HEADER = "# bittrack history journal";
+
+std::string getHistoryPath()
 {
-  // Prepend the new commit record to the history file
-  const std::string history_path = ".bittrack/commits/history";
+  return ".bittrack/commits/history";
+}
 
-  // Read existing commit history safely
-  std::string old_history = ErrorHandler::safeReadFile(history_path);
+static bool syncFile(const std::string &file_path)
+{
+  int fd = open(file_path.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    return false;
+  }
 
-  // Build the new full file content:
-  std::string new_entry = last_commit_hash + " " + new_branch_name + "\n";
-  std::string updated_history = new_entry + old_history;
+  bool synced = fsync(fd) == 0;
+  close(fd);
+  return synced;
+}
 
-  // Save using the safe write function
-  bool ok = ErrorHandler::safeWriteFile(history_path, updated_history);
+std::vector<std::pair<std::string, std::string>> readCommitHistory()
+{
+  // Records are returned oldest first, whatever the on-disk format
+  std::vector<std::pair<std::string, std::string>> history;
+  std::istringstream history_stream(ErrorHandler::safeReadFile(getHistoryPath()));
+  std::string line;
+  bool is_journal = false;
+  while (std::getline(history_stream, line))
+  {
+    if (line == HISTORY_HEADER)
+    {
+      is_journal = true;
+      continue;
+    }
 
-  if (!ok)
+    std::istringstream iss(line);
+    std::string commit_hash, branch;
+    if (iss >> commit_hash >> branch)
+    {
+      history.emplace_back(commit_hash, branch);
+    }
+  }
+
+  if (!is_journal)
   {
+    std::reverse(history.begin(), history.end());
+  }
+
+  return history;
+}
+
+bool writeCommitHistory(const std::vector<std::pair<std::string, std::string>> &history)
+{
+  std::string content = HISTORY_HEADER + "\n";
+  for (const auto &[commit_hash, branch] : history)
+  {
+    content += commit_hash + " " + branch + "\n";
+  }
+
+  // Replace the journal atomically, only rewrites such as branch cleanup need this
+  std::string temp_history_path = getHistoryPath() + ".tmp";
+  if (!ErrorHandler::safeWriteFile(temp_history_path, content) || !syncFile(temp_history_path) ||
+      !ErrorHandler::safeRename(temp_history_path, getHistoryPath()))
+  {
+    ErrorHandler::safeRemoveFile(temp_history_path);
     ErrorHandler::printError(
         ErrorCode::FILE_WRITE_ERROR,
-        "Failed to update commit history " + history_path,
+        "Failed to rewrite commit history " + getHistoryPath(),
         ErrorSeverity::ERROR,
-        "insertCommitRecordToHistory");
+        "write_commit_history");
+    return false;
   }
+
+  return true;
 }
 
-void storeSnapshot(
-    const std::string &file_path,
-    const std::string &commit_hash)
+void insertCommitRecordToHistory(
+    const std::string &last_commit_hash,
+    const std::string &new_branch_name)
 {
-  // Create the snapshot directory structure
-  std::string newDirPath = ".bittrack/objects/" + commit_hash;
-  std::filesystem::path relative_Path = std::filesystem::relative(file_path, ".");
-  std::filesystem::path snapshot_path = std::filesystem::path(newDirPath) / relative_Path;
+  // Convert a legacy newest-first history once, later records are only appended
+  std::string first_line = ErrorHandler::safeReadFirstLine(getHistoryPath());
+  if (first_line != HISTORY_HEADER && !writeCommitHistory(readCommitHistory()))
+  {
+    return;
+  }
 
-  // Ensure the parent directories exist
-  ErrorHandler::safeCreateDirectories(snapshot_path.parent_path());
+  // The commit log must be on disk before the journal refers to it
+  syncFile(".bittrack/commits/" + last_commit_hash);
 
-  // Read the entire file content
-  std::string buffer = ErrorHandler::safeReadFile(file_path);
-  if (buffer.empty())
+  // A single append of one short record is never interleaved with another writer
+  std::string new_entry = last_commit_hash + " " + new_branch_name + "\n";
+  int fd = open(getHistoryPath().c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+  bool ok = fd >= 0 &&
+            write(fd, new_entry.data(), new_entry.size()) == static_cast<ssize_t>(new_entry.size()) &&
+            fsync(fd) == 0;
+  if (fd >= 0)
+  {
+    close(fd);
+  }
+
+  if (!ok)
   {
     ErrorHandler::printError(
-        ErrorCode::FILE_READ_ERROR,
-        "Unable to read file: " + file_path,
+        ErrorCode::FILE_WRITE_ERROR,
+        "Failed to update commit history " + getHistoryPath(),
         ErrorSeverity::ERROR,
-        "store_snapshot");
-    return;
+        "insertCommitRecordToHistory");
   }
+}
 
-  // Write the buffer content to the snapshot file
-  if (!ErrorHandler::safeWriteFile(snapshot_path, buffer))
+std::string storeSnapshot(const std::string &file_path)
+{
+  // Store the file content as a blob; unchanged content is never written twice
+  std::string blob_hash = storeBlobFromFile(file_path);
+  if (blob_hash.empty())
   {
     ErrorHandler::printError(
         ErrorCode::FILE_WRITE_ERROR,
-        "Unable to create snapshot file: " + snapshot_path.string(),
+        "Unable to create snapshot of file: " + file_path,
         ErrorSeverity::ERROR,
         "store_snapshot");
-    return;
   }
+
+  return blob_hash;
 }
 
 std::string getCommitParent(const std::string &commit_hash)
@@ -87,6 +153,33 @@ std::string getCommitParent(const std::string &commit_hash)
   return "";
 }
 
+std::vector<std::string> getCommitParents(const std::string &commit_hash)
+{
+  // Merge commits record one Parent line per parent
+  std::vector<std::string> parents;
+  if (commit_hash.empty() || !std::filesystem::exists(".bittrack/commits/" + commit_hash))
+  {
+    return parents;
+  }
+
+  std::istringstream commit_stream(ErrorHandler::safeReadFile(".bittrack/commits/" + commit_hash));
+  std::string line;
+  while (std::getline(commit_stream, line) && line.rfind("Files:", 0) != 0)
+  {
+    if (line.rfind("Parent: ", 0) == 0)
+    {
+      std::string parent = line.substr(8);
+      parent.erase(parent.find_last_not_of(" \t\n\r") + 1);
+      if (!parent.empty())
+      {
+        parents.push_back(parent);
+      }
+    }
+  }
+
+  return parents;
+}
+
 void createCommitLog(
     const std::string &author, const std::string &message,
     const std::unordered_map<std::string, std::string> &file_hashes,
@@ -131,8 +224,9 @@ void createCommitLog(
         "create_commit_log");
   }
 
-  // Update commit history
+  // Update commit history and the commit graph
   insertCommitRecordToHistory(commit_hash, current_branch);
+  updateCommitGraph(commit_hash);
 
   if (!ErrorHandler::safeWriteFile(".bittrack/refs/heads/" + current_branch, commit_hash + "\n"))
   {
@@ -146,37 +240,71 @@ void createCommitLog(
 
 std::string getLastCommit(const std::string &branch)
 {
-  // Read the history file safely
-  std::string history_content =
-      ErrorHandler::safeReadFile(".bittrack/commits/history");
-  if (history_content.empty())
+  // Legacy histories are small enough to read whole
+  if (ErrorHandler::safeReadFirstLine(getHistoryPath()) != HISTORY_HEADER)
   {
+    std::vector<std::pair<std::string, std::string>> history = readCommitHistory();
+    for (auto record = history.rbegin(); record != history.rend(); ++record)
+    {
+      if (record->second == branch)
+      {
+        return record->first;
+      }
+    }
     return "";
   }
 
-  std::istringstream history_stream(history_content);
-  std::string line;
-
-  // Iterate through the history file
-  while (std::getline(history_stream, line))
+  int fd = open(getHistoryPath().c_str(), O_RDONLY);
+  if (fd < 0)
   {
-    // Parse each line to extract commit hash and branch name
-    std::istringstream iss(line);
-    std::string commit_file_hash, commit_branch;
+    return "";
+  }
 
-    // Check if the line has the correct format
-    if (!(iss >> commit_file_hash >> commit_branch))
+  // Scan the journal backwards in blocks, the newest records are at the end
+  const off_t block_size = 64 * 1024;
+  off_t block_end = lseek(fd, 0, SEEK_END);
+  std::string pending;
+  std::string commit_hash;
+  while (block_end > 0 && commit_hash.empty())
+  {
+    off_t block_start = std::max<off_t>(0, block_end - block_size);
+    std::string block(static_cast<std::size_t>(block_end - block_start), '\0');
+    if (pread(fd, &block[0], block.size(), block_start) != static_cast<ssize_t>(block.size()))
     {
-      continue;
+      break;
     }
+    pending = block + pending;
+    block_end = block_start;
 
-    // Check if the branch matches
-    if (commit_branch == branch)
+    // Only lines whose start is known are complete, the first may continue in the previous block
+    std::size_t line_end = pending.size();
+    while (commit_hash.empty())
     {
-      return commit_file_hash;
+      std::size_t line_start = line_end == 0 ? std::string::npos : pending.rfind('\n', line_end - 1);
+      if (line_start == std::string::npos && block_start > 0)
+      {
+        break;
+      }
+
+      std::size_t begin = line_start == std::string::npos ? 0 : line_start + 1;
+      std::istringstream iss(pending.substr(begin, line_end - begin));
+      std::string record_hash, record_branch;
+      if (iss >> record_hash >> record_branch && record_hash != "#" && record_branch == branch)
+      {
+        commit_hash = record_hash;
+      }
+
+      if (line_start == std::string::npos)
+      {
+        break;
+      }
+      line_end = line_start;
     }
+    pending.resize(line_end);
   }
-  return "";
+
+  close(fd);
+  return commit_hash;
 }
 
 void commitChanges(const std::string &author, const std::string &message)
@@ -213,86 +341,20 @@ void commitChanges(const std::string &author, const std::string &message)
   std::unordered_map<std::string, std::string> file_hashes;
   std::string timestamp = std::to_string(std::time(nullptr));
   std::string commit_hash = generateCommitHash(author, message, timestamp);
-  std::string line;
-
-  // Create commit directory
-  std::string commit_dir = ".bittrack/objects/" + commit_hash;
-  std::filesystem::create_directories(commit_dir);
-
-  // Handle deleted files
-  std::set<std::string> deleted_files;
-  // Read staged deletions
-  std::string staging_content = ErrorHandler::safeReadFile(".bittrack/index");
-  if (!staging_content.empty())
-  {
-    std::istringstream staging_stream(staging_content);
-    std::string line;
-    while (std::getline(staging_stream, line))
-    {
-      if (line.empty())
-      {
-        continue;
-      }
-
-      // Parse the line to extract file path and hash
-      size_t last_space_pos = line.find_last_of(' ');
-      if (last_space_pos != std::string::npos)
-      {
-        // Extract file path and hash
-        std::string filePath = line.substr(0, last_space_pos);
-        std::string fileHash = line.substr(last_space_pos + 1);
-
-        // Trim whitespace from fileHash
-        fileHash.erase(0, fileHash.find_first_not_of(" \t"));
-        fileHash.erase(fileHash.find_last_not_of(" \t") + 1);
-
-        // Check for deletions (empty hash)
-        if (fileHash.empty())
-        {
-          // Record deleted file
-          std::string originalFilePath = getActualPath(filePath);
-          deleted_files.insert(originalFilePath);
-        }
-      }
-    }
-  }
 
-  // Copy unchanged files from previous commit
+  // Start from the tree of the previous commit so unchanged files keep their blobs
   std::string previous_commit = getCurrentCommit();
   if (!previous_commit.empty())
   {
-    // Copy files from previous commit, excluding deleted files
-    std::string previous_commit_path = ".bittrack/objects/" + previous_commit;
-    if (std::filesystem::exists(previous_commit_path))
+    for (const auto &[file_path, blob_hash] : getCommitTree(previous_commit))
     {
-      // Iterate through files in the previous commit
-      for (const auto &entry : ErrorHandler::safeListDirectoryFiles(previous_commit_path))
-      {
-        // Determine relative path
-        std::string file_path = entry.string();
-
-        if (deleted_files.find(file_path) != deleted_files.end())
-        {
-          continue;
-        }
-
-        // Copy file from the previous commit's object directory
-        std::string new_file_path = commit_dir + "/" + file_path;
-        std::filesystem::path source_path = std::filesystem::path(previous_commit_path) / entry;
-        ErrorHandler::safeCreateDirectories(std::filesystem::path(new_file_path).parent_path());
-        ErrorHandler::safeCopyFile(source_path, new_file_path);
-
-        // Compute and store file hash
-        std::string file_hash = hashFile(new_file_path);
-        file_hashes[file_path] = file_hash;
-      }
+      file_hashes[file_path] = blob_hash;
     }
   }
 
   // Process staged files
-  std::string staging_content_final =
-      ErrorHandler::safeReadFile(".bittrack/index");
-  if (staging_content_final.empty())
+  std::unordered_map<std::string, std::string> staged_files = loadStagedFiles();
+  if (staged_files.empty())
   {
     ErrorHandler::printError(
         ErrorCode::STAGING_FAILED,
@@ -302,66 +364,57 @@ void commitChanges(const std::string &author, const std::string &message)
     return;
   }
 
-  std::istringstream staging_stream_final(staging_content_final);
-  bool has_staged_files = false;
-  while (std::getline(staging_stream_final, line))
+  std::vector<std::string> files_to_store;
+  for (const auto &[filePath, fileHash] : staged_files)
   {
-    if (line.empty())
+    // Handle deletions
+    if (fileHash.empty())
     {
-      continue;
+      // File is marked for deletion, an empty hash drops it from the tree
+      std::string originalFilePath = getActualPath(filePath);
+      file_hashes[originalFilePath] = "";
     }
-
-    has_staged_files = true;
-
-    // Parse the line to extract file path and hash
-    size_t last_space_pos = line.find_last_of(' ');
-    if (last_space_pos != std::string::npos)
+    else
     {
-      // Extract file path and hash
-      std::string filePath = line.substr(0, last_space_pos);
-      std::string fileHash = line.substr(last_space_pos + 1);
-
-      fileHash.erase(0, fileHash.find_first_not_of(" \t"));
-      fileHash.erase(fileHash.find_last_not_of(" \t") + 1);
+      // File is added or modified
+      files_to_store.push_back(filePath);
+    }
+  }
 
-      // Handle deletions
-      if (fileHash.empty())
+  // Hash and compress the snapshots on the worker pool; failures are reported
+  // afterwards on this thread so messages never interleave
+  std::vector<std::string> blob_hashes(files_to_store.size());
+  parallelForEach(
+      files_to_store.size(),
+      [&](std::size_t i)
       {
-        // File is marked for deletion
-        std::string originalFilePath = getActualPath(filePath);
-        file_hashes[originalFilePath] = "";
-        std::string deleted_file_path = commit_dir + "/" + originalFilePath;
-
-        // Remove the file from the commit snapshot if it exists
-        if (std::filesystem::exists(deleted_file_path))
+        std::ifstream input(files_to_store[i], std::ios::binary);
+        if (input.is_open())
         {
-          ErrorHandler::safeRemoveFile(deleted_file_path);
+          blob_hashes[i] = storeBlobFromStream(input);
         }
-      }
-      else
-      {
-        // File is added or modified
-        storeSnapshot(filePath, commit_hash);
-        file_hashes[filePath] = fileHash;
-      }
-    }
-  }
+      });
 
-  // Check if there were any staged files
-  if (!has_staged_files)
+  for (std::size_t i = 0; i < files_to_store.size(); i++)
   {
-    ErrorHandler::printError(
-        ErrorCode::STAGING_FAILED,
-        "No files to commit!",
-        ErrorSeverity::ERROR,
-        "commit_changes");
-    return;
+    if (blob_hashes[i].empty())
+    {
+      ErrorHandler::printError(
+          ErrorCode::FILE_WRITE_ERROR,
+          "Unable to create snapshot of file: " + files_to_store[i],
+          ErrorSeverity::ERROR,
+          "store_snapshot");
+    }
+    else
+    {
+      file_hashes[files_to_store[i]] = blob_hashes[i];
+    }
   }
 
   // Create commit log
   createCommitLog(author, message, file_hashes, commit_hash);
-  // Clear the staging area
-  ErrorHandler::safeWriteFile(".bittrack/index", "");
+  // Clear the staging area, cached stat data is kept for status
+  clearStagingArea();
   // Run post-commit hook
   HookResult hook_result = runHook(HookType::POST_COMMIT);
   if (!hook_result.success)
@@ -461,14 +514,54 @@ std::vector<std::string> getCommitFiles(const std::string &commit_hash)
 {
   // Retrieve the list of files associated with a specific commit
   std::vector<std::string> files;
-  std::string commit_path = ".bittrack/objects/" + commit_hash;
-
-  // Use safe list directory files
-  std::vector<std::filesystem::path> commitFiles =
-      ErrorHandler::safeListDirectoryFiles(commit_path);
-  for (const auto &entry : commitFiles)
+  for (const auto &[file_path, blob_hash] : getCommitTree(commit_hash))
   {
-    files.push_back(entry.filename().string());
+    files.push_back(file_path);
   }
   return files;
 }
+
+std::map<std::string, std::string> getCommitTree(const std::string &commit_hash)
+{
+  // Map every file present in the commit to its blob hash
+  std::map<std::string, std::string> tree;
+  if (commit_hash.empty() || !std::filesystem::exists(".bittrack/commits/" + commit_hash))
+  {
+    return tree;
+  }
+
+  std::string commit_content = ErrorHandler::safeReadFile(".bittrack/commits/" + commit_hash);
+  std::istringstream commit_stream(commit_content);
+  std::string line;
+  bool in_files_section = false;
+
+  while (std::getline(commit_stream, line))
+  {
+    if (line.rfind("Files:", 0) == 0)
+    {
+      in_files_section = true;
+      continue;
+    }
+
+    if (!in_files_section || line.empty())
+    {
+      continue;
+    }
+
+    // Each entry is "<path> <blob hash>"; deleted files have an empty hash
+    size_t last_space_pos = line.find_last_of(' ');
+    if (last_space_pos == std::string::npos)
+    {
+      continue;
+    }
+
+    std::string file_path = line.substr(0, last_space_pos);
+    std::string blob_hash = line.substr(last_space_pos + 1);
+    if (!blob_hash.empty())
+    {
+      tree[file_path] = blob_hash;
+    }
+  }
+
+  return tree;
+}
@@ -25,7 +25,7 @@ DiffResult compareTwoFiles(
   std::vector<std::string> lines2 = readFileLines(file2);
 
   // compute hunks
-  result.hunks = computeHunks(lines1, lines2);
+  result.hunks = computeHunks(lines1, lines2, getDiffContextLines());
   return result;
 }
 
@@ -62,7 +62,7 @@ DiffResult compareFileWithContent(
   }
 
   // compute hunks
-  result.hunks = computeHunks(file_lines, content_lines);
+  result.hunks = computeHunks(file_lines, content_lines, getDiffContextLines());
   return result;
 }
 
@@ -125,6 +125,7 @@ DiffResult diffStagedFiles()
   }
 
   // Diff each staged file against the last commit
+  std::map<std::string, std::string> commit_tree = getCommitTree(current_commit);
   for (const auto &file : staged_files)
   {
     // Skip binary files
@@ -135,15 +136,27 @@ DiffResult diffStagedFiles()
 
     // Get staged content
     std::string staged_content = getStagedFileContent(file);
-    std::string commit_file = ".bittrack/objects/" + current_commit + "/" + file;
+    auto commit_entry = commit_tree.find(file);
 
     // Compare staged file to last commit
-    if (std::filesystem::exists(commit_file))
+    if (commit_entry != commit_tree.end())
     {
-      DiffResult file_diff = compareTwoFiles(commit_file, file);
+      if (!std::filesystem::exists(file))
+      {
+        continue;
+      }
+
+      // Read the committed lines from the blob store
+      std::vector<std::string> commit_lines;
+      std::istringstream commit_stream(readBlob(commit_entry->second));
+      std::string commit_line;
+      while (std::getline(commit_stream, commit_line))
+      {
+        commit_lines.push_back(commit_line);
+      }
 
       // Adjust hunk headers to include file name
-      for (const auto &hunk : file_diff.hunks)
+      for (const auto &hunk : computeHunks(commit_lines, readFileLines(file), getDiffContextLines()))
       {
         DiffHunk file_hunk = hunk;
         file_hunk.header = file + ": " + hunk.header;
@@ -263,15 +276,10 @@ DiffResult diffWorkingDirectory()
 
   // Also include files from the last commit that may have been deleted in the
   // working directory
-  std::string commit_dir = ".bittrack/objects/" + current_commit;
-  if (std::filesystem::exists(commit_dir))
+  std::map<std::string, std::string> commit_tree = getCommitTree(current_commit);
+  for (const auto &[file, blob_hash] : commit_tree)
   {
-    // Recursively iterate through commit directory to find all files
-    for (const auto &entry : ErrorHandler::safeListDirectoryFiles(commit_dir))
-    {
-      std::string rel_path = std::filesystem::relative(entry, commit_dir).string();
-      all_files.insert(rel_path);
-    }
+    all_files.insert(file);
   }
 
   // Diff each file against the last commit
@@ -284,11 +292,11 @@ DiffResult diffWorkingDirectory()
     }
 
     // Get commit file path
-    std::string commit_file = ".bittrack/objects/" + current_commit + "/" + file;
-    if (std::filesystem::exists(commit_file))
+    auto commit_entry = commit_tree.find(file);
+    if (commit_entry != commit_tree.end())
     {
       // Compare working file to last commit
-      DiffResult file_diff = compareTwoFiles(file, commit_file);
+      DiffResult file_diff = compareFileWithContent(file, readBlob(commit_entry->second));
 
       // Adjust hunk headers to include file name
       for (const auto &hunk : file_diff.hunks)
@@ -412,117 +420,293 @@ std::vector<std::string> readFileLines(const std::string &file_path)
   return lines;
 }
 
+int getDiffContextLines()
+{
+  // Number of unchanged lines shown around each change, from diff.context
+  std::string context = configGet("diff.context");
+  if (!context.empty())
+  {
+    try
+    {
+      int context_lines = std::stoi(context);
+      if (context_lines >= 0)
+      {
+        return context_lines;
+      }
+    }
+    catch (const std::exception &)
+    {
+    }
+
+    ErrorHandler::printError(
+        ErrorCode::CONFIG_ERROR,
+        "Invalid diff.context value '" + context + "', using 3",
+        ErrorSeverity::WARNING,
+        "get_diff_context_lines");
+  }
+
+  return 3;
+}
+
 std::vector<DiffHunk> computeHunks(
     const std::vector<std::string> &old_lines,
-    const std::vector<std::string> &new_lines)
+    const std::vector<std::string> &new_lines,
+    int context_lines)
 {
   // Compute diff lines
   std::vector<DiffHunk> hunks;
   std::vector<DiffLine> diff_lines = computeDiffLines(old_lines, new_lines);
 
-  // Group diff lines into hunks
-  if (diff_lines.empty())
+  // Collect the positions of changed lines
+  std::vector<size_t> changes;
+  for (size_t i = 0; i < diff_lines.size(); i++)
   {
-    return hunks;
+    if (diff_lines[i].type != DiffLineType::CONTEXT)
+    {
+      changes.push_back(i);
+    }
   }
 
-  // Initialize hunk variables
-  DiffHunk current_hunk(0, 0, 0, 0, "");
-  int old_line = 1;
-  int new_line = 1;
+  // Old and new line numbers before each diff line
+  std::vector<int> old_before(diff_lines.size() + 1, 0);
+  std::vector<int> new_before(diff_lines.size() + 1, 0);
+  for (size_t i = 0; i < diff_lines.size(); i++)
+  {
+    old_before[i + 1] = old_before[i] + (diff_lines[i].type != DiffLineType::ADDITION ? 1 : 0);
+    new_before[i + 1] = new_before[i] + (diff_lines[i].type != DiffLineType::DELETION ? 1 : 0);
+  }
 
-  // Iterate through diff lines
-  for (const auto &line : diff_lines)
+  size_t context = static_cast<size_t>(std::max(context_lines, 0));
+  size_t next_change = 0;
+  while (next_change < changes.size())
   {
-    // Check if line is addition or deletion
-    if (line.type == DiffLineType::ADDITION || line.type == DiffLineType::DELETION)
+    // Extend the hunk while the gap to the next change fits in both contexts
+    size_t first_change = changes[next_change];
+    size_t last_change = first_change;
+    while (next_change + 1 < changes.size() && changes[next_change + 1] - last_change - 1 <= 2 * context)
     {
-      // Start new hunk if necessary
-      if (current_hunk.lines.empty())
-      {
-        current_hunk.old_start = old_line;
-        current_hunk.new_start = new_line;
-        current_hunk.header = "@@ -" + std::to_string(old_line) + ",0 +" + std::to_string(new_line) + ",0 @@";
-      }
-      current_hunk.lines.push_back(line);
+      last_change = changes[++next_change];
     }
-    else
+    next_change++;
+
+    size_t begin = first_change > context ? first_change - context : 0;
+    size_t end = std::min(diff_lines.size(), last_change + context + 1);
+
+    // An empty side starts at the line before the hunk, as in unified diffs
+    int old_count = old_before[end] - old_before[begin];
+    int new_count = new_before[end] - new_before[begin];
+    int old_start = old_count > 0 ? old_before[begin] + 1 : old_before[begin];
+    int new_start = new_count > 0 ? new_before[begin] + 1 : new_before[begin];
+
+    DiffHunk hunk(
+        old_start,
+        old_count,
+        new_start,
+        new_count,
+        "@@ -" + std::to_string(old_start) + "," + std::to_string(old_count) +
+            " +" + std::to_string(new_start) + "," + std::to_string(new_count) + " @@");
+    hunk.lines.assign(diff_lines.begin() + begin, diff_lines.begin() + end);
+    hunks.push_back(hunk);
+  }
+
+  return hunks;
+}
+
+// Find the middle snake of the edit graph between a[a_lo, a_hi) and
+// b[b_lo, b_hi) and recurse on both halves, marking deleted and inserted lines
+static void markMyersEdits(
+    const std::vector<int> &a, size_t a_lo, size_t a_hi,
+    const std::vector<int> &b, size_t b_lo, size_t b_hi,
+    std::vector<bool> &deleted,
+    std::vector<bool> &inserted)
+{
+  long n = static_cast<long>(a_hi - a_lo);
+  long m = static_cast<long>(b_hi - b_lo);
+  if (n == 0 || m == 0)
+  {
+    for (size_t i = a_lo; i < a_hi; i++)
     {
-      // If we hit a context line and have a current hunk, finalize it
-      if (!current_hunk.lines.empty())
-      {
-        current_hunk.old_count = current_hunk.lines.size();
-        current_hunk.new_count = current_hunk.lines.size();
-        hunks.push_back(current_hunk);
-        current_hunk = DiffHunk(0, 0, 0, 0, "");
-      }
+      deleted[i] = true;
     }
-
-    if (line.type != DiffLineType::ADDITION)
+    for (size_t j = b_lo; j < b_hi; j++)
     {
-      old_line++;
+      inserted[j] = true;
     }
-    if (line.type != DiffLineType::DELETION)
+    return;
+  }
+
+  long total = n + m;
+  long width = 2 * std::min(n, m) + 2;
+  long delta = n - m;
+  std::vector<long> forward(width, 0);
+  std::vector<long> backward(width, 0);
+  auto slot = [width](long k)
+  { return static_cast<size_t>(((k % width) + width) % width); };
+
+  for (long h = 0; h <= total / 2 + total % 2; h++)
+  {
+    // Alternate a forward pass from the start and a backward pass from the end
+    for (int pass = 0; pass < 2; pass++)
     {
-      new_line++;
+      bool is_forward = pass == 0;
+      std::vector<long> &current = is_forward ? forward : backward;
+      std::vector<long> &opposite = is_forward ? backward : forward;
+
+      for (long k = -(h - 2 * std::max(0L, h - m)); k <= h - 2 * std::max(0L, h - n); k += 2)
+      {
+        long x = (k == -h || (k != h && current[slot(k - 1)] < current[slot(k + 1)]))
+                     ? current[slot(k + 1)]
+                     : current[slot(k - 1)] + 1;
+        long y = x - k;
+        long start_x = x;
+        long start_y = y;
+
+        // Follow the diagonal while lines match
+        while (x < n && y < m &&
+               (is_forward ? a[a_lo + x] == b[b_lo + y]
+                           : a[a_lo + n - x - 1] == b[b_lo + m - y - 1]))
+        {
+          x++;
+          y++;
+        }
+        current[slot(k)] = x;
+
+        long z = delta - k;
+        long limit = is_forward ? h - 1 : h;
+        if (total % 2 == (is_forward ? 1 : 0) && z >= -limit && z <= limit &&
+            current[slot(k)] + opposite[slot(z)] >= n)
+        {
+          long edits = is_forward ? 2 * h - 1 : 2 * h;
+          long snake_x = is_forward ? start_x : n - x;
+          long snake_y = is_forward ? start_y : m - y;
+          long snake_u = is_forward ? x : n - start_x;
+          long snake_v = is_forward ? y : m - start_y;
+
+          if (edits > 1 || (snake_x != snake_u && snake_y != snake_v))
+          {
+            markMyersEdits(a, a_lo, a_lo + snake_x, b, b_lo, b_lo + snake_y, deleted, inserted);
+            markMyersEdits(a, a_lo + snake_u, a_hi, b, b_lo + snake_v, b_hi, deleted, inserted);
+          }
+          else if (m > n)
+          {
+            markMyersEdits(a, a_hi, a_hi, b, b_lo + n, b_hi, deleted, inserted);
+          }
+          else if (m < n)
+          {
+            markMyersEdits(a, a_lo + m, a_hi, b, b_hi, b_hi, deleted, inserted);
+          }
+          return;
+        }
+      }
     }
   }
+}
+
+// Mark the lines a minimal edit script deletes from old_lines and inserts
+// from new_lines
+static void markLineEdits(
+    const std::vector<std::string> &old_lines,
+    const std::vector<std::string> &new_lines,
+    std::vector<bool> &deleted,
+    std::vector<bool> &inserted)
+{
+  // Map each distinct line to an integer so the search compares ints
+  std::unordered_map<std::string, int> line_ids;
+  std::vector<int> old_ids;
+  std::vector<int> new_ids;
+  old_ids.reserve(old_lines.size());
+  new_ids.reserve(new_lines.size());
+  for (const auto &line : old_lines)
+  {
+    old_ids.push_back(line_ids.emplace(line, static_cast<int>(line_ids.size())).first->second);
+  }
+  for (const auto &line : new_lines)
+  {
+    new_ids.push_back(line_ids.emplace(line, static_cast<int>(line_ids.size())).first->second);
+  }
 
-  // Finalize last hunk if necessary
-  if (!current_hunk.lines.empty())
+  // Common prefix and suffix never take part in the edit script
+  size_t prefix = 0;
+  while (prefix < old_ids.size() && prefix < new_ids.size() && old_ids[prefix] == new_ids[prefix])
+  {
+    prefix++;
+  }
+  size_t old_end = old_ids.size();
+  size_t new_end = new_ids.size();
+  while (old_end > prefix && new_end > prefix && old_ids[old_end - 1] == new_ids[new_end - 1])
   {
-    current_hunk.old_count = current_hunk.lines.size();
-    current_hunk.new_count = current_hunk.lines.size();
-    hunks.push_back(current_hunk);
+    old_end--;
+    new_end--;
   }
 
-  return hunks;
+  // Compute a minimal edit script with Myers' linear space O(ND) algorithm
+  deleted.assign(old_ids.size(), false);
+  inserted.assign(new_ids.size(), false);
+  markMyersEdits(old_ids, prefix, old_end, new_ids, prefix, new_end, deleted, inserted);
 }
 
 std::vector<DiffLine> computeDiffLines(
     const std::vector<std::string> &old_lines,
     const std::vector<std::string> &new_lines)
 {
-  // Compute diff lines using a simple line-by-line comparison
-  std::vector<DiffLine> diff_lines;
-  size_t max_lines = std::max(old_lines.size(), new_lines.size());
+  std::vector<bool> deleted;
+  std::vector<bool> inserted;
+  markLineEdits(old_lines, new_lines, deleted, inserted);
 
-  // Iterate through lines
-  for (size_t i = 0; i < max_lines; i++)
+  // Walk both sides, emitting deletions before insertions in each change
+  std::vector<DiffLine> diff_lines;
+  size_t i = 0;
+  size_t j = 0;
+  while (i < old_lines.size() || j < new_lines.size())
   {
-    // Check if line exists in old and new
-    bool old_exists = (i < old_lines.size());
-    bool new_exists = (i < new_lines.size());
-
-    // Determine line type
-    if (old_exists && new_exists)
+    if (i < old_lines.size() && deleted[i])
     {
-      // Both lines exist, check for equality
-      if (old_lines[i] == new_lines[i])
-      {
-        diff_lines.push_back(DiffLine(DiffLineType::CONTEXT, i + 1, old_lines[i]));
-      }
-      else
-      {
-        diff_lines.push_back(DiffLine(DiffLineType::DELETION, i + 1, old_lines[i]));
-        diff_lines.push_back(DiffLine(DiffLineType::ADDITION, i + 1, new_lines[i]));
-      }
+      diff_lines.push_back(DiffLine(DiffLineType::DELETION, i + 1, old_lines[i]));
+      i++;
     }
-    else if (old_exists) // Line exists only in old
+    else if (j < new_lines.size() && inserted[j])
     {
-      // Line deleted
-      diff_lines.push_back(DiffLine(DiffLineType::DELETION, i + 1, old_lines[i]));
+      diff_lines.push_back(DiffLine(DiffLineType::ADDITION, j + 1, new_lines[j]));
+      j++;
     }
     else
     {
-      // Line added
-      diff_lines.push_back(DiffLine(DiffLineType::ADDITION, i + 1, new_lines[i]));
+      diff_lines.push_back(DiffLine(DiffLineType::CONTEXT, i + 1, old_lines[i]));
+      i++;
+      j++;
     }
   }
 
   return diff_lines;
 }
 
+std::vector<int> computeLineMatches(
+    const std::vector<std::string> &old_lines,
+    const std::vector<std::string> &new_lines)
+{
+  std::vector<bool> deleted;
+  std::vector<bool> inserted;
+  markLineEdits(old_lines, new_lines, deleted, inserted);
+
+  // Lines kept by the edit script pair up in order
+  std::vector<int> matches(old_lines.size(), -1);
+  size_t j = 0;
+  for (size_t i = 0; i < old_lines.size(); i++)
+  {
+    if (deleted[i])
+    {
+      continue;
+    }
+    while (inserted[j])
+    {
+      j++;
+    }
+    matches[i] = static_cast<int>(j++);
+  }
+
+  return matches;
+}
+
 void printDiffLine(
     const DiffLine &line,
     const std::string &prefix)
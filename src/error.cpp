@@ -1,3 +1,4 @@
+#include "../include/clone.hpp"
 #include "../include/error.hpp"
 
 void ErrorHandler::printError(const BitTrackError &error)
@@ -304,12 +305,12 @@ bool ErrorHandler::validateRemoteUrl(const std::string &url)
     return false;
   }
 
-  std::regex urlPattern("^(https?|ftp)://[^\\s/$.?#].[^\\s]*$");
+  std::regex urlPattern("^((https?|ftp)://[^\\s/$.?#].[^\\s]*|file:///[^\\s]*)$");
   if (!std::regex_match(url, urlPattern))
   {
     printError(
         ErrorCode::INVALID_REMOTE_URL,
-        "Invalid URL format. Use http:// or https:// URLs",
+        "Invalid URL format. Use http://, https:// or file:// URLs",
         ErrorSeverity::ERROR,
         url);
     return false;
@@ -367,8 +368,16 @@ bool ErrorHandler::safeCopyFile(
       safeCreateDirectories(to.parent_path());
     }
 
-    std::filesystem::copy_file(
-        from, to, std::filesystem::copy_options::overwrite_existing);
+    // Reflinks make the copy free on copy-on-write file systems
+    if (!cloneFile(from.string(), to.string()))
+    {
+      printError(
+          ErrorCode::FILE_WRITE_ERROR,
+          "Unable to copy " + from.string() + " to " + to.string() + ": " + std::string(std::strerror(errno)),
+          ErrorSeverity::ERROR,
+          to.string());
+      return false;
+    }
     return true;
   }
   catch (const std::filesystem::filesystem_error &e)
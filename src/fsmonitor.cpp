@@ -0,0 +1,623 @@
+#include "../include/fsmonitor.hpp"
+
+std::string getFsMonitorSocketPath()
+{
+  return ".bittrack/fsmonitor.sock";
+}
+
+std::string getFsMonitorStatePath()
+{
+  return ".bittrack/fsmonitor-state";
+}
+
+static int connectFsMonitor()
+{
+  int socket_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (socket_fd < 0)
+  {
+    return -1;
+  }
+
+  // A wedged daemon must only cost a fallback to a full scan, never a hang
+  struct timeval timeout = {2, 0};
+  setsockopt(socket_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  setsockopt(socket_fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+  struct sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  std::strncpy(address.sun_path, getFsMonitorSocketPath().c_str(), sizeof(address.sun_path) - 1);
+  if (connect(socket_fd, reinterpret_cast<struct sockaddr *>(&address), sizeof(address)) != 0)
+  {
+    close(socket_fd);
+    return -1;
+  }
+
+  return socket_fd;
+}
+
+static bool sendAll(
+    int socket_fd,
+    const std::string &data)
+{
+  std::size_t written = 0;
+  while (written < data.size())
+  {
+    ssize_t result = send(socket_fd, data.data() + written, data.size() - written, MSG_NOSIGNAL);
+    if (result <= 0)
+    {
+      return false;
+    }
+    written += static_cast<std::size_t>(result);
+  }
+  return true;
+}
+
+static bool sendFsMonitorRequest(
+    const std::string &request,
+    std::string &response)
+{
+  int socket_fd = connectFsMonitor();
+  if (socket_fd < 0)
+  {
+    return false;
+  }
+
+  // One request per connection; the daemon closes once it has answered
+  bool succeeded = sendAll(socket_fd, request + "\n");
+  std::vector<char> buffer(64 * 1024);
+  ssize_t bytes_read = 0;
+  while (succeeded && (bytes_read = read(socket_fd, buffer.data(), buffer.size())) > 0)
+  {
+    response.append(buffer.data(), static_cast<std::size_t>(bytes_read));
+  }
+  close(socket_fd);
+
+  return succeeded && bytes_read == 0;
+}
+
+bool isFsMonitorRunning()
+{
+  std::string response;
+  return sendFsMonitorRequest("ping", response) && response == "pong\n";
+}
+
+bool queryFsMonitor(
+    const std::string &since_token,
+    FsMonitorChanges &changes)
+{
+  std::string response;
+  if (!sendFsMonitorRequest("query " + since_token, response))
+  {
+    return false;
+  }
+
+  // The answer is the new token, then either "full" or "changes" followed by one path per line
+  std::istringstream lines(response);
+  std::string token_line;
+  std::string kind;
+  if (!std::getline(lines, token_line) || token_line.rfind("token ", 0) != 0 || !std::getline(lines, kind))
+  {
+    return false;
+  }
+
+  changes.token = token_line.substr(6);
+  changes.full_scan = kind != "changes";
+  changes.paths.clear();
+  std::string path;
+  while (std::getline(lines, path))
+  {
+    changes.paths.push_back(path);
+  }
+  return !changes.token.empty();
+}
+
+bool loadFsMonitorState(FsMonitorState &state)
+{
+  std::ifstream state_file(getFsMonitorStatePath());
+  if (!state_file.is_open())
+  {
+    return false;
+  }
+
+  std::string token_line;
+  std::string head_line;
+  std::string index_line;
+  if (!std::getline(state_file, token_line) || token_line.rfind("token ", 0) != 0 ||
+      !std::getline(state_file, head_line) || head_line.rfind("head ", 0) != 0 ||
+      !std::getline(state_file, index_line) || index_line.rfind("index ", 0) != 0)
+  {
+    return false;
+  }
+
+  state.token = token_line.substr(6);
+  state.head = head_line.substr(5);
+  state.index_digest = index_line.substr(6);
+  state.untracked.clear();
+  std::string path;
+  while (std::getline(state_file, path))
+  {
+    state.untracked.push_back(path);
+  }
+  return true;
+}
+
+bool saveFsMonitorState(const FsMonitorState &state)
+{
+  std::string content = "token " + state.token + "\n" +
+                        "head " + state.head + "\n" +
+                        "index " + state.index_digest + "\n";
+  for (const auto &path : state.untracked)
+  {
+    content += path + "\n";
+  }
+
+  // Concurrent status calls each replace the whole file
+  std::string temp_path = getFsMonitorStatePath() + ".tmp" + std::to_string(getpid());
+  if (!ErrorHandler::safeWriteFile(temp_path, content) ||
+      !ErrorHandler::safeRename(temp_path, getFsMonitorStatePath()))
+  {
+    ErrorHandler::safeRemoveFile(temp_path);
+    return false;
+  }
+  return true;
+}
+
+#ifdef __linux__
+
+// Events that can change what status reports for a path
+static const uint32_t FSMONITOR_EVENTS = IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB |
+                                         IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR | IN_EXCL_UNLINK;
+
+// Remembered paths before the daemon forgets them and asks for full scans instead
+static const std::size_t FSMONITOR_MAX_PATHS = 1000000;
+
+// Live state of the monitor daemon
+struct FsMonitorDaemon
+{
+  int inotify_fd;                                    // inotify instance watching the working tree
+  std::string instance;                              // tells tokens of this daemon apart from earlier ones
+  uint64_t sequence;                                 // bumped for every recorded change
+  uint64_t reset_sequence;                           // tokens before this point need a full scan
+  bool healthy;                                      // false once a directory could not be watched
+  std::unordered_map<int, std::string> watches;      // watch descriptor to directory, "" for the root
+  std::unordered_map<std::string, uint64_t> changes; // path to the sequence of its latest change
+
+  FsMonitorDaemon() : inotify_fd(-1), sequence(0), reset_sequence(0), healthy(true) {}
+};
+
+static void forgetChanges(FsMonitorDaemon &daemon)
+{
+  daemon.changes.clear();
+  daemon.reset_sequence = ++daemon.sequence;
+}
+
+static void recordChange(
+    FsMonitorDaemon &daemon,
+    const std::string &path)
+{
+  daemon.changes[path] = ++daemon.sequence;
+  if (daemon.changes.size() > FSMONITOR_MAX_PATHS)
+  {
+    forgetChanges(daemon);
+  }
+}
+
+static bool watchTree(
+    FsMonitorDaemon &daemon,
+    const std::string &root,
+    bool record_files)
+{
+  std::shared_ptr<const std::vector<IgnorePattern>> patterns = getIgnorePatterns();
+
+  // Watch each directory before listing it, so files created meanwhile are
+  // either listed here or reported by the new watch
+  std::vector<std::string> pending = {root};
+  while (!pending.empty())
+  {
+    std::string directory = pending.back();
+    pending.pop_back();
+
+    std::string directory_path = directory.empty() ? "." : directory;
+    int watch = inotify_add_watch(daemon.inotify_fd, directory_path.c_str(), FSMONITOR_EVENTS);
+    if (watch < 0)
+    {
+      // A directory removed before it could be watched is reported by its parent
+      if (errno == ENOENT || errno == ENOTDIR)
+      {
+        continue;
+      }
+      return false;
+    }
+    daemon.watches[watch] = directory;
+
+    DIR *handle = opendir(directory_path.c_str());
+    if (handle == nullptr)
+    {
+      continue;
+    }
+
+    while (struct dirent *item = readdir(handle))
+    {
+      std::string name = item->d_name;
+      if (name == "." || name == "..")
+      {
+        continue;
+      }
+
+      std::string relative_path = directory.empty() ? name : directory + "/" + name;
+      bool is_directory = item->d_type == DT_DIR;
+      if (item->d_type == DT_UNKNOWN)
+      {
+        struct stat link_stat;
+        is_directory = lstat(relative_path.c_str(), &link_stat) == 0 && S_ISDIR(link_stat.st_mode);
+      }
+
+      if (is_directory)
+      {
+        if (!shouldIgnoreDirectory(relative_path, *patterns))
+        {
+          pending.push_back(relative_path);
+        }
+      }
+      else if (record_files)
+      {
+        recordChange(daemon, relative_path);
+      }
+    }
+    closedir(handle);
+  }
+
+  return true;
+}
+
+static void rewatchTree(FsMonitorDaemon &daemon)
+{
+  // New ignore rules change which directories are watched, start over
+  for (const auto &[watch, directory] : daemon.watches)
+  {
+    inotify_rm_watch(daemon.inotify_fd, watch);
+  }
+  daemon.watches.clear();
+  resetIgnorePatterns();
+  forgetChanges(daemon);
+  daemon.healthy = watchTree(daemon, "", false);
+}
+
+static void drainEvents(FsMonitorDaemon &daemon)
+{
+  std::shared_ptr<const std::vector<IgnorePattern>> patterns = getIgnorePatterns();
+  bool rules_changed = false;
+
+  alignas(struct inotify_event) char buffer[64 * 1024];
+  ssize_t bytes_read = 0;
+  while ((bytes_read = read(daemon.inotify_fd, buffer, sizeof(buffer))) > 0)
+  {
+    for (char *cursor = buffer; cursor < buffer + bytes_read;)
+    {
+      const struct inotify_event *event = reinterpret_cast<const struct inotify_event *>(cursor);
+      cursor += sizeof(struct inotify_event) + event->len;
+
+      // Dropped events leave every earlier token unanswerable
+      if (event->mask & IN_Q_OVERFLOW)
+      {
+        forgetChanges(daemon);
+        continue;
+      }
+
+      auto watch = daemon.watches.find(event->wd);
+      if (watch == daemon.watches.end())
+      {
+        continue;
+      }
+      if (event->mask & IN_IGNORED)
+      {
+        daemon.watches.erase(watch);
+        continue;
+      }
+      if (event->len == 0)
+      {
+        continue;
+      }
+
+      std::string name = event->name;
+      std::string path = watch->second.empty() ? name : watch->second + "/" + name;
+      if (event->mask & IN_ISDIR)
+      {
+        if (name == ".bittrack")
+        {
+          continue;
+        }
+
+        // Everything below a created, removed or renamed directory is dirty
+        recordChange(daemon, path + "/");
+        if ((event->mask & (IN_CREATE | IN_MOVED_TO)) && !shouldIgnoreDirectory(path, *patterns) &&
+            !watchTree(daemon, path, true))
+        {
+          daemon.healthy = false;
+        }
+        continue;
+      }
+
+      if (path == ".bitignore")
+      {
+        rules_changed = true;
+      }
+      recordChange(daemon, path);
+    }
+  }
+
+  if (rules_changed)
+  {
+    rewatchTree(daemon);
+  }
+}
+
+static std::string answerQuery(
+    FsMonitorDaemon &daemon,
+    const std::string &since_token)
+{
+  // Pick up everything the kernel queued before the client asked
+  drainEvents(daemon);
+
+  bool known = false;
+  uint64_t since_sequence = 0;
+  std::size_t separator = since_token.rfind(':');
+  if (daemon.healthy && separator != std::string::npos && since_token.substr(0, separator) == daemon.instance)
+  {
+    try
+    {
+      since_sequence = std::stoull(since_token.substr(separator + 1));
+      known = since_sequence >= daemon.reset_sequence && since_sequence <= daemon.sequence;
+    }
+    catch (const std::exception &)
+    {
+    }
+  }
+
+  std::string response = "token " + daemon.instance + ":" + std::to_string(daemon.sequence) + "\n";
+  if (!known)
+  {
+    return response + "full\n";
+  }
+
+  response += "changes\n";
+  for (const auto &[path, sequence] : daemon.changes)
+  {
+    if (sequence > since_sequence)
+    {
+      response += path + "\n";
+    }
+  }
+  return response;
+}
+
+static bool answerClient(
+    FsMonitorDaemon &daemon,
+    int client_fd)
+{
+  struct timeval timeout = {2, 0};
+  setsockopt(client_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  setsockopt(client_fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+  std::string request;
+  char buffer[4096];
+  ssize_t bytes_read = 0;
+  while (request.find('\n') == std::string::npos && request.size() < sizeof(buffer) &&
+         (bytes_read = read(client_fd, buffer, sizeof(buffer))) > 0)
+  {
+    request.append(buffer, static_cast<std::size_t>(bytes_read));
+  }
+  request = request.substr(0, request.find('\n'));
+
+  bool keep_running = true;
+  std::string response;
+  if (request == "ping")
+  {
+    response = "pong\n";
+  }
+  else if (request == "stop")
+  {
+    response = "stopping\n";
+    keep_running = false;
+  }
+  else if (request.rfind("query ", 0) == 0 || request == "query")
+  {
+    response = answerQuery(daemon, request.size() > 6 ? request.substr(6) : "");
+  }
+
+  sendAll(client_fd, response);
+  close(client_fd);
+  return keep_running;
+}
+
+void runFsMonitorDaemon()
+{
+  FsMonitorDaemon daemon;
+  daemon.instance = std::to_string(getpid()) + "-" + std::to_string(time(nullptr));
+  daemon.inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (daemon.inotify_fd < 0)
+  {
+    ErrorHandler::printError(
+        ErrorCode::FILESYSTEM_ERROR,
+        "Unable to initialize inotify: " + std::string(std::strerror(errno)),
+        ErrorSeverity::ERROR,
+        "run_fsmonitor_daemon");
+    return;
+  }
+
+  // Watch the whole tree before accepting clients, so the first token is trustworthy
+  if (!watchTree(daemon, "", false))
+  {
+    ErrorHandler::printError(
+        ErrorCode::FILESYSTEM_ERROR,
+        "Unable to watch the working tree: " + std::string(std::strerror(errno)),
+        ErrorSeverity::ERROR,
+        "run_fsmonitor_daemon");
+    close(daemon.inotify_fd);
+    return;
+  }
+
+  int listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  struct sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  std::strncpy(address.sun_path, getFsMonitorSocketPath().c_str(), sizeof(address.sun_path) - 1);
+  unlink(address.sun_path);
+  if (listen_fd < 0 ||
+      bind(listen_fd, reinterpret_cast<struct sockaddr *>(&address), sizeof(address)) != 0 ||
+      listen(listen_fd, 16) != 0)
+  {
+    ErrorHandler::printError(
+        ErrorCode::FILESYSTEM_ERROR,
+        "Unable to listen on " + getFsMonitorSocketPath() + ": " + std::string(std::strerror(errno)),
+        ErrorSeverity::ERROR,
+        "run_fsmonitor_daemon");
+    if (listen_fd >= 0)
+    {
+      close(listen_fd);
+    }
+    close(daemon.inotify_fd);
+    return;
+  }
+
+  struct stat socket_stat;
+  stat(address.sun_path, &socket_stat);
+
+  bool keep_running = true;
+  while (keep_running && daemon.healthy)
+  {
+    struct pollfd descriptors[2] = {{daemon.inotify_fd, POLLIN, 0}, {listen_fd, POLLIN, 0}};
+    int ready = poll(descriptors, 2, 5000);
+    if (ready < 0 && errno != EINTR)
+    {
+      break;
+    }
+
+    if (descriptors[0].revents & POLLIN)
+    {
+      drainEvents(daemon);
+    }
+    if (descriptors[1].revents & POLLIN)
+    {
+      int client_fd = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+      if (client_fd >= 0)
+      {
+        keep_running = answerClient(daemon, client_fd);
+      }
+    }
+
+    // Exit once the repository is gone or another daemon took over the socket
+    struct stat current_stat;
+    if (stat(address.sun_path, &current_stat) != 0 || current_stat.st_ino != socket_stat.st_ino)
+    {
+      close(listen_fd);
+      close(daemon.inotify_fd);
+      return;
+    }
+  }
+
+  unlink(address.sun_path);
+  close(listen_fd);
+  close(daemon.inotify_fd);
+}
+
+#else
+
+void runFsMonitorDaemon()
+{
+  ErrorHandler::printError(
+      ErrorCode::FILESYSTEM_ERROR,
+      "The file system monitor requires Linux inotify",
+      ErrorSeverity::ERROR,
+      "run_fsmonitor_daemon");
+}
+
+#endif
+
+void startFsMonitor()
+{
+  if (isFsMonitorRunning())
+  {
+    std::cout << "File system monitor is already running" << std::endl;
+    return;
+  }
+
+#ifndef __linux__
+  throw BitTrackError(
+      ErrorCode::FILESYSTEM_ERROR,
+      "The file system monitor requires Linux inotify",
+      ErrorSeverity::ERROR,
+      "start_fsmonitor");
+#else
+  // Detach twice so the daemon is neither a child nor a session leader of the caller
+  pid_t child = fork();
+  if (child < 0)
+  {
+    throw BitTrackError(
+        ErrorCode::FILESYSTEM_ERROR,
+        "Unable to start the file system monitor: " + std::string(std::strerror(errno)),
+        ErrorSeverity::ERROR,
+        "start_fsmonitor");
+  }
+  if (child == 0)
+  {
+    setsid();
+    if (fork() != 0)
+    {
+      _exit(0);
+    }
+
+    int null_fd = open("/dev/null", O_RDWR);
+    dup2(null_fd, STDIN_FILENO);
+    dup2(null_fd, STDOUT_FILENO);
+    dup2(null_fd, STDERR_FILENO);
+    signal(SIGPIPE, SIG_IGN);
+    runFsMonitorDaemon();
+    _exit(0);
+  }
+  waitpid(child, nullptr, 0);
+
+  // Watching a large tree takes a while; the socket only appears once it is done
+  for (int attempt = 0; attempt < 300; attempt++)
+  {
+    if (isFsMonitorRunning())
+    {
+      std::cout << "File system monitor started" << std::endl;
+      return;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+
+  throw BitTrackError(
+      ErrorCode::FILESYSTEM_ERROR,
+      "File system monitor did not start",
+      ErrorSeverity::ERROR,
+      "start_fsmonitor");
+#endif
+}
+
+void stopFsMonitor()
+{
+  std::string response;
+  if (!sendFsMonitorRequest("stop", response))
+  {
+    std::cout << "File system monitor is not running" << std::endl;
+    return;
+  }
+
+  ErrorHandler::safeRemoveFile(getFsMonitorStatePath());
+  std::cout << "File system monitor stopped" << std::endl;
+}
+
+void printFsMonitorStatus()
+{
+  if (isFsMonitorRunning())
+  {
+    std::cout << "File system monitor is running" << std::endl;
+  }
+  else
+  {
+    std::cout << "File system monitor is not running" << std::endl;
+  }
+}
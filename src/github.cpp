@@ -1,5 +1,325 @@
 #include "../include/github.hpp"
 
+// Every GitHub API call goes through the shared transport, so one TLS
+// connection to api.github.com serves the whole command
+static HttpRequest makeGithubRequest(
+    const std::string &token,
+    const std::string &method,
+    const std::string &url,
+    const std::string &json_data = "")
+{
+  HttpRequest request;
+  request.method = method;
+  request.url = url;
+  request.body = json_data;
+  request.headers.push_back("Authorization: token " + token);
+  if (!json_data.empty())
+  {
+    request.headers.push_back("Content-Type: application/json");
+  }
+  request.headers.push_back("User-Agent: BitTrack/1.0");
+  return request;
+}
+
+static std::string getGithubRepoUrl(
+    const std::string &username,
+    const std::string &repo_name)
+{
+  return "https://api.github.com/repos/" + username + "/" + repo_name;
+}
+
+// Value of the first "sha" field in a response, empty when there is none
+static std::string extractGithubSha(const std::string &response_data)
+{
+  return findJsonString(response_data, "sha");
+}
+
+// State of a request body that wraps a blob's base64 encoding in JSON
+struct GithubBlobBody
+{
+  std::string blob_hash;              // blob whose content is encoded
+  std::string prefix;                 // JSON sent before the encoded content
+  std::string suffix;                 // JSON sent after the encoded content
+  std::unique_ptr<BlobReader> reader; // opened on the first read
+  std::vector<unsigned char> raw;     // content waiting to be encoded
+  std::string pending;                // bytes not yet handed to the transport
+  std::size_t pending_offset;         // bytes of pending already handed over
+  bool started;                       // the prefix has been produced
+  bool done;                          // the suffix has been produced
+
+  GithubBlobBody() : pending_offset(0), started(false), done(false) {}
+};
+
+static bool fillGithubBlobBody(GithubBlobBody &body)
+{
+  body.pending.clear();
+  body.pending_offset = 0;
+  if (!body.started)
+  {
+    body.started = true;
+    body.pending = body.prefix;
+    body.reader = std::make_unique<BlobReader>();
+    return openBlobReader(body.blob_hash, *body.reader);
+  }
+
+  // Fill a whole block so only the final one can end in a partial 3-byte
+  // group and need padding
+  std::size_t filled = 0;
+  while (filled < body.raw.size())
+  {
+    std::size_t count = readBlobChunk(*body.reader, body.raw.data() + filled, body.raw.size() - filled);
+    if (count == 0)
+    {
+      break;
+    }
+    filled += count;
+  }
+  if (body.reader->failed)
+  {
+    return false;
+  }
+
+  body.pending.resize((filled + 2) / 3 * 4);
+  body.pending.resize(base64EncodeBlock(body.raw.data(), filled, &body.pending[0]));
+  if (filled < body.raw.size() || body.reader->finished)
+  {
+    body.pending += body.suffix;
+    body.done = true;
+  }
+  return true;
+}
+
+// Streams prefix, the blob's base64 encoding and suffix as the body of
+// request, holding one encoded block at a time instead of the blob, its
+// encoding and the JSON around it
+static void setGithubBlobBody(
+    HttpRequest &request,
+    const std::string &prefix,
+    const std::string &blob_hash,
+    const std::string &suffix)
+{
+  auto body = std::make_shared<GithubBlobBody>();
+  body->blob_hash = blob_hash;
+  body->prefix = prefix;
+  body->suffix = suffix;
+  body->raw.resize(48 * 1024); // a multiple of 3 bytes, encoding to 64 KiB
+
+  request.body_source = [body](char *buffer, std::size_t size, std::size_t &written)
+  {
+    written = 0;
+    while (written < size)
+    {
+      if (body->pending_offset == body->pending.size())
+      {
+        if (body->done)
+        {
+          break;
+        }
+        if (!fillGithubBlobBody(*body))
+        {
+          return false;
+        }
+        continue;
+      }
+
+      std::size_t count = std::min(size - written, body->pending.size() - body->pending_offset);
+      std::memcpy(buffer + written, body->pending.data() + body->pending_offset, count);
+      body->pending_offset += count;
+      written += count;
+    }
+    return true;
+  };
+
+  // The next read reopens the blob and starts again from the prefix
+  request.body_rewind = [body]()
+  {
+    body->pending.clear();
+    body->pending_offset = 0;
+    body->started = false;
+    body->done = false;
+    return true;
+  };
+
+  // Base64 turns every started 3-byte group into 4 characters, so the
+  // length is known without encoding anything
+  int64_t content_size = getBlobSize(blob_hash);
+  if (content_size >= 0)
+  {
+    request.body_size = static_cast<int64_t>(prefix.size() + suffix.size()) + (content_size + 2) / 3 * 4;
+  }
+}
+
+static HttpRequest makeGithubBlobRequest(
+    const std::string &token,
+    const std::string &username,
+    const std::string &repo_name,
+    const std::string &blob_hash)
+{
+  HttpRequest request = makeGithubRequest(token, "POST", getGithubRepoUrl(username, repo_name) + "/git/blobs");
+  request.headers.push_back("Content-Type: application/json");
+  setGithubBlobBody(request, "{\"content\":\"", blob_hash, "\",\"encoding\":\"base64\"}");
+  return request;
+}
+
+static std::string parseGithubBlobResponse(const HttpResponse &response)
+{
+  if (response.result != CURLE_OK)
+  {
+    ErrorHandler::printError(
+        ErrorCode::REMOTE_CONNECTION_FAILED,
+        "CURL Error: " +
+            std::string(curl_easy_strerror(response.result)),
+        ErrorSeverity::ERROR,
+        "create_github_blob");
+    std::cout << "GitHub API Error Response: " << response.body << std::endl;
+    return "";
+  }
+
+  std::string blob_sha = extractGithubSha(response.body);
+  if (blob_sha.empty())
+  {
+    ErrorHandler::printError(ErrorCode::REMOTE_CONNECTION_FAILED, "Could not find SHA in response", ErrorSeverity::ERROR, "create_github_blob");
+  }
+  return blob_sha;
+}
+
+// Creates the blobs on GitHub several at a time over shared connections and
+// records each SHA, empty on failure; bodies are streamed from the object
+// store, and the batches bound how many of their buffers exist at once
+static void createGithubBlobs(
+    const std::string &token,
+    const std::string &username,
+    const std::string &repo_name,
+    const std::vector<std::string> &blob_hashes,
+    std::map<std::string, std::string> &github_blobs)
+{
+  std::size_t batch_size = getHttpConcurrency() * 4;
+  for (std::size_t start = 0; start < blob_hashes.size(); start += batch_size)
+  {
+    std::size_t end = std::min(blob_hashes.size(), start + batch_size);
+    std::vector<HttpRequest> requests;
+    for (std::size_t i = start; i < end; i++)
+    {
+      requests.push_back(makeGithubBlobRequest(token, username, repo_name, blob_hashes[i]));
+    }
+
+    std::vector<HttpResponse> responses = httpPerformAll(requests);
+    for (std::size_t i = start; i < end; i++)
+    {
+      github_blobs[blob_hashes[i]] = parseGithubBlobResponse(responses[i - start]);
+    }
+  }
+}
+
+static std::string decodeGithubBlobContent(const HttpResponse &response)
+{
+  if (response.result != CURLE_OK)
+  {
+    return "";
+  }
+
+  // The line breaks GitHub puts in the encoding are skipped by the decoder
+  return base64Decode(findJsonString(response.body, "content"));
+}
+
+// State of a blob download whose JSON response is decoded into the object
+// store as it arrives
+struct GithubBlobDownload
+{
+  JsonParser parser;                  // tokenizes the response, streaming the content string
+  bool started;                       // the writer was opened for the content string
+  bool complete;                      // the content string ended
+  Base64DecodeState base64;           // decoder state between chunks
+  std::vector<unsigned char> decoded; // content decoded from the current piece
+  BlobWriter writer;                  // stores the decoded content
+  std::string blob_hash;              // stored blob, set once the content string ends
+
+  GithubBlobDownload() : started(false), complete(false) {}
+};
+
+static bool decodeGithubBlobChars(
+    GithubBlobDownload &download,
+    const char *data,
+    std::size_t size)
+{
+  if (!download.started)
+  {
+    download.started = true;
+    if (!openBlobWriter(download.writer))
+    {
+      return false;
+    }
+  }
+
+  // The parser has already undone escapes; the line breaks GitHub puts in the
+  // encoding are skipped by the decoder
+  download.decoded.resize(size * 3 / 4 + 1);
+  std::size_t written = 0;
+  return base64DecodeBlock(data, size, download.decoded.data(), written, download.base64) &&
+         writeBlobChunk(download.writer, download.decoded.data(), written);
+}
+
+static bool feedGithubBlobDownload(
+    GithubBlobDownload &download,
+    const char *data,
+    std::size_t size)
+{
+  if (download.complete)
+  {
+    return true;
+  }
+
+  // The parser stops itself once the content string ends
+  feedJson(download.parser, data, size);
+  if (download.parser.failed || (download.parser.stopped && !download.complete))
+  {
+    return false;
+  }
+
+  // Store the blob as soon as its content ends so finished transfers do not
+  // keep a temporary object and a deflater open; empty content never reached
+  // the decoder, so its writer is opened here
+  if (download.complete)
+  {
+    if (!download.started && !decodeGithubBlobChars(download, data, 0))
+    {
+      return false;
+    }
+    download.blob_hash = finishBlobWriter(download.writer);
+    download.decoded = std::vector<unsigned char>();
+    return !download.blob_hash.empty();
+  }
+  return true;
+}
+
+static HttpRequest makeGithubBlobDownloadRequest(
+    const std::string &token,
+    const std::string &username,
+    const std::string &repo_name,
+    const std::string &github_blob,
+    const std::shared_ptr<GithubBlobDownload> &download)
+{
+  HttpRequest request = makeGithubRequest(token, "GET", getGithubRepoUrl(username, repo_name) + "/git/blobs/" + github_blob);
+
+  // The content string is decoded in pieces as the tokenizer reaches them
+  GithubBlobDownload *state = download.get();
+  download->parser.stream_key = "content";
+  download->parser.chunk_handler = [state](const char *data, std::size_t size)
+  {
+    return decodeGithubBlobChars(*state, data, size);
+  };
+  download->parser.handler = [state](JsonEvent event, const std::string &key, const std::string &, std::size_t)
+  {
+    state->complete = event == JsonEvent::STRING && key == "content";
+    return !state->complete;
+  };
+  request.body_sink = [download](const char *data, std::size_t size)
+  {
+    return feedGithubBlobDownload(*download, data, size);
+  };
+  return request;
+}
+
 bool isGithubRemote(const std::string &url)
 {
   // Simple check for GitHub URL
@@ -49,56 +369,74 @@ std::string getGithubCommitForBittrack(const std::string &bittrack_commit)
   return "";
 }
 
-std::string getLatestGithubCommit(
-    const std::string &token,
+std::unordered_map<std::string, std::string> getGithubBlobMapping(
     const std::string &username,
     const std::string &repo_name)
 {
-  CURL *curl = curl_easy_init(); // Initialize CURL
-  if (!curl)
+  // Each line is "<owner>/<repo> <local blob hash> <GitHub blob SHA>"
+  std::unordered_map<std::string, std::string> mapping;
+  if (!std::filesystem::exists(".bittrack/github_blobs"))
   {
-    return "";
+    return mapping;
   }
 
-  std::string current_branch = getCurrentBranchName();
-
-  // Prepare the URL for the latest commit
-  std::string response_data;
-  std::string url = "https://api.github.com/repos/" + username + "/" + repo_name + "/git/refs/heads/" + current_branch;
+  std::string repository = username + "/" + repo_name;
+  std::istringstream iss(ErrorHandler::safeReadFile(".bittrack/github_blobs"));
+  std::string line;
+  while (std::getline(iss, line))
+  {
+    std::istringstream line_ss(line);
+    std::string line_repository, blob_hash, github_blob;
+    if (line_ss >> line_repository >> blob_hash >> github_blob && line_repository == repository)
+    {
+      mapping[blob_hash] = github_blob;
+    }
+  }
+  return mapping;
+}
 
-  struct curl_slist *headers = nullptr;                                            // Initialize headers
-  headers = curl_slist_append(headers, ("Authorization: token " + token).c_str()); // Add authorization header
-  headers = curl_slist_append(headers, "User-Agent: BitTrack/1.0");                // Add user-agent header
+void addGithubBlobMappings(
+    const std::string &username,
+    const std::string &repo_name,
+    const std::vector<std::pair<std::string, std::string>> &blobs)
+{
+  if (blobs.empty())
+  {
+    return;
+  }
 
-  curl_easy_setopt(curl, CURLOPT_URL, url.c_str());             // Set the URL
-  curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);          // Set headers
-  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback); // Set write callback
-  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response_data);    // Set response data storage
+  std::string lines;
+  for (const auto &[blob_hash, github_blob] : blobs)
+  {
+    lines += username + "/" + repo_name + " " + blob_hash + " " + github_blob + "\n";
+  }
+  if (!ErrorHandler::safeAppendFile(".bittrack/github_blobs", lines))
+  {
+    ErrorHandler::printError(
+        ErrorCode::FILE_WRITE_ERROR,
+        "Could not update .bittrack/github_blobs",
+        ErrorSeverity::WARNING,
+        "add_github_blob_mappings");
+  }
+}
 
-  CURLcode res = curl_easy_perform(curl); // Perform the request
-  curl_slist_free_all(headers);           // Free headers
-  curl_easy_cleanup(curl);                // Clean up CURL
+std::string getLatestGithubCommit(
+    const std::string &token,
+    const std::string &username,
+    const std::string &repo_name)
+{
+  std::string current_branch = getCurrentBranchName();
 
-  if (res != CURLE_OK) // Check for errors
+  // Prepare the URL for the latest commit
+  std::string url = getGithubRepoUrl(username, repo_name) + "/git/refs/heads/" + current_branch;
+  HttpResponse response = httpPerform(makeGithubRequest(token, "GET", url));
+  if (response.result != CURLE_OK) // Check for errors
   {
     return "";
   }
 
   // Parse the response to extract the SHA
-  size_t sha_pos = response_data.find("\"sha\":\"");
-  if (sha_pos != std::string::npos) // If SHA found
-  {
-    // Extract SHA value
-    sha_pos += 7;
-    size_t sha_end = response_data.find("\"", sha_pos);
-    if (sha_end != std::string::npos) // If end quote found
-    {
-      // Return the extracted SHA
-      return response_data.substr(sha_pos, sha_end - sha_pos);
-    }
-  }
-
-  return "";
+  return extractGithubSha(response.body);
 }
 
 std::string extractInfoFromGithubUrl(
@@ -192,49 +530,21 @@ bool pushToGithub(
       std::string commit_message =
           getCommitMessage(current_commit); // Get commit message
 
-      std::vector<std::string> blob_shas;  // To store blob SHAs
-      std::vector<std::string> file_names; // To store file names
-
-      for (const auto &file_path : latest_commit_files)
+      // Stream each committed blob into the request body
+      for (const auto &[file_path, blob_hash] : getCommitTree(current_commit))
       {
-        // Read file content using safeReadFile
-        std::string content = ErrorHandler::safeReadFile(file_path);
-        if (content.empty() && !std::filesystem::exists(file_path))
-        {
-          continue;
-        }
-
-        std::string base64_content =
-            base64Encode(content); // Encode content to base64
-
-        // Create the file on GitHub
-        CURL *curl = curl_easy_init();
-        if (!curl)
-        {
-          continue;
-        }
-
-        std::string response_data;                                                                                 // To store response data
-        std::string url = "https://api.github.com/repos/" + username + "/" + repo_name + "/contents/" + file_path; // Prepare URL
-        std::string json_data = "{\"message\":\"" + commit_message + "\",\"content\":\"" + base64_content + "\"}"; // Prepare JSON data
-
-        struct curl_slist *headers = nullptr;                                            // Initialize headers
-        headers = curl_slist_append(headers, ("Authorization: token " + token).c_str()); // Add authorization header
-        headers = curl_slist_append(headers, "Content-Type: application/json");          // Add content-type header
-        headers = curl_slist_append(headers, "User-Agent: BitTrack/1.0");                // Add user-agent header
-
-        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());              // Set the URL
-        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "PUT");          // Set HTTP method to PUT
-        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, json_data.c_str()); // Set JSON data
-        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);           // Set headers
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);  // Set write callback
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response_data);     // Set response data storage
-
-        CURLcode res = curl_easy_perform(curl); // Perform the request
-        curl_slist_free_all(headers);           // Free headers
-        curl_easy_cleanup(curl);                // Clean up CURL
-
-        if (res == CURLE_OK && response_data.find("\"sha\":\"") != std::string::npos) // Check for success
+        // Create the file on GitHub; each PUT commits to the branch, so these
+        // go one at a time to avoid conflicting ref updates
+        HttpRequest request = makeGithubRequest(token, "PUT", getGithubRepoUrl(username, repo_name) + "/contents/" + file_path);
+        request.headers.push_back("Content-Type: application/json");
+        setGithubBlobBody(
+            request,
+            "{\"message\":\"" + jsonEscape(commit_message) + "\",\"content\":\"",
+            blob_hash,
+            "\"}");
+
+        HttpResponse response = httpPerform(request);
+        if (response.result == CURLE_OK && !extractGithubSha(response.body).empty()) // Check for success
         {
           std::cout << "Created file: " << file_path << std::endl;
         }
@@ -253,14 +563,10 @@ bool pushToGithub(
       return true;
     }
 
-    // Push commits one by one
     std::string current_tree_sha = "";
     std::string last_commit_sha = parent_sha;
     std::string commit_message = getCommitMessage(current_commit);
 
-    // If new branch (last_commit_sha is empty), try to finding parent from
-    // local commit history
-
     std::vector<std::string> committed_files = getCommittedFiles(current_commit); // Get files in current commit
     if (committed_files.empty())
     {
@@ -272,151 +578,212 @@ bool pushToGithub(
       return false;
     }
 
-    std::vector<std::string> blob_shas;  // To store blob SHAs
-    std::vector<std::string> file_names; // To store file names
+    std::map<std::string, std::string> commit_tree = getCommitTree(current_commit);
 
-    for (const auto &file_path : committed_files)
+    // When the remote still holds the commit pushed last, its tree is the base
+    // and only the files that differ from it travel
+    std::map<std::string, std::string> pushed_tree;
+    std::string pushed_github_commit;
+    if (!last_pushed.empty() && std::filesystem::exists(".bittrack/github_commits"))
+    {
+      pushed_github_commit = getGithubCommitForBittrack(last_pushed);
+    }
+    if (!pushed_github_commit.empty() && (!branch_exists || pushed_github_commit == parent_sha))
     {
-      // Handle deleted files
-      if (isDeleted(file_path))
+      pushed_tree = getCommitTree(last_pushed);
+      if (!pushed_tree.empty())
       {
-        std::string actual_path = getActualPath(file_path);                            // Get actual file path
-        if (deleteGithubFile(token, username, repo_name, actual_path, commit_message)) // Delete file on GitHub
-        {
-          std::cout << "Deleted file: " << actual_path << std::endl;
-        }
-        else
-        {
-          ErrorHandler::printError(
-              ErrorCode::REMOTE_CONNECTION_FAILED,
-              "Failed to delete file: " + actual_path,
-              ErrorSeverity::ERROR,
-              "push_to_github_api");
-        }
+        current_tree_sha = getGithubCommitTree(token, username, repo_name, pushed_github_commit);
       }
-      else
+      if (current_tree_sha.empty())
       {
-        // Read file content from commit using safeReadFile
-        std::string commit_file_path =
-            ".bittrack/objects/" + current_commit + "/" + file_path;
-        std::string content = ErrorHandler::safeReadFile(commit_file_path);
-        if (content.empty() && !std::filesystem::exists(commit_file_path))
-        {
-          ErrorHandler::printError(
-              ErrorCode::FILE_READ_ERROR,
-              "Could not read commit file: " +
-                  commit_file_path,
-              ErrorSeverity::ERROR,
-              "push_to_github_api");
-          continue;
-        }
+        pushed_tree.clear();
+      }
+    }
 
-        // Create blob on GitHub
-        std::string blob_sha =
-            createGithubBlob(token, username, repo_name, content);
-        if (!blob_sha.empty())
-        {
-          blob_shas.push_back(blob_sha);
-          file_names.push_back(file_path);
-          // std::cout << "Created blob for " << file_path << std::endl;
-        }
-        else
-        {
-          ErrorHandler::printError(
-              ErrorCode::REMOTE_CONNECTION_FAILED,
-              "Failed to create blob for " + file_path,
-              ErrorSeverity::ERROR,
-              "push_to_github_api");
-        }
+    std::vector<std::string> blob_shas;  // To store blob SHAs, empty for a removed file
+    std::vector<std::string> file_names; // To store file names
+    std::vector<std::pair<std::string, std::string>> changed; // file path and local blob hash
+    for (const auto &[file_path, blob_hash] : commit_tree)
+    {
+      auto pushed = pushed_tree.find(file_path);
+      if (pushed == pushed_tree.end() || pushed->second != blob_hash)
+      {
+        changed.emplace_back(file_path, blob_hash);
       }
     }
 
-    // Handle case where all files are deleted
-    if (blob_shas.empty() && !committed_files.empty())
+    if (!current_tree_sha.empty())
     {
-      bool all_deleted = true;
-      for (const auto &file_path : committed_files)
+      // Files dropped since the last push are removed from the base tree
+      for (const auto &[file_path, blob_hash] : pushed_tree)
       {
-        // Check if file is deleted
-        if (!isDeleted(file_path))
+        if (commit_tree.find(file_path) == commit_tree.end())
         {
-          all_deleted = false;
-          break;
+          blob_shas.push_back("");
+          file_names.push_back(file_path);
         }
       }
-
-      // If all files are deleted, we still need to create a tree
-      if (!all_deleted)
+    }
+    else if (commit_tree.empty())
+    {
+      // Every file was deleted; remove them from the parent's tree
+      if (last_commit_sha.empty())
       {
         ErrorHandler::printError(
             ErrorCode::REMOTE_CONNECTION_FAILED,
-            "Could not create blobs for current commit",
+            "No parent commit for deletion-only commit",
             ErrorSeverity::ERROR,
             "push_to_github_api");
         return false;
       }
+      current_tree_sha = getGithubCommitTree(token, username, repo_name, last_commit_sha);
+      if (current_tree_sha.empty())
+      {
+        ErrorHandler::printError(
+            ErrorCode::REMOTE_CONNECTION_FAILED,
+            "Could not get tree from parent commit " + last_commit_sha,
+            ErrorSeverity::ERROR,
+            "push_to_github_api");
+        return false;
+      }
+      for (const auto &file_path : committed_files)
+      {
+        if (isDeleted(file_path))
+        {
+          blob_shas.push_back("");
+          file_names.push_back(getActualPath(file_path));
+        }
+      }
     }
-    else if (blob_shas.empty()) // No files to process
+
+    // Blobs recorded by earlier pushes and pulls are named by their git hash,
+    // as is content the remote has under another path such as a renamed file;
+    // only the rest is uploaded
+    std::unordered_map<std::string, std::string> known_blobs = getGithubBlobMapping(username, repo_name);
+    std::set<std::string> pushed_blobs;
+    for (const auto &[file_path, blob_hash] : pushed_tree)
     {
-      ErrorHandler::printError(
-          ErrorCode::INTERNAL_ERROR,
-          "No files to process for current commit",
-          ErrorSeverity::ERROR,
-          "push_to_github_api");
-      return false;
+      pushed_blobs.insert(blob_hash);
     }
 
-    if (!blob_shas.empty()) // If there are blobs to add
+    std::map<std::string, std::string> github_blobs; // local blob hash to GitHub blob SHA
+    std::vector<std::string> uploads;                // local blob hashes to create on GitHub
+    std::vector<std::string> recorded;               // local blob hashes named from the recorded mapping
+    for (const auto &[file_path, blob_hash] : changed)
     {
-      if (current_tree_sha.empty()) // If no current tree, create new
+      if (github_blobs.count(blob_hash) != 0)
       {
-        current_tree_sha = createGithubTreeWithFiles(token, username, repo_name, blob_shas, file_names);
+        continue;
       }
-      else
+      if (!blobExists(blob_hash))
       {
-        // Update existing tree
-        current_tree_sha = createGithubTreeWithFiles(
-            token,
-            username,
-            repo_name,
-            blob_shas,
-            file_names,
-            current_tree_sha);
+        ErrorHandler::printError(
+            ErrorCode::FILE_READ_ERROR,
+            "Could not read commit file: " +
+                file_path,
+            ErrorSeverity::ERROR,
+            "push_to_github_api");
+        return false;
+      }
+      auto known = known_blobs.find(blob_hash);
+      if (known != known_blobs.end())
+      {
+        github_blobs[blob_hash] = known->second;
+        recorded.push_back(blob_hash);
+        continue;
       }
+      if (pushed_blobs.count(blob_hash) != 0)
+      {
+        github_blobs[blob_hash] = gitBlobHashStored(blob_hash);
+        continue;
+      }
+      github_blobs[blob_hash] = "";
+      uploads.push_back(blob_hash);
+    }
 
-      if (current_tree_sha.empty()) // If tree creation failed
+    createGithubBlobs(token, username, repo_name, uploads, github_blobs);
+
+    std::vector<std::pair<std::string, std::string>> learned; // blobs GitHub now holds
+    for (const auto &[blob_hash, blob_sha] : github_blobs)
+    {
+      if (!blob_sha.empty() && known_blobs.count(blob_hash) == 0)
+      {
+        learned.emplace_back(blob_hash, blob_sha);
+      }
+    }
+    addGithubBlobMappings(username, repo_name, learned);
+
+    bool blobs_created = true;
+    for (const auto &[file_path, blob_hash] : changed)
+    {
+      const std::string &blob_sha = github_blobs[blob_hash];
+      if (blob_sha.empty())
       {
         ErrorHandler::printError(
             ErrorCode::REMOTE_CONNECTION_FAILED,
-            "Could not create or update tree for current commit",
+            "Failed to create blob for " + file_path,
             ErrorSeverity::ERROR,
             "push_to_github_api");
-        return false;
+        blobs_created = false;
+        continue;
       }
+      blob_shas.push_back(blob_sha);
+      file_names.push_back(file_path);
     }
-    else if (current_tree_sha.empty()) // If no blobs and no current tree
+
+    // A tree missing a file would silently drop or revert it on GitHub
+    if (!blobs_created)
     {
-      if (last_commit_sha.empty())
+      ErrorHandler::printError(
+          ErrorCode::REMOTE_CONNECTION_FAILED,
+          "Could not create blobs for current commit",
+          ErrorSeverity::ERROR,
+          "push_to_github_api");
+      return false;
+    }
+
+    std::cout << "Uploaded " << uploads.size() << " of " << commit_tree.size() << " files" << std::endl;
+
+    if (!file_names.empty()) // If the tree changes
+    {
+      std::string base_tree_sha = current_tree_sha;
+      current_tree_sha = createGithubTreeWithFiles(
+          token,
+          username,
+          repo_name,
+          blob_shas,
+          file_names,
+          base_tree_sha);
+
+      // A recorded blob can be gone, for example when the repository was
+      // recreated; its git hash does not change, so upload it and try again
+      if (current_tree_sha.empty() && !recorded.empty())
       {
         ErrorHandler::printError(
             ErrorCode::REMOTE_CONNECTION_FAILED,
-            "No parent commit for deletion-only commit",
-            ErrorSeverity::ERROR,
+            "Could not create tree from recorded blobs, uploading " + std::to_string(recorded.size()) + " of them again",
+            ErrorSeverity::WARNING,
             "push_to_github_api");
-        return false;
+        createGithubBlobs(token, username, repo_name, recorded, github_blobs);
+        current_tree_sha = createGithubTreeWithFiles(
+            token,
+            username,
+            repo_name,
+            blob_shas,
+            file_names,
+            base_tree_sha);
       }
-      // Get tree from parent commit
-      std::string parent_tree_sha = getGithubCommitTree(token, username, repo_name, last_commit_sha);
-      if (parent_tree_sha.empty())
+
+      if (current_tree_sha.empty()) // If tree creation failed
       {
         ErrorHandler::printError(
             ErrorCode::REMOTE_CONNECTION_FAILED,
-            "Could not get tree from parent commit " + last_commit_sha,
+            "Could not create or update tree for current commit",
             ErrorSeverity::ERROR,
             "push_to_github_api");
         return false;
       }
-      current_tree_sha = parent_tree_sha; // Set current tree to parent tree
     }
 
     std::string author_name = getCommitAuthor(current_commit);       // Get author name
@@ -499,58 +866,9 @@ std::string createGithubBlob(
     const std::string &repo_name,
     const std::string &content)
 {
-  CURL *curl = curl_easy_init();
-  if (!curl)
-  {
-    return "";
-  }
-
-  std::string response_data;                                                                     // To store response data
-  std::string url = "https://api.github.com/repos/" + username + "/" + repo_name + "/git/blobs"; // Prepare URL
-  std::string base64_content = base64Encode(content);                                            // Encode content to base64
-  std::string json_data = "{\"content\":\"" + base64_content + "\",\"encoding\":\"base64\"}";    // Prepare JSON data
-
-  struct curl_slist *headers = nullptr;                                            // Initialize headers
-  headers = curl_slist_append(headers, ("Authorization: token " + token).c_str()); // Add authorization header
-  headers = curl_slist_append(headers, "Content-Type: application/json");          // Add content-type header
-  headers = curl_slist_append(headers, "User-Agent: BitTrack/1.0");                // Add user-agent header
-
-  curl_easy_setopt(curl, CURLOPT_URL, url.c_str());              // Set the URL
-  curl_easy_setopt(curl, CURLOPT_POSTFIELDS, json_data.c_str()); // Set JSON data
-  curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);           // Set headers
-  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);  // Set write callback
-  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response_data);     // Set response data storage
-
-  CURLcode res = curl_easy_perform(curl); // Perform the request
-  curl_slist_free_all(headers);           // Free headers
-  curl_easy_cleanup(curl);                // Clean up CURL
-
-  if (res != CURLE_OK)
-  {
-    ErrorHandler::printError(
-        ErrorCode::REMOTE_CONNECTION_FAILED,
-        "CURL Error: " +
-            std::string(curl_easy_strerror(res)),
-        ErrorSeverity::ERROR,
-        "create_github_blob");
-    std::cout << "GitHub API Error Response: " << response_data << std::endl;
-    return "";
-  }
-
-  // Parse the response to extract the SHA
-  size_t sha_pos = response_data.find("\"sha\":\"");
-  if (sha_pos != std::string::npos) // If SHA found
-  {
-    sha_pos += 7;                                       // Skip to SHA value
-    size_t sha_end = response_data.find("\"", sha_pos); // Find end quote
-    if (sha_end != std::string::npos)                   // If end quote found
-    {
-      return response_data.substr(sha_pos, sha_end - sha_pos); // Return the extracted SHA
-    }
-  }
-
-  ErrorHandler::printError(ErrorCode::REMOTE_CONNECTION_FAILED, "Could not find SHA in response", ErrorSeverity::ERROR, "create_github_blob");
-  return "";
+  std::string json_data = "{\"content\":\"" + base64Encode(content) + "\",\"encoding\":\"base64\"}";
+  std::string url = getGithubRepoUrl(username, repo_name) + "/git/blobs";
+  return parseGithubBlobResponse(httpPerform(makeGithubRequest(token, "POST", url, json_data)));
 }
 
 std::string getGithubCommitTree(
@@ -559,49 +877,20 @@ std::string getGithubCommitTree(
     const std::string &repo_name,
     const std::string &commit_sha)
 {
-  CURL *curl = curl_easy_init();
-  if (!curl)
-    return "";
-
-  std::string url = "https://api.github.com/repos/" + username + "/" + repo_name + "/git/commits/" + commit_sha; // Prepare URL
-  std::string response_data;                                                                                     // To store response data
-
-  struct curl_slist *headers = nullptr;                                            // Initialize headers
-  headers = curl_slist_append(headers, ("Authorization: token " + token).c_str()); // Add authorization header
-  headers = curl_slist_append(headers, "User-Agent: BitTrack/1.0");                // Add user-agent header
-
-  curl_easy_setopt(curl, CURLOPT_URL, url.c_str());             // Set the URL
-  curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);          // Set headers
-  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback); // Set write callback
-  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response_data);    // Set response data storage
-
-  CURLcode res = curl_easy_perform(curl); // Perform the request
-  curl_slist_free_all(headers);           // Free headers
-  curl_easy_cleanup(curl);                // Clean up CURL
-
-  if (res != CURLE_OK)
+  std::string url = getGithubRepoUrl(username, repo_name) + "/git/commits/" + commit_sha; // Prepare URL
+  HttpResponse response = httpPerform(makeGithubRequest(token, "GET", url));
+  if (response.result != CURLE_OK)
   {
     ErrorHandler::printError(
         ErrorCode::REMOTE_CONNECTION_FAILED,
         "CURL error: " +
-            std::string(curl_easy_strerror(res)),
+            std::string(curl_easy_strerror(response.result)),
         ErrorSeverity::ERROR,
         "get_github_commit_tree");
     return "";
   }
 
-  size_t tree_pos = response_data.find("\"tree\":{\"sha\":\""); // Find tree SHA in response
-  if (tree_pos != std::string::npos)                            // If tree SHA found
-  {
-    tree_pos += 15;                                       // Skip "tree":{"sha":"
-    size_t tree_end = response_data.find("\"", tree_pos); // Find end quote
-    if (tree_end != std::string::npos)                    // If end quote found
-    {
-      return response_data.substr(tree_pos, tree_end - tree_pos); // Return the extracted tree SHA
-    }
-  }
-
-  return "";
+  return getJsonString(response.body, {"tree", "sha"});
 }
 
 std::string createGithubTreeWithFiles(
@@ -612,12 +901,7 @@ std::string createGithubTreeWithFiles(
     const std::vector<std::string> &file_names,
     const std::string &base_tree_sha)
 {
-  CURL *curl = curl_easy_init();
-  if (!curl)
-    return "";
-
-  std::string response_data;                                                                     // To store response data
-  std::string url = "https://api.github.com/repos/" + username + "/" + repo_name + "/git/trees"; // Prepare URL
+  std::string url = getGithubRepoUrl(username, repo_name) + "/git/trees"; // Prepare URL
 
   std::string json_data = "{\"base_tree\":"; // Prepare JSON data
   if (base_tree_sha.empty())
@@ -637,58 +921,27 @@ std::string createGithubTreeWithFiles(
       json_data += ","; // Add comma between entries
     }
 
-    std::string escaped_filename =
-        file_names[i]; // Escape double quotes in filename
-    size_t pos = 0;
-    while ((pos = escaped_filename.find("\"", pos)) != std::string::npos) // Find double quotes
-    {
-      escaped_filename.replace(pos, 1, "\\\""); // Replace with escaped version
-      pos += 2;                                 // Move past the escaped quote
-    }
+    std::string escaped_filename = jsonEscape(file_names[i]); // Escape the filename for JSON
 
-    // Add file entry to JSON
-    json_data += "{\"path\":\"" + escaped_filename + "\",\"mode\":\"100644\",\"type\":\"blob\",\"sha\":\"" + blob_shas[i] + "\"}";
+    // Add file entry to JSON, a null SHA removes the path from the base tree
+    std::string sha_value = blob_shas[i].empty() ? "null" : "\"" + blob_shas[i] + "\"";
+    json_data += "{\"path\":\"" + escaped_filename + "\",\"mode\":\"100644\",\"type\":\"blob\",\"sha\":" + sha_value + "}";
   }
 
   json_data += "]}"; // End tree array and JSON
 
-  struct curl_slist *headers = nullptr;                                            // Initialize headers
-  headers = curl_slist_append(headers, ("Authorization: token " + token).c_str()); // Add authorization header
-  headers = curl_slist_append(headers, "Content-Type: application/json");          // Add content-type header
-  headers = curl_slist_append(headers, "User-Agent: BitTrack/1.0");                // Add user-agent header
-
-  curl_easy_setopt(curl, CURLOPT_URL, url.c_str());              // Set the URL
-  curl_easy_setopt(curl, CURLOPT_POSTFIELDS, json_data.c_str()); // Set JSON data
-  curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);           // Set headers
-  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);  // Set write callback
-  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response_data);     // Set response data storage
-
-  CURLcode res = curl_easy_perform(curl); // Perform the request
-  curl_slist_free_all(headers);           // Free headers
-  curl_easy_cleanup(curl);                // Clean up CURL
-
-  if (res != CURLE_OK)
+  HttpResponse response = httpPerform(makeGithubRequest(token, "POST", url, json_data));
+  if (response.result != CURLE_OK)
   {
     ErrorHandler::printError(
         ErrorCode::REMOTE_CONNECTION_FAILED,
-        "CURL error: " + std::string(curl_easy_strerror(res)),
+        "CURL error: " + std::string(curl_easy_strerror(response.result)),
         ErrorSeverity::ERROR,
         "create_github_tree_with_files");
     return "";
   }
 
-  size_t sha_pos = response_data.find("\"sha\":\""); // Find SHA in response
-  if (sha_pos != std::string::npos)                  // If SHA found
-  {
-    sha_pos += 7;                                       // Skip "sha":"
-    size_t sha_end = response_data.find("\"", sha_pos); // Find end quote
-    if (sha_end != std::string::npos)                   // If end quote found
-    {
-      return response_data.substr(sha_pos, sha_end - sha_pos); // Return the extracted SHA
-    }
-  }
-
-  return "";
+  return extractGithubSha(response.body);
 }
 
 std::string createGithubCommit(
@@ -702,28 +955,9 @@ std::string createGithubCommit(
     const std::string &author_email,
     const std::string &timestamp)
 {
-  CURL *curl = curl_easy_init();
-  if (!curl)
-  {
-    return "";
-  }
+  std::string url = getGithubRepoUrl(username, repo_name) + "/git/commits"; // Prepare URL
 
-  std::string response_data;                                                                       // To store response data
-  std::string url = "https://api.github.com/repos/" + username + "/" + repo_name + "/git/commits"; // Prepare URL
-
-  std::string escaped_message = message; // Escape double quotes and newlines in message
-  size_t pos = 0;
-  while ((pos = escaped_message.find("\"", pos)) != std::string::npos) // Find double quotes
-  {
-    escaped_message.replace(pos, 1, "\\\""); // Replace with escaped version
-    pos += 2;
-  }
-  pos = 0;
-  while ((pos = escaped_message.find("\n", pos)) != std::string::npos) // Find newlines
-  {
-    escaped_message.replace(pos, 1, "\\n"); // Replace with escaped version
-    pos += 2;
-  }
+  std::string escaped_message = jsonEscape(message); // Escape the message for JSON
 
   auto now = std::chrono::system_clock::now();                     // Get current time
   auto time_t = std::chrono::system_clock::to_time_t(now);         // Convert to time_t
@@ -737,54 +971,29 @@ std::string createGithubCommit(
     json_data += ",\"parents\":[\"" + parent_sha + "\"]"; // Add parent SHA if exists
   }
 
-  json_data += ",\"author\":{\"name\":\"" + author_name + "\",\"email\":\"" + author_email + "\",\"date\":\"" + github_timestamp + "\"}";    // Add author info
-  json_data += ",\"committer\":{\"name\":\"" + author_name + "\",\"email\":\"" + author_email + "\",\"date\":\"" + github_timestamp + "\"}"; // Add committer info
+  std::string person = "{\"name\":\"" + jsonEscape(author_name) + "\",\"email\":\"" + jsonEscape(author_email) + "\",\"date\":\"" + github_timestamp + "\"}";
+  json_data += ",\"author\":" + person;    // Add author info
+  json_data += ",\"committer\":" + person; // Add committer info
   json_data += "}";                                                                                                                          // End JSON
 
-  struct curl_slist *headers = nullptr;                                            // Initialize headers
-  headers = curl_slist_append(headers, ("Authorization: token " + token).c_str()); // Add authorization header
-  headers = curl_slist_append(headers, "Content-Type: application/json");          // Add content-type header
-  headers = curl_slist_append(headers, "User-Agent: BitTrack/1.0");                // Add user-agent header
-
-  curl_easy_setopt(curl, CURLOPT_URL, url.c_str());              // Set the URL
-  curl_easy_setopt(curl, CURLOPT_POSTFIELDS, json_data.c_str()); // Set JSON data
-  curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);           // Set headers
-  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);  // Set write callback
-  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response_data);     // Set response data storage
-
-  CURLcode res = curl_easy_perform(curl); // Perform the request
-
-  if (res != CURLE_OK || response_data.find("\"sha\"") == std::string::npos)
+  HttpResponse response = httpPerform(makeGithubRequest(token, "POST", url, json_data));
+  if (response.result != CURLE_OK || extractGithubSha(response.body).empty())
   {
-    std::cout << "GitHub API Error Response: " << response_data << std::endl;
+    std::cout << "GitHub API Error Response: " << response.body << std::endl;
   }
 
-  curl_slist_free_all(headers); // Free headers
-  curl_easy_cleanup(curl);      // Clean up CURL
-
-  if (res != CURLE_OK)
+  if (response.result != CURLE_OK)
   {
     ErrorHandler::printError(
         ErrorCode::REMOTE_CONNECTION_FAILED,
-        "CURL error: " + std::string(curl_easy_strerror(res)),
+        "CURL error: " + std::string(curl_easy_strerror(response.result)),
         ErrorSeverity::ERROR,
         "create_github_commit");
 
     return "";
   }
 
-  size_t sha_pos = response_data.find("\"sha\":\""); // Find SHA in response
-  if (sha_pos != std::string::npos)                  // If SHA found
-  {
-    sha_pos += 7;                                       // Skip "sha":"
-    size_t sha_end = response_data.find("\"", sha_pos); // Find end quote
-    if (sha_end != std::string::npos)                   // If end quote found
-    {
-      return response_data.substr(sha_pos, sha_end - sha_pos); // Return the extracted SHA
-    }
-  }
-
-  return "";
+  return extractGithubSha(response.body);
 }
 
 std::string getGithubLastCommithash(
@@ -793,34 +1002,15 @@ std::string getGithubLastCommithash(
     const std::string &repo_name,
     const std::string &ref)
 {
-  CURL *curl = curl_easy_init();
-  if (!curl)
-  {
-    return "";
-  }
-
-  std::string response_data;                                                                           // To store response data
-  std::string url = "https://api.github.com/repos/" + username + "/" + repo_name + "/git/refs/" + ref; // Prepare URL
-
-  struct curl_slist *headers = nullptr;                                            // Initialize headers
-  headers = curl_slist_append(headers, ("Authorization: token " + token).c_str()); // Add authorization header
-  headers = curl_slist_append(headers, "User-Agent: BitTrack/1.0");                // Add user-agent header
-
-  curl_easy_setopt(curl, CURLOPT_URL, url.c_str());             // Set the URL
-  curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);          // Set headers
-  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback); // Set write callback
-  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response_data);    // Set response data storage
-
-  CURLcode res = curl_easy_perform(curl); // Perform the request
-  curl_slist_free_all(headers);           // Free headers
-  curl_easy_cleanup(curl);                // Clean up CURL
-
-  if (res != CURLE_OK)
+  std::string url = getGithubRepoUrl(username, repo_name) + "/git/refs/" + ref; // Prepare URL
+  HttpResponse response = httpPerform(makeGithubRequest(token, "GET", url));
+  if (response.result != CURLE_OK)
   {
     return "";
   }
 
-  if (response_data.find("Bad credentials") != std::string::npos)
+  const std::string &response_data = response.body;
+  if (getJsonString(response_data, {"message"}) == "Bad credentials")
   {
     ErrorHandler::printError(
         ErrorCode::CONFIG_ERROR,
@@ -831,23 +1021,7 @@ std::string getGithubLastCommithash(
     return "";
   }
 
-  if (response_data.empty())
-  {
-    return "";
-  }
-
-  size_t sha_pos = response_data.find("\"sha\":\""); // Find SHA in response
-  if (sha_pos != std::string::npos)                  // If SHA found
-  {
-    sha_pos += 7;                                       // Skip "sha":"
-    size_t sha_end = response_data.find("\"", sha_pos); // Find end quote
-    if (sha_end != std::string::npos)                   // If end quote found
-    {
-      return response_data.substr(sha_pos, sha_end - sha_pos); // Return the extracted SHA
-    }
-  }
-
-  return "";
+  return extractGithubSha(response_data);
 }
 
 bool updateGithubReferance(
@@ -857,33 +1031,10 @@ bool updateGithubReferance(
     const std::string &ref,
     const std::string &sha)
 {
-  CURL *curl = curl_easy_init();
-  if (!curl)
-  {
-    return false;
-  }
+  std::string url = getGithubRepoUrl(username, repo_name) + "/git/refs/" + ref; // Prepare URL
+  std::string json_data = "{\"sha\":\"" + sha + "\"}";                           // Prepare JSON data
 
-  std::string response_data;                                                                           // To store response data
-  std::string url = "https://api.github.com/repos/" + username + "/" + repo_name + "/git/refs/" + ref; // Prepare URL
-  std::string json_data = "{\"sha\":\"" + sha + "\"}";                                                 // Prepare JSON data
-
-  struct curl_slist *headers = nullptr;                                            // Initialize headers
-  headers = curl_slist_append(headers, ("Authorization: token " + token).c_str()); // Add authorization header
-  headers = curl_slist_append(headers, "Content-Type: application/json");          // Add content-type header
-  headers = curl_slist_append(headers, "User-Agent: BitTrack/1.0");                // Add user-agent header
-
-  curl_easy_setopt(curl, CURLOPT_URL, url.c_str());              // Set the URL
-  curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "PATCH");        // Set HTTP method to PATCH
-  curl_easy_setopt(curl, CURLOPT_POSTFIELDS, json_data.c_str()); // Set JSON data
-  curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);           // Set headers
-  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);  // Set write callback
-  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response_data);     // Set response data storage
-
-  CURLcode res = curl_easy_perform(curl); // Perform the request
-  curl_slist_free_all(headers);           // Free headers
-  curl_easy_cleanup(curl);                // Clean up CURL
-
-  return res == CURLE_OK;
+  return httpPerform(makeGithubRequest(token, "PATCH", url, json_data)).result == CURLE_OK;
 }
 
 bool createGithubReferance(
@@ -893,42 +1044,21 @@ bool createGithubReferance(
     const std::string &ref,
     const std::string &sha)
 {
-  CURL *curl = curl_easy_init();
-  if (!curl)
-  {
-    return false;
-  }
-
-  std::string response_data;                                                                    // To store response data
-  std::string url = "https://api.github.com/repos/" + username + "/" + repo_name + "/git/refs"; // Prepare URL
-  std::string json_data = "{\"ref\":\"refs/" + ref + "\",\"sha\":\"" + sha + "\"}";             // Prepare JSON data
+  std::string url = getGithubRepoUrl(username, repo_name) + "/git/refs";               // Prepare URL
+  std::string json_data = "{\"ref\":\"refs/" + ref + "\",\"sha\":\"" + sha + "\"}"; // Prepare JSON data
 
-  struct curl_slist *headers = nullptr;                                            // Initialize headers
-  headers = curl_slist_append(headers, ("Authorization: token " + token).c_str()); // Add authorization header
-  headers = curl_slist_append(headers, "Content-Type: application/json");          // Add content-type header
-  headers = curl_slist_append(headers, "User-Agent: BitTrack/1.0");                // Add user-agent header
-
-  curl_easy_setopt(curl, CURLOPT_URL, url.c_str());              // Set the URL
-  curl_easy_setopt(curl, CURLOPT_POSTFIELDS, json_data.c_str()); // Set JSON data
-  curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);           // Set headers
-  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);  // Set write callback
-  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response_data);     // Set response data storage
-
-  CURLcode res = curl_easy_perform(curl); // Perform the request
-  curl_slist_free_all(headers);           // Free headers
-  curl_easy_cleanup(curl);                // Clean up CURL
-
-  if (res != CURLE_OK)
+  HttpResponse response = httpPerform(makeGithubRequest(token, "POST", url, json_data));
+  if (response.result != CURLE_OK)
   {
     ErrorHandler::printError(
         ErrorCode::REMOTE_CONNECTION_FAILED,
-        "CURL error: " + std::string(curl_easy_strerror(res)),
+        "CURL error: " + std::string(curl_easy_strerror(response.result)),
         ErrorSeverity::ERROR,
         "create_github_ref");
     return false;
   }
 
-  if (response_data.find("\"ref\":\"refs/" + ref + "\"") != std::string::npos)
+  if (getJsonString(response.body, {"ref"}) == "refs/" + ref)
   {
     return true;
   }
@@ -1013,34 +1143,14 @@ std::string getGithubCommitData(
     const std::string &commit_sha)
 {
   // Get commit data from GitHub API
-  CURL *curl = curl_easy_init();
-  if (!curl)
-  {
-    return "";
-  }
-
-  std::string response_data;                                                                                     // To store response data
-  std::string url = "https://api.github.com/repos/" + username + "/" + repo_name + "/git/commits/" + commit_sha; // Prepare URL
-
-  struct curl_slist *headers = nullptr;                                            // Initialize headers
-  headers = curl_slist_append(headers, ("Authorization: token " + token).c_str()); // Add authorization header
-  headers = curl_slist_append(headers, "User-Agent: BitTrack/1.0");                // Add user-agent header
-
-  curl_easy_setopt(curl, CURLOPT_URL, url.c_str());             // Set the URL
-  curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);          // Set headers
-  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback); // Set write callback
-  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response_data);    // Set response data storage
-
-  CURLcode res = curl_easy_perform(curl); // Perform the request
-  curl_slist_free_all(headers);           // Free headers
-  curl_easy_cleanup(curl);                // Clean up CURL
-
-  if (res != CURLE_OK)
+  std::string url = getGithubRepoUrl(username, repo_name) + "/git/commits/" + commit_sha; // Prepare URL
+  HttpResponse response = httpPerform(makeGithubRequest(token, "GET", url));
+  if (response.result != CURLE_OK)
   {
     return "";
   }
 
-  return response_data;
+  return response.body;
 }
 
 bool extractFilesFromGithubCommit(
@@ -1051,183 +1161,252 @@ bool extractFilesFromGithubCommit(
     const std::string &commit_data,
     std::vector<std::string> &downloaded_files)
 {
-  // Extract tree SHA from commit data
-  size_t tree_pos = commit_data.find("\"tree\":{\"sha\":\"");
-  if (tree_pos == std::string::npos)
-  {
-    return false;
-  }
-
-  tree_pos += 15;                                     // Skip "tree":{"sha":"
-  size_t tree_end = commit_data.find("\"", tree_pos); // Find end quote
-  if (tree_end == std::string::npos)
+  std::string tree_sha = getJsonString(commit_data, {"tree", "sha"}); // Extract tree SHA from commit data
+  if (tree_sha.empty())
   {
     return false;
   }
 
-  std::string tree_sha = commit_data.substr(tree_pos, tree_end - tree_pos);        // Extracted tree SHA
-  std::string tree_data = getGithubTreeData(token, username, repo_name, tree_sha); // Get tree data from GitHub
-  if (tree_data.empty())
+  std::vector<std::pair<std::string, std::string>> files; // path, sha pairs
+  if (!getGithubTreeFiles(token, username, repo_name, tree_sha, files))
   {
     return false;
   }
 
   return downloadFilesFromGithubTree(
-      token, username, repo_name, tree_data,
+      token, username, repo_name, files,
       downloaded_files); // Download files from the tree
 }
 
-std::string getGithubTreeData(
+bool onGithubTreeEvent(
+    GithubTreeListing &listing,
+    JsonEvent event,
+    const std::string &key,
+    const std::string &value,
+    std::size_t depth)
+{
+  // Entries are the objects at depth 2 of {"tree":[{...}, ...]}; only their
+  // fields are kept, so memory does not grow with the response
+  if (depth == 1)
+  {
+    if (event == JsonEvent::ARRAY_START && key == "tree")
+    {
+      listing.in_tree = true;
+      listing.found_tree = true;
+    }
+    else if (event == JsonEvent::ARRAY_END)
+    {
+      listing.in_tree = false;
+    }
+    else if (event == JsonEvent::LITERAL && key == "truncated")
+    {
+      listing.truncated = value == "true";
+    }
+    else if (event == JsonEvent::STRING && key == "message")
+    {
+      listing.message = value;
+    }
+  }
+  else if (listing.in_tree && depth == 2 && event == JsonEvent::OBJECT_START)
+  {
+    listing.path.clear();
+    listing.sha.clear();
+    listing.type.clear();
+  }
+  else if (listing.in_tree && depth == 2 && event == JsonEvent::OBJECT_END)
+  {
+    if (listing.type == "blob" && !listing.path.empty() && !listing.sha.empty())
+    {
+      listing.files->push_back({listing.path, listing.sha});
+    }
+  }
+  else if (listing.in_tree && depth == 3 && event == JsonEvent::STRING)
+  {
+    if (key == "path")
+    {
+      listing.path = value;
+    }
+    else if (key == "sha")
+    {
+      listing.sha = value;
+    }
+    else if (key == "type")
+    {
+      listing.type = value;
+    }
+  }
+  return true;
+}
+
+bool getGithubTreeFiles(
     const std::string &token,
     const std::string &username,
     const std::string &repo_name,
-    const std::string &tree_sha)
+    const std::string &tree_sha,
+    std::vector<std::pair<std::string, std::string>> &files)
 {
-  // Get tree data from GitHub API
-  CURL *curl = curl_easy_init();
-  if (!curl)
+  // The recursive listing of a large repository runs to many megabytes, so it
+  // is tokenized straight from the transfer instead of being buffered
+  std::string url = getGithubRepoUrl(username, repo_name) + "/git/trees/" + tree_sha + "?recursive=1"; // Prepare URL
+  auto listing = std::make_shared<GithubTreeListing>();
+  listing->files = &files;
+  auto parser = std::make_shared<JsonParser>();
+  parser->handler = [listing](JsonEvent event, const std::string &key, const std::string &value, std::size_t depth)
   {
-    return "";
-  }
+    return onGithubTreeEvent(*listing, event, key, value, depth);
+  };
 
-  std::string response_data;                                                                                                  // To store response data
-  std::string url = "https://api.github.com/repos/" + username + "/" + repo_name + "/git/trees/" + tree_sha + "?recursive=1"; // Prepare URL
+  HttpRequest request = makeGithubRequest(token, "GET", url);
+  request.body_sink = [parser](const char *data, std::size_t size)
+  {
+    feedJson(*parser, data, size);
+    return true; // a malformed listing is reported once the transfer is over
+  };
 
-  struct curl_slist *headers = nullptr;                                            // Initialize headers
-  headers = curl_slist_append(headers, ("Authorization: token " + token).c_str()); // Add authorization header
-  headers = curl_slist_append(headers, "User-Agent: BitTrack/1.0");                // Add user-agent header
+  HttpResponse response = httpPerform(request);
+  if (response.result != CURLE_OK)
+  {
+    return false;
+  }
 
-  curl_easy_setopt(curl, CURLOPT_URL, url.c_str());             // Set the URL
-  curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);          // Set headers
-  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback); // Set write callback
-  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response_data);    // Set response data storage
+  // Errors come back as {"message": ...} with no tree to look for
+  bool parsed = finishJson(*parser);
+  if (response.status < 200 || response.status >= 300)
+  {
+    ErrorHandler::printError(
+        ErrorCode::REMOTE_CONNECTION_FAILED,
+        "GitHub refused the tree listing (HTTP " + std::to_string(response.status) + ")" +
+            (listing->message.empty() ? "" : ": " + listing->message),
+        ErrorSeverity::ERROR,
+        "get_github_tree_files");
+    return false;
+  }
 
-  CURLcode res = curl_easy_perform(curl); // Perform the request
-  curl_slist_free_all(headers);           // Free headers
-  curl_easy_cleanup(curl);                // Clean up CURL
+  if (!parsed || !listing->found_tree)
+  {
+    ErrorHandler::printError(
+        ErrorCode::REMOTE_CONNECTION_FAILED,
+        "Could not find tree array in GitHub response",
+        ErrorSeverity::ERROR,
+        "get_github_tree_files");
+    return false;
+  }
 
-  if (res != CURLE_OK)
+  if (listing->truncated)
   {
-    return "";
+    ErrorHandler::printError(
+        ErrorCode::REMOTE_CONNECTION_FAILED,
+        "GitHub truncated the tree listing; only " + std::to_string(files.size()) + " files will be pulled",
+        ErrorSeverity::WARNING,
+        "get_github_tree_files");
   }
 
-  return response_data;
+  return true;
 }
 
 bool downloadFilesFromGithubTree(
     const std::string &token,
     const std::string &username,
     const std::string &repo_name,
-    const std::string &tree_data,
+    const std::vector<std::pair<std::string, std::string>> &files,
     std::vector<std::string> &downloaded_files)
 {
   try
   {
-    std::vector<std::pair<std::string, std::string>> files; // path, sha pairs
-
-    size_t tree_start = tree_data.find("\"tree\":["); // Find start of tree array
-    if (tree_start == std::string::npos)
-    {
-      ErrorHandler::printError(
-          ErrorCode::REMOTE_CONNECTION_FAILED,
-          "Could not find tree array in GitHub response",
-          ErrorSeverity::ERROR,
-          "download_files_from_github_tree");
-      return false;
-    }
+    // A working file that already holds the remote content is kept as it is
+    std::vector<std::string> working_blobs(files.size());
+    parallelForEach(
+        files.size(),
+        [&](std::size_t i)
+        {
+          if (std::filesystem::is_regular_file(files[i].first))
+          {
+            working_blobs[i] = gitBlobHashFile(files[i].first);
+          }
+        });
 
-    tree_start += 7;                                   // Skip "tree":[
-    size_t tree_end = tree_data.find("]", tree_start); // Find end of tree array
-    if (tree_end == std::string::npos)
+    // Blobs recorded by earlier pushes and pulls are restored from the local
+    // object store when it still holds them
+    std::unordered_map<std::string, std::string> local_blobs; // GitHub blob SHA to local blob hash
+    for (const auto &[blob_hash, github_blob] : getGithubBlobMapping(username, repo_name))
     {
-      ErrorHandler::printError(
-          ErrorCode::REMOTE_CONNECTION_FAILED,
-          "Malformed tree array in GitHub response",
-          ErrorSeverity::ERROR,
-          "download_files_from_github_tree");
-      return false;
+      local_blobs[github_blob] = blob_hash;
     }
 
-    std::string tree_content = tree_data.substr(tree_start, tree_end - tree_start); // Extract tree content
-    size_t pos = 0;                                                                 // Position in tree content
-    while (pos < tree_content.length())
+    std::vector<std::string> blob_hashes(files.size()); // local blob to write to each path
+    std::vector<std::size_t> fetched;
+    std::vector<std::shared_ptr<GithubBlobDownload>> downloads;
+    std::vector<HttpRequest> requests;
+    std::size_t unchanged = 0;
+    for (std::size_t i = 0; i < files.size(); i++)
     {
-      size_t file_start = tree_content.find("{", pos); // Find start of file entry
-      if (file_start == std::string::npos)
+      if (working_blobs[i] == files[i].second)
       {
-        break;
+        unchanged++;
+        downloaded_files.push_back(files[i].first);
+        continue;
       }
 
-      size_t file_end = tree_content.find("}", file_start); // Find end of file entry
-      if (file_end == std::string::npos)
+      auto local = local_blobs.find(files[i].second);
+      if (local != local_blobs.end() && blobExists(local->second))
       {
-        break;
+        blob_hashes[i] = local->second;
+        continue;
       }
 
-      std::string file_entry = tree_content.substr(file_start, file_end - file_start + 1); // Extract file entry
-      size_t path_pos = file_entry.find("\"path\":\"");                                    // Find path
-      size_t sha_pos = file_entry.find("\"sha\":\"");                                      // Find sha
-      size_t type_pos = file_entry.find("\"type\":\"");                                    // Find type
+      // Only transfers in flight hold an open object, so every download can
+      // be queued at once
+      fetched.push_back(i);
+      downloads.push_back(std::make_shared<GithubBlobDownload>());
+      requests.push_back(makeGithubBlobDownloadRequest(token, username, repo_name, files[i].second, downloads.back()));
+    }
 
-      if (path_pos != std::string::npos && sha_pos != std::string::npos && type_pos != std::string::npos) // If all found
-      {
-        size_t type_start = type_pos + 8;                    // Skip "type":"
-        size_t type_end = file_entry.find("\"", type_start); // Find end quote of type
-        if (type_end != std::string::npos)
+    // The rest stream concurrently over shared connections, decoded straight
+    // into the object store
+    std::vector<std::pair<std::string, std::string>> learned; // blobs fetched from GitHub
+    std::vector<HttpResponse> responses = httpPerformAll(requests);
+
+    // A truncated or altered response still decodes to some blob, so only
+    // content whose Git hash matches the tree is written or remembered; a
+    // mismatching blob this download created is removed straight away
+    std::vector<std::string> fetched_blobs(fetched.size());
+    parallelForEach(
+        fetched.size(),
+        [&](std::size_t k)
         {
-          std::string type = file_entry.substr(type_start, type_end - type_start); // Extract type
-          if (type == "blob")
+          const std::string &blob_hash = downloads[k]->blob_hash;
+          if (blob_hash.empty())
           {
-            path_pos += 8;                                     // Skip "path":"
-            size_t path_end = file_entry.find("\"", path_pos); // Find end quote of path
-            if (path_end != std::string::npos)                 // If end quote found
-            {
-              std::string path = file_entry.substr(path_pos, path_end - path_pos); // Extract path
-              sha_pos += 7;                                                        // Skip "sha":"
-              size_t sha_end = file_entry.find("\"", sha_pos);                     // Find end quote of sha
-              if (sha_end != std::string::npos)                                    // If end quote found
-              {
-                std::string sha = file_entry.substr(sha_pos, sha_end - sha_pos); // Extract sha
-                files.push_back({path, sha});                                    // Store path and sha
-              }
-            }
+            return;
           }
-        }
+          if (responses[k].result == CURLE_OK && gitBlobHashStored(blob_hash) == files[fetched[k]].second)
+          {
+            fetched_blobs[k] = blob_hash;
+          }
+          else if (downloads[k]->writer.created)
+          {
+            ErrorHandler::safeRemoveFile(getBlobPath(blob_hash));
+          }
+        });
+    for (std::size_t k = 0; k < fetched.size(); k++)
+    {
+      blob_hashes[fetched[k]] = fetched_blobs[k];
+      if (!fetched_blobs[k].empty())
+      {
+        learned.emplace_back(fetched_blobs[k], files[fetched[k]].second);
       }
-      pos = file_end + 1;
     }
+    std::cout << "Downloaded " << fetched.size() << " of " << files.size() << " files, " << unchanged << " unchanged" << std::endl;
 
-    for (const auto &file : files)
+    for (std::size_t i = 0; i < files.size(); i++)
     {
-      std::string file_path = file.first;
-      std::string file_sha = file.second;
-
-      std::string file_content = getGithubBlobContent(
-          token, username, repo_name, file_sha); // Get blob content
-      if (!file_content.empty())
+      if (working_blobs[i] == files[i].second)
       {
-        std::filesystem::path file_path_obj(file_path); // Create path object
-        if (file_path_obj.has_parent_path())            // Create directories if needed
-        {
-          std::filesystem::create_directories(file_path_obj.parent_path());
-        }
-
-        std::ofstream file_stream(file_path); // Write content to file
-        if (file_stream.is_open())
-        {
-          file_stream << file_content;
-          file_stream.close();
-          downloaded_files.push_back(file_path);
-        }
-        else
-        {
-          ErrorHandler::printError(
-              ErrorCode::FILE_WRITE_ERROR, "Could not create file " + file_path,
-              ErrorSeverity::ERROR,
-              "download_files_from_github_tree");
-        }
+        continue;
       }
-      else
+
+      const std::string &file_path = files[i].first;
+      if (blob_hashes[i].empty())
       {
         ErrorHandler::printError(
             ErrorCode::REMOTE_CONNECTION_FAILED,
@@ -1235,7 +1414,13 @@ bool downloadFilesFromGithubTree(
             ErrorSeverity::ERROR,
             "download_files_from_github_tree");
       }
+      else if (restoreBlobToFile(blob_hashes[i], file_path))
+      {
+        downloaded_files.push_back(file_path);
+      }
     }
+
+    addGithubBlobMappings(username, repo_name, learned);
     return true;
   }
   catch (const std::exception &e)
@@ -1255,85 +1440,24 @@ std::string getGithubBlobContent(
     const std::string &repo_name,
     const std::string &blob_sha)
 {
-  CURL *curl = curl_easy_init();
-  if (!curl)
-  {
-    return "";
-  }
-
-  std::string response_data;                                                                                 // To store response data
-  std::string url = "https://api.github.com/repos/" + username + "/" + repo_name + "/git/blobs/" + blob_sha; // Prepare URL
-
-  struct curl_slist *headers = nullptr;                                            // Initialize headers
-  headers = curl_slist_append(headers, ("Authorization: token " + token).c_str()); // Add authorization header
-  headers = curl_slist_append(headers, "User-Agent: BitTrack/1.0");                // Add user-agent header
-
-  curl_easy_setopt(curl, CURLOPT_URL, url.c_str());             // Set the URL
-  curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);          // Set headers
-  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback); // Set write callback
-  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response_data);    // Set response data storage
-
-  CURLcode res = curl_easy_perform(curl); // Perform the request
-  curl_slist_free_all(headers);           // Free headers
-  curl_easy_cleanup(curl);                // Clean up CURL
-
-  if (res != CURLE_OK)
-  {
-    return "";
-  }
-
-  size_t content_pos = response_data.find("\"content\":\""); // Find content in response
-  if (content_pos == std::string::npos)
-  {
-    return "";
-  }
-
-  content_pos += 11;                                          // Skip "content":"
-  size_t content_end = response_data.find("\"", content_pos); // Find end quote of content
-  if (content_end == std::string::npos)
-  {
-    return "";
-  }
-
-  std::string encoded_content = response_data.substr(content_pos, content_end - content_pos); // Extract encoded content
-
-  // Remove JSON escapes (\n)
-  size_t pos = 0;
-  while ((pos = encoded_content.find("\\n", pos)) != std::string::npos)
-  {
-    encoded_content.replace(pos, 2, "");
-  }
-  pos = 0;
-  while ((pos = encoded_content.find("\\r", pos)) != std::string::npos)
-  {
-    encoded_content.replace(pos, 2, "");
-  }
-
-  return base64Decode(encoded_content);
+  std::string url = getGithubRepoUrl(username, repo_name) + "/git/blobs/" + blob_sha; // Prepare URL
+  return decodeGithubBlobContent(httpPerform(makeGithubRequest(token, "GET", url)));
 }
 
 bool validateGithubOperationSuccess(const std::string &response_data)
 {
-  if (response_data.find("\"message\":\"") !=
-      std::string::npos) // Check for error messages
-  {
-    // Common error messages
-    if (response_data.find("\"message\":\"Not Found\"") != std::string::npos ||
-        response_data.find("\"message\":\"Bad credentials\"") != std::string::npos ||
-        response_data.find("\"message\":\"Validation Failed\"") != std::string::npos ||
-        response_data.find("\"message\":\"Repository not found\"") != std::string::npos)
-    {
-      return false;
-    }
-  }
-
-  // Check for success indicator
-  if (response_data.find("\"sha\":\"") != std::string::npos)
+  // Common error messages
+  std::string message = getJsonString(response_data, {"message"});
+  if (message == "Not Found" ||
+      message == "Bad credentials" ||
+      message == "Validation Failed" ||
+      message == "Repository not found")
   {
-    return true;
+    return false;
   }
 
-  return false;
+  // Check for success indicator
+  return !extractGithubSha(response_data).empty();
 }
 
 bool deleteGithubFile(
@@ -1343,98 +1467,36 @@ bool deleteGithubFile(
     const std::string &filename,
     const std::string &message)
 {
-  CURL *curl = curl_easy_init();
-  if (!curl)
-  {
-    return false;
-  }
-
-  std::string response_data;                                                                                // To store response data
-  std::string url = "https://api.github.com/repos/" + username + "/" + repo_name + "/contents/" + filename; // Prepare URL
-
-  struct curl_slist *headers = nullptr;                                            // Initialize headers
-  headers = curl_slist_append(headers, ("Authorization: token " + token).c_str()); // Add authorization header
-  headers = curl_slist_append(headers, "User-Agent: BitTrack/1.0");                // Add user-agent header
-
-  curl_easy_setopt(curl, CURLOPT_URL, url.c_str());             // Set the URL
-  curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);          // Set headers
-  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback); // Set write callback
-  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response_data);    // Set response data storage
-
-  CURLcode res = curl_easy_perform(curl); // Perform the request
-  curl_slist_free_all(headers);           // Free headers
-  curl_easy_cleanup(curl);                // Clean up CURL
-
-  if (res != CURLE_OK)
+  std::string url = getGithubRepoUrl(username, repo_name) + "/contents/" + filename; // Prepare URL
+  HttpResponse response = httpPerform(makeGithubRequest(token, "GET", url));
+  if (response.result != CURLE_OK)
   {
     return false;
   }
 
-  size_t sha_pos = response_data.find("\"sha\":\""); // Find SHA in response
-  if (sha_pos == std::string::npos)                  // If SHA not found
+  std::string file_sha = getJsonString(response.body, {"sha"}); // SHA of the file's current content
+  if (file_sha.empty())
   {
-    if (response_data.find("\"message\":\"Not Found\"") != std::string::npos) // File not found
+    if (getJsonString(response.body, {"message"}) == "Not Found") // File not found
     {
       std::cout << "    File not found on GitHub: " << filename << " (skipping deletion)" << std::endl;
       return true;
     }
     return false;
   }
-  sha_pos += 7;                                       // Skip "sha":"
-  size_t sha_end = response_data.find("\"", sha_pos); // Find end quote of SHA
-  if (sha_end == std::string::npos)                   // If end quote not found
-  {
-    return false;
-  }
-  std::string file_sha = response_data.substr(sha_pos, sha_end - sha_pos); // Extracted file SHA
-
-  curl = curl_easy_init(); // Initialize CURL for deletion
-  if (!curl)
-  {
-    return false;
-  }
-
-  response_data.clear();
 
-  std::string escaped_message = message; // Escape double quotes and newlines in message
-  size_t pos = 0;
-  while ((pos = escaped_message.find("\"", pos)) != std::string::npos) // Find double quotes
-  {
-    escaped_message.replace(pos, 1, "\\\""); // Replace with escaped version
-    pos += 2;
-  }
-  pos = 0;
-  while ((pos = escaped_message.find("\n", pos)) != std::string::npos) // Find newlines
-  {
-    escaped_message.replace(pos, 1, "\\n"); // Replace with escaped version
-    pos += 2;
-  }
+  std::string escaped_message = jsonEscape(message); // Escape the message for JSON
 
   // Prepare JSON data for deletion
   std::string json_data = "{\"message\":\"" + escaped_message + "\",\"sha\":\"" + file_sha + "\"}";
 
-  headers = nullptr;                                                               // Re-initialize headers
-  headers = curl_slist_append(headers, ("Authorization: token " + token).c_str()); // Add authorization header
-  headers = curl_slist_append(headers, "Content-Type: application/json");          // Add content-type header
-  headers = curl_slist_append(headers, "User-Agent: BitTrack/1.0");                // Add user-agent header
-
-  curl_easy_setopt(curl, CURLOPT_URL, url.c_str());              // Set the URL
-  curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE");       // Set HTTP method to DELETE
-  curl_easy_setopt(curl, CURLOPT_POSTFIELDS, json_data.c_str()); // Set JSON data
-  curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);           // Set headers
-  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);  // Set write callback
-  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response_data);     // Set response data storage
-
-  res = curl_easy_perform(curl); // Perform the request
-  curl_slist_free_all(headers);  // Free headers
-  curl_easy_cleanup(curl);       // Clean up CURL
-
-  if (res != CURLE_OK)
+  HttpResponse deletion = httpPerform(makeGithubRequest(token, "DELETE", url, json_data));
+  if (deletion.result != CURLE_OK)
   {
     return false;
   }
 
-  return validateGithubOperationSuccess(response_data);
+  return validateGithubOperationSuccess(deletion.body);
 }
 
 bool pushTagToGithub(
@@ -1486,63 +1548,74 @@ bool pushTagToGithub(
   }
 }
 
+bool parseGithubTagRefs(
+    const std::string &response_data,
+    std::vector<std::pair<std::string, std::string>> &tags)
+{
+  // Each ref is an object {"ref":"refs/tags/NAME", "object":{"sha":...}},
+  // either alone or as an element of an array; its members may come in any
+  // order, so the pair is taken when the ref object closes
+  std::size_t ref_depth = 0; // depth of the ref objects, 1 inside an array
+  bool in_object = false;    // inside the "object" member of a ref
+  std::string full_ref;
+  std::string sha;
+  return parseJson(
+      response_data,
+      [&](JsonEvent event, const std::string &key, const std::string &value, std::size_t depth)
+      {
+        if (event == JsonEvent::ARRAY_START && depth == 0)
+        {
+          ref_depth = 1;
+        }
+        else if (event == JsonEvent::OBJECT_START && depth == ref_depth)
+        {
+          full_ref.clear();
+          sha.clear();
+        }
+        else if (depth == ref_depth + 1 && key == "object" &&
+                 (event == JsonEvent::OBJECT_START || event == JsonEvent::OBJECT_END))
+        {
+          in_object = event == JsonEvent::OBJECT_START;
+        }
+        else if (event == JsonEvent::STRING && depth == ref_depth + 1 && key == "ref")
+        {
+          full_ref = value;
+        }
+        else if (event == JsonEvent::STRING && in_object && depth == ref_depth + 2 && key == "sha")
+        {
+          sha = value;
+        }
+        else if (event == JsonEvent::OBJECT_END && depth == ref_depth &&
+                 full_ref.rfind("refs/tags/", 0) == 0 && !sha.empty())
+        {
+          tags.emplace_back(full_ref.substr(10), sha);
+        }
+        return true;
+      });
+}
+
 bool pullTagsFromGithub(
     const std::string &token,
     const std::string &username,
     const std::string &repo_name)
 {
-  CURL *curl = curl_easy_init();
-  if (!curl)
+  std::string url = getGithubRepoUrl(username, repo_name) + "/git/refs/tags";
+  HttpResponse response = httpPerform(makeGithubRequest(token, "GET", url));
+  if (response.result != CURLE_OK)
     return false;
 
-  std::string response_data;
-  std::string url = "https://api.github.com/repos/" + username + "/" + repo_name + "/git/refs/tags";
-
-  // Prepare headers
-  struct curl_slist *headers = nullptr;
-  headers = curl_slist_append(headers, ("Authorization: token " + token).c_str());
-  headers = curl_slist_append(headers, "User-Agent: BitTrack/1.0");
-
-  // Set options
-  curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-  curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
-  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response_data);
-
-  // Perform the request
-  CURLcode res = curl_easy_perform(curl);
-  curl_slist_free_all(headers);
-  curl_easy_cleanup(curl);
-
-  if (res != CURLE_OK)
-    return false;
-  // Simple parsing of the JSON response to find tags
-  size_t pos = 0;
-
-  while ((pos = response_data.find("\"ref\":\"", pos)) != std::string::npos)
-  {
-    // Find the end of the ref string
-    pos += 7;
-    size_t ref_end = response_data.find("\"", pos);
-    std::string full_ref = response_data.substr(pos, ref_end - pos);
-
-    // Extract tag name (refs/tags/NAME)
-    std::string tag_name = full_ref.substr(10);
-    // Find the SHA for this tag
-    size_t sha_pos = response_data.find("\"sha\":\"", ref_end);
-    sha_pos += 7;
-    size_t sha_end = response_data.find("\"", sha_pos);
-    std::string sha = response_data.substr(sha_pos, sha_end - sha_pos);
+  std::vector<std::pair<std::string, std::string>> tags;
+  bool parsed = parseGithubTagRefs(response.body, tags);
+  for (const auto &[name, sha] : tags)
+  {
     // Save as a lightweight tag for now (we can enhance this to fetch annotated data later)
     Tag tag;
-    tag.name = tag_name;
+    tag.name = name;
     tag.commit_hash = sha;
     tag.type = TagType::LIGHTWEIGHT;
     tagSave(tag);
-
-    pos = sha_end;
   }
-  return true;
+  return parsed;
 }
 
 std::string createGithubTagObject(
@@ -1555,14 +1628,7 @@ std::string createGithubTagObject(
     const std::string &tagger_name,
     const std::string &tagger_email)
 {
-  CURL *curl = curl_easy_init(); // Initialize CURL
-  if (!curl)
-  {
-    return "";
-  }
-
-  std::string response_data;
-  std::string url = "https://api.github.com/repos/" + username + "/" + repo_name + "/git/tags";
+  std::string url = getGithubRepoUrl(username, repo_name) + "/git/tags";
 
   // Format timestamp
   auto now = std::chrono::system_clock::now();
@@ -1573,43 +1639,15 @@ std::string createGithubTagObject(
   std::string github_timestamp = ss.str();
 
   // Prepare JSON data
-  std::string json_data = "{\"tag\":\"" + tag_name + "\",\"message\":\"" + message + "\",\"object\":\"" + commit_sha + "\",\"type\":\"commit\",\"tagger\":{\"name\":\"" + tagger_name + "\",\"email\":\"" + tagger_email + "\",\"date\":\"" + github_timestamp + "\"}}";
-
-  // Prepare headers
-  struct curl_slist *headers = nullptr;
-  headers = curl_slist_append(headers, ("Authorization: token " + token).c_str());
-  headers = curl_slist_append(headers, "Content-Type: application/json");
-  headers = curl_slist_append(headers, "User-Agent: BitTrack/1.0");
+  std::string json_data = "{\"tag\":\"" + jsonEscape(tag_name) + "\",\"message\":\"" + jsonEscape(message) + "\",\"object\":\"" + commit_sha + "\",\"type\":\"commit\",\"tagger\":{\"name\":\"" + jsonEscape(tagger_name) + "\",\"email\":\"" + jsonEscape(tagger_email) + "\",\"date\":\"" + github_timestamp + "\"}}";
 
   // Perform request
-  curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-  curl_easy_setopt(curl, CURLOPT_POSTFIELDS, json_data.c_str());
-  curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
-  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response_data);
-
-  // Perform request
-  CURLcode res = curl_easy_perform(curl);
-  curl_slist_free_all(headers);
-  curl_easy_cleanup(curl);
-
-  // Check response
-  if (res != CURLE_OK)
+  HttpResponse response = httpPerform(makeGithubRequest(token, "POST", url, json_data));
+  if (response.result != CURLE_OK)
   {
     return "";
   }
 
   // Extract SHA
-  size_t sha_pos = response_data.find("\"sha\":\"");
-  if (sha_pos != std::string::npos)
-  {
-    // Extract SHA
-    sha_pos += 7;
-    size_t sha_end = response_data.find("\"", sha_pos);
-    if (sha_end != std::string::npos)
-    {
-      return response_data.substr(sha_pos, sha_end - sha_pos);
-    }
-  }
-  return "";
+  return extractGithubSha(response.body);
 }
\ No newline at end of file
@@ -0,0 +1,797 @@
+#include "../include/graph.hpp"
+
+// Commit-graph layout (all integers little-endian):
+//   "BTCG" | version u32 | commit count u32 | extra edge count u32
+//   per commit, sorted by hash: hash bytes (32, zero padded) | hash length u8 |
+//              first parent u32 | second parent u32 | generation u32 | timestamp i64
+//   extra edges u32, used when a commit has more than two parents
+//   trailing SHA-256 of everything before it
+// Tail layout, appended to as commits are made and folded into the graph file:
+//   per commit, parents first: hash key (33) | timestamp i64 | parent count u32 |
+//              parent keys (33 each)
+static const char GRAPH_SIGNATURE[4] = {'B', 'T', 'C', 'G'};
+static const uint32_t GRAPH_VERSION = 1;
+static const std::size_t GRAPH_HEADER_SIZE = 16;
+static const std::size_t GRAPH_KEY_SIZE = SHA256_DIGEST_LENGTH + 1;
+static const std::size_t GRAPH_RECORD_SIZE = GRAPH_KEY_SIZE + 4 + 4 + 4 + 8;
+
+// Commits the tail may hold before the next update folds it into the graph
+// file; loading the tail costs a hash lookup per commit, rewriting the file
+// costs every commit
+static const std::size_t GRAPH_TAIL_LIMIT = 512;
+
+// A parent slot without a commit, and the flag marking a second parent slot
+// that points into the extra edge list instead of at a commit
+static const uint32_t GRAPH_NO_PARENT = 0xffffffff;
+static const uint32_t GRAPH_EXTRA_EDGES = 0x80000000;
+
+// Paint flags used by the merge base search
+static const uint8_t PAINT_FIRST = 1;
+static const uint8_t PAINT_SECOND = 2;
+
+// A commit waiting to be written to the graph
+struct GraphCommit
+{
+  std::vector<std::string> parents; // parent commit hashes in log order, or their graph keys
+  int64_t timestamp;                // commit time in seconds since the epoch
+
+  GraphCommit() : timestamp(0) {}
+};
+
+template <typename T>
+static void appendInteger(std::string &buffer, T value)
+{
+  for (std::size_t i = 0; i < sizeof(T); i++)
+  {
+    buffer.push_back(static_cast<char>((static_cast<uint64_t>(value) >> (8 * i)) & 0xff));
+  }
+}
+
+template <typename T>
+static T readInteger(const unsigned char *data)
+{
+  uint64_t result = 0;
+  for (std::size_t i = 0; i < sizeof(T); i++)
+  {
+    result |= static_cast<uint64_t>(data[i]) << (8 * i);
+  }
+  return static_cast<T>(result);
+}
+
+static bool makeGraphKey(const std::string &commit_hash, std::string &key)
+{
+  // The key is the raw hash padded to 32 bytes followed by its length, so
+  // SHA-1 hashes of pulled commits and SHA-256 hashes sort side by side
+  if (commit_hash.empty() || commit_hash.size() % 2 != 0 || commit_hash.size() > SHA256_DIGEST_LENGTH * 2 ||
+      commit_hash.find_first_not_of("0123456789abcdef") != std::string::npos)
+  {
+    return false;
+  }
+
+  auto nibble = [](char digit)
+  { return digit <= '9' ? digit - '0' : digit - 'a' + 10; };
+  key.assign(GRAPH_KEY_SIZE, '\0');
+  for (std::size_t i = 0; i < commit_hash.size(); i += 2)
+  {
+    key[i / 2] = static_cast<char>((nibble(commit_hash[i]) << 4) | nibble(commit_hash[i + 1]));
+  }
+  key[SHA256_DIGEST_LENGTH] = static_cast<char>(commit_hash.size() / 2);
+  return true;
+}
+
+static const unsigned char *getGraphRecord(
+    const CommitGraph &graph,
+    uint32_t position)
+{
+  return graph.data + GRAPH_HEADER_SIZE + static_cast<std::size_t>(position) * GRAPH_RECORD_SIZE;
+}
+
+// Graph key of the commit at position, whether it sits in the file or the tail
+static std::string getGraphKey(
+    const CommitGraph &graph,
+    uint32_t position)
+{
+  if (position >= graph.file_count)
+  {
+    return graph.tail[position - graph.file_count].key;
+  }
+  return std::string(reinterpret_cast<const char *>(getGraphRecord(graph, position)), GRAPH_KEY_SIZE);
+}
+
+static int64_t findGraphKey(
+    const CommitGraph &graph,
+    const std::string &key)
+{
+  // Records are sorted by key, so binary search them in place
+  uint32_t low = 0;
+  uint32_t high = graph.file_count;
+  while (low < high)
+  {
+    uint32_t middle = low + (high - low) / 2;
+    int order = std::memcmp(getGraphRecord(graph, middle), key.data(), GRAPH_KEY_SIZE);
+    if (order == 0)
+    {
+      return middle;
+    }
+    if (order < 0)
+    {
+      low = middle + 1;
+    }
+    else
+    {
+      high = middle;
+    }
+  }
+
+  auto tail_commit = graph.tail_keys.find(key);
+  if (tail_commit == graph.tail_keys.end())
+  {
+    return -1;
+  }
+  return tail_commit->second;
+}
+
+static bool readCommitLog(
+    const std::string &commit_hash,
+    GraphCommit &commit)
+{
+  std::string log_path = ".bittrack/commits/" + commit_hash;
+  if (!std::filesystem::is_regular_file(log_path))
+  {
+    return false;
+  }
+
+  // Only the header matters, so stop at the file list
+  std::istringstream log_stream(ErrorHandler::safeReadFile(log_path));
+  std::string line;
+  while (std::getline(log_stream, line) && line.rfind("Files:", 0) != 0)
+  {
+    if (line.rfind("Parent: ", 0) == 0)
+    {
+      std::string parent = line.substr(8);
+      parent.erase(parent.find_last_not_of(" \t\r") + 1);
+      commit.parents.push_back(parent);
+    }
+    else if (line.rfind("Timestamp: ", 0) == 0 || line.rfind("Date: ", 0) == 0)
+    {
+      std::tm time_parts = {};
+      std::istringstream time_stream(line.substr(line.find(' ') + 1));
+      time_stream >> std::get_time(&time_parts, "%Y-%m-%d %H:%M:%S");
+      if (!time_stream.fail())
+      {
+        time_parts.tm_isdst = -1;
+        commit.timestamp = static_cast<int64_t>(std::mktime(&time_parts));
+      }
+    }
+  }
+
+  return true;
+}
+
+static void addGraphCommit(
+    std::map<std::string, GraphCommit> &commits,
+    const std::string &commit_hash,
+    const GraphCommit &commit)
+{
+  // Convert the commit and its parents to graph keys
+  std::string key;
+  if (!makeGraphKey(commit_hash, key))
+  {
+    return;
+  }
+
+  GraphCommit &keyed_commit = commits[key];
+  keyed_commit.timestamp = commit.timestamp;
+  for (const auto &parent : commit.parents)
+  {
+    std::string parent_key;
+    if (makeGraphKey(parent, parent_key))
+    {
+      keyed_commit.parents.push_back(parent_key);
+    }
+  }
+}
+
+static bool saveCommitGraph(const std::map<std::string, GraphCommit> &commits)
+{
+  // Commits are keyed by their binary graph key, which is also the file order
+  std::vector<std::map<std::string, GraphCommit>::const_iterator> keyed_commits;
+  std::unordered_map<std::string, uint32_t> positions;
+  for (auto commit = commits.begin(); commit != commits.end(); ++commit)
+  {
+    positions[commit->first] = static_cast<uint32_t>(keyed_commits.size());
+    keyed_commits.push_back(commit);
+  }
+
+  // Resolve parents to positions, dropping parents whose logs are gone
+  std::vector<std::vector<uint32_t>> parents(keyed_commits.size());
+  for (std::size_t i = 0; i < keyed_commits.size(); i++)
+  {
+    for (const auto &parent : keyed_commits[i]->second.parents)
+    {
+      auto parent_position = positions.find(parent);
+      if (parent_position != positions.end())
+      {
+        parents[i].push_back(parent_position->second);
+      }
+    }
+  }
+
+  // A commit's generation is one more than its highest parent, roots are 1
+  std::vector<uint32_t> generations(keyed_commits.size(), 0);
+  for (std::size_t root = 0; root < keyed_commits.size(); root++)
+  {
+    std::vector<uint32_t> pending = {static_cast<uint32_t>(root)};
+    while (!pending.empty())
+    {
+      uint32_t position = pending.back();
+      if (generations[position] != 0)
+      {
+        pending.pop_back();
+        continue;
+      }
+
+      // Compute the parents first, then come back to this commit
+      uint32_t generation = 1;
+      bool parents_ready = true;
+      for (uint32_t parent : parents[position])
+      {
+        if (generations[parent] == 0)
+        {
+          pending.push_back(parent);
+          parents_ready = false;
+        }
+        else
+        {
+          generation = std::max(generation, generations[parent] + 1);
+        }
+      }
+
+      if (parents_ready)
+      {
+        generations[position] = generation;
+        pending.pop_back();
+      }
+    }
+  }
+
+  std::string buffer(GRAPH_SIGNATURE, sizeof(GRAPH_SIGNATURE));
+  std::vector<uint32_t> extra_edges;
+  std::string records;
+  for (std::size_t i = 0; i < keyed_commits.size(); i++)
+  {
+    uint32_t first_parent = parents[i].empty() ? GRAPH_NO_PARENT : parents[i][0];
+    uint32_t second_parent = parents[i].size() < 2 ? GRAPH_NO_PARENT : parents[i][1];
+    if (parents[i].size() > 2)
+    {
+      // Octopus merges list every parent after the first in the extra edges,
+      // the last one is flagged to end the list
+      second_parent = GRAPH_EXTRA_EDGES | static_cast<uint32_t>(extra_edges.size());
+      for (std::size_t j = 1; j < parents[i].size(); j++)
+      {
+        extra_edges.push_back(parents[i][j] | (j + 1 == parents[i].size() ? GRAPH_EXTRA_EDGES : 0));
+      }
+    }
+
+    records += keyed_commits[i]->first;
+    appendInteger(records, first_parent);
+    appendInteger(records, second_parent);
+    appendInteger(records, generations[i]);
+    appendInteger(records, keyed_commits[i]->second.timestamp);
+  }
+
+  appendInteger(buffer, GRAPH_VERSION);
+  appendInteger(buffer, static_cast<uint32_t>(keyed_commits.size()));
+  appendInteger(buffer, static_cast<uint32_t>(extra_edges.size()));
+  buffer += records;
+  for (uint32_t edge : extra_edges)
+  {
+    appendInteger(buffer, edge);
+  }
+
+  unsigned char digest[SHA256_DIGEST_LENGTH];
+  SHA256(reinterpret_cast<const unsigned char *>(buffer.data()), buffer.size(), digest);
+  buffer.append(reinterpret_cast<char *>(digest), SHA256_DIGEST_LENGTH);
+
+  // Replace the graph atomically so readers never map a partial file
+  std::string temp_graph_path = getCommitGraphPath() + ".tmp";
+  std::ofstream temp_file(temp_graph_path, std::ios::binary | std::ios::trunc);
+  temp_file.write(buffer.data(), buffer.size());
+  temp_file.close();
+  if (temp_file.fail() || !ErrorHandler::safeRename(temp_graph_path, getCommitGraphPath()))
+  {
+    ErrorHandler::safeRemoveFile(temp_graph_path);
+    ErrorHandler::printError(
+        ErrorCode::FILE_WRITE_ERROR,
+        "Cannot write commit graph: " + getCommitGraphPath(),
+        ErrorSeverity::ERROR,
+        "save_commit_graph");
+    return false;
+  }
+
+  // The file now holds every commit of the tail; should the removal not
+  // happen, loading skips tail commits the file already has
+  ErrorHandler::safeRemoveFile(getCommitGraphTailPath());
+  return true;
+}
+
+static void unloadCommitGraph(CommitGraph &graph)
+{
+  if (graph.data != nullptr)
+  {
+    munmap(const_cast<unsigned char *>(graph.data), graph.size);
+  }
+  graph.data = nullptr;
+  graph.size = 0;
+  graph.count = 0;
+  graph.file_count = 0;
+  graph.edges_offset = 0;
+  graph.tail.clear();
+  graph.tail_keys.clear();
+}
+
+CommitGraph::~CommitGraph()
+{
+  unloadCommitGraph(*this);
+}
+
+std::string getCommitGraphPath()
+{
+  return ".bittrack/commit-graph";
+}
+
+std::string getCommitGraphTailPath()
+{
+  return ".bittrack/commit-graph-tail";
+}
+
+bool writeCommitGraph()
+{
+  // Rebuild the graph from every commit log
+  std::map<std::string, GraphCommit> commits;
+  for (const auto &entry : ErrorHandler::safeListDirectoryFiles(".bittrack/commits"))
+  {
+    std::string commit_hash = entry.filename().string();
+    GraphCommit commit;
+    if (commit_hash != "history" && readCommitLog(commit_hash, commit))
+    {
+      addGraphCommit(commits, commit_hash, commit);
+    }
+  }
+
+  return saveCommitGraph(commits);
+}
+
+bool updateCommitGraph(const std::string &commit_hash)
+{
+  CommitGraph graph;
+  bool loaded = loadCommitGraph(graph);
+  if (loaded && findGraphCommit(graph, commit_hash) >= 0)
+  {
+    return true;
+  }
+
+  // Collect the new commit and the ancestors the graph has not seen yet,
+  // parents before children so each tail commit can find its parents
+  std::vector<std::pair<std::string, GraphCommit>> added;
+  std::unordered_map<std::string, GraphCommit> logs;
+  std::vector<std::pair<std::string, bool>> pending = {{commit_hash, false}};
+  while (!pending.empty())
+  {
+    auto [current, expanded] = pending.back();
+    pending.pop_back();
+
+    // A commit comes back expanded once all of its parents have been added
+    std::string key;
+    if (!makeGraphKey(current, key))
+    {
+      continue;
+    }
+    if (expanded)
+    {
+      added.emplace_back(current, logs[key]);
+      continue;
+    }
+
+    GraphCommit commit;
+    if (logs.count(key) > 0 || findGraphKey(graph, key) >= 0 || !readCommitLog(current, commit))
+    {
+      continue;
+    }
+    pending.emplace_back(current, true);
+    for (auto parent = commit.parents.rbegin(); parent != commit.parents.rend(); ++parent)
+    {
+      pending.emplace_back(*parent, false);
+    }
+    logs[key] = std::move(commit);
+  }
+  if (added.empty())
+  {
+    return true;
+  }
+
+  if (!loaded || graph.tail.size() + added.size() > GRAPH_TAIL_LIMIT)
+  {
+    // Fold the tail and the new commits into a rewritten graph file, copying
+    // the raw keys so the existing commits are never converted to hex
+    std::map<std::string, GraphCommit> commits;
+    for (uint32_t position = 0; position < graph.count; position++)
+    {
+      GraphCommit &commit = commits[getGraphKey(graph, position)];
+      commit.timestamp = getGraphTimestamp(graph, position);
+      for (uint32_t parent : getGraphParents(graph, position))
+      {
+        commit.parents.push_back(getGraphKey(graph, parent));
+      }
+    }
+    for (const auto &[current, commit] : added)
+    {
+      addGraphCommit(commits, current, commit);
+    }
+    return saveCommitGraph(commits);
+  }
+
+  std::string records;
+  for (const auto &[current, commit] : added)
+  {
+    std::string key;
+    makeGraphKey(current, key);
+    std::vector<std::string> parent_keys;
+    for (const auto &parent : commit.parents)
+    {
+      std::string parent_key;
+      if (makeGraphKey(parent, parent_key))
+      {
+        parent_keys.push_back(parent_key);
+      }
+    }
+
+    records += key;
+    appendInteger(records, commit.timestamp);
+    appendInteger(records, static_cast<uint32_t>(parent_keys.size()));
+    for (const auto &parent_key : parent_keys)
+    {
+      records += parent_key;
+    }
+  }
+
+  // One append per update, so a reader sees whole records or a torn last one
+  std::ofstream tail_file(getCommitGraphTailPath(), std::ios::binary | std::ios::app);
+  tail_file.write(records.data(), records.size());
+  tail_file.close();
+  if (tail_file.fail())
+  {
+    ErrorHandler::printError(
+        ErrorCode::FILE_WRITE_ERROR,
+        "Cannot write commit graph: " + getCommitGraphTailPath(),
+        ErrorSeverity::ERROR,
+        "update_commit_graph");
+    return false;
+  }
+  return true;
+}
+
+// Reads the tail file into graph, after the commits of the mapped file
+static void loadCommitGraphTail(CommitGraph &graph)
+{
+  std::string records = ErrorHandler::safeReadFile(getCommitGraphTailPath());
+  const unsigned char *data = reinterpret_cast<const unsigned char *>(records.data());
+  std::size_t offset = 0;
+  while (offset + GRAPH_KEY_SIZE + 12 <= records.size())
+  {
+    // A record cut short by an interrupted append ends the tail
+    uint32_t parent_count = readInteger<uint32_t>(data + offset + GRAPH_KEY_SIZE + 8);
+    std::size_t record_size = GRAPH_KEY_SIZE + 12 + static_cast<std::size_t>(parent_count) * GRAPH_KEY_SIZE;
+    if (parent_count > records.size() / GRAPH_KEY_SIZE || offset + record_size > records.size())
+    {
+      break;
+    }
+
+    GraphTailCommit commit;
+    commit.key = records.substr(offset, GRAPH_KEY_SIZE);
+    commit.timestamp = readInteger<int64_t>(data + offset + GRAPH_KEY_SIZE);
+    bool known = findGraphKey(graph, commit.key) >= 0;
+
+    // Parents come earlier in the file or the tail; ones whose logs were
+    // never read are dropped as the file does
+    commit.generation = 1;
+    for (uint32_t i = 0; i < parent_count; i++)
+    {
+      std::size_t parent_offset = offset + GRAPH_KEY_SIZE + 12 + static_cast<std::size_t>(i) * GRAPH_KEY_SIZE;
+      int64_t parent = findGraphKey(graph, records.substr(parent_offset, GRAPH_KEY_SIZE));
+      if (parent >= 0)
+      {
+        commit.parents.push_back(static_cast<uint32_t>(parent));
+        commit.generation = std::max(commit.generation, getGraphGeneration(graph, static_cast<uint32_t>(parent)) + 1);
+      }
+    }
+    offset += record_size;
+
+    if (!known)
+    {
+      graph.tail_keys[commit.key] = graph.count;
+      graph.tail.push_back(std::move(commit));
+      graph.count++;
+    }
+  }
+}
+
+bool loadCommitGraph(CommitGraph &graph)
+{
+  unloadCommitGraph(graph);
+
+  int fd = open(getCommitGraphPath().c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    return false;
+  }
+
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || static_cast<std::size_t>(file_stat.st_size) < GRAPH_HEADER_SIZE + SHA256_DIGEST_LENGTH)
+  {
+    close(fd);
+    return false;
+  }
+
+  std::size_t size = static_cast<std::size_t>(file_stat.st_size);
+  void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED)
+  {
+    return false;
+  }
+
+  graph.data = static_cast<const unsigned char *>(mapping);
+  graph.size = size;
+
+  // Check the header, the table sizes and the trailing checksum before use
+  uint32_t version = readInteger<uint32_t>(graph.data + 4);
+  uint32_t count = readInteger<uint32_t>(graph.data + 8);
+  uint32_t edge_count = readInteger<uint32_t>(graph.data + 12);
+  std::size_t edges_offset = GRAPH_HEADER_SIZE + static_cast<std::size_t>(count) * GRAPH_RECORD_SIZE;
+  std::size_t body_size = size - SHA256_DIGEST_LENGTH;
+
+  unsigned char digest[SHA256_DIGEST_LENGTH];
+  SHA256(graph.data, body_size, digest);
+  if (std::memcmp(graph.data, GRAPH_SIGNATURE, sizeof(GRAPH_SIGNATURE)) != 0 || version != GRAPH_VERSION ||
+      edges_offset + static_cast<std::size_t>(edge_count) * 4 != body_size ||
+      std::memcmp(digest, graph.data + body_size, SHA256_DIGEST_LENGTH) != 0)
+  {
+    ErrorHandler::printError(
+        ErrorCode::REPOSITORY_CORRUPTED,
+        "Commit graph is invalid, ignoring " + getCommitGraphPath(),
+        ErrorSeverity::WARNING,
+        "load_commit_graph");
+    unloadCommitGraph(graph);
+    return false;
+  }
+
+  graph.count = count;
+  graph.file_count = count;
+  graph.edges_offset = edges_offset;
+  loadCommitGraphTail(graph);
+  return true;
+}
+
+int64_t findGraphCommit(
+    const CommitGraph &graph,
+    const std::string &commit_hash)
+{
+  std::string key;
+  if (graph.data == nullptr || !makeGraphKey(commit_hash, key))
+  {
+    return -1;
+  }
+  return findGraphKey(graph, key);
+}
+
+std::string getGraphCommitHash(
+    const CommitGraph &graph,
+    uint32_t position)
+{
+  std::string key = getGraphKey(graph, position);
+  return toHexString(reinterpret_cast<unsigned char *>(&key[0]), static_cast<unsigned char>(key[SHA256_DIGEST_LENGTH]));
+}
+
+uint32_t getGraphGeneration(
+    const CommitGraph &graph,
+    uint32_t position)
+{
+  if (position >= graph.file_count)
+  {
+    return graph.tail[position - graph.file_count].generation;
+  }
+  return readInteger<uint32_t>(getGraphRecord(graph, position) + GRAPH_KEY_SIZE + 8);
+}
+
+int64_t getGraphTimestamp(
+    const CommitGraph &graph,
+    uint32_t position)
+{
+  if (position >= graph.file_count)
+  {
+    return graph.tail[position - graph.file_count].timestamp;
+  }
+  return readInteger<int64_t>(getGraphRecord(graph, position) + GRAPH_KEY_SIZE + 12);
+}
+
+std::vector<uint32_t> getGraphParents(
+    const CommitGraph &graph,
+    uint32_t position)
+{
+  if (position >= graph.file_count)
+  {
+    return graph.tail[position - graph.file_count].parents;
+  }
+
+  std::vector<uint32_t> parents;
+  const unsigned char *record = getGraphRecord(graph, position);
+  uint32_t first_parent = readInteger<uint32_t>(record + GRAPH_KEY_SIZE);
+  uint32_t second_parent = readInteger<uint32_t>(record + GRAPH_KEY_SIZE + 4);
+
+  if (first_parent != GRAPH_NO_PARENT)
+  {
+    parents.push_back(first_parent);
+  }
+
+  if (second_parent == GRAPH_NO_PARENT)
+  {
+    return parents;
+  }
+
+  if (!(second_parent & GRAPH_EXTRA_EDGES))
+  {
+    parents.push_back(second_parent);
+    return parents;
+  }
+
+  // Walk the extra edge list until the entry flagged as last
+  const unsigned char *edge = graph.data + graph.edges_offset + static_cast<std::size_t>(second_parent & ~GRAPH_EXTRA_EDGES) * 4;
+  while (edge < graph.data + graph.size - SHA256_DIGEST_LENGTH)
+  {
+    uint32_t value = readInteger<uint32_t>(edge);
+    parents.push_back(value & ~GRAPH_EXTRA_EDGES);
+    if (value & GRAPH_EXTRA_EDGES)
+    {
+      break;
+    }
+    edge += 4;
+  }
+
+  return parents;
+}
+
+static bool loadGraphWithCommits(
+    CommitGraph &graph,
+    const std::vector<std::string> &commit_hashes,
+    std::vector<uint32_t> &positions)
+{
+  // Add commits the graph does not know yet, then map it
+  bool loaded = loadCommitGraph(graph);
+  for (const auto &commit_hash : commit_hashes)
+  {
+    if (!loaded || findGraphCommit(graph, commit_hash) < 0)
+    {
+      updateCommitGraph(commit_hash);
+      loaded = loadCommitGraph(graph);
+    }
+  }
+
+  positions.clear();
+  for (const auto &commit_hash : commit_hashes)
+  {
+    int64_t position = findGraphCommit(graph, commit_hash);
+    if (position < 0)
+    {
+      return false;
+    }
+    positions.push_back(static_cast<uint32_t>(position));
+  }
+
+  return true;
+}
+
+bool graphIsAncestor(
+    const std::string &ancestor,
+    const std::string &descendant)
+{
+  if (ancestor.empty() || descendant.empty())
+  {
+    return false;
+  }
+  if (ancestor == descendant)
+  {
+    return true;
+  }
+
+  CommitGraph graph;
+  std::vector<uint32_t> positions;
+  if (!loadGraphWithCommits(graph, {ancestor, descendant}, positions))
+  {
+    return false;
+  }
+
+  // Nothing at or below the ancestor's generation can lead back to it
+  uint32_t target = positions[0];
+  uint32_t target_generation = getGraphGeneration(graph, target);
+  std::vector<bool> visited(graph.count, false);
+  std::vector<uint32_t> pending = {positions[1]};
+  while (!pending.empty())
+  {
+    uint32_t position = pending.back();
+    pending.pop_back();
+    if (position == target)
+    {
+      return true;
+    }
+    if (visited[position] || getGraphGeneration(graph, position) <= target_generation)
+    {
+      continue;
+    }
+
+    visited[position] = true;
+    for (uint32_t parent : getGraphParents(graph, position))
+    {
+      pending.push_back(parent);
+    }
+  }
+
+  return false;
+}
+
+std::string graphMergeBase(
+    const std::string &commit1,
+    const std::string &commit2)
+{
+  if (commit1.empty() || commit2.empty())
+  {
+    return "";
+  }
+  if (commit1 == commit2)
+  {
+    return commit1;
+  }
+
+  CommitGraph graph;
+  std::vector<uint32_t> positions;
+  if (!loadGraphWithCommits(graph, {commit1, commit2}, positions))
+  {
+    return "";
+  }
+
+  // Paint ancestors of each side, visiting the highest generation first so a
+  // commit is only examined once all of its descendants have painted it
+  std::vector<uint8_t> paint(graph.count, 0);
+  std::priority_queue<std::tuple<uint32_t, int64_t, uint32_t>> queue;
+  auto enqueue = [&](uint32_t position, uint8_t flags)
+  {
+    paint[position] |= flags;
+    queue.emplace(getGraphGeneration(graph, position), getGraphTimestamp(graph, position), position);
+  };
+  enqueue(positions[0], PAINT_FIRST);
+  enqueue(positions[1], PAINT_SECOND);
+
+  while (!queue.empty())
+  {
+    uint32_t position = std::get<2>(queue.top());
+    queue.pop();
+
+    // The first commit reached from both sides has the highest generation of
+    // all common ancestors, so none of the others can descend from it
+    uint8_t flags = paint[position];
+    if ((flags & (PAINT_FIRST | PAINT_SECOND)) == (PAINT_FIRST | PAINT_SECOND))
+    {
+      return getGraphCommitHash(graph, position);
+    }
+
+    for (uint32_t parent : getGraphParents(graph, position))
+    {
+      if ((paint[parent] & flags) != flags)
+      {
+        enqueue(parent, flags);
+      }
+    }
+  }
+
+  return "";
+}
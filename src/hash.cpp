@@ -50,14 +50,70 @@ std::string generateCommitHash(
 
 std::string hashFile(const std::string &FilePath)
 {
-  // Read the file content
-  std::ifstream file(FilePath, std::ios::binary);
-  std::ostringstream ss;
-  ss << file.rdbuf();
-
-  // Compute the SHA-256 hash of the file content
-  std::string FileContent = ss.str();
-  return sha256Hash(FileContent);
+  const std::size_t chunk_size = 1024 * 1024;
+
+  int fd = open(FilePath.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    return "";
+  }
+
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0)
+  {
+    close(fd);
+    return "";
+  }
+
+  EVP_MD_CTX *digest = EVP_MD_CTX_new();
+  EVP_DigestInit_ex(digest, EVP_sha256(), nullptr);
+
+  // Read fixed-size chunks into one buffer so resident memory stays constant no
+  // matter how large the file is, and a file truncated mid-hash ends the read
+  // instead of faulting the way a mapped window would
+  bool seekable = S_ISREG(file_stat.st_mode);
+  if (seekable)
+  {
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+  }
+
+  std::vector<unsigned char> buffer(chunk_size);
+  off_t offset = 0;
+  ssize_t bytes_read;
+  while (true)
+  {
+    bytes_read = seekable ? pread(fd, buffer.data(), buffer.size(), offset) : read(fd, buffer.data(), buffer.size());
+    if (bytes_read < 0 && errno == EINTR)
+    {
+      continue;
+    }
+    if (bytes_read <= 0)
+    {
+      break;
+    }
+    EVP_DigestUpdate(digest, buffer.data(), static_cast<std::size_t>(bytes_read));
+    offset += bytes_read;
+  }
+  bool succeeded = bytes_read == 0;
+  close(fd);
+
+  unsigned char hash[EVP_MAX_MD_SIZE];
+  unsigned int hash_length = 0;
+  EVP_DigestFinal_ex(digest, hash, &hash_length);
+  EVP_MD_CTX_free(digest);
+
+  return succeeded ? toHexString(hash, hash_length) : "";
+}
+
+std::vector<std::string> hashFilesParallel(const std::vector<std::string> &file_paths)
+{
+  // Hash the batch on the worker pool, results line up with the input paths
+  std::vector<std::string> hashes(file_paths.size());
+  parallelForEach(
+      file_paths.size(),
+      [&](std::size_t i)
+      { hashes[i] = hashFile(file_paths[i]); });
+  return hashes;
 }
 
 std::string sha256Hash(const std::string &input)
@@ -67,3 +123,56 @@ std::string sha256Hash(const std::string &input)
 
   return toHexString(hash, SHA256_DIGEST_LENGTH);
 }
+
+std::string gitBlobHash(const std::string &content)
+{
+  // Git and GitHub name a blob by the SHA-1 of a "blob <size>" header and its content
+  std::string header = "blob " + std::to_string(content.size());
+  EVP_MD_CTX *digest = EVP_MD_CTX_new();
+  EVP_DigestInit_ex(digest, EVP_sha1(), nullptr);
+  EVP_DigestUpdate(digest, header.c_str(), header.size() + 1);
+  EVP_DigestUpdate(digest, content.data(), content.size());
+
+  unsigned char hash[EVP_MAX_MD_SIZE];
+  unsigned int hash_length = 0;
+  EVP_DigestFinal_ex(digest, hash, &hash_length);
+  EVP_MD_CTX_free(digest);
+
+  return toHexString(hash, hash_length);
+}
+
+std::string gitBlobHashFile(const std::string &file_path)
+{
+  const std::size_t chunk_size = 1024 * 1024;
+
+  std::ifstream file(file_path, std::ios::binary);
+  std::error_code error;
+  uintmax_t file_size = std::filesystem::file_size(file_path, error);
+  if (!file.is_open() || error)
+  {
+    return "";
+  }
+
+  // Same digest as gitBlobHash, read in chunks so large files are never held in memory
+  std::string header = "blob " + std::to_string(file_size);
+  EVP_MD_CTX *digest = EVP_MD_CTX_new();
+  EVP_DigestInit_ex(digest, EVP_sha1(), nullptr);
+  EVP_DigestUpdate(digest, header.c_str(), header.size() + 1);
+
+  std::vector<char> buffer(chunk_size);
+  uintmax_t total = 0;
+  while (file)
+  {
+    file.read(buffer.data(), buffer.size());
+    EVP_DigestUpdate(digest, buffer.data(), static_cast<std::size_t>(file.gcount()));
+    total += static_cast<uintmax_t>(file.gcount());
+  }
+
+  unsigned char hash[EVP_MAX_MD_SIZE];
+  unsigned int hash_length = 0;
+  EVP_DigestFinal_ex(digest, hash, &hash_length);
+  EVP_MD_CTX_free(digest);
+
+  // A file that changed size while being read has no consistent hash
+  return !file.bad() && total == file_size ? toHexString(hash, hash_length) : "";
+}
@@ -0,0 +1,318 @@
+#include "../include/http.hpp"
+
+// One transport per process: connections stay open between requests, and
+// DNS answers and TLS sessions are reused by every new connection
+struct HttpTransport
+{
+  std::mutex mutex; // the curl handles are used by one thread at a time
+  CURLM *multi;     // runs the transfers and owns the connection pool
+  CURLSH *share;    // DNS and TLS session cache shared by all transfers
+
+  HttpTransport() : multi(nullptr), share(nullptr)
+  {
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    multi = curl_multi_init();
+    share = curl_share_init();
+    if (share != nullptr)
+    {
+      curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+      curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    }
+    if (multi != nullptr)
+    {
+      // Several transfers to one host share a connection over HTTP/2
+      long concurrency = static_cast<long>(getHttpConcurrency());
+      curl_multi_setopt(multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+      curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, concurrency);
+      curl_multi_setopt(multi, CURLMOPT_MAXCONNECTS, concurrency);
+    }
+  }
+
+  ~HttpTransport()
+  {
+    if (multi != nullptr)
+    {
+      curl_multi_cleanup(multi);
+    }
+    if (share != nullptr)
+    {
+      curl_share_cleanup(share);
+    }
+  }
+
+  HttpTransport(const HttpTransport &) = delete;
+  HttpTransport &operator=(const HttpTransport &) = delete;
+};
+
+static HttpTransport &getHttpTransport()
+{
+  static HttpTransport transport;
+  return transport;
+}
+
+static unsigned int readHttpConcurrency()
+{
+  const unsigned int default_concurrency = 8;
+  std::string value = configGet("http.concurrency");
+  if (value.empty())
+  {
+    return default_concurrency;
+  }
+
+  try
+  {
+    int parsed = std::stoi(value);
+    if (parsed >= 1 && parsed <= 64)
+    {
+      return static_cast<unsigned int>(parsed);
+    }
+  }
+  catch (const std::exception &)
+  {
+  }
+
+  ErrorHandler::printError(
+      ErrorCode::CONFIG_ERROR,
+      "Invalid http.concurrency '" + value + "', expected 1-64; using default",
+      ErrorSeverity::WARNING,
+      "get_http_concurrency");
+  return default_concurrency;
+}
+
+// http.concurrency as last read, 0 until it is read
+static std::atomic<unsigned int> http_concurrency{0};
+
+unsigned int getHttpConcurrency()
+{
+  // Read http.concurrency once
+  unsigned int value = http_concurrency.load();
+  if (value == 0)
+  {
+    value = readHttpConcurrency();
+    http_concurrency = value;
+  }
+  return value;
+}
+
+void resetHttpConcurrency()
+{
+  http_concurrency = 0;
+}
+
+static size_t readBodyCallback(
+    char *buffer,
+    size_t size,
+    size_t nitems,
+    void *userdata)
+{
+  const HttpBodySource &source = *static_cast<const HttpBodySource *>(userdata);
+  std::size_t written = 0;
+  if (!source(buffer, size * nitems, written))
+  {
+    return CURL_READFUNC_ABORT;
+  }
+  return written;
+}
+
+static int seekBodyCallback(
+    void *userdata,
+    curl_off_t offset,
+    int origin)
+{
+  // Curl only seeks to resend the body from the start
+  const HttpBodyRewind &rewind = *static_cast<const HttpBodyRewind *>(userdata);
+  if (origin != SEEK_SET || offset != 0 || !rewind)
+  {
+    return CURL_SEEKFUNC_CANTSEEK;
+  }
+  return rewind() ? CURL_SEEKFUNC_OK : CURL_SEEKFUNC_FAIL;
+}
+
+static size_t writeBodyCallback(
+    char *data,
+    size_t size,
+    size_t nmemb,
+    void *userdata)
+{
+  const HttpBodySink &sink = *static_cast<const HttpBodySink *>(userdata);
+  if (!sink(data, size * nmemb))
+  {
+    return 0; // fewer bytes than offered makes curl fail the transfer
+  }
+  return size * nmemb;
+}
+
+static CURL *createTransfer(
+    const HttpRequest &request,
+    HttpResponse &response,
+    curl_slist *&headers,
+    CURLSH *share)
+{
+  CURL *curl = curl_easy_init();
+  if (curl == nullptr)
+  {
+    return nullptr;
+  }
+
+  for (const auto &header : request.headers)
+  {
+    headers = curl_slist_append(headers, header.c_str());
+  }
+
+  curl_easy_setopt(curl, CURLOPT_URL, request.url.c_str());
+  curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+  if (request.body_sink)
+  {
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeBodyCallback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, const_cast<HttpBodySink *>(&request.body_sink));
+  }
+  else
+  {
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response.body);
+  }
+  curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+
+  // Renamed repositories answer with a redirect; the body is resent to the
+  // new location, rewound through the seek callback when it is streamed
+  curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+  curl_easy_setopt(curl, CURLOPT_POSTREDIR, static_cast<long>(CURL_REDIR_POST_ALL));
+  curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+  curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "");
+  curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, static_cast<long>(CURL_HTTP_VERSION_2TLS));
+
+  // Wait for a connection that can multiplex rather than opening another one
+  curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);
+  if (share != nullptr)
+  {
+    curl_easy_setopt(curl, CURLOPT_SHARE, share);
+  }
+
+  if (request.body_source)
+  {
+    // A body of unknown length goes out chunked
+    curl_easy_setopt(curl, CURLOPT_POST, 1L);
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(request.body_size));
+    curl_easy_setopt(curl, CURLOPT_READFUNCTION, readBodyCallback);
+    curl_easy_setopt(curl, CURLOPT_READDATA, const_cast<HttpBodySource *>(&request.body_source));
+    curl_easy_setopt(curl, CURLOPT_SEEKFUNCTION, seekBodyCallback);
+    curl_easy_setopt(curl, CURLOPT_SEEKDATA, const_cast<HttpBodyRewind *>(&request.body_rewind));
+    if (request.method != "POST")
+    {
+      curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, request.method.c_str());
+    }
+  }
+  else if (request.method == "POST")
+  {
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(request.body.size()));
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, request.body.c_str());
+  }
+  else if (request.method != "GET")
+  {
+    curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, request.method.c_str());
+    if (!request.body.empty())
+    {
+      curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(request.body.size()));
+      curl_easy_setopt(curl, CURLOPT_POSTFIELDS, request.body.c_str());
+    }
+  }
+
+  return curl;
+}
+
+HttpResponse httpPerform(const HttpRequest &request)
+{
+  return httpPerformAll({request}).front();
+}
+
+std::vector<HttpResponse> httpPerformAll(const std::vector<HttpRequest> &requests)
+{
+  std::vector<HttpResponse> responses(requests.size());
+  std::vector<curl_slist *> headers(requests.size(), nullptr);
+  std::vector<CURL *> transfers(requests.size(), nullptr);
+  if (requests.empty())
+  {
+    return responses;
+  }
+
+  HttpTransport &transport = getHttpTransport();
+  std::lock_guard<std::mutex> lock(transport.mutex);
+  if (transport.multi == nullptr)
+  {
+    return responses;
+  }
+
+  // Keep at most http.concurrency transfers in flight, starting the next
+  // request as soon as one finishes; responses keep the order of requests
+  const std::size_t limit = getHttpConcurrency();
+  std::size_t next = 0;
+  std::size_t active = 0;
+  while (next < requests.size() || active > 0)
+  {
+    while (active < limit && next < requests.size())
+    {
+      std::size_t index = next++;
+      CURL *curl = createTransfer(requests[index], responses[index], headers[index], transport.share);
+      if (curl == nullptr)
+      {
+        continue;
+      }
+      curl_easy_setopt(curl, CURLOPT_PRIVATE, reinterpret_cast<void *>(static_cast<uintptr_t>(index)));
+      if (curl_multi_add_handle(transport.multi, curl) != CURLM_OK)
+      {
+        curl_easy_cleanup(curl);
+        continue;
+      }
+      transfers[index] = curl;
+      active++;
+    }
+
+    int running = 0;
+    if (curl_multi_perform(transport.multi, &running) != CURLM_OK)
+    {
+      break;
+    }
+
+    int queued = 0;
+    while (CURLMsg *message = curl_multi_info_read(transport.multi, &queued))
+    {
+      if (message->msg != CURLMSG_DONE)
+      {
+        continue;
+      }
+
+      CURL *curl = message->easy_handle;
+      void *index_pointer = nullptr;
+      curl_easy_getinfo(curl, CURLINFO_PRIVATE, &index_pointer);
+      std::size_t index = static_cast<std::size_t>(reinterpret_cast<uintptr_t>(index_pointer));
+      responses[index].result = message->data.result;
+      curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &responses[index].status);
+
+      curl_multi_remove_handle(transport.multi, curl);
+      curl_easy_cleanup(curl);
+      transfers[index] = nullptr;
+      active--;
+    }
+
+    if (active > 0 && running > 0)
+    {
+      curl_multi_poll(transport.multi, nullptr, 0, 1000, nullptr);
+    }
+  }
+
+  // A failed multi handle leaves transfers attached; detach them before returning
+  for (CURL *curl : transfers)
+  {
+    if (curl != nullptr)
+    {
+      curl_multi_remove_handle(transport.multi, curl);
+      curl_easy_cleanup(curl);
+    }
+  }
+
+  for (curl_slist *header_list : headers)
+  {
+    curl_slist_free_all(header_list);
+  }
+  return responses;
+}
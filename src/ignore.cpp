@@ -1,77 +1,128 @@
 #include "../include/ignore.hpp"
 
-std::string IgnorePattern::convertGitPatternToRegex(const std::string &git_pattern)
+static std::string toLowerCase(const std::string &text)
 {
-  std::string regex_pattern;
+  std::string lowered = text;
+  std::transform(lowered.begin(), lowered.end(), lowered.begin(), [](unsigned char c)
+                 { return static_cast<char>(std::tolower(c)); });
+  return lowered;
+}
+
+void IgnorePattern::compile()
+{
+  // Patterns match case-insensitively, so compare lower-cased text
+  body = toLowerCase(pattern);
 
-  for (size_t i = 0; i < git_pattern.length(); ++i)
+  // A leading / anchors the pattern at the repository root
+  is_anchored = !body.empty() && body[0] == '/';
+  if (is_anchored)
+  {
+    body = body.substr(1);
+  }
+  else
   {
-    char c = git_pattern[i];
+    // An unanchored pattern may start anywhere in the path, which already
+    // covers any leading * or ** wildcards
+    body = body.substr(std::min(body.find_first_not_of('*'), body.length()));
+  }
 
-    switch (c)
+  kind = body.find_first_of("*?") == std::string::npos ? IgnoreMatchKind::LITERAL : IgnoreMatchKind::GLOB;
+}
+
+static bool matchesLiteral(
+    const std::string &path,
+    const IgnorePattern &pattern)
+{
+  // The pattern must end at the end of the path or at a directory boundary,
+  // unless it ends with a separator itself
+  const std::string &literal = pattern.body;
+  bool open_ended = !literal.empty() && literal.back() == '/';
+  if (pattern.is_anchored)
+  {
+    return path.compare(0, literal.length(), literal) == 0 &&
+           (open_ended || path.length() == literal.length() || path[literal.length()] == '/');
+  }
+
+  if (open_ended)
+  {
+    return path.find(literal) != std::string::npos;
+  }
+
+  if (path.length() >= literal.length() &&
+      path.compare(path.length() - literal.length(), literal.length(), literal) == 0)
+  {
+    return true;
+  }
+  return path.find(literal + "/") != std::string::npos;
+}
+
+static bool matchesGlob(
+    const std::string &path,
+    const IgnorePattern &pattern)
+{
+  // reachable[i] is true when the pattern consumed so far can end at path[i];
+  // * and ? stay within one path component while ** crosses directories
+  const std::string &glob = pattern.body;
+  std::size_t length = path.length();
+  std::vector<char> reachable(length + 1, pattern.is_anchored ? 0 : 1);
+  reachable[0] = 1;
+
+  std::vector<char> next(length + 1);
+  for (std::size_t g = 0; g < glob.length(); g++)
+  {
+    char token = glob[g];
+    bool any_depth = token == '*' && g + 1 < glob.length() && glob[g + 1] == '*';
+    if (any_depth)
     {
-    case '*':
-      if (i + 1 < git_pattern.length() && git_pattern[i + 1] == '*')
+      g++;
+    }
+
+    std::fill(next.begin(), next.end(), 0);
+    for (std::size_t i = 0; i <= length; i++)
+    {
+      if (token == '*')
       {
-        // ** matches any number of directories
-        regex_pattern += ".*";
-        ++i; // Skip the second *
+        next[i] = reachable[i] || (i > 0 && next[i - 1] && (any_depth || path[i - 1] != '/'));
       }
-      else
+      else if (i < length && reachable[i] && (token == '?' ? path[i] != '/' : path[i] == token))
       {
-        // * matches any characters except /
-        regex_pattern += "[^/]*";
+        next[i + 1] = 1;
       }
-      break;
-    case '?':
-      // ? matches any single character except /
-      regex_pattern += "[^/]";
-      break;
-    case '.':
-    case '+':
-    case '(':
-    case ')':
-    case '[':
-    case ']':
-    case '{':
-    case '}':
-    case '^':
-    case '$':
-    case '|':
-    case '\\':
-      regex_pattern += '\\';
-      regex_pattern += c;
-      break;
-    case '/': // / is literal in Git patterns
-      regex_pattern += '/';
-      break;
-    default:
-      regex_pattern += c;
-      break;
     }
-  }
 
-  // If pattern doesn't start with /, it can match anywhere in the path
-  if (git_pattern[0] != '/')
-  {
-    regex_pattern = ".*" + regex_pattern;
-  }
-  else
-  {
-    regex_pattern = "^" + regex_pattern;
+    // "**/" may also match no directories at all, so a/**/b matches a/b
+    if (any_depth && g + 1 < glob.length() && glob[g + 1] == '/')
+    {
+      g++;
+      for (std::size_t i = length; i > 0; i--)
+      {
+        next[i] = reachable[i] || (next[i - 1] && path[i - 1] == '/');
+      }
+      next[0] = reachable[0];
+    }
+    reachable.swap(next);
   }
 
-  // If pattern doesn't end with /, it can match files or directories
-  if (git_pattern.back() != '/')
+  bool open_ended = !glob.empty() && glob.back() == '/';
+  for (std::size_t i = 0; i <= length; i++)
   {
-    regex_pattern += "(/.*)?$";
+    if (reachable[i] && (open_ended || i == length || path[i] == '/'))
+    {
+      return true;
+    }
   }
-  else
+  return false;
+}
+
+static bool matchesLoweredPath(
+    const std::string &lowered_path,
+    const IgnorePattern &pattern)
+{
+  if (pattern.kind == IgnoreMatchKind::LITERAL)
   {
-    regex_pattern += ".*$";
+    return matchesLiteral(lowered_path, pattern);
   }
-
-  return regex_pattern;
+  return matchesGlob(lowered_path, pattern);
 }
 
 std::string normalizePath(const std::string &path)
@@ -114,28 +165,7 @@ bool matchesPattern(
     const std::string &filePath,
     const IgnorePattern &pattern)
 {
-  std::string normalized_path = normalizePath(filePath);
-
-  // for directory patterns, check if the path is within the directory
-  if (pattern.is_directory)
-  {
-    if (normalized_path.find(pattern.pattern + "/") == 0 ||
-        normalized_path == pattern.pattern)
-    {
-      return true;
-    }
-  }
-
-  // use regex matching
-  try
-  {
-    return std::regex_match(normalized_path, pattern.regex_pattern);
-  }
-  catch (const std::regex_error &)
-  {
-    // fallback to simple string matching
-    return normalized_path.find(pattern.pattern) != std::string::npos;
-  }
+  return matchesLoweredPath(toLowerCase(normalizePath(filePath)), pattern);
 }
 
 std::vector<std::string> readBitignore(const std::string &filePath)
@@ -201,13 +231,19 @@ bool isFileIgnoredByIgnorePatterns(
     return false;
   }
 
-  std::string normalized_path = normalizePath(filePath);
+  // normalize the path once for all patterns
+  std::string lowered_path = toLowerCase(normalizePath(filePath));
   bool ignored = false;
 
   // process patterns in order (later patterns can override earlier ones)
   for (const auto &pattern : patterns)
   {
-    if (matchesPattern(normalized_path, pattern))
+    if (pattern.pattern.empty())
+    {
+      continue;
+    }
+
+    if (matchesLoweredPath(lowered_path, pattern))
     {
       if (pattern.is_negation)
       {
@@ -257,38 +293,97 @@ bool isFileIgnoredByPatterns(
   }
 }
 
-bool shouldIgnoreFile(const std::string &file_path)
+// .bitignore rules compiled once per process for the working directory
+static std::mutex ignore_cache_mutex;
+static std::string ignore_cache_directory;
+static std::shared_ptr<const std::vector<IgnorePattern>> ignore_cache_patterns;
+
+std::shared_ptr<const std::vector<IgnorePattern>> getIgnorePatterns()
 {
-  std::string normalized = normalizePath(file_path);
-  if (normalized == ".bittrack" || normalized.find(".bittrack/") == 0 ||  normalized == "bittrack" || normalized == "./bittrack")
+  std::string current_dir = std::filesystem::current_path().string();
+  std::lock_guard<std::mutex> lock(ignore_cache_mutex);
+  if (ignore_cache_patterns && ignore_cache_directory == current_dir)
   {
-    return true;
+    return ignore_cache_patterns;
   }
 
-  std::string current_dir = std::filesystem::current_path().string();
-  std::string bitignore_path = current_dir + "/.bitignore";
-
-  while (current_dir != std::filesystem::path(current_dir).parent_path().string())
+  // use the nearest .bitignore in the working directory or its parents
+  std::string search_dir = current_dir;
+  std::string bitignore_path = search_dir + "/.bitignore";
+  while (search_dir != std::filesystem::path(search_dir).parent_path().string())
   {
-    bitignore_path = current_dir + "/.bitignore";
+    bitignore_path = search_dir + "/.bitignore";
     if (std::filesystem::exists(bitignore_path))
     {
       break;
     }
-    current_dir = std::filesystem::path(current_dir).parent_path().string();
+    search_dir = std::filesystem::path(search_dir).parent_path().string();
   }
 
-  if (!std::filesystem::exists(bitignore_path))
+  std::vector<IgnorePattern> patterns;
+  if (std::filesystem::exists(bitignore_path))
   {
-    return false;
+    patterns = parseIgnorePatterns(readBitignore(bitignore_path));
   }
 
-  std::vector<std::string> raw_patterns = readBitignore(bitignore_path);
-  std::vector<IgnorePattern> patterns = parseIgnorePatterns(raw_patterns);
+  ignore_cache_directory = current_dir;
+  ignore_cache_patterns = std::make_shared<const std::vector<IgnorePattern>>(std::move(patterns));
+  return ignore_cache_patterns;
+}
+
+void resetIgnorePatterns()
+{
+  std::lock_guard<std::mutex> lock(ignore_cache_mutex);
+  ignore_cache_patterns.reset();
+}
+
+bool shouldIgnoreFile(const std::string &file_path)
+{
+  return shouldIgnoreFile(file_path, *getIgnorePatterns());
+}
+
+bool shouldIgnoreFile(
+    const std::string &file_path,
+    const std::vector<IgnorePattern> &patterns)
+{
+  std::string normalized = normalizePath(file_path);
+  if (normalized == ".bittrack" || normalized.find(".bittrack/") == 0 ||  normalized == "bittrack" || normalized == "./bittrack")
+  {
+    return true;
+  }
 
   return isFileIgnoredByIgnorePatterns(file_path, patterns);
 }
 
+bool shouldIgnoreDirectory(const std::string &dir_path)
+{
+  return shouldIgnoreDirectory(dir_path, *getIgnorePatterns());
+}
+
+bool shouldIgnoreDirectory(
+    const std::string &dir_path,
+    const std::vector<IgnorePattern> &patterns)
+{
+  std::string normalized = normalizePath(dir_path);
+  std::string name = std::filesystem::path(normalized).filename().string();
+  if (name == ".bittrack")
+  {
+    return true;
+  }
+
+  // a later negation may re-include files below an ignored directory, so
+  // whole subtrees are only pruned when no negation rule exists
+  for (const auto &pattern : patterns)
+  {
+    if (pattern.is_negation)
+    {
+      return false;
+    }
+  }
+
+  return isFileIgnoredByIgnorePatterns(normalized, patterns);
+}
+
 void createDefaultBitignore()
 {
   std::string content = "# BitTrack ignore file\n"
@@ -315,6 +410,8 @@ void createDefaultBitignore()
 
   if (ErrorHandler::safeWriteFile(".bitignore", content))
   {
+    // the cached rules no longer reflect the new file
+    resetIgnorePatterns();
     std::cout << "Created default .bitignore file." << std::endl;
   }
 }
\ No newline at end of file
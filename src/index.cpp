@@ -0,0 +1,412 @@
+#include "../include/index.hpp"
+
+// Binary index layout (all integers little-endian):
+//   "BTIX" | version u32 | entry count u32
+//   per entry: path length u32 | path | flags u8 | [32 byte hash] |
+//              mtime ns i64 | size u64 | inode u64 | mode u32
+//   trailing SHA-256 of everything before it
+static const char INDEX_SIGNATURE[4] = {'B', 'T', 'I', 'X'};
+static const uint32_t INDEX_VERSION = 1;
+static const uint8_t INDEX_FLAG_STAGED = 1;
+static const uint8_t INDEX_FLAG_HAS_HASH = 2;
+
+// Entries modified this close to the index write may still change within the
+// filesystem's timestamp granularity, so their stat data is not trusted
+static const int64_t RACY_WINDOW_NS = 1000000000;
+
+template <typename T>
+static void appendInteger(std::string &buffer, T value)
+{
+  for (std::size_t i = 0; i < sizeof(T); i++)
+  {
+    buffer.push_back(static_cast<char>((static_cast<uint64_t>(value) >> (8 * i)) & 0xff));
+  }
+}
+
+template <typename T>
+static bool readInteger(const std::string &buffer, std::size_t &offset, T &value)
+{
+  if (offset + sizeof(T) > buffer.size())
+  {
+    return false;
+  }
+
+  uint64_t result = 0;
+  for (std::size_t i = 0; i < sizeof(T); i++)
+  {
+    result |= static_cast<uint64_t>(static_cast<unsigned char>(buffer[offset + i])) << (8 * i);
+  }
+  value = static_cast<T>(result);
+  offset += sizeof(T);
+  return true;
+}
+
+static std::string digestBytes(const std::string &data)
+{
+  unsigned char digest[SHA256_DIGEST_LENGTH];
+  SHA256(reinterpret_cast<const unsigned char *>(data.data()), data.size(), digest);
+  return std::string(reinterpret_cast<char *>(digest), SHA256_DIGEST_LENGTH);
+}
+
+static std::string hexToBytes(const std::string &hex)
+{
+  std::string bytes;
+  for (std::size_t i = 0; i + 1 < hex.size(); i += 2)
+  {
+    bytes.push_back(static_cast<char>(std::stoi(hex.substr(i, 2), nullptr, 16)));
+  }
+  return bytes;
+}
+
+static int64_t currentTimeNs()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+static std::map<std::string, IndexEntry> loadLegacyIndex(const std::string &content)
+{
+  // Older repositories store the staging area as "<path> <hash>" lines
+  std::map<std::string, IndexEntry> index;
+  std::istringstream index_stream(content);
+  std::string line;
+  while (std::getline(index_stream, line))
+  {
+    size_t last_space_pos = line.find_last_of(' ');
+    if (line.empty() || last_space_pos == std::string::npos)
+    {
+      continue;
+    }
+
+    // Deletions were written as "<path> (deleted) " with an empty hash
+    std::string file_path = line.substr(0, last_space_pos);
+    const std::string deleted_suffix = " (deleted)";
+    if (file_path.size() > deleted_suffix.size() &&
+        file_path.compare(file_path.size() - deleted_suffix.size(), deleted_suffix.size(), deleted_suffix) == 0)
+    {
+      file_path = file_path.substr(0, file_path.size() - deleted_suffix.size());
+    }
+
+    IndexEntry entry;
+    entry.hash = line.substr(last_space_pos + 1);
+    entry.staged = true;
+    index[file_path] = entry;
+  }
+
+  return index;
+}
+
+std::string getIndexPath()
+{
+  return ".bittrack/index";
+}
+
+std::map<std::string, IndexEntry> loadIndex()
+{
+  std::map<std::string, IndexEntry> index;
+  if (!std::filesystem::exists(getIndexPath()))
+  {
+    return index;
+  }
+
+  std::ifstream index_file(getIndexPath(), std::ios::binary);
+  std::string content((std::istreambuf_iterator<char>(index_file)), std::istreambuf_iterator<char>());
+  if (content.empty())
+  {
+    return index;
+  }
+
+  if (content.compare(0, sizeof(INDEX_SIGNATURE), INDEX_SIGNATURE, sizeof(INDEX_SIGNATURE)) != 0)
+  {
+    return loadLegacyIndex(content);
+  }
+
+  // Verify the trailing checksum before trusting any entry
+  std::size_t body_size = content.size() >= SHA256_DIGEST_LENGTH ? content.size() - SHA256_DIGEST_LENGTH : 0;
+  std::string body = content.substr(0, body_size);
+  if (body_size == 0 || digestBytes(body) != content.substr(body_size))
+  {
+    ErrorHandler::printError(
+        ErrorCode::REPOSITORY_CORRUPTED,
+        "Index checksum mismatch, ignoring " + getIndexPath(),
+        ErrorSeverity::ERROR,
+        "load_index");
+    return index;
+  }
+
+  std::size_t offset = sizeof(INDEX_SIGNATURE);
+  uint32_t version = 0;
+  uint32_t entry_count = 0;
+  if (!readInteger(body, offset, version) || version != INDEX_VERSION || !readInteger(body, offset, entry_count))
+  {
+    ErrorHandler::printError(
+        ErrorCode::REPOSITORY_CORRUPTED,
+        "Unsupported index version in " + getIndexPath(),
+        ErrorSeverity::ERROR,
+        "load_index");
+    return index;
+  }
+
+  for (uint32_t i = 0; i < entry_count; i++)
+  {
+    uint32_t path_length = 0;
+    uint8_t flags = 0;
+    IndexEntry entry;
+    if (!readInteger(body, offset, path_length) || offset + path_length > body.size())
+    {
+      break;
+    }
+    std::string file_path = body.substr(offset, path_length);
+    offset += path_length;
+
+    if (!readInteger(body, offset, flags))
+    {
+      break;
+    }
+    if (flags & INDEX_FLAG_HAS_HASH)
+    {
+      if (offset + SHA256_DIGEST_LENGTH > body.size())
+      {
+        break;
+      }
+      entry.hash = toHexString(reinterpret_cast<unsigned char *>(&body[offset]), SHA256_DIGEST_LENGTH);
+      offset += SHA256_DIGEST_LENGTH;
+    }
+    entry.staged = (flags & INDEX_FLAG_STAGED) != 0;
+
+    if (!readInteger(body, offset, entry.mtime_ns) ||
+        !readInteger(body, offset, entry.size) ||
+        !readInteger(body, offset, entry.inode) ||
+        !readInteger(body, offset, entry.mode))
+    {
+      break;
+    }
+    index[file_path] = entry;
+  }
+
+  return index;
+}
+
+bool saveIndex(const std::map<std::string, IndexEntry> &index)
+{
+  int64_t now_ns = currentTimeNs();
+
+  std::string buffer(INDEX_SIGNATURE, sizeof(INDEX_SIGNATURE));
+  appendInteger(buffer, INDEX_VERSION);
+  appendInteger(buffer, static_cast<uint32_t>(index.size()));
+
+  for (const auto &[file_path, entry] : index)
+  {
+    bool has_hash = entry.hash.length() == SHA256_DIGEST_LENGTH * 2;
+    uint8_t flags = (entry.staged ? INDEX_FLAG_STAGED : 0) | (has_hash ? INDEX_FLAG_HAS_HASH : 0);
+
+    appendInteger(buffer, static_cast<uint32_t>(file_path.size()));
+    buffer += file_path;
+    appendInteger(buffer, flags);
+    if (has_hash)
+    {
+      buffer += hexToBytes(entry.hash);
+    }
+
+    // Drop the mtime of racily clean entries so the next status re-hashes them
+    int64_t mtime_ns = entry.mtime_ns >= now_ns - RACY_WINDOW_NS ? 0 : entry.mtime_ns;
+    appendInteger(buffer, mtime_ns);
+    appendInteger(buffer, entry.size);
+    appendInteger(buffer, entry.inode);
+    appendInteger(buffer, entry.mode);
+  }
+  buffer += digestBytes(buffer);
+
+  // Replace the index atomically so readers never see a partial file
+  std::string temp_index_path = getIndexPath() + ".tmp";
+  std::ofstream temp_file(temp_index_path, std::ios::binary | std::ios::trunc);
+  temp_file.write(buffer.data(), buffer.size());
+  temp_file.close();
+  if (temp_file.fail() || !ErrorHandler::safeRename(temp_index_path, getIndexPath()))
+  {
+    ErrorHandler::safeRemoveFile(temp_index_path);
+    ErrorHandler::printError(
+        ErrorCode::FILE_WRITE_ERROR,
+        "Cannot write index file: " + getIndexPath(),
+        ErrorSeverity::ERROR,
+        "save_index");
+    return false;
+  }
+
+  return true;
+}
+
+std::string getIndexDigest()
+{
+  // The index ends with a digest of its content, so comparing the trailing
+  // bytes detects any rewrite without parsing the entries
+  std::ifstream index_file(getIndexPath(), std::ios::binary | std::ios::ate);
+  if (!index_file.is_open() || index_file.tellg() < static_cast<std::streamoff>(SHA256_DIGEST_LENGTH))
+  {
+    return "";
+  }
+
+  unsigned char digest[SHA256_DIGEST_LENGTH];
+  index_file.seekg(-static_cast<std::streamoff>(SHA256_DIGEST_LENGTH), std::ios::end);
+  index_file.read(reinterpret_cast<char *>(digest), SHA256_DIGEST_LENGTH);
+  if (!index_file)
+  {
+    return "";
+  }
+  return toHexString(digest, SHA256_DIGEST_LENGTH);
+}
+
+bool readFileStat(
+    const std::string &file_path,
+    IndexEntry &entry)
+{
+  struct stat file_stat;
+  if (stat(file_path.c_str(), &file_stat) != 0)
+  {
+    return false;
+  }
+
+  setFileStat(file_stat, entry);
+  return true;
+}
+
+void setFileStat(
+    const struct stat &file_stat,
+    IndexEntry &entry)
+{
+#ifdef __APPLE__
+  entry.mtime_ns = static_cast<int64_t>(file_stat.st_mtimespec.tv_sec) * 1000000000 + file_stat.st_mtimespec.tv_nsec;
+#else
+  entry.mtime_ns = static_cast<int64_t>(file_stat.st_mtim.tv_sec) * 1000000000 + file_stat.st_mtim.tv_nsec;
+#endif
+  entry.size = static_cast<uint64_t>(file_stat.st_size);
+  entry.inode = static_cast<uint64_t>(file_stat.st_ino);
+  entry.mode = static_cast<uint32_t>(file_stat.st_mode);
+}
+
+bool isStatUnchanged(
+    const IndexEntry &cached,
+    const IndexEntry &current)
+{
+  // A zero mtime marks an entry whose stat data must not be trusted
+  return cached.mtime_ns != 0 &&
+         cached.mtime_ns == current.mtime_ns &&
+         cached.size == current.size &&
+         cached.inode == current.inode &&
+         cached.mode == current.mode;
+}
+
+std::string getCachedFileHash(
+    const std::string &file_path,
+    std::map<std::string, IndexEntry> &index,
+    bool &index_changed)
+{
+  return getCachedFileHashes({file_path}, index, index_changed)[file_path];
+}
+
+std::map<std::string, std::string> getCachedFileHashes(
+    const std::vector<std::string> &file_paths,
+    std::map<std::string, IndexEntry> &index,
+    bool &index_changed)
+{
+  std::map<std::string, std::string> hashes;
+  std::vector<std::string> present_paths;
+  std::vector<IndexEntry> present_stats;
+
+  // Files that cannot be stat'ed have no hash
+  for (const auto &file_path : file_paths)
+  {
+    IndexEntry current;
+    if (!readFileStat(file_path, current))
+    {
+      hashes[file_path] = "";
+      continue;
+    }
+
+    present_paths.push_back(file_path);
+    present_stats.push_back(current);
+  }
+
+  hashes.merge(getCachedFileHashes(present_paths, present_stats, index, index_changed));
+  return hashes;
+}
+
+std::map<std::string, std::string> getCachedFileHashes(
+    const std::vector<std::string> &file_paths,
+    const std::vector<IndexEntry> &file_stats,
+    std::map<std::string, IndexEntry> &index,
+    bool &index_changed)
+{
+  std::map<std::string, std::string> hashes;
+  std::vector<std::string> stale_paths;
+  std::vector<IndexEntry> stale_stats;
+
+  // Reuse the recorded hash while the file's stat data is unchanged
+  for (std::size_t i = 0; i < file_paths.size(); i++)
+  {
+    const std::string &file_path = file_paths[i];
+    const IndexEntry &current = file_stats[i];
+
+    auto cached = index.find(file_path);
+    if (cached != index.end() && !cached->second.hash.empty() && isStatUnchanged(cached->second, current))
+    {
+      hashes[file_path] = cached->second.hash;
+      continue;
+    }
+
+    stale_paths.push_back(file_path);
+    stale_stats.push_back(current);
+  }
+
+  // Re-hash everything else as one parallel batch
+  std::vector<std::string> stale_hashes = hashFilesParallel(stale_paths);
+  for (std::size_t i = 0; i < stale_paths.size(); i++)
+  {
+    const std::string &file_path = stale_paths[i];
+    IndexEntry current = stale_stats[i];
+    current.hash = stale_hashes[i];
+    hashes[file_path] = current.hash;
+
+    auto cached = index.find(file_path);
+    if (cached != index.end() && cached->second.staged)
+    {
+      // Staged entries keep the staged hash, only the stat cache is refreshed
+      // when the working file still matches it
+      if (cached->second.hash == current.hash)
+      {
+        current.staged = true;
+        cached->second = current;
+        index_changed = true;
+      }
+      continue;
+    }
+
+    index[file_path] = current;
+    index_changed = true;
+  }
+
+  return hashes;
+}
+
+void resetStagedEntries(std::map<std::string, IndexEntry> &index)
+{
+  // Staged deletions are dropped, staged files stay as cached stat entries
+  for (auto it = index.begin(); it != index.end();)
+  {
+    if (it->second.staged && it->second.hash.empty())
+    {
+      it = index.erase(it);
+      continue;
+    }
+    it->second.staged = false;
+    ++it;
+  }
+}
+
+bool clearStagingArea()
+{
+  std::map<std::string, IndexEntry> index = loadIndex();
+  resetStagedEntries(index);
+  return saveIndex(index);
+}
@@ -0,0 +1,535 @@
+#include "../include/json.hpp"
+
+static const std::string JSON_EMPTY;
+
+static void emitJson(
+    JsonParser &parser,
+    JsonEvent event,
+    const std::string &key,
+    const std::string &value)
+{
+  if (!parser.handler(event, key, value, parser.containers.size()))
+  {
+    parser.stopped = true;
+  }
+}
+
+// Member name of a value starting now: the pending key inside an object, "" elsewhere
+static const std::string &currentJsonKey(const JsonParser &parser)
+{
+  return !parser.containers.empty() && parser.containers.back() == '{' ? parser.key : JSON_EMPTY;
+}
+
+static void endJsonValue(JsonParser &parser)
+{
+  parser.state = parser.containers.empty() ? JsonState::DONE : JsonState::AFTER_VALUE;
+}
+
+static void openJsonContainer(
+    JsonParser &parser,
+    char container)
+{
+  emitJson(parser, container == '{' ? JsonEvent::OBJECT_START : JsonEvent::ARRAY_START, currentJsonKey(parser), JSON_EMPTY);
+  parser.keys.push_back(currentJsonKey(parser));
+  parser.containers.push_back(container);
+  parser.state = container == '{' ? JsonState::OBJECT_FIRST : JsonState::ARRAY_FIRST;
+}
+
+static void closeJsonContainer(
+    JsonParser &parser,
+    char closer)
+{
+  char expected = closer == '}' ? '{' : '[';
+  if (parser.containers.empty() || parser.containers.back() != expected)
+  {
+    parser.failed = true;
+    return;
+  }
+
+  std::string key = std::move(parser.keys.back());
+  parser.keys.pop_back();
+  parser.containers.pop_back();
+  emitJson(parser, closer == '}' ? JsonEvent::OBJECT_END : JsonEvent::ARRAY_END, key, JSON_EMPTY);
+  endJsonValue(parser);
+}
+
+static void appendCodePoint(
+    std::string &output,
+    uint32_t code_point)
+{
+  if (code_point < 0x80)
+  {
+    output.push_back(static_cast<char>(code_point));
+  }
+  else if (code_point < 0x800)
+  {
+    output.push_back(static_cast<char>(0xc0 | (code_point >> 6)));
+    output.push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+  }
+  else if (code_point < 0x10000)
+  {
+    output.push_back(static_cast<char>(0xe0 | (code_point >> 12)));
+    output.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3f)));
+    output.push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+  }
+  else
+  {
+    output.push_back(static_cast<char>(0xf0 | (code_point >> 18)));
+    output.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3f)));
+    output.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3f)));
+    output.push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+  }
+}
+
+// A high surrogate not followed by its low half stands for U+FFFD
+static void flushSurrogate(JsonParser &parser)
+{
+  if (parser.high_surrogate != 0)
+  {
+    appendCodePoint(parser.token, 0xfffd);
+    parser.high_surrogate = 0;
+  }
+}
+
+static void appendCodeUnit(
+    JsonParser &parser,
+    uint32_t code_unit)
+{
+  // UTF-16 surrogate pairs combine into one code point; a lone half becomes U+FFFD
+  bool is_high = code_unit >= 0xd800 && code_unit <= 0xdbff;
+  bool is_low = code_unit >= 0xdc00 && code_unit <= 0xdfff;
+  if (parser.high_surrogate != 0 && is_low)
+  {
+    appendCodePoint(parser.token, 0x10000 + ((parser.high_surrogate - 0xd800) << 10) + (code_unit - 0xdc00));
+    parser.high_surrogate = 0;
+    return;
+  }
+  flushSurrogate(parser);
+  if (is_high)
+  {
+    parser.high_surrogate = code_unit;
+    return;
+  }
+  appendCodePoint(parser.token, is_low ? 0xfffd : code_unit);
+}
+
+// Hands the characters of a streamed string collected so far to chunk_handler
+static void streamJsonString(
+    JsonParser &parser,
+    const char *data,
+    std::size_t size)
+{
+  if (size > 0 && !parser.chunk_handler(data, size))
+  {
+    parser.stopped = true;
+  }
+}
+
+static void flushStreamedToken(JsonParser &parser)
+{
+  if (parser.streaming)
+  {
+    streamJsonString(parser, parser.token.data(), parser.token.size());
+    parser.token.clear();
+  }
+}
+
+static void endJsonString(JsonParser &parser)
+{
+  flushSurrogate(parser);
+  flushStreamedToken(parser);
+  parser.streaming = false;
+
+  if (parser.token_is_key)
+  {
+    parser.key = parser.token;
+    parser.state = JsonState::COLON;
+    return;
+  }
+  emitJson(parser, JsonEvent::STRING, currentJsonKey(parser), parser.token);
+  endJsonValue(parser);
+}
+
+// Checks number against the JSON grammar, -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?,
+// which is stricter than strtod and does not depend on the locale
+static bool isJsonNumber(const std::string &number)
+{
+  std::size_t i = 0;
+  auto digits = [&]()
+  {
+    std::size_t start = i;
+    while (i < number.size() && number[i] >= '0' && number[i] <= '9')
+    {
+      i++;
+    }
+    return i - start;
+  };
+
+  if (i < number.size() && number[i] == '-')
+  {
+    i++;
+  }
+  if (i < number.size() && number[i] == '0')
+  {
+    i++;
+  }
+  else if (digits() == 0)
+  {
+    return false;
+  }
+
+  if (i < number.size() && number[i] == '.')
+  {
+    i++;
+    if (digits() == 0)
+    {
+      return false;
+    }
+  }
+
+  if (i < number.size() && (number[i] == 'e' || number[i] == 'E'))
+  {
+    i++;
+    if (i < number.size() && (number[i] == '+' || number[i] == '-'))
+    {
+      i++;
+    }
+    if (digits() == 0)
+    {
+      return false;
+    }
+  }
+
+  return i == number.size();
+}
+
+static void endJsonScalar(JsonParser &parser)
+{
+  if (parser.state == JsonState::NUMBER)
+  {
+    if (!isJsonNumber(parser.token))
+    {
+      parser.failed = true;
+      return;
+    }
+    emitJson(parser, JsonEvent::NUMBER, currentJsonKey(parser), parser.token);
+  }
+  else
+  {
+    if (parser.token != "true" && parser.token != "false" && parser.token != "null")
+    {
+      parser.failed = true;
+      return;
+    }
+    emitJson(parser, JsonEvent::LITERAL, currentJsonKey(parser), parser.token);
+  }
+  endJsonValue(parser);
+}
+
+static void startJsonValue(
+    JsonParser &parser,
+    char c)
+{
+  if (c == '{' || c == '[')
+  {
+    openJsonContainer(parser, c);
+  }
+  else if (c == '"')
+  {
+    parser.token.clear();
+    parser.token_is_key = false;
+    parser.streaming = !parser.stream_key.empty() && currentJsonKey(parser) == parser.stream_key;
+    parser.state = JsonState::STRING;
+  }
+  else if (c == '-' || (c >= '0' && c <= '9'))
+  {
+    parser.token.assign(1, c);
+    parser.state = JsonState::NUMBER;
+  }
+  else if (c == 't' || c == 'f' || c == 'n')
+  {
+    parser.token.assign(1, c);
+    parser.state = JsonState::LITERAL;
+  }
+  else
+  {
+    parser.failed = true;
+  }
+}
+
+static int hexDigitValue(char c)
+{
+  if (c >= '0' && c <= '9')
+  {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f')
+  {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F')
+  {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+bool feedJson(
+    JsonParser &parser,
+    const char *data,
+    std::size_t size)
+{
+  std::size_t i = 0;
+  while (i < size && !parser.failed && !parser.stopped)
+  {
+    char c = data[i];
+    switch (parser.state)
+    {
+    case JsonState::STRING:
+    {
+      // Plain characters are copied in one run up to the next quote or backslash
+      std::size_t end = i;
+      while (end < size && data[end] != '"' && data[end] != '\\' && static_cast<unsigned char>(data[end]) >= 0x20)
+      {
+        end++;
+      }
+      if (end > i)
+      {
+        flushSurrogate(parser);
+      }
+      if (parser.streaming)
+      {
+        flushStreamedToken(parser);
+        streamJsonString(parser, data + i, end - i);
+      }
+      else
+      {
+        parser.token.append(data + i, end - i);
+      }
+      i = end;
+      if (i == size)
+      {
+        break;
+      }
+      if (data[i] == '\\')
+      {
+        parser.state = JsonState::ESCAPE;
+      }
+      else if (data[i] == '"')
+      {
+        endJsonString(parser);
+      }
+      else
+      {
+        parser.failed = true; // raw control characters are not allowed in strings
+      }
+      i++;
+      break;
+    }
+
+    case JsonState::ESCAPE:
+    {
+      static const std::string escapes = "\"\\/bfnrt";
+      static const std::string replacements = "\"\\/\b\f\n\r\t";
+      std::size_t escape = escapes.find(c);
+      if (c == 'u')
+      {
+        parser.code_unit = 0;
+        parser.code_digits = 0;
+        parser.state = JsonState::UNICODE;
+      }
+      else if (escape != std::string::npos)
+      {
+        flushSurrogate(parser);
+        parser.token.push_back(replacements[escape]);
+        flushStreamedToken(parser);
+        parser.state = JsonState::STRING;
+      }
+      else
+      {
+        parser.failed = true;
+      }
+      i++;
+      break;
+    }
+
+    case JsonState::UNICODE:
+    {
+      int digit = hexDigitValue(c);
+      if (digit < 0)
+      {
+        parser.failed = true;
+        break;
+      }
+      parser.code_unit = (parser.code_unit << 4) | static_cast<uint32_t>(digit);
+      if (++parser.code_digits == 4)
+      {
+        appendCodeUnit(parser, parser.code_unit);
+        if (parser.high_surrogate == 0)
+        {
+          flushStreamedToken(parser);
+        }
+        parser.state = JsonState::STRING;
+      }
+      i++;
+      break;
+    }
+
+    case JsonState::NUMBER:
+    case JsonState::LITERAL:
+    {
+      bool continues = parser.state == JsonState::NUMBER
+                           ? (c >= '0' && c <= '9') || c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-'
+                           : c >= 'a' && c <= 'z';
+      if (continues)
+      {
+        parser.token.push_back(c);
+        i++;
+      }
+      else
+      {
+        endJsonScalar(parser); // the terminating character is read again in the new state
+      }
+      break;
+    }
+
+    default:
+    {
+      if (c == ' ' || c == '\t' || c == '\n' || c == '\r')
+      {
+        i++;
+        break;
+      }
+
+      switch (parser.state)
+      {
+      case JsonState::VALUE:
+        startJsonValue(parser, c);
+        break;
+      case JsonState::ARRAY_FIRST:
+        if (c == ']')
+        {
+          closeJsonContainer(parser, c);
+        }
+        else
+        {
+          startJsonValue(parser, c);
+        }
+        break;
+      case JsonState::OBJECT_FIRST:
+      case JsonState::KEY:
+        if (c == '}' && parser.state == JsonState::OBJECT_FIRST)
+        {
+          closeJsonContainer(parser, c);
+        }
+        else if (c == '"')
+        {
+          parser.token.clear();
+          parser.token_is_key = true;
+          parser.state = JsonState::STRING;
+        }
+        else
+        {
+          parser.failed = true;
+        }
+        break;
+      case JsonState::COLON:
+        parser.failed = c != ':';
+        parser.state = JsonState::VALUE;
+        break;
+      case JsonState::AFTER_VALUE:
+        if (c == ',')
+        {
+          parser.state = parser.containers.back() == '{' ? JsonState::KEY : JsonState::VALUE;
+        }
+        else if (c == '}' || c == ']')
+        {
+          closeJsonContainer(parser, c);
+        }
+        else
+        {
+          parser.failed = true;
+        }
+        break;
+      default:
+        parser.failed = true; // anything but whitespace after the document
+        break;
+      }
+      i++;
+      break;
+    }
+    }
+  }
+
+  return !parser.failed && !parser.stopped;
+}
+
+bool finishJson(JsonParser &parser)
+{
+  // A number or literal at the root only ends with the input
+  if (!parser.failed && !parser.stopped && parser.containers.empty() &&
+      (parser.state == JsonState::NUMBER || parser.state == JsonState::LITERAL))
+  {
+    endJsonScalar(parser);
+  }
+  return !parser.failed && (parser.stopped || parser.state == JsonState::DONE);
+}
+
+bool parseJson(
+    const std::string &json,
+    const JsonHandler &handler)
+{
+  JsonParser parser;
+  parser.handler = handler;
+  feedJson(parser, json.data(), json.size());
+  return finishJson(parser);
+}
+
+std::string findJsonString(
+    const std::string &json,
+    const std::string &key)
+{
+  std::string found;
+  parseJson(
+      json,
+      [&](JsonEvent event, const std::string &value_key, const std::string &value, std::size_t)
+      {
+        if (event == JsonEvent::STRING && value_key == key)
+        {
+          found = value;
+          return false;
+        }
+        return true;
+      });
+  return found;
+}
+
+std::string getJsonString(
+    const std::string &json,
+    const std::vector<std::string> &path)
+{
+  // matched counts the open objects, from the root, that lie on the path
+  std::string found;
+  std::size_t matched = 0;
+  parseJson(
+      json,
+      [&](JsonEvent event, const std::string &key, const std::string &value, std::size_t depth)
+      {
+        if (event == JsonEvent::OBJECT_START && depth == matched && depth < path.size() &&
+            (depth == 0 || key == path[depth - 1]))
+        {
+          matched++;
+        }
+        else if ((event == JsonEvent::OBJECT_END || event == JsonEvent::ARRAY_END) && depth < matched)
+        {
+          matched = depth;
+        }
+        else if (event == JsonEvent::STRING && !path.empty() && depth == path.size() && matched == depth && key == path.back())
+        {
+          found = value;
+          return false;
+        }
+        return true;
+      });
+  return found;
+}
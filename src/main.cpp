@@ -3,6 +3,7 @@
 #include "../include/config.hpp"
 #include "../include/diff.hpp"
 #include "../include/error.hpp"
+#include "../include/fsmonitor.hpp"
 #include "../include/hooks.hpp"
 #include "../include/maintenance.hpp"
 #include "../include/merge.hpp"
@@ -51,7 +52,7 @@ void init()
           "init");
     }
 
-    if (!ErrorHandler::safeWriteFile(".bittrack/commits/history", ""))
+    if (!writeCommitHistory({}))
     {
       throw BitTrackError(
           ErrorCode::FILE_WRITE_ERROR,
@@ -126,7 +127,7 @@ void stageFlag(int argc, const char *argv[], int &i)
     std::string file_to_add = argv[++i];
     VALIDATE_FILE_PATH(file_to_add);
 
-    if (shouldIgnoreFile(file_to_add) || isFileIgnoredByIgnorePatterns(file_to_add, parseIgnorePatterns(readBitignore(".bitignore"))))
+    if (shouldIgnoreFile(file_to_add))
     {
       throw BitTrackError(
           ErrorCode::FILE_IGNORED,
@@ -186,16 +187,11 @@ void commitsHistoryFlag()
 {
   std::cout << "Commit history:" << std::endl;
 
-  std::string history_file_content = ErrorHandler::safeReadFile(".bittrack/commits/history");
-  std::istringstream history_file(history_file_content);
-
-  std::string line;
-  while (std::getline(history_file, line))
+  // Show the newest commits first
+  std::vector<std::pair<std::string, std::string>> history = readCommitHistory();
+  for (auto record = history.rbegin(); record != history.rend(); ++record)
   {
-    if (!line.empty())
-    {
-      std::cout << line << std::endl;
-    }
+    std::cout << record->first << " " << record->second << std::endl;
   }
 }
 
@@ -833,6 +829,41 @@ void maintenanceFlag(int argc, const char *argv[], int &i)
   HANDLE_EXCEPTION("maintenance operations")
 }
 
+void fsmonitorFlag(int argc, const char *argv[], int &i)
+{
+  try
+  {
+    std::string subFlag = i + 1 < argc ? argv[++i] : "status";
+
+    if (subFlag == "start")
+    {
+      startFsMonitor();
+    }
+    else if (subFlag == "stop")
+    {
+      stopFsMonitor();
+    }
+    else if (subFlag == "status")
+    {
+      printFsMonitorStatus();
+    }
+    else
+    {
+      throw BitTrackError(
+          ErrorCode::INVALID_ARGUMENTS,
+          "Invalid fsmonitor sub-command: " + subFlag,
+          ErrorSeverity::ERROR,
+          "--fsmonitor");
+    }
+  }
+  catch (const BitTrackError &e)
+  {
+    ErrorHandler::printError(e);
+    throw;
+  }
+  HANDLE_EXCEPTION("fsmonitor operations")
+}
+
 void mergeFlag(int argc, const char *argv[], int &i)
 {
   try
@@ -943,6 +974,9 @@ void helpFlag()
   std::cout << "           optimize             optimize repository\n";
   std::cout << "           analyze              analyze repository structure\n";
   std::cout << "           prune                prune unreachable objects\n";
+  std::cout << "  --fsmonitor start             start the file system monitor for fast status\n";
+  std::cout << "              stop              stop the file system monitor\n";
+  std::cout << "              status            show whether the monitor is running\n";
   std::cout << "  --remote -v                   print current remote URL\n";
   std::cout << "           -s <url>             set remote URL\n";
   std::cout << "           -l                   list remote branches\n";
@@ -951,6 +985,7 @@ void helpFlag()
   std::cout << "  --pull   <branch>             pull changes from remote\n";
   std::cout << "  --clone <url> [path]          clone a repository from remote URL\n";
   std::cout << "  --fetch [remote]              fetch changes from remote repository\n";
+  std::cout << "  --serve [port]                serve this repository to native remotes on 127.0.0.1\n";
   std::cout << "  --help                        show this help menu\n";
 }
 
@@ -1008,6 +1043,9 @@ int main(int argc, const char *argv[])
             "repository check");
       }
 
+      // Repositories from before the blob store are converted on first use
+      migrateLegacyObjects();
+
       if (arg == "--status")
       {
         status();
@@ -1118,6 +1156,11 @@ int main(int argc, const char *argv[])
         maintenanceFlag(argc, argv, i);
         break;
       }
+      else if (arg == "--fsmonitor")
+      {
+        fsmonitorFlag(argc, argv, i);
+        break;
+      }
       else if (arg == "--remote")
       {
         remoteFlag(argc, argv, i);
@@ -1198,6 +1241,27 @@ int main(int argc, const char *argv[])
         HANDLE_EXCEPTION("fetch")
         break;
       }
+      else if (arg == "--serve")
+      {
+        try
+        {
+          int port = TRANSFER_DEFAULT_PORT;
+
+          if (i + 1 < argc)
+          {
+            port = std::stoi(argv[++i]);
+          }
+
+          runTransferServer(port);
+        }
+        catch (const BitTrackError &e)
+        {
+          ErrorHandler::printError(e);
+          throw;
+        }
+        HANDLE_EXCEPTION("serve")
+        break;
+      }
       else
       {
         throw BitTrackError(
@@ -1,11 +1,140 @@
 #include "../include/maintenance.hpp"
 
+// Name every blob after a path it was committed under, walking commits
+// newest first so each path's revisions are ordered from the latest back;
+// included blobs no commit refers to follow without a name
+static std::vector<PackObject> getPackObjects(const std::set<std::string> &included)
+{
+  std::vector<PackObject> objects;
+  std::set<std::string> seen;
+  for (const auto &commit_hash : getReachableCommits())
+  {
+    for (const auto &[file_path, blob_hash] : getCommitTree(commit_hash))
+    {
+      if (included.count(blob_hash) > 0 && seen.insert(blob_hash).second)
+      {
+        objects.push_back({blob_hash, file_path});
+      }
+    }
+  }
+  for (const auto &blob_hash : included)
+  {
+    if (seen.insert(blob_hash).second)
+    {
+      objects.push_back({blob_hash, ""});
+    }
+  }
+
+  return objects;
+}
+
+// Drop unreachable objects from loose storage and from the pack, returning the bytes freed
+static size_t removeUnreachableObjects(const std::vector<std::string> &unreachable)
+{
+  // Loose objects are independent files, so delete them across the worker threads
+  std::atomic<size_t> freed_space(0);
+  std::vector<char> packed(unreachable.size(), 0);
+  parallelForEach(
+      unreachable.size(),
+      [&](std::size_t i)
+      {
+        std::string blob_path = getBlobPath(unreachable[i]);
+        struct stat blob_stat;
+        if (lstat(blob_path.c_str(), &blob_stat) == 0 && S_ISREG(blob_stat.st_mode))
+        {
+          freed_space += static_cast<size_t>(blob_stat.st_size);
+          ErrorHandler::safeRemoveFile(blob_path);
+        }
+        packed[i] = hasPackedObject(unreachable[i]) ? 1 : 0;
+      });
+
+  std::set<std::string> unreachable_packed;
+  for (std::size_t i = 0; i < unreachable.size(); i++)
+  {
+    if (packed[i])
+    {
+      unreachable_packed.insert(unreachable[i]);
+    }
+  }
+  if (unreachable_packed.empty())
+  {
+    return freed_space;
+  }
+
+  // Packed objects cannot be deleted in place, so rewrite the pack without them
+  size_t old_pack_size = 0;
+  for (const auto &pack : getPackFiles())
+  {
+    old_pack_size += pack->pack_size + pack->idx_size;
+  }
+
+  // Only reachable objects go back into the pack; unreachable ones still inside
+  // the grace period are unpacked with the old pack's time, as repack does, so
+  // the rewrite does not restart their grace period
+  std::set<std::string> reachable = getReachableObjects();
+  std::set<std::string> kept;
+  for (const auto &blob_hash : listPackedObjects())
+  {
+    if (unreachable_packed.count(blob_hash) > 0)
+    {
+      continue;
+    }
+    if (reachable.count(blob_hash) > 0)
+    {
+      kept.insert(blob_hash);
+    }
+    else if (!std::filesystem::exists(getBlobPath(blob_hash)) && !loosenBlob(blob_hash, getPackedObjectTime(blob_hash)))
+    {
+      kept.insert(blob_hash);
+    }
+  }
+
+  PackStats stats;
+  if (repackObjects(getPackObjects(kept), stats) && old_pack_size > stats.pack_size)
+  {
+    freed_space += old_pack_size - stats.pack_size;
+  }
+  return freed_space;
+}
+
+std::time_t getGcGracePeriod()
+{
+  // gc.graceperiod is given in days; objects younger than that are never swept
+  const std::time_t default_grace_period = 14 * 24 * 60 * 60;
+  std::string days = configGet("gc.graceperiod");
+  if (days.empty())
+  {
+    return default_grace_period;
+  }
+
+  try
+  {
+    long parsed_days = std::stol(days);
+    if (parsed_days >= 0)
+    {
+      return static_cast<std::time_t>(parsed_days) * 24 * 60 * 60;
+    }
+  }
+  catch (const std::exception &)
+  {
+  }
+
+  ErrorHandler::printError(
+      ErrorCode::CONFIG_ERROR,
+      "Invalid gc.graceperiod '" + days + "', expected a number of days; using default",
+      ErrorSeverity::WARNING,
+      "get_gc_grace_period");
+  return default_grace_period;
+}
+
 void garbageCollect()
 {
   std::cout << "Running garbage collection..." << std::endl;
 
-  // Get list of unreachable objects
-  std::vector<std::string> unreachable = getUnreachableObjects();
+  // Recent unreachable objects may belong to a command that is still running,
+  // such as a stage whose index has not been written yet
+  std::time_t grace_period = getGcGracePeriod();
+  std::vector<std::string> unreachable = getUnreachableObjects(grace_period);
 
   if (unreachable.empty())
   {
@@ -14,15 +143,7 @@ void garbageCollect()
   }
 
   // remove unreachable objects and calculate freed space
-  size_t freed_space = 0;
-  for (const auto &obj : unreachable)
-  {
-    if (std::filesystem::exists(obj))
-    {
-      freed_space += std::filesystem::file_size(obj);
-      ErrorHandler::safeRemoveFile(obj);
-    }
-  }
+  size_t freed_space = removeUnreachableObjects(unreachable);
 
   std::cout << "Removed " << unreachable.size() << " unreachable objects" << std::endl;
   std::cout << "Freed " << formatSize(freed_space) << " of space" << std::endl;
@@ -32,57 +153,56 @@ void repackRepository()
 {
   std::cout << "Repacking repository..." << std::endl;
 
-  // gather all objects
-  std::string objects_dir = ".bittrack/objects";
-  if (!std::filesystem::exists(objects_dir))
+  std::vector<std::string> blobs = listBlobs();
+  if (blobs.empty())
   {
     std::cout << "No objects to repack" << std::endl;
     return;
   }
 
-  // statistics
-  size_t original_count = 0;
-  size_t repacked_count = 0;
+  // size of loose objects and existing packs before repacking
   size_t original_size = 0;
-  size_t repacked_size = 0;
-
-  std::vector<std::filesystem::path> objects = ErrorHandler::safeListDirectoryFiles(objects_dir);
-
-  // calculate original stats
-  for (const auto &entry : objects)
+  for (const auto &blob_hash : blobs)
   {
-    original_count++;
-    original_size += std::filesystem::file_size(entry);
+    std::error_code error;
+    uintmax_t loose_size = std::filesystem::file_size(getBlobPath(blob_hash), error);
+    original_size += error ? 0 : loose_size;
+  }
+  for (const auto &pack : getPackFiles())
+  {
+    original_size += pack->pack_size + pack->idx_size;
   }
 
-  // repack objects into a single directory
-  std::string packed_dir = objects_dir + "/packed";
-  std::vector<std::filesystem::path> packed_files = ErrorHandler::safeListDirectoryFiles(packed_dir);
-
-  // move objects to packed directory
-  for (const auto &entry : packed_files)
+  // Only reachable objects go into the pack; unreachable ones stay loose, where
+  // their modification time tells gc when the grace period has run out
+  std::set<std::string> reachable = getReachableObjects();
+  std::set<std::string> included;
+  for (const auto &blob_hash : blobs)
   {
-    // Skip already packed objects
-    if (entry.parent_path().string() != packed_dir)
+    if (reachable.count(blob_hash) > 0)
     {
-      // move object
-      std::string filename = entry.filename().string();
-      std::string new_path = packed_dir + "/" + filename;
-
-      // avoid overwriting existing files
-      if (!std::filesystem::exists(new_path))
+      included.insert(blob_hash);
+    }
+    else if (!std::filesystem::exists(getBlobPath(blob_hash)))
+    {
+      // unpack it before the pack holding it is replaced, keeping the pack's
+      // time so repacking does not restart its grace period
+      if (!loosenBlob(blob_hash, getPackedObjectTime(blob_hash)))
       {
-        // move file
-        std::filesystem::rename(entry, new_path);
-        repacked_count++;
-        repacked_size += std::filesystem::file_size(new_path);
+        included.insert(blob_hash);
       }
     }
   }
 
-  std::cout << "Repacked " << repacked_count << " objects" << std::endl;
+  PackStats stats;
+  if (!repackObjects(getPackObjects(included), stats))
+  {
+    return;
+  }
+
+  std::cout << "Repacked " << stats.object_count << " objects (" << stats.delta_count << " as deltas)" << std::endl;
   std::cout << "Original size: " << formatSize(original_size) << std::endl;
-  std::cout << "Repacked size: " << formatSize(repacked_size) << std::endl;
+  std::cout << "Repacked size: " << formatSize(stats.pack_size) << std::endl;
   std::cout << "Repository repacked successfully" << std::endl;
 }
 
@@ -90,17 +210,11 @@ void pruneObjects()
 {
   std::cout << "Pruning objects..." << std::endl;
 
-  // Get list of unreachable objects
-  std::vector<std::string> unreachable = getUnreachableObjects();
+  // Unlike gc, prune removes unreachable objects of any age
+  std::vector<std::string> unreachable = getUnreachableObjects(0);
 
   // remove unreachable objects
-  for (const auto &obj : unreachable)
-  {
-    if (std::filesystem::exists(obj))
-    {
-      std::filesystem::remove(obj);
-    }
-  }
+  removeUnreachableObjects(unreachable);
 
   std::cout << "Pruned " << unreachable.size() << " objects" << std::endl;
 }
@@ -121,7 +235,7 @@ void fsckRepository()
     for (const auto &entry : objects)
     {
       // try to open the file
-      std::ifstream file(entry);
+      std::ifstream file(std::filesystem::path(objects_dir) / entry);
       if (!file.good())
       {
         missing_objects.push_back(entry);
@@ -129,6 +243,9 @@ void fsckRepository()
     }
   }
 
+  // Check that every packed object still rebuilds to its hash
+  verifyPackFiles(missing_objects);
+
   // report results
   if (missing_objects.empty())
   {
@@ -182,19 +299,13 @@ void findLargeFiles(size_t threshold)
   // store large files
   std::vector<std::pair<std::string, size_t>> large_files;
 
-  // scan files in repository
-  std::vector<std::filesystem::path> repository_files = ErrorHandler::safeListDirectoryFiles(".");
-  for (const auto &entry : repository_files)
+  // scan the working tree, using the size captured by the walk
+  for (const auto &entry : listWorkingTreeFiles())
   {
-    // Skip .bittrack directory
-    if (entry.string().find(".bittrack") != 0)
+    size_t file_size = static_cast<size_t>(entry.file_stat.st_size);
+    if (file_size > threshold)
     {
-      // Check file size
-      size_t file_size = std::filesystem::file_size(entry);
-      if (file_size > threshold)
-      {
-        large_files.push_back({entry.string(), file_size});
-      }
+      large_files.push_back({entry.path, file_size});
     }
   }
 
@@ -244,6 +355,12 @@ void optimizeRepository()
   garbageCollect();
   repackRepository();
 
+  // Rebuild the commit graph from scratch, dropping commits whose logs are gone
+  if (writeCommitGraph())
+  {
+    std::cout << "Commit graph rewritten" << std::endl;
+  }
+
   std::cout << "Repository optimization completed" << std::endl;
 }
 
@@ -261,7 +378,7 @@ RepoStats calculateRepositoryStats()
     {
       // update stats
       stats.total_objects++;
-      size_t file_size = std::filesystem::file_size(entry);
+      size_t file_size = std::filesystem::file_size(std::filesystem::path(objects_dir) / entry);
       stats.total_size += file_size;
 
       // Check for largest file
@@ -305,27 +422,12 @@ RepoStats calculateRepositoryStats()
   return stats;
 }
 
-std::vector<std::string> getUnreachableObjects()
+std::vector<std::string> getReachableCommits()
 {
-  // store unreachable objects
-  std::vector<std::string> unreachable;
-
-  // gather all objects
-  std::string objects_dir_path = ".bittrack/objects";
-  if (!std::filesystem::exists(objects_dir_path))
-  {
-    return unreachable;
-  }
-
-  // determine reachable objects
-  std::set<std::string> reachable_objects;
-
-  // add current commit
-  std::string current_commit = getCurrentCommit();
-  if (!current_commit.empty()) // Check if current commit is valid
-  {
-    reachable_objects.insert(current_commit);
-  }
+  // Roots newest first: the current commit, branch tips, remote-tracking refs,
+  // tags, stashes, the last pushed commit, then the history from the latest commit back
+  std::vector<std::string> roots;
+  roots.push_back(getCurrentCommit());
 
   // add commits from branches
   std::string refs_dir = ".bittrack/refs/heads";
@@ -341,24 +443,122 @@ std::vector<std::string> getUnreachableObjects()
 
         if (std::getline(file, commit_hash)) // Check if line was read successfully
         {
-          reachable_objects.insert(commit_hash);
+          roots.push_back(commit_hash);
         }
         file.close();
       }
     }
   }
 
-  std::vector<std::filesystem::path> objects_dir = ErrorHandler::safeListDirectoryFiles(objects_dir_path);
-  for (const auto &entry : objects_dir)
+  // Remote-tracking refs keep fetched branches alive until the next fetch moves them
+  for (const auto &tracking_ref : ErrorHandler::safeListDirectoryFiles(".bittrack/refs/remotes"))
   {
-    // Get object hash
-    std::string object_path = entry.string();
-    std::string object_hash = entry.filename().string();
+    std::ifstream file(".bittrack/refs/remotes" / tracking_ref);
+    std::string commit_hash;
+    if (std::getline(file, commit_hash))
+    {
+      roots.push_back(commit_hash);
+    }
+  }
+
+  for (const auto &tag : getAllTags())
+  {
+    roots.push_back(tag.commit_hash);
+  }
+  for (const auto &entry : getStashEntries())
+  {
+    roots.push_back(entry.commit_hash);
+  }
+  std::ifstream last_pushed(".bittrack/last_pushed_commit");
+  std::string last_pushed_commit;
+  if (std::getline(last_pushed, last_pushed_commit))
+  {
+    roots.push_back(last_pushed_commit);
+  }
+
+  std::vector<std::pair<std::string, std::string>> history = readCommitHistory();
+  for (auto record = history.rbegin(); record != history.rend(); ++record)
+  {
+    roots.push_back(record->first);
+  }
+
+  // Mark: follow every parent of every root, merge commits included
+  std::vector<std::string> reachable_commits;
+  std::set<std::string> seen;
+  std::vector<std::string> pending(roots.rbegin(), roots.rend());
+  while (!pending.empty())
+  {
+    std::string commit_hash = pending.back();
+    pending.pop_back();
+    commit_hash.erase(commit_hash.find_last_not_of(" \t\r\n") + 1);
+    if (commit_hash.empty() || !seen.insert(commit_hash).second)
+    {
+      continue;
+    }
+
+    reachable_commits.push_back(commit_hash);
+    std::vector<std::string> parents = getCommitParents(commit_hash);
+    pending.insert(pending.end(), parents.rbegin(), parents.rend());
+  }
 
+  return reachable_commits;
+}
+
+std::set<std::string> getReachableObjects()
+{
+  // a blob is reachable if any reachable commit tree refers to it
+  std::set<std::string> reachable_objects;
+  for (const auto &commit_hash : getReachableCommits())
+  {
+    for (const auto &[file_path, blob_hash] : getCommitTree(commit_hash))
+    {
+      reachable_objects.insert(blob_hash);
+    }
+  }
+
+  // or the index does: staged changes and the resolutions of a merge in progress
+  for (const auto &[file_path, entry] : loadIndex())
+  {
+    if (!entry.hash.empty())
+    {
+      reachable_objects.insert(entry.hash);
+    }
+  }
+
+  return reachable_objects;
+}
+
+std::vector<std::string> getUnreachableObjects(std::time_t grace_period)
+{
+  // store unreachable objects
+  std::vector<std::string> unreachable;
+
+  // gather all objects
+  std::string objects_dir_path = ".bittrack/objects";
+  if (!std::filesystem::exists(objects_dir_path))
+  {
+    return unreachable;
+  }
+
+  // A packed object was last known reachable when the newest pack holding it
+  // was written, since repacking only packs reachable objects
+  std::time_t cutoff = std::time(nullptr) - grace_period;
+
+  std::set<std::string> reachable_objects = getReachableObjects();
+  for (const auto &blob_hash : listBlobs())
+  {
     // Check if object is reachable
-    if (reachable_objects.find(object_hash) == reachable_objects.end())
+    if (reachable_objects.find(blob_hash) != reachable_objects.end())
     {
-      unreachable.push_back(object_path);
+      continue;
+    }
+
+    // Sweep: skip objects written within the grace period
+    struct stat blob_stat;
+    std::time_t modified = stat(getBlobPath(blob_hash).c_str(), &blob_stat) == 0 ? blob_stat.st_mtime : getPackedObjectTime(blob_hash);
+    if (grace_period == 0 || modified <= cutoff)
+    {
+      unreachable.push_back(blob_hash);
     }
   }
 
@@ -371,21 +571,17 @@ std::vector<std::string> getDuplicateFiles()
   std::vector<std::string> duplicates;
   std::map<std::string, std::vector<std::string>> file_hashes;
 
-  std::vector<std::filesystem::path> repository_files = ErrorHandler::safeListDirectoryFiles(".");
-  for (const auto &entry : repository_files)
+  for (const auto &entry : listWorkingTreeFiles())
   {
-    if (entry.string().find(".bittrack") != 0)
+    try
     {
-      try
-      {
-        // compute file hash
-        std::string file_hash = hashFile(entry.string());
-        file_hashes[file_hash].push_back(entry.string());
-      }
-      catch (...)
-      {
-        continue;
-      }
+      // compute file hash
+      std::string file_hash = hashFile(entry.path);
+      file_hashes[file_hash].push_back(entry.path);
+    }
+    catch (...)
+    {
+      continue;
     }
   }
 
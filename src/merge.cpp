@@ -24,17 +24,48 @@ MergeResult mergeBranches(
     return result;
   }
 
-  // Check if already up to date
-  if (source_commit == target_commit)
+  // The merge works on the checked-out target and leaves files it does not
+  // change as they are, so the working tree must hold exactly that commit
+  if (target_branch != getCurrentBranchName())
+  {
+    result.message = "Target branch '" + target_branch + "' is not checked out";
+    return result;
+  }
+  if (hasUncommittedChanges())
+  {
+    result.message = "Commit or stash your changes before merging";
+    return result;
+  }
+
+  // Check if already up to date, including when the source is behind the target
+  if (source_commit == target_commit || isAncestor(source_commit, target_commit))
   {
     result.success = true;
     result.message = "Already up to date";
     return result;
   }
 
-  // Check for fast-forward merge
-  if (isFastForward(source_branch, target_branch))
+  // Check for fast-forward merge: the target moves to the source commit
+  if (isFastForward(source_commit, target_commit))
   {
+    restoreFilesFromCommit(source_commit, target_commit);
+    ErrorHandler::safeWriteFile(".bittrack/refs/heads/" + target_branch, source_commit + "\n");
+
+    // Journal the first-parent chain the branch moved over, oldest first
+    std::vector<std::string> chain;
+    std::string commit = source_commit;
+    while (!commit.empty() && commit != target_commit && isAncestor(target_commit, commit))
+    {
+      chain.push_back(commit);
+      std::vector<std::string> parents = getCommitParents(commit);
+      commit = parents.empty() ? "" : parents.front();
+    }
+    for (auto record = chain.rbegin(); record != chain.rend(); ++record)
+    {
+      insertCommitRecordToHistory(*record, target_branch);
+    }
+    updateCommitGraph(source_commit);
+
     result.success = true;
     result.message = "Fast-forward merge";
     result.merge_commit = source_commit;
@@ -56,7 +87,7 @@ MergeResult mergeBranches(
   if (result.success)
   {
     std::string merge_message = "Merge branch '" + source_branch + "' into " + target_branch;
-    createMergeCommit(merge_message, {target_commit, source_commit});
+    createMergeCommit(merge_message, {target_commit, source_commit}, result.merged_tree);
     result.message = getCurrentCommit();
   }
 
@@ -96,143 +127,297 @@ void writeConflict(
   conflict.close();
 }
 
-MergeResult threeWayMerge(
-    const std::string &base,
-    const std::string &ours,
-    const std::string &theirs)
+// Split content into lines that keep their newline, so a missing final
+// newline survives the merge
+static std::vector<std::string> splitMergeLines(const std::string &content)
 {
-  MergeResult result;
-  std::set<std::string> all_files;
+  std::vector<std::string> lines;
+  size_t start = 0;
+  while (start < content.size())
+  {
+    size_t end = content.find('\n', start);
+    end = end == std::string::npos ? content.size() : end + 1;
+    lines.push_back(content.substr(start, end - start));
+    start = end;
+  }
+  return lines;
+}
 
-  // Collect all files from the three commits
-  std::vector<std::string> base_files = getCommitFiles(base);
-  std::vector<std::string> our_files = getCommitFiles(ours);
-  std::vector<std::string> their_files = getCommitFiles(theirs);
+static bool sameMergeLines(
+    const std::vector<std::string> &first, size_t first_begin, size_t first_end,
+    const std::vector<std::string> &second, size_t second_begin, size_t second_end)
+{
+  return first_end - first_begin == second_end - second_begin &&
+         std::equal(first.begin() + first_begin, first.begin() + first_end, second.begin() + second_begin);
+}
 
-  // Combine all file lists
-  all_files.insert(base_files.begin(), base_files.end());
-  all_files.insert(our_files.begin(), our_files.end());
-  all_files.insert(their_files.begin(), their_files.end());
+static void appendMergeLines(
+    std::string &merged,
+    const std::vector<std::string> &lines,
+    size_t begin,
+    size_t end)
+{
+  for (size_t i = begin; i < end; i++)
+  {
+    merged += lines[i];
+  }
+}
 
-  // Process each file
-  for (const auto &file : all_files)
+// Write one side of a conflict region, ending it with a newline so the next
+// marker starts on its own line
+static void appendConflictSide(
+    std::string &merged,
+    const std::vector<std::string> &lines,
+    size_t begin,
+    size_t end)
+{
+  appendMergeLines(merged, lines, begin, end);
+  if (begin < end && merged.back() != '\n')
   {
-    bool base_exists = std::filesystem::exists(base + "/" + file);    // Check if file exists in base
-    bool our_exists = std::filesystem::exists(ours + "/" + file);     // Check if file exists in ours
-    bool their_exists = std::filesystem::exists(theirs + "/" + file); // Check if file exists in theirs
+    merged += '\n';
+  }
+}
+
+bool mergeFileContents(
+    const std::string &base,
+    const std::string &ours,
+    const std::string &theirs,
+    std::string &merged)
+{
+  merged.clear();
 
-    std::string base_content = base_exists ? ErrorHandler::safeReadFile(base + "/" + file) : "";     // Get base content
-    std::string our_content = our_exists ? ErrorHandler::safeReadFile(ours + "/" + file) : "";       // Get our content
-    std::string their_content = their_exists ? ErrorHandler::safeReadFile(theirs + "/" + file) : ""; // Get their content
+  // Binary content has no lines to merge
+  if (base.find('\0') != std::string::npos || ours.find('\0') != std::string::npos ||
+      theirs.find('\0') != std::string::npos)
+  {
+    return false;
+  }
 
-    if (!base_exists) // Handle new files
+  std::vector<std::string> base_lines = splitMergeLines(base);
+  std::vector<std::string> our_lines = splitMergeLines(ours);
+  std::vector<std::string> their_lines = splitMergeLines(theirs);
+  std::vector<int> our_matches = computeLineMatches(base_lines, our_lines);
+  std::vector<int> their_matches = computeLineMatches(base_lines, their_lines);
+
+  bool clean = true;
+  size_t b = 0;
+  size_t o = 0;
+  size_t t = 0;
+  while (b < base_lines.size() || o < our_lines.size() || t < their_lines.size())
+  {
+    // A base line both sides kept in place is stable and copied through
+    if (b < base_lines.size() &&
+        our_matches[b] == static_cast<int>(o) && their_matches[b] == static_cast<int>(t))
     {
-      if (our_exists && their_exists) // Handle new file additions
-      {
-        if (our_content == their_content) // New file added identically by both
-        {
-          ErrorHandler::safeWriteFile(file, our_content); // or their_content, they are the same
-          std::cout << "New file added by both: " << file << std::endl;
-        }
-        else // Conflict in new file
-        {
-          result.has_conflicts = true;
-          result.conflicted_files.push_back(file);
-          writeConflict(file, our_content, their_content);
-          std::cout << "Conflict in new file: " << file << std::endl;
-        }
-      }
-      else if (our_exists && !their_exists) // New file added by us
-      {
-        ErrorHandler::safeWriteFile(file, our_content);
-        std::cout << "New file added by us: " << file << std::endl;
-      }
-      else if (!our_exists && their_exists) // New file added by them
-      {
-        ErrorHandler::safeWriteFile(file, their_content);
-        std::cout << "New file added by them: " << file << std::endl;
-      }
+      merged += base_lines[b];
+      b++;
+      o++;
+      t++;
       continue;
     }
 
-    // Handle deletions and modifications
-    if (base_exists && !our_exists && !their_exists) // Deleted by both
+    // Otherwise the unstable chunk runs up to the next base line both sides kept
+    size_t b_end = b;
+    while (b_end < base_lines.size() && (our_matches[b_end] < 0 || their_matches[b_end] < 0))
     {
-      std::remove(file.c_str());
-      std::cout << "File deleted by both: " << file << std::endl;
-      continue;
+      b_end++;
     }
+    size_t o_end = b_end < base_lines.size() ? static_cast<size_t>(our_matches[b_end]) : our_lines.size();
+    size_t t_end = b_end < base_lines.size() ? static_cast<size_t>(their_matches[b_end]) : their_lines.size();
 
-    if (base_exists && !our_exists && their_exists) // Deleted by us
+    if (sameMergeLines(base_lines, b, b_end, their_lines, t, t_end)) // Only we changed it
     {
-      if (base_content == their_content) // No changes by them
-      {
-        std::remove(file.c_str());
-        std::cout << "Deleted by us: " << file << std::endl;
-      }
-      else // Modified by them
-      {
-        result.has_conflicts = true;
-        result.conflicted_files.push_back(file);
-        writeConflict(file, "", their_content);
-        std::cout << "Conflict: we deleted, they modified " << file << std::endl;
-      }
-      continue;
+      appendMergeLines(merged, our_lines, o, o_end);
     }
-
-    if (base_exists && our_exists && !their_exists) // Deleted by them
+    else if (sameMergeLines(base_lines, b, b_end, our_lines, o, o_end) || // Only they changed it
+             sameMergeLines(our_lines, o, o_end, their_lines, t, t_end))  // or both made the same change
     {
-      if (base_content == our_content) // No changes by us
+      appendMergeLines(merged, their_lines, t, t_end);
+    }
+    else
+    {
+      // Lines both sides agree on at the edges of the chunk stay outside the
+      // markers, leaving only the lines that really differ in conflict
+      size_t prefix = 0;
+      while (o + prefix < o_end && t + prefix < t_end && our_lines[o + prefix] == their_lines[t + prefix])
       {
-        std::remove(file.c_str());
-        std::cout << "Deleted by them: " << file << std::endl;
+        prefix++;
       }
-      else // Modified by us
+      size_t suffix = 0;
+      while (o_end - suffix > o + prefix && t_end - suffix > t + prefix &&
+             our_lines[o_end - suffix - 1] == their_lines[t_end - suffix - 1])
       {
-        result.has_conflicts = true;
-        result.conflicted_files.push_back(file);
-        writeConflict(file, our_content, "");
-        std::cout << "Conflict: they deleted, we modified " << file << std::endl;
+        suffix++;
       }
-      continue;
+
+      appendMergeLines(merged, our_lines, o, o + prefix);
+      merged += "<<<<<<< HEAD\n";
+      appendConflictSide(merged, our_lines, o + prefix, o_end - suffix);
+      merged += "=======\n";
+      appendConflictSide(merged, their_lines, t + prefix, t_end - suffix);
+      merged += ">>>>>>> theirs\n";
+      appendMergeLines(merged, our_lines, o_end - suffix, o_end);
+      clean = false;
     }
 
-    if (our_content == their_content) // Both sides identical
+    b = b_end;
+    o = o_end;
+    t = t_end;
+  }
+
+  return clean;
+}
+
+// Apply a file both sides or only they changed to the working tree, which
+// holds our version
+static void applyFileMerge(FileMerge &merge)
+{
+  const std::string &file = merge.path;
+  if (merge.base_hash == merge.our_hash) // Only they changed it
+  {
+    merge.merged_hash = merge.their_hash;
+    if (merge.their_hash.empty())
     {
-      ErrorHandler::safeWriteFile(file, our_content);
-      std::cout << "Both sides identical: " << file << std::endl;
-      continue;
+      std::remove(file.c_str());
+      merge.message = "Deleted by them: " + file;
+    }
+    else
+    {
+      ErrorHandler::safeWriteFile(file, readBlob(merge.their_hash));
+      merge.message = (merge.base_hash.empty() ? "New file added by them: " : "Merged theirs into ") + file;
     }
+    return;
+  }
+
+  std::string base_content = merge.base_hash.empty() ? "" : readBlob(merge.base_hash);
+  std::string our_content = merge.our_hash.empty() ? "" : readBlob(merge.our_hash);
+  std::string their_content = merge.their_hash.empty() ? "" : readBlob(merge.their_hash);
+  merge.conflicted = true;
+
+  if (merge.our_hash.empty()) // Deleted by us, modified by them
+  {
+    writeConflict(file, "", their_content);
+    merge.message = "Conflict: we deleted, they modified " + file;
+    return;
+  }
+
+  if (merge.their_hash.empty()) // Deleted by them, modified by us
+  {
+    writeConflict(file, our_content, "");
+    merge.message = "Conflict: they deleted, we modified " + file;
+    return;
+  }
+
+  // Both sides changed the file: merge them line by line against the base,
+  // which is empty for a file both sides added
+  std::string merged;
+  if (mergeFileContents(base_content, our_content, their_content, merged))
+  {
+    ErrorHandler::safeWriteFile(file, merged);
+    merge.merged_hash = storeBlob(merged);
+    merge.conflicted = false;
+    merge.message = "Successfully auto-merged: " + file;
+    return;
+  }
+
+  // Only the regions both sides changed differently are left in conflict;
+  // binary files conflict as a whole
+  if (merged.empty())
+  {
+    writeConflict(file, our_content, their_content);
+  }
+  else
+  {
+    ErrorHandler::safeWriteFile(file, merged);
+  }
+  merge.message = (merge.base_hash.empty() ? "Conflict in new file: " : "Conflict in ") + file;
+}
+
+MergeResult threeWayMerge(
+    const std::string &base,
+    const std::string &ours,
+    const std::string &theirs)
+{
+  MergeResult result;
+  std::set<std::string> all_files;
+
+  // Collect all files from the three commit trees
+  std::map<std::string, std::string> base_tree = getCommitTree(base);
+  std::map<std::string, std::string> our_tree = getCommitTree(ours);
+  std::map<std::string, std::string> their_tree = getCommitTree(theirs);
+
+  // Combine all file lists
+  for (const auto &[file, blob_hash] : base_tree)
+  {
+    all_files.insert(file);
+  }
+  for (const auto &[file, blob_hash] : our_tree)
+  {
+    all_files.insert(file);
+  }
+  for (const auto &[file, blob_hash] : their_tree)
+  {
+    all_files.insert(file);
+  }
+
+  // Classify each file by its blob hashes alone. The working tree holds our
+  // version, so a file whose result is ours is neither read nor written, and
+  // the merged tree starts out as ours
+  auto hashIn = [](const std::map<std::string, std::string> &tree, const std::string &file)
+  {
+    auto entry = tree.find(file);
+    return entry == tree.end() ? std::string() : entry->second;
+  };
 
-    if (base_content == our_content) // Their changes
+  std::vector<FileMerge> merges; // files the merge reports on, in path order
+  std::vector<std::size_t> pending;
+  for (const auto &file : all_files)
+  {
+    FileMerge merge(file, hashIn(base_tree, file), hashIn(our_tree, file), hashIn(their_tree, file));
+    if (merge.our_hash == merge.their_hash) // Identical on both sides, or deleted by both
     {
-      ErrorHandler::safeWriteFile(file, their_content);
-      std::cout << "Merged theirs into " << file << std::endl;
       continue;
     }
 
-    if (base_content == their_content) // Our changes
+    if (merge.base_hash == merge.their_hash) // Only we changed it
     {
-      ErrorHandler::safeWriteFile(file, our_content);
-      std::cout << "Kept ours in " << file << std::endl;
-      continue;
+      merge.merged_hash = merge.our_hash;
+      merge.message = merge.base_hash.empty()  ? "New file added by us: " + file
+                      : merge.our_hash.empty() ? "Deleted by us: " + file
+                                               : "Kept ours in " + file;
     }
+    else
+    {
+      pending.push_back(merges.size());
+    }
+    merges.push_back(merge);
+  }
 
-    // Attempt automatic merge before declaring a conflict
-    std::string our_path = ours + "/" + file;
-    std::string their_path = theirs + "/" + file;
+  // Files they changed are read, merged and written concurrently
+  parallelForEach(
+      pending.size(),
+      [&](std::size_t i)
+      {
+        applyFileMerge(merges[pending[i]]);
+      });
 
-    if (attemptAutomaticMerge(our_path, their_path, file))
+  result.merged_tree = std::move(our_tree);
+  for (const auto &merge : merges)
+  {
+    std::cout << merge.message << std::endl;
+    if (merge.conflicted)
     {
-      std::cout << "Successfully auto-merged: " << file << std::endl;
-      continue; // Skip the conflict block
+      result.has_conflicts = true;
+      result.conflicted_files.push_back(merge.path);
+    }
+    else if (merge.merged_hash.empty())
+    {
+      result.merged_tree.erase(merge.path);
+    }
+    else
+    {
+      result.merged_tree[merge.path] = merge.merged_hash;
     }
-
-    // If auto-merge fails, handle as conflict
-    result.has_conflicts = true;
-    result.conflicted_files.push_back(file);
-    writeConflict(file, our_content, their_content);
-    std::cout << "Conflict in " << file << std::endl;
   }
 
   // Finalize merge result
@@ -331,52 +516,15 @@ std::string findMergeBase(
     const std::string &commit1,
     const std::string &commit2)
 {
-  std::string current = commit1;
-  std::set<std::string> visited;
-
-  // Traverse the ancestry of commit1
-  while (!current.empty() && visited.find(current) == visited.end())
-  {
-    // Mark current commit as visited
-    visited.insert(current);
-
-    // Check if current commit is an ancestor of commit2
-    if (isAncestor(current, commit2))
-    {
-      return current;
-    }
-
-    // Move to the parent commit
-    current = getLastCommit(current);
-  }
-
-  return "";
+  // Walk the commit graph instead of re-reading commit logs at every step
+  return graphMergeBase(commit1, commit2);
 }
 
 bool isAncestor(
     const std::string &ancestor,
     const std::string &descendant)
 {
-  std::string current = descendant;
-  std::set<std::string> visited;
-
-  // Traverse the ancestry of descendant
-  while (!current.empty() && visited.find(current) == visited.end())
-  {
-    // Mark current commit as visited
-    visited.insert(current);
-
-    // Check if current commit matches the ancestor
-    if (current == ancestor)
-    {
-      return true;
-    }
-
-    // Move to the parent commit
-    current = getLastCommit(current);
-  }
-
-  return false;
+  return graphIsAncestor(ancestor, descendant);
 }
 
 bool isFastForward(
@@ -445,35 +593,39 @@ bool isMergeInProgress()
 
 void createMergeCommit(
     const std::string &message,
-    const std::vector<std::string> &parents)
+    const std::vector<std::string> &parents,
+    const std::map<std::string, std::string> &tree)
 {
-  // Create a new commit object for the merge commit
+  // Create a new commit log for the merge commit
   std::string commit_hash = generateCommitHash(getCurrentUser(), message, getCurrentTimestamp());
-  std::string commit_dir = ".bittrack/objects/" + commit_hash;
-  ErrorHandler::safeCreateDirectories(commit_dir);
-
-  // Write commit metadata
-  std::string commit_file = commit_dir + "/commit.txt";
-  ErrorHandler::safeWriteFile(
-      commit_file,
-      "commit " + commit_hash + "\n" +
-          "message " + message + "\n" +
-          "timestamp " + getCurrentTimestamp() + "\n" +
-          "author " + getCurrentUser() + "\n");
+  std::string current_branch = getCurrentBranchName();
+
+  std::string content = "Author: " + getCurrentUser() + "\n";
+  content += "Branch: " + current_branch + "\n";
+  content += "Timestamp: " + getCurrentTimestamp() + "\n";
 
   // Write parent commits
   for (const auto &parent : parents)
   {
-    ErrorHandler::safeWriteFile(commit_file, "parent " + parent + "\n");
+    content += "Parent: " + parent + "\n";
   }
+  content += "Message: " + message + "\n";
+  content += "Files: \n";
+
+  // The merged tree already names every blob, so no file is read again
+  for (const auto &[file, blob_hash] : tree)
+  {
+    content += file + " " + blob_hash + "\n";
+  }
+
+  ErrorHandler::safeWriteFile(".bittrack/commits/" + commit_hash, content);
 
   // Update HEAD to point to the new merge commit
-  std::ofstream head_file(".bittrack/refs/heads/" + getCurrentBranchName());
-  head_file << commit_hash << std::endl;
-  head_file.close();
+  ErrorHandler::safeWriteFile(".bittrack/refs/heads/" + current_branch, commit_hash + "\n");
 
-  // Insert commit record into history
-  insertCommitRecordToHistory(commit_hash, getCurrentBranchName());
+  // Insert commit record into history and the commit graph
+  insertCommitRecordToHistory(commit_hash, current_branch);
+  updateCommitGraph(commit_hash);
 
   std::cout << "Created merge commit: " << commit_hash << std::endl;
 }
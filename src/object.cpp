@@ -0,0 +1,689 @@
+#include "../include/object.hpp"
+
+// Loose object layout: "BTOB" | content size u64 little-endian | zlib stream.
+// Objects written before the size was recorded are a bare zlib stream, which
+// never starts with 'B' since its first byte names the deflate method (8)
+static const char BLOB_SIGNATURE[4] = {'B', 'T', 'O', 'B'};
+static const std::size_t BLOB_HEADER_SIZE = 12;
+
+std::string getObjectsDir()
+{
+  return ".bittrack/objects";
+}
+
+std::string getBlobPath(const std::string &blob_hash)
+{
+  // Blobs are fanned out by the first two hex digits of their hash
+  return getObjectsDir() + "/" + blob_hash.substr(0, 2) + "/" + blob_hash.substr(2);
+}
+
+bool blobExists(const std::string &blob_hash)
+{
+  if (blob_hash.length() != SHA256_DIGEST_LENGTH * 2)
+  {
+    return false;
+  }
+
+  return std::filesystem::exists(getBlobPath(blob_hash)) || hasPackedObject(blob_hash);
+}
+
+static int readCompressionLevel()
+{
+  std::string level = configGet("core.compression");
+  if (level.empty())
+  {
+    return static_cast<int>(MZ_DEFAULT_LEVEL);
+  }
+
+  try
+  {
+    int parsed_level = std::stoi(level);
+    if (parsed_level >= MZ_NO_COMPRESSION && parsed_level <= MZ_BEST_COMPRESSION)
+    {
+      return parsed_level;
+    }
+  }
+  catch (const std::exception &)
+  {
+  }
+
+  ErrorHandler::printError(
+      ErrorCode::CONFIG_ERROR,
+      "Invalid core.compression level '" + level + "', expected 0-9; using default",
+      ErrorSeverity::WARNING,
+      "get_compression_level");
+  return static_cast<int>(MZ_DEFAULT_LEVEL);
+}
+
+// core.compression as last read, -1 until it is read
+static std::atomic<int> compression_level{-1};
+
+int getCompressionLevel()
+{
+  // Read core.compression once, it is consulted for every blob
+  int value = compression_level.load();
+  if (value == -1)
+  {
+    value = readCompressionLevel();
+    compression_level = value;
+  }
+  return value;
+}
+
+void resetCompressionLevel()
+{
+  compression_level = -1;
+}
+
+BlobWriter::~BlobWriter()
+{
+  if (deflating)
+  {
+    mz_deflateEnd(&stream);
+  }
+  if (digest != nullptr)
+  {
+    EVP_MD_CTX_free(digest);
+  }
+
+  // An unfinished object never becomes visible
+  if (!temp_path.empty())
+  {
+    file.close();
+    ErrorHandler::safeRemoveFile(temp_path);
+  }
+}
+
+bool openBlobWriter(BlobWriter &writer)
+{
+  static std::atomic<unsigned long> temp_counter{0};
+
+  // Deflate into a temporary file; the final name is only known once the content is hashed
+  ErrorHandler::safeCreateDirectories(getObjectsDir());
+  writer.temp_path = getObjectsDir() + "/tmp_" + std::to_string(getpid()) + "_" + std::to_string(temp_counter++);
+  writer.file.open(writer.temp_path, std::ios::binary | std::ios::trunc);
+  if (!writer.file.is_open())
+  {
+    ErrorHandler::printError(
+        ErrorCode::FILE_WRITE_ERROR,
+        "Unable to create temporary object: " + writer.temp_path,
+        ErrorSeverity::ERROR,
+        "store_blob");
+    writer.temp_path.clear();
+    writer.failed = true;
+    return false;
+  }
+
+  // The size is patched into the header once the content has been written
+  char header[BLOB_HEADER_SIZE] = {};
+  std::memcpy(header, BLOB_SIGNATURE, sizeof(BLOB_SIGNATURE));
+  writer.file.write(header, sizeof(header));
+
+  writer.digest = EVP_MD_CTX_new();
+  EVP_DigestInit_ex(writer.digest, EVP_sha256(), nullptr);
+  writer.deflating = mz_deflateInit(&writer.stream, getCompressionLevel()) == MZ_OK;
+  writer.failed = !writer.deflating;
+  writer.output.resize(64 * 1024);
+  return !writer.failed;
+}
+
+static bool deflateBlobChunk(
+    BlobWriter &writer,
+    const unsigned char *data,
+    std::size_t size,
+    int flush)
+{
+  mz_stream &stream = writer.stream;
+  stream.next_in = data;
+  stream.avail_in = static_cast<unsigned int>(size);
+
+  // Drain the compressor until it stops filling the output buffer
+  do
+  {
+    stream.next_out = writer.output.data();
+    stream.avail_out = static_cast<unsigned int>(writer.output.size());
+    if (mz_deflate(&stream, flush) == MZ_STREAM_ERROR)
+    {
+      writer.failed = true;
+      return false;
+    }
+    writer.file.write(reinterpret_cast<const char *>(writer.output.data()), writer.output.size() - stream.avail_out);
+  } while (stream.avail_out == 0);
+
+  writer.failed = !writer.file.good();
+  return !writer.failed;
+}
+
+bool writeBlobChunk(
+    BlobWriter &writer,
+    const unsigned char *data,
+    std::size_t size)
+{
+  const std::size_t max_chunk = 1 << 30;
+
+  if (writer.failed || !writer.deflating)
+  {
+    return false;
+  }
+
+  // Hash and compress the content chunk by chunk
+  EVP_DigestUpdate(writer.digest, data, size);
+  writer.size += size;
+  for (std::size_t offset = 0; offset < size; offset += max_chunk)
+  {
+    if (!deflateBlobChunk(writer, data + offset, std::min(max_chunk, size - offset), MZ_NO_FLUSH))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::string finishBlobWriter(BlobWriter &writer)
+{
+  if (writer.temp_path.empty())
+  {
+    return "";
+  }
+
+  bool succeeded = !writer.failed && writer.deflating && deflateBlobChunk(writer, nullptr, 0, MZ_FINISH);
+  if (writer.deflating)
+  {
+    mz_deflateEnd(&writer.stream);
+    writer.deflating = false;
+  }
+
+  unsigned char hash[EVP_MAX_MD_SIZE];
+  unsigned int hash_length = 0;
+  EVP_DigestFinal_ex(writer.digest, hash, &hash_length);
+  std::string blob_hash = toHexString(hash, hash_length);
+
+  char size[8];
+  for (std::size_t i = 0; i < sizeof(size); i++)
+  {
+    size[i] = static_cast<char>((writer.size >> (8 * i)) & 0xff);
+  }
+  writer.file.seekp(sizeof(BLOB_SIGNATURE));
+  writer.file.write(size, sizeof(size));
+  writer.file.close();
+  if (!succeeded || writer.file.fail())
+  {
+    ErrorHandler::printError(
+        ErrorCode::FILE_WRITE_ERROR,
+        "Unable to compress blob: " + blob_hash,
+        ErrorSeverity::ERROR,
+        "store_blob");
+    return "";
+  }
+
+  // The blob id is the hash of its content, so identical content is stored once
+  std::string temp_path = writer.temp_path;
+  writer.temp_path.clear();
+  if (writer.loose ? std::filesystem::exists(getBlobPath(blob_hash)) : blobExists(blob_hash))
+  {
+    ErrorHandler::safeRemoveFile(temp_path);
+    return blob_hash;
+  }
+
+  // Rename into place so a partially written blob is never visible
+  std::string blob_path = getBlobPath(blob_hash);
+  ErrorHandler::safeCreateDirectories(std::filesystem::path(blob_path).parent_path());
+  if (!ErrorHandler::safeRename(temp_path, blob_path))
+  {
+    ErrorHandler::printError(
+        ErrorCode::FILE_WRITE_ERROR,
+        "Unable to store blob: " + blob_hash,
+        ErrorSeverity::ERROR,
+        "store_blob");
+    ErrorHandler::safeRemoveFile(temp_path);
+    return "";
+  }
+
+  writer.created = true;
+  return blob_hash;
+}
+
+std::string storeBlobFromStream(std::istream &input)
+{
+  const std::size_t chunk_size = 64 * 1024;
+
+  BlobWriter writer;
+  if (!openBlobWriter(writer))
+  {
+    return "";
+  }
+
+  std::vector<char> buffer(chunk_size);
+  while (input)
+  {
+    input.read(buffer.data(), chunk_size);
+    std::size_t bytes_read = static_cast<std::size_t>(input.gcount());
+    if (!writeBlobChunk(writer, reinterpret_cast<const unsigned char *>(buffer.data()), bytes_read))
+    {
+      break;
+    }
+  }
+  if (input.bad())
+  {
+    writer.failed = true;
+  }
+
+  return finishBlobWriter(writer);
+}
+
+std::string storeBlob(const std::string &content)
+{
+  // Skip compression entirely when the content is already stored
+  std::string blob_hash = sha256Hash(content);
+  if (blobExists(blob_hash))
+  {
+    return blob_hash;
+  }
+
+  std::istringstream input(content);
+  return storeBlobFromStream(input);
+}
+
+std::string storeBlobFromFile(const std::string &file_path)
+{
+  std::ifstream input(file_path, std::ios::binary);
+  if (!input.is_open())
+  {
+    ErrorHandler::printError(
+        ErrorCode::FILE_NOT_FOUND,
+        "Unable to read file: " + file_path,
+        ErrorSeverity::ERROR,
+        "store_blob_from_file");
+    return "";
+  }
+
+  // Stream the file so large files are never held in memory
+  return storeBlobFromStream(input);
+}
+
+BlobReader::~BlobReader()
+{
+  if (inflating)
+  {
+    mz_inflateEnd(&stream);
+  }
+}
+
+bool openBlobReader(
+    const std::string &blob_hash,
+    BlobReader &reader)
+{
+  // Blobs that are not loose may have been moved into a pack by repack
+  reader.file.open(getBlobPath(blob_hash), std::ios::binary);
+  if (!reader.file.is_open())
+  {
+    reader.is_packed = true;
+    uint64_t size = 0;
+    if (!openPackedObject(blob_hash, reader.pack, reader.pack_input, reader.pack_remaining, size, reader.packed))
+    {
+      reader.failed = true;
+      return false;
+    }
+    reader.size = static_cast<int64_t>(size);
+    if (reader.pack_input == nullptr)
+    {
+      return true;
+    }
+  }
+  else
+  {
+    unsigned char header[BLOB_HEADER_SIZE];
+    reader.file.read(reinterpret_cast<char *>(header), sizeof(header));
+    if (reader.file.gcount() == static_cast<std::streamsize>(sizeof(header)) &&
+        std::memcmp(header, BLOB_SIGNATURE, sizeof(BLOB_SIGNATURE)) == 0)
+    {
+      uint64_t size = 0;
+      for (std::size_t i = 0; i < 8; i++)
+      {
+        size |= static_cast<uint64_t>(header[sizeof(BLOB_SIGNATURE) + i]) << (8 * i);
+      }
+      reader.size = static_cast<int64_t>(size);
+    }
+    else
+    {
+      reader.file.clear();
+      reader.file.seekg(0);
+    }
+  }
+
+  if (mz_inflateInit(&reader.stream) != MZ_OK)
+  {
+    reader.failed = true;
+    return false;
+  }
+  reader.inflating = true;
+  if (!reader.is_packed)
+  {
+    reader.input.resize(64 * 1024);
+  }
+  return true;
+}
+
+std::size_t readBlobChunk(
+    BlobReader &reader,
+    unsigned char *buffer,
+    std::size_t size)
+{
+  if (reader.finished || reader.failed || size == 0)
+  {
+    return 0;
+  }
+
+  if (reader.is_packed && reader.pack_input == nullptr)
+  {
+    std::size_t count = std::min(size, reader.packed.size() - reader.packed_offset);
+    std::memcpy(buffer, reader.packed.data() + reader.packed_offset, count);
+    reader.packed_offset += count;
+    reader.finished = reader.packed_offset == reader.packed.size();
+    return count;
+  }
+
+  mz_stream &stream = reader.stream;
+  stream.next_out = buffer;
+  stream.avail_out = static_cast<unsigned int>(std::min<std::size_t>(size, UINT32_MAX));
+  std::size_t capacity = stream.avail_out;
+  while (stream.avail_out > 0)
+  {
+    // Refill the input once the previous chunk is consumed; at end of file the
+    // inflater may still hold buffered output, so keep draining it
+    if (stream.avail_in == 0 && reader.is_packed)
+    {
+      stream.next_in = reader.pack_input;
+      stream.avail_in = static_cast<unsigned int>(std::min<uint64_t>(reader.pack_remaining, UINT32_MAX));
+      reader.pack_input += stream.avail_in;
+      reader.pack_remaining -= stream.avail_in;
+    }
+    else if (stream.avail_in == 0)
+    {
+      reader.file.read(reinterpret_cast<char *>(reader.input.data()), reader.input.size());
+      stream.next_in = reader.input.data();
+      stream.avail_in = static_cast<unsigned int>(reader.file.gcount());
+    }
+
+    int status = mz_inflate(&stream, MZ_NO_FLUSH);
+    if (status == MZ_STREAM_END)
+    {
+      reader.finished = true;
+      break;
+    }
+    if (status != MZ_OK)
+    {
+      // A truncated blob never reaches the end of the deflate stream
+      reader.failed = true;
+      break;
+    }
+  }
+
+  return capacity - stream.avail_out;
+}
+
+bool inflateBlob(
+    const std::string &blob_hash,
+    std::ostream &output)
+{
+  const std::size_t chunk_size = 64 * 1024;
+
+  BlobReader reader;
+  if (!openBlobReader(blob_hash, reader))
+  {
+    return false;
+  }
+
+  // Inflate chunk by chunk straight into the output stream
+  std::vector<unsigned char> buffer(chunk_size);
+  while (std::size_t count = readBlobChunk(reader, buffer.data(), chunk_size))
+  {
+    output.write(reinterpret_cast<const char *>(buffer.data()), count);
+  }
+
+  return !reader.failed && output.good();
+}
+
+std::string readBlob(const std::string &blob_hash)
+{
+  if (!blobExists(blob_hash))
+  {
+    ErrorHandler::printError(
+        ErrorCode::FILE_NOT_FOUND,
+        "Blob not found: " + blob_hash,
+        ErrorSeverity::ERROR,
+        "read_blob");
+    return "";
+  }
+
+  std::ostringstream content;
+  if (!inflateBlob(blob_hash, content))
+  {
+    ErrorHandler::printError(
+        ErrorCode::REPOSITORY_CORRUPTED,
+        "Unable to inflate blob: " + blob_hash,
+        ErrorSeverity::ERROR,
+        "read_blob");
+    return "";
+  }
+
+  return content.str();
+}
+
+int64_t getBlobSize(const std::string &blob_hash)
+{
+  const std::size_t chunk_size = 64 * 1024;
+
+  BlobReader reader;
+  if (!openBlobReader(blob_hash, reader))
+  {
+    return -1;
+  }
+  if (reader.size >= 0)
+  {
+    return reader.size;
+  }
+
+  // Older loose objects carry no size header, so the content is inflated and counted
+  std::vector<unsigned char> buffer(chunk_size);
+  int64_t size = 0;
+  while (std::size_t count = readBlobChunk(reader, buffer.data(), chunk_size))
+  {
+    size += static_cast<int64_t>(count);
+  }
+
+  return reader.failed ? -1 : size;
+}
+
+std::string gitBlobHashStored(const std::string &blob_hash)
+{
+  const std::size_t chunk_size = 64 * 1024;
+
+  // The Git header needs the size up front; objects that do not record it are
+  // read twice rather than held in memory
+  BlobReader reader;
+  if (!openBlobReader(blob_hash, reader))
+  {
+    return "";
+  }
+  int64_t size = reader.size >= 0 ? reader.size : getBlobSize(blob_hash);
+  if (size < 0)
+  {
+    return "";
+  }
+
+  std::string header = "blob " + std::to_string(size);
+  EVP_MD_CTX *digest = EVP_MD_CTX_new();
+  EVP_DigestInit_ex(digest, EVP_sha1(), nullptr);
+  EVP_DigestUpdate(digest, header.c_str(), header.size() + 1);
+
+  std::vector<unsigned char> buffer(chunk_size);
+  int64_t total = 0;
+  while (std::size_t count = readBlobChunk(reader, buffer.data(), chunk_size))
+  {
+    EVP_DigestUpdate(digest, buffer.data(), count);
+    total += static_cast<int64_t>(count);
+  }
+
+  unsigned char hash[EVP_MAX_MD_SIZE];
+  unsigned int hash_length = 0;
+  EVP_DigestFinal_ex(digest, hash, &hash_length);
+  EVP_MD_CTX_free(digest);
+
+  return !reader.failed && total == size ? toHexString(hash, hash_length) : "";
+}
+
+bool loosenBlob(
+    const std::string &blob_hash,
+    std::time_t modified)
+{
+  const std::size_t chunk_size = 64 * 1024;
+
+  std::string blob_path = getBlobPath(blob_hash);
+  if (std::filesystem::exists(blob_path))
+  {
+    return true;
+  }
+
+  BlobReader reader;
+  BlobWriter writer;
+  writer.loose = true;
+  if (!openBlobReader(blob_hash, reader) || !openBlobWriter(writer))
+  {
+    return false;
+  }
+
+  std::vector<unsigned char> buffer(chunk_size);
+  while (std::size_t count = readBlobChunk(reader, buffer.data(), chunk_size))
+  {
+    if (!writeBlobChunk(writer, buffer.data(), count))
+    {
+      break;
+    }
+  }
+  if (reader.failed)
+  {
+    writer.failed = true;
+  }
+  if (finishBlobWriter(writer) != blob_hash)
+  {
+    return false;
+  }
+
+  struct timespec times[2] = {{modified, 0}, {modified, 0}};
+  utimensat(AT_FDCWD, blob_path.c_str(), times, 0);
+  return true;
+}
+
+bool restoreBlobToFile(
+    const std::string &blob_hash,
+    const std::string &file_path)
+{
+  if (!blobExists(blob_hash))
+  {
+    ErrorHandler::printError(
+        ErrorCode::FILE_NOT_FOUND,
+        "Blob not found: " + blob_hash,
+        ErrorSeverity::ERROR,
+        "restore_blob_to_file");
+    return false;
+  }
+
+  std::filesystem::path target(file_path);
+  if (!target.parent_path().empty())
+  {
+    ErrorHandler::safeCreateDirectories(target.parent_path());
+  }
+
+  // Inflate directly into the working file instead of buffering the content
+  std::ofstream output(target, std::ios::binary | std::ios::trunc);
+  if (!output.is_open() || !inflateBlob(blob_hash, output))
+  {
+    ErrorHandler::printError(
+        ErrorCode::FILE_WRITE_ERROR,
+        "Unable to restore blob " + blob_hash + " to " + file_path,
+        ErrorSeverity::ERROR,
+        "restore_blob_to_file");
+    return false;
+  }
+
+  return true;
+}
+
+std::size_t migrateLegacyObjects()
+{
+  // Older repositories copied every file to .bittrack/objects/<commit>/<path>;
+  // their commit logs already name each file by the SHA-256 of its content,
+  // which is the blob hash, so storing the copies as blobs is enough
+  std::error_code error;
+  std::vector<std::filesystem::path> legacy_dirs;
+  for (const auto &entry : std::filesystem::directory_iterator(getObjectsDir(), error))
+  {
+    std::string name = entry.path().filename().string();
+    if (name.size() == SHA256_DIGEST_LENGTH * 2 &&
+        std::all_of(name.begin(), name.end(), [](unsigned char c)
+                    { return std::isxdigit(c) != 0; }) &&
+        entry.is_directory(error))
+    {
+      legacy_dirs.push_back(entry.path());
+    }
+  }
+  if (legacy_dirs.empty())
+  {
+    return 0;
+  }
+
+  std::size_t migrated = 0;
+  for (const auto &legacy_dir : legacy_dirs)
+  {
+    bool complete = true;
+    std::error_code walk_error;
+    for (const auto &entry : std::filesystem::recursive_directory_iterator(legacy_dir, walk_error))
+    {
+      if (!entry.is_regular_file(walk_error))
+      {
+        continue;
+      }
+      if (storeBlobFromFile(entry.path().string()).empty())
+      {
+        complete = false;
+      }
+      else
+      {
+        migrated++;
+      }
+    }
+
+    // A directory is only dropped once every copy in it is a blob
+    if (complete && !walk_error)
+    {
+      std::filesystem::remove_all(legacy_dir, walk_error);
+    }
+  }
+
+  // The old layout never wrote empty files, but commits still list them
+  storeBlob("");
+  std::cout << "Migrated " << migrated << " files from " << legacy_dirs.size() << " commit snapshots to the blob store" << std::endl;
+  return migrated;
+}
+
+std::vector<std::string> listBlobs()
+{
+  // Rebuild each blob hash from its fan-out directory and file name
+  std::vector<std::string> blobs;
+  for (const auto &entry : ErrorHandler::safeListDirectoryFiles(getObjectsDir()))
+  {
+    std::string blob_hash = entry.parent_path().string() + entry.filename().string();
+    if (blob_hash.length() == SHA256_DIGEST_LENGTH * 2)
+    {
+      blobs.push_back(blob_hash);
+    }
+  }
+
+  // A blob may be both loose and packed while a repack is in progress
+  std::vector<std::string> packed_blobs = listPackedObjects();
+  blobs.insert(blobs.end(), packed_blobs.begin(), packed_blobs.end());
+  std::sort(blobs.begin(), blobs.end());
+  blobs.erase(std::unique(blobs.begin(), blobs.end()), blobs.end());
+  return blobs;
+}
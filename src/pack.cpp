@@ -0,0 +1,1132 @@
+#include "../include/pack.hpp"
+
+// Pack layout (all integers little-endian):
+//   "BTPK" | version u32 | object count u32
+//   per object: kind u8 | payload size u64 | base offset u64 (deltas only) |
+//               stored size u64 | deflated payload
+//   trailing SHA-256 of everything before it
+// Index layout:
+//   "BTPI" | version u32 | object count u32 | fan-out u32[256]
+//   per object, sorted by hash: hash (32) | pack offset u64
+//   SHA-256 of the pack | trailing SHA-256 of everything before it
+static const char PACK_SIGNATURE[4] = {'B', 'T', 'P', 'K'};
+static const char PACK_INDEX_SIGNATURE[4] = {'B', 'T', 'P', 'I'};
+static const uint32_t PACK_VERSION = 1;
+static const std::size_t PACK_HEADER_SIZE = 12;
+static const std::size_t PACK_INDEX_HEADER_SIZE = 12 + 256 * 4;
+static const std::size_t PACK_INDEX_RECORD_SIZE = SHA256_DIGEST_LENGTH + 8;
+
+// Object kinds; a delta payload rebuilds the object from an earlier object in the same pack
+static const uint8_t PACK_OBJECT_FULL = 0;
+static const uint8_t PACK_OBJECT_DELTA = 1;
+
+// Delta search: candidates considered per object, longest chain a reader
+// has to follow, and objects too large to be held in memory for packing
+static const std::size_t PACK_WINDOW = 10;
+static const int PACK_MAX_DEPTH = 50;
+static const std::size_t PACK_MAX_DELTA_SOURCE = 64 * 1024 * 1024;
+static const std::size_t PACK_MAX_OBJECT_SIZE = 1024 * 1024 * 1024;
+
+// Delta instructions, and the block size used to find matching base ranges
+static const uint8_t DELTA_INSERT = 0;
+static const uint8_t DELTA_COPY = 1;
+static const std::size_t DELTA_BLOCK_SIZE = 16;
+static const uint32_t DELTA_HASH_MULTIPLIER = 0x01000193;
+
+// Packs are loaded once per repository and shared by all threads
+static std::mutex pack_files_mutex;
+static bool pack_files_loaded = false;
+static std::string pack_files_root;
+static std::vector<std::shared_ptr<const PackFile>> pack_files;
+
+template <typename T>
+static void appendInteger(std::string &buffer, T value)
+{
+  for (std::size_t i = 0; i < sizeof(T); i++)
+  {
+    buffer.push_back(static_cast<char>((static_cast<uint64_t>(value) >> (8 * i)) & 0xff));
+  }
+}
+
+template <typename T>
+static T readInteger(const unsigned char *data)
+{
+  uint64_t result = 0;
+  for (std::size_t i = 0; i < sizeof(T); i++)
+  {
+    result |= static_cast<uint64_t>(data[i]) << (8 * i);
+  }
+  return static_cast<T>(result);
+}
+
+static void appendVarint(std::string &buffer, uint64_t value)
+{
+  while (value >= 0x80)
+  {
+    buffer.push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  buffer.push_back(static_cast<char>(value));
+}
+
+static bool readVarint(
+    const std::string &buffer,
+    std::size_t &offset,
+    uint64_t &value)
+{
+  value = 0;
+  for (int shift = 0; offset < buffer.size() && shift < 64; shift += 7)
+  {
+    uint8_t byte = static_cast<uint8_t>(buffer[offset++]);
+    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool hashToBytes(
+    const std::string &blob_hash,
+    unsigned char *bytes)
+{
+  if (blob_hash.size() != SHA256_DIGEST_LENGTH * 2 ||
+      blob_hash.find_first_not_of("0123456789abcdef") != std::string::npos)
+  {
+    return false;
+  }
+
+  auto nibble = [](char digit)
+  { return digit <= '9' ? digit - '0' : digit - 'a' + 10; };
+  for (std::size_t i = 0; i < SHA256_DIGEST_LENGTH; i++)
+  {
+    bytes[i] = static_cast<unsigned char>((nibble(blob_hash[2 * i]) << 4) | nibble(blob_hash[2 * i + 1]));
+  }
+  return true;
+}
+
+std::string getPackDir()
+{
+  return getObjectsDir() + "/pack";
+}
+
+PackFile::~PackFile()
+{
+  if (pack_data != nullptr)
+  {
+    munmap(const_cast<unsigned char *>(pack_data), pack_size);
+  }
+  if (idx_data != nullptr)
+  {
+    munmap(const_cast<unsigned char *>(idx_data), idx_size);
+  }
+}
+
+static const unsigned char *mapFile(
+    const std::string &path,
+    std::size_t &size)
+{
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    return nullptr;
+  }
+
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0)
+  {
+    close(fd);
+    return nullptr;
+  }
+
+  size = static_cast<std::size_t>(file_stat.st_size);
+  void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  return mapping == MAP_FAILED ? nullptr : static_cast<const unsigned char *>(mapping);
+}
+
+static std::shared_ptr<const PackFile> loadPackFile(const std::string &idx_path)
+{
+  auto pack = std::make_shared<PackFile>();
+  pack->pack_path = idx_path.substr(0, idx_path.size() - 4) + ".pack";
+  pack->idx_data = mapFile(idx_path, pack->idx_size);
+  pack->pack_data = mapFile(pack->pack_path, pack->pack_size);
+
+  // Check both headers, the table size and that the index belongs to this
+  // pack; full checksums are left to fsck so opening a pack stays cheap
+  bool valid = pack->idx_data != nullptr && pack->pack_data != nullptr &&
+               pack->idx_size >= PACK_INDEX_HEADER_SIZE + 2 * SHA256_DIGEST_LENGTH &&
+               pack->pack_size >= PACK_HEADER_SIZE + SHA256_DIGEST_LENGTH &&
+               std::memcmp(pack->idx_data, PACK_INDEX_SIGNATURE, sizeof(PACK_INDEX_SIGNATURE)) == 0 &&
+               std::memcmp(pack->pack_data, PACK_SIGNATURE, sizeof(PACK_SIGNATURE)) == 0 &&
+               readInteger<uint32_t>(pack->idx_data + 4) == PACK_VERSION &&
+               readInteger<uint32_t>(pack->pack_data + 4) == PACK_VERSION;
+  if (valid)
+  {
+    pack->count = readInteger<uint32_t>(pack->idx_data + 8);
+    valid = readInteger<uint32_t>(pack->pack_data + 8) == pack->count &&
+            pack->idx_size == PACK_INDEX_HEADER_SIZE + static_cast<std::size_t>(pack->count) * PACK_INDEX_RECORD_SIZE + 2 * SHA256_DIGEST_LENGTH &&
+            readInteger<uint32_t>(pack->idx_data + PACK_INDEX_HEADER_SIZE - 4) == pack->count &&
+            std::memcmp(pack->pack_data + pack->pack_size - SHA256_DIGEST_LENGTH,
+                        pack->idx_data + pack->idx_size - 2 * SHA256_DIGEST_LENGTH,
+                        SHA256_DIGEST_LENGTH) == 0;
+  }
+
+  if (!valid)
+  {
+    ErrorHandler::printError(
+        ErrorCode::REPOSITORY_CORRUPTED,
+        "Pack is invalid, ignoring " + pack->pack_path,
+        ErrorSeverity::WARNING,
+        "load_pack_file");
+    return nullptr;
+  }
+  return pack;
+}
+
+std::vector<std::shared_ptr<const PackFile>> getPackFiles()
+{
+  std::lock_guard<std::mutex> lock(pack_files_mutex);
+  std::error_code error;
+  std::string root = std::filesystem::current_path(error).string();
+  if (!pack_files_loaded || root != pack_files_root)
+  {
+    pack_files.clear();
+    pack_files_root = root;
+    std::vector<std::string> idx_paths;
+    for (const auto &entry : std::filesystem::directory_iterator(getPackDir(), error))
+    {
+      if (entry.path().extension() == ".idx")
+      {
+        idx_paths.push_back(entry.path().string());
+      }
+    }
+    std::sort(idx_paths.begin(), idx_paths.end());
+
+    for (const auto &idx_path : idx_paths)
+    {
+      std::shared_ptr<const PackFile> pack = loadPackFile(idx_path);
+      if (pack)
+      {
+        pack_files.push_back(pack);
+      }
+    }
+    pack_files_loaded = true;
+  }
+
+  return pack_files;
+}
+
+void resetPackFiles()
+{
+  std::lock_guard<std::mutex> lock(pack_files_mutex);
+  pack_files.clear();
+  pack_files_loaded = false;
+}
+
+static const unsigned char *getPackRecord(
+    const PackFile &pack,
+    uint32_t position)
+{
+  return pack.idx_data + PACK_INDEX_HEADER_SIZE + static_cast<std::size_t>(position) * PACK_INDEX_RECORD_SIZE;
+}
+
+static int64_t findPackRecord(
+    const PackFile &pack,
+    const unsigned char *key)
+{
+  // The fan-out table narrows the search to hashes sharing the first byte
+  uint32_t low = key[0] == 0 ? 0 : readInteger<uint32_t>(pack.idx_data + 12 + 4 * (key[0] - 1));
+  uint32_t high = readInteger<uint32_t>(pack.idx_data + 12 + 4 * key[0]);
+  while (low < high)
+  {
+    uint32_t middle = low + (high - low) / 2;
+    int order = std::memcmp(getPackRecord(pack, middle), key, SHA256_DIGEST_LENGTH);
+    if (order == 0)
+    {
+      return middle;
+    }
+    if (order < 0)
+    {
+      low = middle + 1;
+    }
+    else
+    {
+      high = middle;
+    }
+  }
+  return -1;
+}
+
+static bool readPackEntry(
+    const PackFile &pack,
+    uint64_t offset,
+    std::string &content,
+    int depth)
+{
+  // Entries live between the header and the trailing checksum
+  std::size_t end = pack.pack_size - SHA256_DIGEST_LENGTH;
+  if (offset < PACK_HEADER_SIZE || offset + 17 > end || depth > PACK_MAX_DEPTH)
+  {
+    return false;
+  }
+
+  const unsigned char *entry = pack.pack_data + offset;
+  uint8_t kind = entry[0];
+  uint64_t payload_size = readInteger<uint64_t>(entry + 1);
+  std::size_t position = 9;
+  uint64_t base_offset = 0;
+  if (kind == PACK_OBJECT_DELTA)
+  {
+    if (offset + position + 16 > end)
+    {
+      return false;
+    }
+    base_offset = readInteger<uint64_t>(entry + position);
+    position += 8;
+  }
+  else if (kind != PACK_OBJECT_FULL)
+  {
+    return false;
+  }
+  uint64_t stored_size = readInteger<uint64_t>(entry + position);
+  position += 8;
+  if (stored_size > end - offset - position || payload_size > PACK_MAX_OBJECT_SIZE)
+  {
+    return false;
+  }
+
+  std::string payload(payload_size, '\0');
+  if (payload_size > 0)
+  {
+    mz_ulong inflated_size = static_cast<mz_ulong>(payload_size);
+    if (mz_uncompress(reinterpret_cast<unsigned char *>(&payload[0]), &inflated_size, entry + position, static_cast<mz_ulong>(stored_size)) != MZ_OK ||
+        inflated_size != payload_size)
+    {
+      return false;
+    }
+  }
+
+  if (kind == PACK_OBJECT_FULL)
+  {
+    content = std::move(payload);
+    return true;
+  }
+
+  // Bases are always written before the deltas that refer to them
+  std::string base;
+  return base_offset < offset &&
+         readPackEntry(pack, base_offset, base, depth + 1) &&
+         applyDelta(base, payload, content);
+}
+
+bool hasPackedObject(const std::string &blob_hash)
+{
+  unsigned char key[SHA256_DIGEST_LENGTH];
+  if (!hashToBytes(blob_hash, key))
+  {
+    return false;
+  }
+
+  for (const auto &pack : getPackFiles())
+  {
+    if (findPackRecord(*pack, key) >= 0)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::time_t getPackedObjectTime(const std::string &blob_hash)
+{
+  unsigned char key[SHA256_DIGEST_LENGTH];
+  if (!hashToBytes(blob_hash, key))
+  {
+    return 0;
+  }
+
+  std::time_t newest = 0;
+  for (const auto &pack : getPackFiles())
+  {
+    struct stat pack_stat;
+    if (findPackRecord(*pack, key) >= 0 && stat(pack->pack_path.c_str(), &pack_stat) == 0)
+    {
+      newest = std::max(newest, pack_stat.st_mtime);
+    }
+  }
+  return newest;
+}
+
+bool readPackedObject(
+    const std::string &blob_hash,
+    std::string &content)
+{
+  unsigned char key[SHA256_DIGEST_LENGTH];
+  if (!hashToBytes(blob_hash, key))
+  {
+    return false;
+  }
+
+  for (const auto &pack : getPackFiles())
+  {
+    int64_t position = findPackRecord(*pack, key);
+    if (position >= 0)
+    {
+      uint64_t offset = readInteger<uint64_t>(getPackRecord(*pack, static_cast<uint32_t>(position)) + SHA256_DIGEST_LENGTH);
+      return readPackEntry(*pack, offset, content, 0);
+    }
+  }
+  return false;
+}
+
+bool openPackedObject(
+    const std::string &blob_hash,
+    std::shared_ptr<const PackFile> &pack,
+    const unsigned char *&deflated,
+    uint64_t &deflated_size,
+    uint64_t &content_size,
+    std::string &content)
+{
+  unsigned char key[SHA256_DIGEST_LENGTH];
+  if (!hashToBytes(blob_hash, key))
+  {
+    return false;
+  }
+
+  for (const auto &candidate : getPackFiles())
+  {
+    int64_t position = findPackRecord(*candidate, key);
+    if (position < 0)
+    {
+      continue;
+    }
+
+    // A delta is rebuilt in memory, which bounds it to the delta target size
+    uint64_t offset = readInteger<uint64_t>(getPackRecord(*candidate, static_cast<uint32_t>(position)) + SHA256_DIGEST_LENGTH);
+    std::size_t end = candidate->pack_size - SHA256_DIGEST_LENGTH;
+    if (offset < PACK_HEADER_SIZE || offset + 17 > end || candidate->pack_data[offset] != PACK_OBJECT_FULL)
+    {
+      deflated = nullptr;
+      bool rebuilt = readPackEntry(*candidate, offset, content, 0);
+      content_size = content.size();
+      return rebuilt;
+    }
+
+    // A whole object is handed back as its deflated bytes inside the mapping
+    deflated_size = readInteger<uint64_t>(candidate->pack_data + offset + 9);
+    if (deflated_size > end - offset - 17)
+    {
+      return false;
+    }
+    pack = candidate;
+    content_size = readInteger<uint64_t>(candidate->pack_data + offset + 1);
+    deflated = candidate->pack_data + offset + 17;
+    return true;
+  }
+  return false;
+}
+
+std::vector<std::string> listPackedObjects()
+{
+  std::vector<std::string> blobs;
+  for (const auto &pack : getPackFiles())
+  {
+    for (uint32_t position = 0; position < pack->count; position++)
+    {
+      unsigned char key[SHA256_DIGEST_LENGTH];
+      std::memcpy(key, getPackRecord(*pack, position), SHA256_DIGEST_LENGTH);
+      blobs.push_back(toHexString(key, SHA256_DIGEST_LENGTH));
+    }
+  }
+  return blobs;
+}
+
+static uint32_t hashDeltaBlock(const unsigned char *data)
+{
+  uint32_t hash = 0;
+  for (std::size_t i = 0; i < DELTA_BLOCK_SIZE; i++)
+  {
+    hash = hash * DELTA_HASH_MULTIPLIER + data[i];
+  }
+  return hash;
+}
+
+static void indexDeltaBase(
+    const std::string &base,
+    std::unordered_map<uint32_t, uint32_t> &blocks)
+{
+  // Fingerprint the base at block boundaries; the first occurrence of a block wins
+  const unsigned char *data = reinterpret_cast<const unsigned char *>(base.data());
+  blocks.reserve(base.size() / DELTA_BLOCK_SIZE);
+  for (std::size_t offset = 0; offset + DELTA_BLOCK_SIZE <= base.size(); offset += DELTA_BLOCK_SIZE)
+  {
+    blocks.emplace(hashDeltaBlock(data + offset), static_cast<uint32_t>(offset));
+  }
+}
+
+static void appendDeltaInsert(
+    std::string &delta,
+    const std::string &target,
+    std::size_t start,
+    std::size_t end)
+{
+  if (end > start)
+  {
+    delta.push_back(static_cast<char>(DELTA_INSERT));
+    appendVarint(delta, end - start);
+    delta.append(target, start, end - start);
+  }
+}
+
+static std::string createIndexedDelta(
+    const std::string &base,
+    const std::unordered_map<uint32_t, uint32_t> &blocks,
+    const std::string &target,
+    std::size_t max_size)
+{
+  std::string delta;
+  appendVarint(delta, base.size());
+  appendVarint(delta, target.size());
+
+  const unsigned char *base_data = reinterpret_cast<const unsigned char *>(base.data());
+  const unsigned char *target_data = reinterpret_cast<const unsigned char *>(target.data());
+
+  // Multiplier raised to the block size, used to drop the byte leaving the rolling window
+  uint32_t leaving_factor = 1;
+  for (std::size_t i = 0; i < DELTA_BLOCK_SIZE; i++)
+  {
+    leaving_factor *= DELTA_HASH_MULTIPLIER;
+  }
+
+  // Slide a block-sized window over the target; when it matches a base block,
+  // grow the match in both directions and emit it as a copy
+  std::size_t insert_start = 0;
+  std::size_t position = 0;
+  uint32_t hash = target.size() >= DELTA_BLOCK_SIZE ? hashDeltaBlock(target_data) : 0;
+  while (!blocks.empty() && position + DELTA_BLOCK_SIZE <= target.size())
+  {
+    auto block = blocks.find(hash);
+    if (block != blocks.end() && std::memcmp(base_data + block->second, target_data + position, DELTA_BLOCK_SIZE) == 0)
+    {
+      std::size_t base_start = block->second;
+      std::size_t target_start = position;
+      while (target_start > insert_start && base_start > 0 && base_data[base_start - 1] == target_data[target_start - 1])
+      {
+        base_start--;
+        target_start--;
+      }
+
+      std::size_t length = position + DELTA_BLOCK_SIZE - target_start;
+      while (base_start + length < base.size() && target_start + length < target.size() &&
+             base_data[base_start + length] == target_data[target_start + length])
+      {
+        length++;
+      }
+
+      appendDeltaInsert(delta, target, insert_start, target_start);
+      delta.push_back(static_cast<char>(DELTA_COPY));
+      appendVarint(delta, base_start);
+      appendVarint(delta, length);
+      if (delta.size() > max_size)
+      {
+        return "";
+      }
+
+      position = target_start + length;
+      insert_start = position;
+      if (position + DELTA_BLOCK_SIZE <= target.size())
+      {
+        hash = hashDeltaBlock(target_data + position);
+      }
+      continue;
+    }
+
+    if (position + DELTA_BLOCK_SIZE < target.size())
+    {
+      hash = hash * DELTA_HASH_MULTIPLIER + target_data[position + DELTA_BLOCK_SIZE] - leaving_factor * target_data[position];
+    }
+    position++;
+
+    // Pending literal bytes count against the budget too
+    if (delta.size() + (position - insert_start) > max_size)
+    {
+      return "";
+    }
+  }
+
+  appendDeltaInsert(delta, target, insert_start, target.size());
+  return delta.size() > max_size ? "" : delta;
+}
+
+std::string createDelta(
+    const std::string &base,
+    const std::string &target,
+    std::size_t max_size)
+{
+  std::unordered_map<uint32_t, uint32_t> blocks;
+  indexDeltaBase(base, blocks);
+  return createIndexedDelta(base, blocks, target, max_size);
+}
+
+bool applyDelta(
+    const std::string &base,
+    const std::string &delta,
+    std::string &result)
+{
+  std::size_t offset = 0;
+  uint64_t base_size = 0;
+  uint64_t result_size = 0;
+  if (!readVarint(delta, offset, base_size) || !readVarint(delta, offset, result_size) ||
+      base_size != base.size() || result_size > PACK_MAX_OBJECT_SIZE)
+  {
+    return false;
+  }
+
+  result.clear();
+  result.reserve(result_size);
+  while (offset < delta.size())
+  {
+    uint8_t instruction = static_cast<uint8_t>(delta[offset++]);
+    uint64_t length = 0;
+    if (instruction == DELTA_INSERT)
+    {
+      if (!readVarint(delta, offset, length) || length > delta.size() - offset)
+      {
+        return false;
+      }
+      result.append(delta, offset, length);
+      offset += length;
+    }
+    else if (instruction == DELTA_COPY)
+    {
+      uint64_t copy_offset = 0;
+      if (!readVarint(delta, offset, copy_offset) || !readVarint(delta, offset, length) ||
+          copy_offset > base.size() || length > base.size() - copy_offset)
+      {
+        return false;
+      }
+      result.append(base, copy_offset, length);
+    }
+    else
+    {
+      return false;
+    }
+
+    if (result.size() > result_size)
+    {
+      return false;
+    }
+  }
+
+  return result.size() == result_size;
+}
+
+// An object recently written to the pack, kept as a delta base candidate
+struct PackWindowEntry
+{
+  std::string content;                          // full object content
+  std::unordered_map<uint32_t, uint32_t> blocks; // block fingerprints of the content
+  uint64_t offset;                              // where the object starts in the pack
+  int depth;                                    // deltas to follow before reaching a full object
+
+  PackWindowEntry() : offset(0), depth(0) {}
+};
+
+static bool readObjectForPacking(
+    const std::string &blob_hash,
+    std::string &content)
+{
+  std::ostringstream stream;
+  if (!inflateBlob(blob_hash, stream))
+  {
+    return false;
+  }
+  content = stream.str();
+  return true;
+}
+
+static bool appendPackEntry(
+    std::ofstream &pack_stream,
+    uint8_t kind,
+    uint64_t base_offset,
+    const std::string &payload,
+    uint64_t &written)
+{
+  mz_ulong stored_size = mz_compressBound(static_cast<mz_ulong>(payload.size()));
+  std::vector<unsigned char> stored(stored_size);
+  if (mz_compress2(stored.data(), &stored_size, reinterpret_cast<const unsigned char *>(payload.data()),
+                   static_cast<mz_ulong>(payload.size()), getCompressionLevel()) != MZ_OK)
+  {
+    return false;
+  }
+
+  std::string header;
+  header.push_back(static_cast<char>(kind));
+  appendInteger(header, static_cast<uint64_t>(payload.size()));
+  if (kind == PACK_OBJECT_DELTA)
+  {
+    appendInteger(header, base_offset);
+  }
+  appendInteger(header, static_cast<uint64_t>(stored_size));
+
+  pack_stream.write(header.data(), header.size());
+  pack_stream.write(reinterpret_cast<const char *>(stored.data()), stored_size);
+  written += header.size() + stored_size;
+  return pack_stream.good();
+}
+
+static bool hashFileContent(
+    const std::string &path,
+    unsigned char *digest)
+{
+  std::ifstream input(path, std::ios::binary);
+  if (!input.is_open())
+  {
+    return false;
+  }
+
+  EVP_MD_CTX *context = EVP_MD_CTX_new();
+  EVP_DigestInit_ex(context, EVP_sha256(), nullptr);
+  std::vector<char> buffer(64 * 1024);
+  while (input.read(buffer.data(), buffer.size()) || input.gcount() > 0)
+  {
+    EVP_DigestUpdate(context, buffer.data(), static_cast<std::size_t>(input.gcount()));
+  }
+  unsigned int digest_length = 0;
+  EVP_DigestFinal_ex(context, digest, &digest_length);
+  EVP_MD_CTX_free(context);
+  return !input.bad();
+}
+
+// Writes the objects as a pack at pack_path: header, entries and trailing
+// checksum. records gets each object's key and offset and packed the hashes
+// written; objects too large to pack are left out
+static bool writePackContent(
+    const std::vector<PackObject> &objects,
+    const std::string &pack_path,
+    std::vector<std::pair<std::string, uint64_t>> &records,
+    std::unordered_set<std::string> &packed,
+    unsigned char *pack_digest,
+    PackStats &stats)
+{
+  std::ofstream pack_stream(pack_path, std::ios::binary | std::ios::trunc);
+  if (!pack_stream.is_open())
+  {
+    ErrorHandler::printError(
+        ErrorCode::FILE_WRITE_ERROR,
+        "Unable to create pack: " + pack_path,
+        ErrorSeverity::ERROR,
+        "write_pack");
+    return false;
+  }
+
+  // The object count is patched in once every object has been written
+  std::string header(PACK_SIGNATURE, sizeof(PACK_SIGNATURE));
+  appendInteger(header, PACK_VERSION);
+  appendInteger(header, static_cast<uint32_t>(0));
+  pack_stream.write(header.data(), header.size());
+  uint64_t written = header.size();
+
+  // Revisions of one path sit next to each other, in the order the caller
+  // gave them (newest first), so recent content is stored whole and older
+  // revisions become deltas against it
+  std::vector<const PackObject *> ordered;
+  for (const auto &object : objects)
+  {
+    ordered.push_back(&object);
+  }
+  std::stable_sort(
+      ordered.begin(),
+      ordered.end(),
+      [](const PackObject *a, const PackObject *b)
+      { return a->path_hint < b->path_hint; });
+
+  std::vector<std::unique_ptr<PackWindowEntry>> window;
+  bool succeeded = true;
+  for (const PackObject *object : ordered)
+  {
+    unsigned char key[SHA256_DIGEST_LENGTH];
+    if (!hashToBytes(object->hash, key) || !packed.insert(object->hash).second)
+    {
+      continue;
+    }
+
+    std::string content;
+    if (!readObjectForPacking(object->hash, content))
+    {
+      ErrorHandler::printError(
+          ErrorCode::REPOSITORY_CORRUPTED,
+          "Unable to read object for packing: " + object->hash,
+          ErrorSeverity::ERROR,
+          "write_pack");
+      succeeded = false;
+      break;
+    }
+
+    // Objects too large to pack stay loose
+    if (content.size() > PACK_MAX_OBJECT_SIZE)
+    {
+      packed.erase(object->hash);
+      continue;
+    }
+
+    // Try every recent object as a base and keep the smallest delta, which
+    // must save at least half of the object to be worth the extra reads.
+    // Readers rebuild a delta in memory, so large objects are always stored whole
+    std::string best_delta;
+    const PackWindowEntry *best_base = nullptr;
+    for (auto candidate = window.rbegin(); candidate != window.rend(); ++candidate)
+    {
+      const PackWindowEntry &base = **candidate;
+      if (base.depth >= PACK_MAX_DEPTH || base.blocks.empty() || content.size() < DELTA_BLOCK_SIZE * 4 ||
+          content.size() > PACK_MAX_DELTA_SOURCE)
+      {
+        continue;
+      }
+
+      std::size_t budget = best_base != nullptr ? best_delta.size() - 1 : content.size() / 2;
+      std::string delta = createIndexedDelta(base.content, base.blocks, content, budget);
+      if (!delta.empty())
+      {
+        best_delta = std::move(delta);
+        best_base = &base;
+      }
+    }
+
+    uint64_t offset = written;
+    int depth = best_base != nullptr ? best_base->depth + 1 : 0;
+    records.push_back({std::string(reinterpret_cast<char *>(key), SHA256_DIGEST_LENGTH), written});
+    if (best_base != nullptr)
+    {
+      succeeded = appendPackEntry(pack_stream, PACK_OBJECT_DELTA, best_base->offset, best_delta, written);
+      stats.delta_count++;
+    }
+    else
+    {
+      succeeded = appendPackEntry(pack_stream, PACK_OBJECT_FULL, 0, content, written);
+    }
+    if (!succeeded)
+    {
+      break;
+    }
+
+    // Only objects small enough to serve as a delta base are kept in the
+    // window, which bounds it to PACK_WINDOW * PACK_MAX_DELTA_SOURCE bytes
+    if (content.size() > PACK_MAX_DELTA_SOURCE)
+    {
+      continue;
+    }
+    auto entry = std::make_unique<PackWindowEntry>();
+    entry->offset = offset;
+    entry->depth = depth;
+    indexDeltaBase(content, entry->blocks);
+    entry->content = std::move(content);
+    window.push_back(std::move(entry));
+    if (window.size() > PACK_WINDOW)
+    {
+      window.erase(window.begin());
+    }
+  }
+  window.clear();
+
+  // Patch the count, then append the checksum of the finished pack
+  std::string count;
+  appendInteger(count, static_cast<uint32_t>(records.size()));
+  pack_stream.seekp(8);
+  pack_stream.write(count.data(), count.size());
+  pack_stream.close();
+
+  if (succeeded)
+  {
+    succeeded = !pack_stream.fail() && hashFileContent(pack_path, pack_digest);
+  }
+  if (succeeded)
+  {
+    std::ofstream trailer(pack_path, std::ios::binary | std::ios::app);
+    trailer.write(reinterpret_cast<char *>(pack_digest), SHA256_DIGEST_LENGTH);
+    trailer.close();
+    succeeded = !trailer.fail();
+  }
+  if (!succeeded)
+  {
+    ErrorHandler::safeRemoveFile(pack_path);
+    return false;
+  }
+
+  stats.object_count = records.size();
+  stats.pack_size = written + SHA256_DIGEST_LENGTH;
+  return true;
+}
+
+// Flush a file or directory to disk
+static bool syncPackPath(const std::string &path)
+{
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    return false;
+  }
+
+  bool synced = fsync(fd) == 0;
+  close(fd);
+  return synced;
+}
+
+// Writes the index of a finished pack and moves both into the pack directory
+// under the name derived from the pack checksum
+static bool installPackIndex(
+    const std::string &temp_pack_path,
+    std::vector<std::pair<std::string, uint64_t>> &records,
+    const unsigned char *pack_digest,
+    std::string &pack_name,
+    std::size_t &index_size)
+{
+  // Build the index: fan-out counts, then the records sorted by hash
+  std::sort(records.begin(), records.end());
+  std::string index(PACK_INDEX_SIGNATURE, sizeof(PACK_INDEX_SIGNATURE));
+  appendInteger(index, PACK_VERSION);
+  appendInteger(index, static_cast<uint32_t>(records.size()));
+  std::size_t record = 0;
+  for (uint32_t first_byte = 0; first_byte < 256; first_byte++)
+  {
+    while (record < records.size() && static_cast<unsigned char>(records[record].first[0]) <= first_byte)
+    {
+      record++;
+    }
+    appendInteger(index, static_cast<uint32_t>(record));
+  }
+  for (const auto &[key, offset] : records)
+  {
+    index += key;
+    appendInteger(index, offset);
+  }
+  index.append(reinterpret_cast<const char *>(pack_digest), SHA256_DIGEST_LENGTH);
+  unsigned char index_digest[SHA256_DIGEST_LENGTH];
+  SHA256(reinterpret_cast<const unsigned char *>(index.data()), index.size(), index_digest);
+  index.append(reinterpret_cast<char *>(index_digest), SHA256_DIGEST_LENGTH);
+  index_size = index.size();
+
+  // Install the pack before its index: readers only look for packs through their index
+  unsigned char name_digest[SHA256_DIGEST_LENGTH];
+  std::memcpy(name_digest, pack_digest, SHA256_DIGEST_LENGTH);
+  pack_name = getPackDir() + "/pack-" + toHexString(name_digest, SHA256_DIGEST_LENGTH);
+  std::string temp_index_path = pack_name + ".idx.tmp";
+  std::ofstream index_stream(temp_index_path, std::ios::binary | std::ios::trunc);
+  index_stream.write(index.data(), index.size());
+  index_stream.close();
+
+  // Both files and the renames reach the disk before any loose copy of their
+  // objects is removed, so a crash cannot leave an object in neither place
+  if (index_stream.fail() ||
+      !syncPackPath(temp_pack_path) ||
+      !syncPackPath(temp_index_path) ||
+      !ErrorHandler::safeRename(temp_pack_path, pack_name + ".pack") ||
+      !ErrorHandler::safeRename(temp_index_path, pack_name + ".idx") ||
+      !syncPackPath(getPackDir()))
+  {
+    ErrorHandler::safeRemoveFile(temp_pack_path);
+    ErrorHandler::safeRemoveFile(temp_index_path);
+    ErrorHandler::printError(
+        ErrorCode::FILE_WRITE_ERROR,
+        "Unable to install pack: " + pack_name,
+        ErrorSeverity::ERROR,
+        "install_pack");
+    return false;
+  }
+  return true;
+}
+
+bool repackObjects(
+    const std::vector<PackObject> &objects,
+    PackStats &stats)
+{
+  ErrorHandler::safeCreateDirectories(getPackDir());
+  std::string temp_pack_path = getPackDir() + "/tmp_pack_" + std::to_string(getpid());
+  std::vector<std::pair<std::string, uint64_t>> records;
+  std::unordered_set<std::string> packed;
+  unsigned char pack_digest[SHA256_DIGEST_LENGTH];
+  if (!writePackContent(objects, temp_pack_path, records, packed, pack_digest, stats))
+  {
+    ErrorHandler::printError(
+        ErrorCode::FILE_WRITE_ERROR,
+        "Unable to write pack, loose objects were left in place",
+        ErrorSeverity::ERROR,
+        "repack_objects");
+    return false;
+  }
+
+  std::string pack_name;
+  std::size_t index_size = 0;
+  if (!installPackIndex(temp_pack_path, records, pack_digest, pack_name, index_size))
+  {
+    return false;
+  }
+
+  // The new pack replaces every older pack and the loose copies of its objects
+  std::error_code error;
+  for (const auto &entry : std::filesystem::directory_iterator(getPackDir(), error))
+  {
+    std::string path = entry.path().string();
+    if (path.rfind(pack_name, 0) != 0 && (entry.path().extension() == ".idx" || entry.path().extension() == ".pack"))
+    {
+      ErrorHandler::safeRemoveFile(path);
+    }
+  }
+  for (const auto &blob_hash : packed)
+  {
+    ErrorHandler::safeRemoveFile(getBlobPath(blob_hash));
+  }
+  resetPackFiles();
+
+  stats.pack_size += index_size;
+  return true;
+}
+
+bool writePack(
+    const std::vector<PackObject> &objects,
+    const std::string &pack_path,
+    PackStats &stats,
+    std::vector<std::string> *oversize)
+{
+  std::vector<std::pair<std::string, uint64_t>> records;
+  std::unordered_set<std::string> packed;
+  unsigned char pack_digest[SHA256_DIGEST_LENGTH];
+  if (!writePackContent(objects, pack_path, records, packed, pack_digest, stats))
+  {
+    return false;
+  }
+
+  // Unlike a repack, nothing stays behind loose, so every object must fit
+  // unless the caller takes the ones that do not
+  for (const auto &object : objects)
+  {
+    if (packed.count(object.hash) > 0)
+    {
+      continue;
+    }
+    if (oversize == nullptr)
+    {
+      ErrorHandler::safeRemoveFile(pack_path);
+      ErrorHandler::printError(
+          ErrorCode::FILE_WRITE_ERROR,
+          "Object is too large to pack: " + object.hash,
+          ErrorSeverity::ERROR,
+          "write_pack");
+      return false;
+    }
+    if (std::find(oversize->begin(), oversize->end(), object.hash) == oversize->end())
+    {
+      oversize->push_back(object.hash);
+    }
+  }
+  return true;
+}
+
+bool installPack(
+    const std::string &pack_path,
+    PackStats &stats)
+{
+  PackFile pack;
+  pack.pack_path = pack_path;
+  pack.pack_data = mapFile(pack_path, pack.pack_size);
+  bool valid = pack.pack_data != nullptr &&
+               pack.pack_size >= PACK_HEADER_SIZE + SHA256_DIGEST_LENGTH &&
+               std::memcmp(pack.pack_data, PACK_SIGNATURE, sizeof(PACK_SIGNATURE)) == 0 &&
+               readInteger<uint32_t>(pack.pack_data + 4) == PACK_VERSION;
+
+  // A pack from elsewhere is checked in full before any of it is trusted
+  unsigned char pack_digest[SHA256_DIGEST_LENGTH];
+  if (valid)
+  {
+    std::size_t content_size = pack.pack_size - SHA256_DIGEST_LENGTH;
+    SHA256(pack.pack_data, content_size, pack_digest);
+    valid = std::memcmp(pack_digest, pack.pack_data + content_size, SHA256_DIGEST_LENGTH) == 0;
+  }
+
+  // Walk the entries in order, naming each object by the hash of its content
+  std::vector<std::pair<std::string, uint64_t>> records;
+  uint32_t count = valid ? readInteger<uint32_t>(pack.pack_data + 8) : 0;
+  uint64_t offset = PACK_HEADER_SIZE;
+  std::size_t end = pack.pack_size - SHA256_DIGEST_LENGTH;
+  for (uint32_t i = 0; valid && i < count; i++)
+  {
+    std::string content;
+    valid = offset + 17 <= end && readPackEntry(pack, offset, content, 0);
+    if (!valid)
+    {
+      break;
+    }
+
+    uint8_t kind = pack.pack_data[offset];
+    std::size_t header_size = kind == PACK_OBJECT_DELTA ? 25 : 17;
+    stats.delta_count += kind == PACK_OBJECT_DELTA ? 1 : 0;
+    unsigned char key[SHA256_DIGEST_LENGTH];
+    SHA256(reinterpret_cast<const unsigned char *>(content.data()), content.size(), key);
+    records.push_back({std::string(reinterpret_cast<char *>(key), SHA256_DIGEST_LENGTH), offset});
+    offset += header_size + readInteger<uint64_t>(pack.pack_data + offset + header_size - 8);
+  }
+  if (!valid || offset != end)
+  {
+    ErrorHandler::safeRemoveFile(pack_path);
+    ErrorHandler::printError(
+        ErrorCode::REPOSITORY_CORRUPTED,
+        "Received pack is invalid: " + pack_path,
+        ErrorSeverity::ERROR,
+        "install_pack");
+    return false;
+  }
+
+  std::string pack_name;
+  std::size_t index_size = 0;
+  if (!installPackIndex(pack_path, records, pack_digest, pack_name, index_size))
+  {
+    return false;
+  }
+  resetPackFiles();
+
+  stats.object_count = records.size();
+  stats.pack_size = pack.pack_size + index_size;
+  return true;
+}
+
+bool verifyPackFiles(std::vector<std::string> &problems)
+{
+  std::size_t problems_before = problems.size();
+  for (const auto &pack : getPackFiles())
+  {
+    unsigned char digest[SHA256_DIGEST_LENGTH];
+    SHA256(pack->pack_data, pack->pack_size - SHA256_DIGEST_LENGTH, digest);
+    if (std::memcmp(digest, pack->pack_data + pack->pack_size - SHA256_DIGEST_LENGTH, SHA256_DIGEST_LENGTH) != 0)
+    {
+      problems.push_back(pack->pack_path + " (checksum mismatch)");
+      continue;
+    }
+
+    SHA256(pack->idx_data, pack->idx_size - SHA256_DIGEST_LENGTH, digest);
+    if (std::memcmp(digest, pack->idx_data + pack->idx_size - SHA256_DIGEST_LENGTH, SHA256_DIGEST_LENGTH) != 0)
+    {
+      problems.push_back(pack->pack_path + " (index checksum mismatch)");
+      continue;
+    }
+
+    // Every object must rebuild to content that hashes to its id
+    for (uint32_t position = 0; position < pack->count; position++)
+    {
+      const unsigned char *record = getPackRecord(*pack, position);
+      unsigned char key[SHA256_DIGEST_LENGTH];
+      std::memcpy(key, record, SHA256_DIGEST_LENGTH);
+      std::string blob_hash = toHexString(key, SHA256_DIGEST_LENGTH);
+
+      std::string content;
+      if (!readPackEntry(*pack, readInteger<uint64_t>(record + SHA256_DIGEST_LENGTH), content, 0) ||
+          sha256Hash(content) != blob_hash)
+      {
+        problems.push_back(pack->pack_path + " (" + blob_hash + ")");
+      }
+    }
+  }
+
+  return problems.size() == problems_before;
+}
@@ -0,0 +1,109 @@
+#include "../include/parallel.hpp"
+
+static unsigned int readWorkerCount()
+{
+  unsigned int hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+  std::string threads = configGet("core.threads");
+  if (threads.empty())
+  {
+    return hardware_threads;
+  }
+
+  try
+  {
+    int parsed_threads = std::stoi(threads);
+    if (parsed_threads >= 0)
+    {
+      return parsed_threads == 0 ? hardware_threads : static_cast<unsigned int>(parsed_threads);
+    }
+  }
+  catch (const std::exception &)
+  {
+  }
+
+  ErrorHandler::printError(
+      ErrorCode::CONFIG_ERROR,
+      "Invalid core.threads value '" + threads + "', using " + std::to_string(hardware_threads),
+      ErrorSeverity::WARNING,
+      "get_worker_count");
+  return hardware_threads;
+}
+
+// core.threads as last read, 0 until it is read
+static std::atomic<unsigned int> worker_count{0};
+
+unsigned int getWorkerCount()
+{
+  // Read core.threads once; 0 or unset in the config means one worker per hardware thread
+  unsigned int value = worker_count.load();
+  if (value == 0)
+  {
+    value = readWorkerCount();
+    worker_count = value;
+  }
+  return value;
+}
+
+void resetWorkerCount()
+{
+  worker_count = 0;
+}
+
+void parallelForEach(
+    std::size_t task_count,
+    const std::function<void(std::size_t)> &task)
+{
+  std::size_t worker_count = std::min<std::size_t>(getWorkerCount(), task_count);
+  if (worker_count <= 1)
+  {
+    for (std::size_t i = 0; i < task_count; i++)
+    {
+      task(i);
+    }
+    return;
+  }
+
+  // Workers pull the next task index until the batch is exhausted; callers
+  // write results by index so the output order never depends on scheduling
+  std::atomic<std::size_t> next_task{0};
+  std::exception_ptr first_error;
+  std::mutex error_mutex;
+  auto worker = [&]()
+  {
+    for (std::size_t i = next_task++; i < task_count; i = next_task++)
+    {
+      try
+      {
+        task(i);
+      }
+      catch (...)
+      {
+        // Stop handing out work and rethrow on the calling thread
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!first_error)
+        {
+          first_error = std::current_exception();
+        }
+        next_task = task_count;
+      }
+    }
+  };
+
+  std::vector<std::thread> workers;
+  workers.reserve(worker_count - 1);
+  for (std::size_t i = 1; i < worker_count; i++)
+  {
+    workers.emplace_back(worker);
+  }
+  worker();
+
+  for (auto &thread : workers)
+  {
+    thread.join();
+  }
+
+  if (first_error)
+  {
+    std::rethrow_exception(first_error);
+  }
+}
@@ -186,6 +186,17 @@ void push(const std::string &remote_name, const std::string &branch_name)
     return;
   }
 
+  // Handle native remotes: one negotiated pack instead of per-file requests
+  if (isNativeRemote(remote_url))
+  {
+    std::string branch = branch_name.empty() ? getCurrentBranchName() : branch_name;
+    if (pushNative(remote_name.empty() ? "origin" : remote_name, remote_url, branch))
+    {
+      runHook(HookType::POST_PUSH);
+    }
+    return;
+  }
+
   // Handle GitHub remote
   if (isGithubRemote(remote_url))
   {
@@ -236,7 +247,7 @@ void push(const std::string &remote_name, const std::string &branch_name)
   {
     ErrorHandler::printError(
         ErrorCode::INTERNAL_ERROR,
-        "Push is only supported for GitHub repositories. Please use a GitHub repository URL",
+        "Push is only supported for GitHub, file:// and BitTrack HTTP remotes",
         ErrorSeverity::ERROR,
         "push");
     return;
@@ -286,6 +297,24 @@ void pull(const std::string &remote_name, const std::string &branch_name)
     return;
   }
 
+  // Handle native remotes: fetch one pack, then fast-forward or merge
+  if (isNativeRemote(remote_url))
+  {
+    HookResult result = runHook(HookType::PRE_PULL);
+    if (!result.success)
+    {
+      std::cout << result.error << std::endl;
+      return;
+    }
+
+    std::string branch = branch_name.empty() ? getCurrentBranchName() : branch_name;
+    if (pullNative(remote_name.empty() ? "origin" : remote_name, remote_url, branch))
+    {
+      runHook(HookType::POST_PULL);
+    }
+    return;
+  }
+
   // Handle GitHub remote
   if (isGithubRemote(remote_url))
   {
@@ -346,8 +375,7 @@ void pull(const std::string &remote_name, const std::string &branch_name)
   {
     ErrorHandler::printError(
         ErrorCode::INTERNAL_ERROR,
-        "Pull is only supported for GitHub repositories. "
-        "Please use a GitHub repository URL",
+        "Pull is only supported for GitHub, file:// and BitTrack HTTP remotes",
         ErrorSeverity::ERROR,
         "pull");
     return;
@@ -462,6 +490,13 @@ void fetchFromRemote(const std::string &remote_name)
 
   std::cout << "Fetching from remote '" << remote_name << "'..." << std::endl;
 
+  // Native remotes negotiate over the commit graph and send one pack
+  if (isNativeRemote(remote_url))
+  {
+    fetchNative(remote_name, remote_url);
+    return;
+  }
+
   // Prepare URL with current branch
   std::string base_url = remote_url;
   std::string current_branch = getCurrentBranchName();
@@ -751,7 +786,7 @@ void integratePulledFilesWithBittrack(
 {
   try
   {
-    if (!ErrorHandler::safeWriteFile(".bittrack/index", ""))
+    if (!clearStagingArea())
     { // Clear staging area
       ErrorHandler::printError(
           ErrorCode::FILE_WRITE_ERROR,
@@ -760,41 +795,22 @@ void integratePulledFilesWithBittrack(
           "integratePulledFilesWithBittrack");
     }
 
-    std::string commit_dir =
-        ".bittrack/objects/" + commit_sha; // Create commit directory
-    ErrorHandler::safeCreateDirectories(commit_dir);
-
-    // Copy pulled files to commit directory
+    // Store pulled files as blobs
+    std::map<std::string, std::string> pulled_tree;
     for (const std::string &file_path : downloaded_files)
     {
       if (std::filesystem::exists(file_path))
       {
-        // Copy file to commit directory
-        std::string commit_file_path = commit_dir + "/" + file_path;
-        ErrorHandler::safeCopyFile(file_path, commit_file_path);
-      }
-    }
-
-    // Remove files not in the pulled list
-    for (const auto &entry : ErrorHandler::safeListDirectoryFiles(commit_dir))
-    {
-      // Get relative path of the file
-      std::string file_path = entry.string();
-      // Check if the file was pulled
-      bool was_pulled = false;
-      for (const auto &pulled_file : downloaded_files)
-      {
-        // Compare relative paths
-        if (file_path == pulled_file)
+        // Downloads are already in the object store; only compress files that are not
+        std::string blob_hash = hashFile(file_path);
+        if (blob_hash.empty() || !blobExists(blob_hash))
         {
-          was_pulled = true;
-          break;
+          blob_hash = storeBlobFromFile(file_path);
+        }
+        if (!blob_hash.empty())
+        {
+          pulled_tree[file_path] = blob_hash;
         }
-      }
-
-      if (!was_pulled)
-      {
-        std::filesystem::remove(std::filesystem::path(commit_dir) / file_path);
       }
     }
 
@@ -803,10 +819,10 @@ void integratePulledFilesWithBittrack(
     commit_log_content += "Date: " + getCurrentTimestamp() + "\n";
     commit_log_content += "Files:\n";
 
-    // Write file paths
-    for (const std::string &file_path : downloaded_files)
+    // Write file paths with their blob hashes
+    for (const auto &[file_path, blob_hash] : pulled_tree)
     {
-      commit_log_content += file_path + "\n";
+      commit_log_content += file_path + " " + blob_hash + "\n";
     }
 
     if (!ErrorHandler::safeWriteFile(".bittrack/commits/" + commit_sha, commit_log_content))
@@ -831,14 +847,9 @@ void integratePulledFilesWithBittrack(
     }
 
     // Update commit history
-    if (!ErrorHandler::safeAppendFile(".bittrack/commits/history", commit_sha + " " + current_branch + "\n"))
-    {
-      ErrorHandler::printError(
-          ErrorCode::FILE_WRITE_ERROR,
-          "Could not update commit history",
-          ErrorSeverity::ERROR,
-          "integratePulledFilesWithBittrack");
-    }
+    insertCommitRecordToHistory(commit_sha, current_branch);
+
+    updateCommitGraph(commit_sha);
 
     // Update last pushed commit
     setLastPushedCommit(commit_sha);
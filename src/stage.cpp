@@ -5,32 +5,16 @@ std::unordered_map<std::string, std::string> loadStagedFiles()
   // Load staged files from the .bittrack/index file
   std::unordered_map<std::string, std::string> staged_files;
 
-  // If the staging index file does not exist, return an empty map
-  if (!std::filesystem::exists(".bittrack/index"))
+  for (const auto &[file_path, entry] : loadIndex())
   {
-    return staged_files;
-  }
-
-  // Open the staging index file for reading
-  std::string staging_file = ErrorHandler::safeReadFile(".bittrack/index");
-  std::istringstream staging_file_content(staging_file);
-
-  // Read each line from the staging index file
-  std::string line;
-  while (std::getline(staging_file_content, line))
-  {
-    if (line.empty())
+    if (!entry.staged)
     {
       continue;
     }
 
-    // Parse the file path and hash from the line
-    std::istringstream iss(line);
-    std::string staged_file_path, staged_file_hash;
-    if (iss >> staged_file_path >> staged_file_hash)
-    {
-      staged_files[staged_file_path] = staged_file_hash;
-    }
+    // Deletions are keyed by their marked path with an empty hash
+    std::string staged_file_path = entry.hash.empty() ? file_path + " (deleted)" : file_path;
+    staged_files[staged_file_path] = entry.hash;
   }
 
   return staged_files;
@@ -38,31 +22,32 @@ std::unordered_map<std::string, std::string> loadStagedFiles()
 
 void saveStagedFiles(const std::unordered_map<std::string, std::string> &staged_files)
 {
-  // Save the staged files to the .bittrack/index file
-  std::string temp_index_path = ".bittrack/index.tmp";
-  std::string content = "";
+  // Save the staged files to the .bittrack/index file, keeping cached stat data
+  std::map<std::string, IndexEntry> index = loadIndex();
+  resetStagedEntries(index);
 
-  // Write each staged file and its hash to the temporary staging file
-  for (const auto &pair : staged_files)
+  // Record each staged file with the stat data it was hashed at
+  for (const auto &[staged_file_path, staged_file_hash] : staged_files)
   {
-    content += pair.first + " " + pair.second + "\n";
+    std::string actual_path = getActualPath(staged_file_path);
+    IndexEntry entry;
+    if (!staged_file_hash.empty())
+    {
+      readFileStat(actual_path, entry);
+    }
+    entry.hash = staged_file_hash;
+    entry.staged = true;
+    index[actual_path] = entry;
   }
 
-  if (!ErrorHandler::safeWriteFile(temp_index_path, content))
+  if (!saveIndex(index))
   {
     throw BitTrackError(
         ErrorCode::FILE_WRITE_ERROR,
-        "Cannot create temporary staging file",
+        "Cannot update staging index",
         ErrorSeverity::ERROR,
         "save_staged_files");
   }
-
-  // Replace the old staging index file with the updated one
-  if (std::filesystem::exists(".bittrack/index"))
-  {
-    ErrorHandler::safeRemoveFile(".bittrack/index");
-  }
-  ErrorHandler::safeRename(temp_index_path, ".bittrack/index");
 }
 
 bool validateFileForStaging(const std::string &file_path)
@@ -146,23 +131,16 @@ bool isFileUnchangedFromCommit(
     return false;
   }
 
-  // Check if the file exists in the current commit
-  std::string commitDir = ".bittrack/objects/" + currentCommit;
-  if (!std::filesystem::exists(commitDir))
+  // Check if the file exists in the committed tree
+  std::map<std::string, std::string> committedTree = getCommitTree(currentCommit);
+  auto committedEntry = committedTree.find(file_path);
+  if (committedEntry == committedTree.end())
   {
     return false;
   }
 
-  // Check if the file exists in the committed files
-  std::string committedFilePath = commitDir + "/" + file_path;
-  if (!std::filesystem::exists(committedFilePath))
-  {
-    return false;
-  }
-
-  // Compare the file hash with the committed file hash
-  std::string committedHash = hashFile(committedFilePath);
-  return file_hash == committedHash;
+  // Blob ids are content hashes, so no rehashing of the snapshot is needed
+  return file_hash == committedEntry->second;
 }
 
 std::unordered_set<std::string> getTrackedFiles()
@@ -171,37 +149,15 @@ std::unordered_set<std::string> getTrackedFiles()
   std::unordered_set<std::string> trackedFiles;
   std::string currentBranch = getCurrentBranchName();
 
-  // Open the commit history file
-  std::string history_file = ErrorHandler::safeReadFile(".bittrack/commits/history");
-  std::istringstream history_file_content(history_file);
-
-  // Read each line from the commit history file
-  std::string line;
-  while (std::getline(history_file_content, line))
+  // Read each record from the commit history
+  for (const auto &[commitHash, branch] : readCommitHistory())
   {
-    if (line.empty())
-    {
-      continue;
-    }
-
-    // Parse the commit hash and branch from the line
-    std::istringstream iss(line);
-    std::string commitHash, branch;
-
-    // Parse the commit hash and branch from the line
-    if (iss >> commitHash >> branch && branch == currentBranch)
+    if (branch == currentBranch)
     {
       // Retrieve files from the commit
-      std::string commitDir = ".bittrack/objects/" + commitHash;
-      std::vector<std::filesystem::path> commitFiles = ErrorHandler::safeListDirectoryFiles(commitDir);
-      if (std::filesystem::exists(commitDir)) // Check if commit directory exists
+      for (const auto &filePath : getCommitFiles(commitHash))
       {
-        for (const auto &entry : commitFiles)
-        {
-          // Get the relative path of the file within the commit directory
-          std::string filePath = entry.string();
-          trackedFiles.insert(filePath);
-        }
+        trackedFiles.insert(filePath);
       }
     }
   }
@@ -218,10 +174,17 @@ void stageSingleFile(
     return;
   }
 
+  stageHashedFile(file_path, calculateFileHash(file_path), staged_files);
+}
+
+void stageHashedFile(
+    const std::string &file_path,
+    const std::string &file_hash,
+    std::unordered_map<std::string, std::string> &staged_files)
+{
   // Determine if the file is marked as deleted and get its actual path
   bool is_deleted_file = isDeleted(file_path);
   std::string actual_path = getActualPath(file_path);
-  std::string file_hash = calculateFileHash(file_path);
 
   if (file_hash.empty() && !is_deleted_file)
   {
@@ -247,18 +210,21 @@ void stageAllFiles(
     std::unordered_map<std::string, std::string> &staged_files)
 {
   // Stage all files in the working directory
-  std::vector<std::filesystem::path> repository_files = ErrorHandler::safeListDirectoryFiles(".");
-  for (const auto &entry : repository_files)
+  // The walker already skips .bittrack and ignored paths
+  std::vector<std::string> files_to_stage;
+  for (const auto &entry : listWorkingTreeFiles())
   {
-    // Get the file path relative to the repository root
-    std::string filePath = entry.string();
-
-    // Skip files in the .bittrack directory and ignored files
-    if (filePath.length() > 2 && filePath.substr(0, 2) == "./")
+    if (validateFileForStaging(entry.path))
     {
-      filePath = filePath.substr(2);
+      files_to_stage.push_back(entry.path);
     }
-    stageSingleFile(filePath, staged_files);
+  }
+
+  // Hash all candidates as one parallel batch, then stage them in order
+  std::vector<std::string> file_hashes = hashFilesParallel(files_to_stage);
+  for (std::size_t i = 0; i < files_to_stage.size(); i++)
+  {
+    stageHashedFile(files_to_stage[i], file_hashes[i], staged_files);
   }
 
   // Handle deleted files
@@ -357,7 +323,7 @@ void unstage(const std::string &filePath)
     }
 
     // Check if there are any staged files
-    if (!std::filesystem::exists(".bittrack/index"))
+    if (!std::filesystem::exists(getIndexPath()))
     {
       std::cout << "No staged files to unstage" << std::endl;
       return;
@@ -387,153 +353,266 @@ void unstage(const std::string &filePath)
       return;
     }
 
-    // Open the staging index file for reading
-    std::ifstream stagingFile(".bittrack/index");
-    if (!stagingFile.is_open())
+    // Drop the staged flag, the entry stays as cached stat data
+    std::map<std::string, IndexEntry> index = loadIndex();
+    auto entry = index.find(actualFilePath);
+    if (entry == index.end() || !entry->second.staged)
     {
-      throw BitTrackError(
-          ErrorCode::FILE_READ_ERROR,
-          "Cannot open staging index file",
-          ErrorSeverity::ERROR,
-          "unstage");
+      std::cout << "File was not found in staging area: " << filePath << std::endl;
+      return;
     }
 
-    // Create a temporary file to store the updated staging index
-    std::string temp_index_path = ".bittrack/index.tmp";
-    std::ofstream tempFile(temp_index_path);
+    if (is_deleted_file || entry->second.hash.empty())
+    {
+      index.erase(entry);
+    }
+    else
+    {
+      entry->second.staged = false;
+    }
 
-    if (!tempFile.is_open())
+    if (!saveIndex(index))
     {
-      stagingFile.close();
       throw BitTrackError(
           ErrorCode::FILE_WRITE_ERROR,
-          "Cannot create temporary staging file",
+          "Cannot update staging index",
           ErrorSeverity::ERROR,
           "unstage");
     }
+  }
+  catch (const BitTrackError &e)
+  {
+    ErrorHandler::printError(e);
+    throw;
+  }
+  HANDLE_EXCEPTION("unstage")
+}
 
-    // Read each line from the staging index file and write to the temporary
-    // file, excluding the specified file
-    std::string line;
-    bool file_removed = false;
+std::vector<std::string> getStagedFiles()
+{
+  std::vector<std::string> files;
 
-    // Process each line in the staging index file
-    while (std::getline(stagingFile, line))
+  try
+  {
+    // Deleted files are listed with their "(deleted)" marker
+    for (const auto &[file_path, entry] : loadIndex())
     {
-      if (line.empty())
+      if (entry.staged)
       {
-        continue;
+        files.push_back(entry.hash.empty() ? file_path + " (deleted)" : file_path);
       }
+    }
+  }
+  catch (const std::exception &e)
+  {
+    ErrorHandler::printError(
+        ErrorCode::UNEXPECTED_EXCEPTION,
+        "Error reading staged files: " + std::string(e.what()),
+        ErrorSeverity::ERROR,
+        "get_staged_files");
+  }
 
-      // Parse the file path and hash from the line
-      std::istringstream iss(line);
-      std::string staged_file_path, staged_file_hash;
+  return files;
+}
 
-      // Check if the line corresponds to the file to be unstaged
-      if (iss >> staged_file_path >> staged_file_hash)
+static void collectMonitoredUnstagedFiles(
+    const FsMonitorState &state,
+    const FsMonitorChanges &changes,
+    const std::set<std::string> &stagedSet,
+    const std::map<std::string, std::string> &committedFiles,
+    std::map<std::string, IndexEntry> &index,
+    bool &index_changed,
+    std::unordered_set<std::string> &unstagedFiles)
+{
+  // Paths under a changed directory are dirty as a whole
+  std::unordered_set<std::string> dirtyFiles;
+  std::vector<std::string> dirtyDirectories;
+  for (const auto &path : changes.paths)
+  {
+    if (!path.empty() && path.back() == '/')
+    {
+      dirtyDirectories.push_back(path);
+    }
+    else
+    {
+      dirtyFiles.insert(path);
+    }
+  }
+  auto isDirty = [&](const std::string &path)
+  {
+    if (dirtyFiles.find(path) != dirtyFiles.end())
+    {
+      return true;
+    }
+    for (const auto &directory : dirtyDirectories)
+    {
+      if (path.compare(0, directory.size(), directory) == 0)
       {
-        bool should_remove = false;
-        if (staged_file_path == actualFilePath)
-        {
-          should_remove = true;
-        }
+        return true;
+      }
+    }
+    return false;
+  };
 
-        if (!should_remove)
-        {
-          tempFile << line << std::endl;
-        }
-        else
-        {
-          file_removed = true;
-        }
+  std::shared_ptr<const std::vector<IgnorePattern>> patterns = getIgnorePatterns();
+
+  // Tracked files the monitor saw no change for keep the hash the index
+  // recorded during the previous status; everything else is looked at again
+  std::vector<std::string> dirtyPaths;
+  std::vector<IndexEntry> dirtyStats;
+  for (const auto &[filePath, committedHash] : committedFiles)
+  {
+    if (stagedSet.find(filePath) != stagedSet.end())
+    {
+      continue;
+    }
+
+    auto cached = index.find(filePath);
+    if (!isDirty(filePath) && cached != index.end() && !cached->second.hash.empty())
+    {
+      if (cached->second.hash != committedHash)
+      {
+        unstagedFiles.insert(filePath);
       }
+      continue;
     }
 
-    // Close the files
-    stagingFile.close();
-    tempFile.close();
+    IndexEntry current;
+    if (!readFileStat(filePath, current))
+    {
+      unstagedFiles.insert(filePath + " (deleted)");
+      if (cached != index.end() && !cached->second.staged)
+      {
+        index.erase(cached);
+        index_changed = true;
+      }
+      continue;
+    }
 
-    // If the file was not removed, delete the temporary file and print a
-    // message
-    if (!file_removed)
+    // Ignored tracked files are only checked for deletion, as in a full scan
+    if (S_ISREG(current.mode) && !shouldIgnoreFile(filePath, *patterns))
     {
-      std::filesystem::remove(temp_index_path);
-      std::cout << "File was not found in staging area: " << filePath << std::endl;
-      return;
+      dirtyPaths.push_back(filePath);
+      dirtyStats.push_back(current);
     }
+  }
 
-    // Replace the old staging index file with the updated one
-    ErrorHandler::safeRemoveFile(".bittrack/index");
-    ErrorHandler::safeRename(temp_index_path, ".bittrack/index");
+  std::map<std::string, std::string> workingHashes = getCachedFileHashes(dirtyPaths, dirtyStats, index, index_changed);
+  for (const auto &filePath : dirtyPaths)
+  {
+    if (workingHashes[filePath] != committedFiles.at(filePath))
+    {
+      unstagedFiles.insert(filePath);
+    }
   }
-  catch (const BitTrackError &e)
+
+  // Untracked files are the previous list plus whatever changed since
+  std::unordered_set<std::string> candidates(dirtyFiles.begin(), dirtyFiles.end());
+  for (const auto &filePath : state.untracked)
   {
-    ErrorHandler::printError(e);
-    throw;
+    if (isDirty(filePath))
+    {
+      candidates.insert(filePath);
+    }
+    else if (committedFiles.find(filePath) == committedFiles.end() && stagedSet.find(filePath) == stagedSet.end())
+    {
+      unstagedFiles.insert(filePath);
+    }
+  }
+  for (const auto &filePath : candidates)
+  {
+    struct stat file_stat;
+    if (committedFiles.find(filePath) == committedFiles.end() &&
+        stagedSet.find(filePath) == stagedSet.end() &&
+        stat(filePath.c_str(), &file_stat) == 0 && S_ISREG(file_stat.st_mode) &&
+        !shouldIgnoreFile(filePath, *patterns))
+    {
+      unstagedFiles.insert(filePath);
+    }
+  }
+
+  // Forget cached stat data for paths that are no longer tracked
+  for (auto it = index.begin(); it != index.end();)
+  {
+    if (!it->second.staged && committedFiles.find(it->first) == committedFiles.end())
+    {
+      it = index.erase(it);
+      index_changed = true;
+      continue;
+    }
+    ++it;
   }
-  HANDLE_EXCEPTION("unstage")
 }
 
-std::vector<std::string> getStagedFiles()
+static void collectScannedUnstagedFiles(
+    const std::set<std::string> &stagedSet,
+    const std::map<std::string, std::string> &committedFiles,
+    std::map<std::string, IndexEntry> &index,
+    bool &index_changed,
+    std::unordered_set<std::string> &unstagedFiles)
 {
-  std::vector<std::string> files;
+  std::vector<std::string> trackedWorkingFiles;
+  std::vector<IndexEntry> trackedWorkingStats;
 
-  try
+  // Check for modified or untracked files in the working directory; the
+  // walker never enters .bittrack or ignored directories
+  for (const auto &entry : listWorkingTreeFiles())
   {
-    // If the staging index file does not exist, return an empty list
-    if (!std::filesystem::exists(".bittrack/index"))
+    const std::string &filePath = entry.path;
+
+    // Skip files that are already staged
+    if (stagedSet.find(filePath) != stagedSet.end())
     {
-      return files;
+      continue;
     }
 
-    // Read each line from the staging index file
-    std::string content = ErrorHandler::safeReadFile(".bittrack/index");
-    if (content.empty())
+    // Tracked files are compared by hash below, untracked files are always listed
+    if (committedFiles.find(filePath) != committedFiles.end())
     {
-      return files;
+      trackedWorkingFiles.push_back(filePath);
+      IndexEntry current;
+      setFileStat(entry.file_stat, current);
+      trackedWorkingStats.push_back(current);
     }
-    std::istringstream index_file(content);
-    std::string line;
-    while (std::getline(index_file, line))
+    else
     {
-      if (line.empty())
-      {
-        continue;
-      }
-
-      // Parse the file name and hash from the line
-      size_t last_space_pos = line.find_last_of(' ');
-      if (last_space_pos != std::string::npos)
-      {
-        // Extract file name and hash
-        std::string fileName = line.substr(0, last_space_pos);
-        std::string fileHash = line.substr(last_space_pos + 1);
-
-        // Trim whitespace from file hash
-        fileHash.erase(0, fileHash.find_first_not_of(" \t"));
-        fileHash.erase(fileHash.find_last_not_of(" \t") + 1);
+      unstagedFiles.insert(filePath);
+    }
+  }
 
-        if (fileHash.empty())
-        {
-          if (!isDeleted(fileName))
-          {
-            fileName += " (deleted)";
-          }
-        }
-        files.push_back(fileName);
-      }
+  // Compare the working file hashes with the committed blob hashes
+  std::map<std::string, std::string> workingHashes = getCachedFileHashes(trackedWorkingFiles, trackedWorkingStats, index, index_changed);
+  for (const auto &filePath : trackedWorkingFiles)
+  {
+    if (workingHashes[filePath] != committedFiles.at(filePath))
+    {
+      unstagedFiles.insert(filePath);
     }
   }
-  catch (const std::exception &e)
+
+  for (const auto &[committedFile, committedHash] : committedFiles)
   {
-    ErrorHandler::printError(
-        ErrorCode::UNEXPECTED_EXCEPTION,
-        "Error reading staged files: " + std::string(e.what()),
-        ErrorSeverity::ERROR,
-        "get_staged_files");
+    // If the committed file does not exist in the working directory and is
+    // not staged, mark it as deleted
+    if (!std::filesystem::exists(committedFile) &&
+        stagedSet.find(committedFile) == stagedSet.end())
+    {
+      unstagedFiles.insert(committedFile + " (deleted)");
+    }
   }
 
-  return files;
+  // Forget cached stat data for paths that are no longer tracked or present
+  for (auto it = index.begin(); it != index.end();)
+  {
+    if (!it->second.staged &&
+        (committedFiles.find(it->first) == committedFiles.end() || !std::filesystem::exists(it->first)))
+    {
+      it = index.erase(it);
+      index_changed = true;
+      continue;
+    }
+    ++it;
+  }
 }
 
 std::vector<std::string> getUnstagedFiles()
@@ -548,83 +627,52 @@ std::vector<std::string> getUnstagedFiles()
     std::set<std::string> stagedSet(stagedFiles.begin(), stagedFiles.end());
 
     // Get the list of committed files in the current commit
-    std::unordered_set<std::string> committedFiles;
-    if (!currentCommit.empty())
-    {
-      // Retrieve files from the current commit
-      std::string commitDir = ".bittrack/objects/" + currentCommit;
-      if (std::filesystem::exists(commitDir))
-      {
-        // Iterate through the committed files and add them to the set
-        for (const auto &entry : ErrorHandler::safeListDirectoryFiles(commitDir))
-        {
-          // Get the relative path of the file within the commit directory
-          committedFiles.insert(entry.string());
-        }
-      }
-    }
-
-    // Check for modified or untracked files in the working directory
-    for (const auto &entry : ErrorHandler::safeListDirectoryFiles("."))
-    {
-      // Get the file path relative to the repository root
-      std::string filePath = entry.string();
-
-      // Skip files in the .bittrack directory and ignored files
-      if (filePath.length() > 2 && filePath.substr(0, 2) == "./")
-      {
-        filePath = filePath.substr(2);
-      }
-
-      // Skip .bittrack files and ignored files
-      if (filePath.find(".bittrack") != std::string::npos ||
-          shouldIgnoreFile(filePath))
-      {
-        continue;
-      }
+    std::map<std::string, std::string> committedFiles = getCommitTree(currentCommit);
 
-      // Skip files that are already staged
-      if (stagedSet.find(filePath) != stagedSet.end())
-      {
-        continue;
-      }
+    // Cached stat data lets unchanged files skip re-hashing
+    std::map<std::string, IndexEntry> index = loadIndex();
+    bool index_changed = false;
 
-      // Check if the file is modified compared to the committed version
-      bool isModified = false;
-      if (committedFiles.find(filePath) != committedFiles.end())
-      {
-        // Compare the file hash with the committed file hash
-        std::string commitDir = ".bittrack/objects/" + currentCommit;
-        std::string committedFilePath = commitDir + "/" + filePath;
+    // With a monitor daemon running, only paths changed since the previous
+    // status are looked at, as long as nothing else touched the index or HEAD
+    // in between; the token is taken before looking so no change is missed
+    FsMonitorState monitorState;
+    FsMonitorChanges monitorChanges;
+    bool haveState = loadFsMonitorState(monitorState) &&
+                     monitorState.head == currentCommit &&
+                     monitorState.index_digest == getIndexDigest();
+    bool monitored = queryFsMonitor(haveState ? monitorState.token : "", monitorChanges);
+    bool rulesChanged = std::find(monitorChanges.paths.begin(), monitorChanges.paths.end(), ".bitignore") != monitorChanges.paths.end();
 
-        if (std::filesystem::exists(committedFilePath))
-        {
-          // Calculate hashes and compare
-          std::string workingHash = hashFile(filePath);
-          std::string committedHash = hashFile(committedFilePath);
-          isModified = (workingHash != committedHash);
-        }
-      }
-      else
-      {
-        isModified = true;
-      }
+    if (monitored && haveState && !monitorChanges.full_scan && !rulesChanged)
+    {
+      collectMonitoredUnstagedFiles(monitorState, monitorChanges, stagedSet, committedFiles, index, index_changed, unstagedFiles);
+    }
+    else
+    {
+      collectScannedUnstagedFiles(stagedSet, committedFiles, index, index_changed, unstagedFiles);
+    }
 
-      if (isModified)
-      {
-        unstagedFiles.insert(filePath);
-      }
+    if (index_changed)
+    {
+      saveIndex(index);
     }
 
-    for (const auto &committedFile : committedFiles)
+    // Remember what this status saw for the next monitored one
+    if (monitored)
     {
-      // If the committed file does not exist in the working directory and is
-      // not staged, mark it as deleted
-      if (!std::filesystem::exists(committedFile) &&
-          stagedSet.find(committedFile) == stagedSet.end())
+      FsMonitorState nextState;
+      nextState.token = monitorChanges.token;
+      nextState.head = currentCommit;
+      nextState.index_digest = getIndexDigest();
+      for (const auto &filePath : unstagedFiles)
       {
-        unstagedFiles.insert(committedFile + " (deleted)");
+        if (committedFiles.find(filePath) == committedFiles.end() && !isDeleted(filePath))
+        {
+          nextState.untracked.push_back(filePath);
+        }
       }
+      saveFsMonitorState(nextState);
     }
   }
   catch (const std::exception &e)
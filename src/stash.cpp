@@ -22,7 +22,7 @@ void stashChanges(const std::string &message)
   backupStagedFiles(entry.id);             // Backup staged files
   removeStagedFilesFromWorkingDirectory(); // Remove staged files from working directory
 
-  if (!ErrorHandler::safeWriteFile(".bittrack/index", ""))
+  if (!clearStagingArea())
   { // Clear staging area
     ErrorHandler::printError(
         ErrorCode::FILE_WRITE_ERROR,
@@ -0,0 +1,1576 @@
+#include "../include/transfer.hpp"
+
+// Transfer stream layout (all integers little-endian):
+//   "BTTR" | version u32 | pack size u64 | pack, in the layout written by pack.cpp
+//   version 2 only: raw object count u32, per object: size u64 | content
+//   ref count u32, per ref: name | old commit | new commit
+//   commit count u32, per commit: hash | commit log
+// where each string is a u64 length followed by its bytes. The pack and the
+// raw objects come first so a receiver can store them as they arrive
+static const char TRANSFER_SIGNATURE[4] = {'B', 'T', 'T', 'R'};
+static const uint32_t TRANSFER_VERSION = 1;
+// Objects too large to pack are sent raw; only streams carrying any use
+// version 2, so other streams stay readable by older receivers
+static const uint32_t TRANSFER_VERSION_RAW_OBJECTS = 2;
+static const std::size_t TRANSFER_HEADER_SIZE = 16;
+static const std::size_t TRANSFER_CHUNK_SIZE = 64 * 1024;
+static const std::size_t TRANSFER_MAX_TEXT = 16 * 1024 * 1024;
+static const uint64_t TRANSFER_MAX_NAME = 4096;
+static const uint64_t TRANSFER_MAX_COMMIT_LOG = 256 * 1024 * 1024;
+static const std::size_t TRANSFER_MAX_REQUEST_HEAD = 64 * 1024;
+
+template <typename T>
+static void appendInteger(std::string &buffer, T value)
+{
+  for (std::size_t i = 0; i < sizeof(T); i++)
+  {
+    buffer.push_back(static_cast<char>((static_cast<uint64_t>(value) >> (8 * i)) & 0xff));
+  }
+}
+
+template <typename T>
+static T readInteger(const unsigned char *data)
+{
+  uint64_t result = 0;
+  for (std::size_t i = 0; i < sizeof(T); i++)
+  {
+    result |= static_cast<uint64_t>(data[i]) << (8 * i);
+  }
+  return static_cast<T>(result);
+}
+
+static void appendString(std::string &buffer, const std::string &value)
+{
+  appendInteger(buffer, static_cast<uint64_t>(value.size()));
+  buffer += value;
+}
+
+template <typename T>
+static bool readStreamInteger(std::istream &stream, T &value)
+{
+  unsigned char bytes[sizeof(T)];
+  if (!stream.read(reinterpret_cast<char *>(bytes), sizeof(T)))
+  {
+    return false;
+  }
+  value = readInteger<T>(bytes);
+  return true;
+}
+
+static bool readStreamString(
+    std::istream &stream,
+    std::string &value,
+    uint64_t max_size)
+{
+  uint64_t size = 0;
+  if (!readStreamInteger(stream, size) || size > max_size)
+  {
+    return false;
+  }
+  value.resize(size);
+  return size == 0 || static_cast<bool>(stream.read(&value[0], size));
+}
+
+static bool isCommitName(const std::string &commit)
+{
+  // Commit names become file names, so only plain hex is accepted from a peer
+  return !commit.empty() && commit.size() <= 128 &&
+         commit.find_first_not_of("0123456789abcdef") == std::string::npos;
+}
+
+static bool hasCommitLog(const std::string &commit)
+{
+  return isCommitName(commit) && std::filesystem::exists(".bittrack/commits/" + commit);
+}
+
+static std::string readRefFile(const std::string &path)
+{
+  std::ifstream file(path);
+  std::string commit;
+  std::getline(file, commit);
+  commit.erase(commit.find_last_not_of(" \t\r\n") + 1);
+  return commit;
+}
+
+static std::string getTrackingRefDir(const std::string &remote_name)
+{
+  return ".bittrack/refs/remotes/" + remote_name;
+}
+
+static HttpBodySource makeStringBodySource(const std::string &text)
+{
+  auto offset = std::make_shared<std::size_t>(0);
+  return [text, offset](char *buffer, std::size_t size, std::size_t &written)
+  {
+    written = std::min(size, text.size() - *offset);
+    std::memcpy(buffer, text.data() + *offset, written);
+    *offset += written;
+    return true;
+  };
+}
+
+static HttpBodySource makeFileBodySource(
+    const std::string &path,
+    HttpBodyRewind &rewind)
+{
+  // Opened now so the source still works after a forked server changes directory
+  auto file = std::make_shared<std::ifstream>(path, std::ios::binary);
+  rewind = [file]()
+  {
+    file->clear();
+    return static_cast<bool>(file->seekg(0));
+  };
+  return [file](char *buffer, std::size_t size, std::size_t &written)
+  {
+    file->read(buffer, size);
+    written = static_cast<std::size_t>(file->gcount());
+    return written > 0 || file->eof();
+  };
+}
+
+static bool readBodyText(
+    const HttpBodySource &input,
+    std::string &text)
+{
+  std::vector<char> buffer(TRANSFER_CHUNK_SIZE);
+  for (;;)
+  {
+    std::size_t written = 0;
+    if (!input(buffer.data(), buffer.size(), written))
+    {
+      return false;
+    }
+    if (written == 0)
+    {
+      return true;
+    }
+    text.append(buffer.data(), written);
+    if (text.size() > TRANSFER_MAX_TEXT)
+    {
+      return false;
+    }
+  }
+}
+
+static bool writeAll(
+    int fd,
+    const char *data,
+    std::size_t size)
+{
+  while (size > 0)
+  {
+    ssize_t written = send(fd, data, size, MSG_NOSIGNAL);
+    if (written < 0 && errno == ENOTSOCK)
+    {
+      written = write(fd, data, size);
+    }
+    if (written < 0 && errno == EINTR)
+    {
+      continue;
+    }
+    if (written <= 0)
+    {
+      return false;
+    }
+    data += written;
+    size -= static_cast<std::size_t>(written);
+  }
+  return true;
+}
+
+bool isNativeRemote(const std::string &url)
+{
+  if (url.rfind("file://", 0) == 0)
+  {
+    return true;
+  }
+  return (url.rfind("http://", 0) == 0 || url.rfind("https://", 0) == 0) && !isGithubRemote(url);
+}
+
+bool isValidTransferRef(const std::string &name)
+{
+  const std::string prefix = "refs/heads/";
+  if (name.rfind(prefix, 0) != 0 || name.size() == prefix.size() || name.size() > TRANSFER_MAX_NAME)
+  {
+    return false;
+  }
+
+  // The branch part becomes a path under .bittrack/refs, so no component may climb out
+  std::string branch = name.substr(prefix.size());
+  return branch.find_first_not_of("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789._-/") == std::string::npos &&
+         branch.front() != '/' && branch.back() != '/' && branch.front() != '.' &&
+         branch.find("//") == std::string::npos && branch.find("/.") == std::string::npos &&
+         branch.find("..") == std::string::npos;
+}
+
+std::vector<TransferRef> getLocalTransferRefs()
+{
+  std::vector<TransferRef> refs;
+  for (const auto &branch : getBranchesList())
+  {
+    TransferRef ref;
+    ref.name = "refs/heads/" + branch;
+    ref.new_commit = readRefFile(".bittrack/refs/heads/" + branch);
+    if (isValidTransferRef(ref.name) && isCommitName(ref.new_commit))
+    {
+      refs.push_back(ref);
+    }
+  }
+  return refs;
+}
+
+static std::vector<std::string> getTransferParents(
+    const CommitGraph &graph,
+    const std::string &commit)
+{
+  // The graph answers without opening commit logs; newer commits fall back to the log
+  int64_t position = graph.data != nullptr ? findGraphCommit(graph, commit) : -1;
+  if (position < 0)
+  {
+    return getCommitParents(commit);
+  }
+
+  std::vector<std::string> parents;
+  for (uint32_t parent : getGraphParents(graph, static_cast<uint32_t>(position)))
+  {
+    parents.push_back(getGraphCommitHash(graph, parent));
+  }
+  return parents;
+}
+
+std::vector<std::string> findMissingCommits(
+    const std::vector<std::string> &wants,
+    const std::vector<std::string> &haves,
+    std::vector<std::string> &boundary)
+{
+  CommitGraph graph;
+  loadCommitGraph(graph);
+
+  // Everything reachable from a have the other side named is already there
+  std::unordered_set<std::string> common;
+  std::vector<std::string> pending;
+  for (const auto &have : haves)
+  {
+    if (hasCommitLog(have))
+    {
+      pending.push_back(have);
+    }
+  }
+  while (!pending.empty())
+  {
+    std::string commit = pending.back();
+    pending.pop_back();
+    if (!common.insert(commit).second)
+    {
+      continue;
+    }
+    for (const auto &parent : getTransferParents(graph, commit))
+    {
+      if (common.count(parent) == 0 && hasCommitLog(parent))
+      {
+        pending.push_back(parent);
+      }
+    }
+  }
+
+  // Walk back from the wants, newest first, stopping at the common commits
+  std::vector<std::string> missing;
+  std::unordered_set<std::string> seen;
+  std::set<std::string> edge;
+  pending.assign(wants.rbegin(), wants.rend());
+  while (!pending.empty())
+  {
+    std::string commit = pending.back();
+    pending.pop_back();
+    if (common.count(commit) > 0)
+    {
+      edge.insert(commit);
+      continue;
+    }
+    if (!seen.insert(commit).second || !hasCommitLog(commit))
+    {
+      continue;
+    }
+
+    missing.push_back(commit);
+    std::vector<std::string> parents = getTransferParents(graph, commit);
+    pending.insert(pending.end(), parents.rbegin(), parents.rend());
+  }
+
+  boundary.assign(edge.begin(), edge.end());
+  return missing;
+}
+
+bool writeTransferStream(
+    const std::vector<TransferRef> &refs,
+    const std::vector<std::string> &commits,
+    const std::vector<std::string> &boundary,
+    const HttpBodySink &output,
+    TransferStats &stats)
+{
+  // Blobs the receiver holds through the boundary commits stay behind
+  std::unordered_set<std::string> known;
+  for (const auto &commit : boundary)
+  {
+    for (const auto &[file, blob_hash] : getCommitTree(commit))
+    {
+      known.insert(blob_hash);
+    }
+  }
+  std::vector<PackObject> objects;
+  for (const auto &commit : commits)
+  {
+    for (const auto &[file, blob_hash] : getCommitTree(commit))
+    {
+      if (known.insert(blob_hash).second)
+      {
+        objects.push_back({blob_hash, file});
+      }
+    }
+  }
+
+  std::string pack_path;
+  PackStats pack_stats;
+  uint64_t pack_size = 0;
+  std::vector<std::string> oversize;
+  if (!objects.empty())
+  {
+    ErrorHandler::safeCreateDirectories(getPackDir());
+    pack_path = getPackDir() + "/tmp_send_" + std::to_string(getpid());
+    std::error_code error;
+    if (!writePack(objects, pack_path, pack_stats, &oversize))
+    {
+      return false;
+    }
+    pack_size = std::filesystem::file_size(pack_path, error);
+    if (pack_stats.object_count == 0)
+    {
+      ErrorHandler::safeRemoveFile(pack_path);
+      pack_path.clear();
+      pack_size = 0;
+    }
+  }
+
+  std::string chunk(TRANSFER_SIGNATURE, sizeof(TRANSFER_SIGNATURE));
+  appendInteger(chunk, oversize.empty() ? TRANSFER_VERSION : TRANSFER_VERSION_RAW_OBJECTS);
+  appendInteger(chunk, pack_size);
+  bool ok = output(chunk.data(), chunk.size());
+  stats.byte_count += chunk.size();
+
+  if (!pack_path.empty())
+  {
+    std::ifstream pack(pack_path, std::ios::binary);
+    std::vector<char> buffer(TRANSFER_CHUNK_SIZE);
+    uint64_t sent = 0;
+    while (ok && pack)
+    {
+      pack.read(buffer.data(), buffer.size());
+      std::size_t count = static_cast<std::size_t>(pack.gcount());
+      ok = count == 0 || output(buffer.data(), count);
+      sent += count;
+    }
+    pack.close();
+    ErrorHandler::safeRemoveFile(pack_path);
+    ok = ok && sent == pack_size;
+    stats.byte_count += sent;
+  }
+
+  // Objects the pack could not hold are streamed from the object store as they are
+  if (!oversize.empty())
+  {
+    chunk.clear();
+    appendInteger(chunk, static_cast<uint32_t>(oversize.size()));
+    ok = ok && output(chunk.data(), chunk.size());
+    stats.byte_count += chunk.size();
+  }
+  std::vector<unsigned char> buffer(TRANSFER_CHUNK_SIZE);
+  for (std::size_t i = 0; ok && i < oversize.size(); i++)
+  {
+    BlobReader reader;
+    int64_t object_size = getBlobSize(oversize[i]);
+    chunk.clear();
+    appendInteger(chunk, static_cast<uint64_t>(object_size));
+    ok = object_size >= 0 && openBlobReader(oversize[i], reader) && output(chunk.data(), chunk.size());
+    stats.byte_count += chunk.size();
+
+    uint64_t sent = 0;
+    while (ok)
+    {
+      std::size_t count = readBlobChunk(reader, buffer.data(), buffer.size());
+      if (count == 0)
+      {
+        break;
+      }
+      ok = output(reinterpret_cast<const char *>(buffer.data()), count);
+      sent += count;
+    }
+    ok = ok && !reader.failed && sent == static_cast<uint64_t>(object_size);
+    stats.byte_count += sent;
+  }
+
+  // Refs and commit logs follow in chunks of about the same size
+  chunk.clear();
+  appendInteger(chunk, static_cast<uint32_t>(refs.size()));
+  for (const auto &ref : refs)
+  {
+    appendString(chunk, ref.name);
+    appendString(chunk, ref.old_commit);
+    appendString(chunk, ref.new_commit);
+  }
+  appendInteger(chunk, static_cast<uint32_t>(commits.size()));
+  for (const auto &commit : commits)
+  {
+    appendString(chunk, commit);
+    appendString(chunk, ErrorHandler::safeReadFile(".bittrack/commits/" + commit));
+    if (chunk.size() >= TRANSFER_CHUNK_SIZE)
+    {
+      ok = ok && output(chunk.data(), chunk.size());
+      stats.byte_count += chunk.size();
+      chunk.clear();
+    }
+  }
+  ok = ok && (chunk.empty() || output(chunk.data(), chunk.size()));
+  stats.byte_count += chunk.size();
+
+  stats.commit_count += commits.size();
+  stats.object_count += pack_stats.object_count + oversize.size();
+  return ok;
+}
+
+TransferReceiver::~TransferReceiver()
+{
+  pack.close();
+  meta.close();
+  if (!pack_path.empty())
+  {
+    std::error_code error;
+    std::filesystem::remove(pack_path, error);
+  }
+  if (!meta_path.empty())
+  {
+    std::error_code error;
+    std::filesystem::remove(meta_path, error);
+  }
+}
+
+bool openTransferReceiver(TransferReceiver &receiver)
+{
+  receiver.meta_path = ".bittrack/tmp_transfer_" + std::to_string(getpid());
+  receiver.meta.open(receiver.meta_path, std::ios::binary | std::ios::trunc);
+  if (!receiver.meta.is_open())
+  {
+    ErrorHandler::printError(
+        ErrorCode::FILE_WRITE_ERROR,
+        "Unable to create " + receiver.meta_path,
+        ErrorSeverity::ERROR,
+        "open_transfer_receiver");
+    receiver.meta_path.clear();
+    return false;
+  }
+  return true;
+}
+
+// Objects are stored as they arrive; if the stream turns out to be bad they
+// are left unreachable for gc, like the loose objects of an interrupted stage
+static void finishRawObject(TransferReceiver &receiver)
+{
+  receiver.failed = finishBlobWriter(*receiver.raw_writer).empty();
+  receiver.raw_writer.reset();
+  receiver.raw_objects--;
+  receiver.raw_count++;
+}
+
+bool feedTransferReceiver(
+    TransferReceiver &receiver,
+    const char *data,
+    std::size_t size)
+{
+  receiver.byte_count += size;
+  while (!receiver.failed && size > 0)
+  {
+    if (receiver.header.size() < TRANSFER_HEADER_SIZE)
+    {
+      std::size_t count = std::min(size, TRANSFER_HEADER_SIZE - receiver.header.size());
+      receiver.header.append(data, count);
+      data += count;
+      size -= count;
+      if (receiver.header.size() < TRANSFER_HEADER_SIZE)
+      {
+        continue;
+      }
+
+      const unsigned char *header = reinterpret_cast<const unsigned char *>(receiver.header.data());
+      receiver.version = readInteger<uint32_t>(header + 4);
+      receiver.failed = std::memcmp(header, TRANSFER_SIGNATURE, sizeof(TRANSFER_SIGNATURE)) != 0 ||
+                        (receiver.version != TRANSFER_VERSION && receiver.version != TRANSFER_VERSION_RAW_OBJECTS);
+      receiver.pack_remaining = readInteger<uint64_t>(header + 8);
+      if (!receiver.failed && receiver.pack_remaining > 0)
+      {
+        // Written inside the pack directory so installing it is a rename
+        ErrorHandler::safeCreateDirectories(getPackDir());
+        receiver.pack_path = getPackDir() + "/tmp_receive_" + std::to_string(getpid());
+        receiver.pack.open(receiver.pack_path, std::ios::binary | std::ios::trunc);
+        receiver.failed = !receiver.pack.is_open();
+      }
+      continue;
+    }
+
+    if (receiver.pack_remaining > 0)
+    {
+      std::size_t count = static_cast<std::size_t>(std::min<uint64_t>(size, receiver.pack_remaining));
+      receiver.pack.write(data, count);
+      receiver.failed = !receiver.pack;
+      receiver.pack_remaining -= count;
+      data += count;
+      size -= count;
+      continue;
+    }
+
+    if (receiver.version == TRANSFER_VERSION_RAW_OBJECTS && (!receiver.raw_counted || receiver.raw_objects > 0))
+    {
+      if (receiver.raw_writer)
+      {
+        std::size_t count = static_cast<std::size_t>(std::min<uint64_t>(size, receiver.raw_remaining));
+        receiver.failed = !writeBlobChunk(*receiver.raw_writer, reinterpret_cast<const unsigned char *>(data), count);
+        receiver.raw_remaining -= count;
+        data += count;
+        size -= count;
+        if (!receiver.failed && receiver.raw_remaining == 0)
+        {
+          finishRawObject(receiver);
+        }
+        continue;
+      }
+
+      // The object count, then each object's size, may be split across chunks
+      std::size_t needed = receiver.raw_counted ? 8 : 4;
+      std::size_t count = std::min(size, needed - receiver.raw_header.size());
+      receiver.raw_header.append(data, count);
+      data += count;
+      size -= count;
+      if (receiver.raw_header.size() < needed)
+      {
+        continue;
+      }
+
+      const unsigned char *bytes = reinterpret_cast<const unsigned char *>(receiver.raw_header.data());
+      if (!receiver.raw_counted)
+      {
+        receiver.raw_objects = readInteger<uint32_t>(bytes);
+        receiver.raw_counted = true;
+      }
+      else
+      {
+        receiver.raw_remaining = readInteger<uint64_t>(bytes);
+        receiver.raw_writer = std::make_unique<BlobWriter>();
+        receiver.failed = !openBlobWriter(*receiver.raw_writer);
+        if (!receiver.failed && receiver.raw_remaining == 0)
+        {
+          finishRawObject(receiver);
+        }
+      }
+      receiver.raw_header.clear();
+      continue;
+    }
+
+    receiver.meta.write(data, size);
+    receiver.failed = !receiver.meta;
+    size = 0;
+  }
+
+  return !receiver.failed;
+}
+
+bool finishTransferReceiver(
+    TransferReceiver &receiver,
+    std::vector<TransferRef> &refs,
+    TransferStats &stats)
+{
+  if (receiver.pack.is_open())
+  {
+    receiver.pack.close();
+    receiver.failed = receiver.failed || !receiver.pack;
+  }
+  receiver.meta.close();
+  bool raw_incomplete = receiver.version == TRANSFER_VERSION_RAW_OBJECTS && (!receiver.raw_counted || receiver.raw_objects > 0);
+  if (receiver.failed || receiver.header.size() < TRANSFER_HEADER_SIZE || receiver.pack_remaining > 0 || raw_incomplete || !receiver.meta)
+  {
+    ErrorHandler::printError(
+        ErrorCode::REMOTE_DOWNLOAD_FAILED,
+        "Transfer stream is incomplete or malformed",
+        ErrorSeverity::ERROR,
+        "finish_transfer_receiver");
+    return false;
+  }
+
+  // Parse everything before storing anything, so a bad stream changes nothing
+  std::ifstream meta(receiver.meta_path, std::ios::binary);
+  uint32_t ref_count = 0;
+  bool valid = readStreamInteger(meta, ref_count);
+  for (uint32_t i = 0; valid && i < ref_count; i++)
+  {
+    TransferRef ref;
+    valid = readStreamString(meta, ref.name, TRANSFER_MAX_NAME) &&
+            readStreamString(meta, ref.old_commit, TRANSFER_MAX_NAME) &&
+            readStreamString(meta, ref.new_commit, TRANSFER_MAX_NAME) &&
+            isValidTransferRef(ref.name) &&
+            (ref.old_commit.empty() || isCommitName(ref.old_commit)) &&
+            isCommitName(ref.new_commit);
+    refs.push_back(ref);
+  }
+
+  uint32_t commit_count = 0;
+  std::vector<std::pair<std::string, std::string>> commits;
+  valid = valid && readStreamInteger(meta, commit_count);
+  for (uint32_t i = 0; valid && i < commit_count; i++)
+  {
+    std::string commit;
+    std::string log;
+    valid = readStreamString(meta, commit, TRANSFER_MAX_NAME) &&
+            readStreamString(meta, log, TRANSFER_MAX_COMMIT_LOG) &&
+            isCommitName(commit);
+    commits.push_back({commit, log});
+  }
+  valid = valid && meta.peek() == std::char_traits<char>::eof();
+  if (!valid)
+  {
+    ErrorHandler::printError(
+        ErrorCode::REMOTE_DOWNLOAD_FAILED,
+        "Transfer stream carries invalid refs or commits",
+        ErrorSeverity::ERROR,
+        "finish_transfer_receiver");
+    return false;
+  }
+
+  // Objects go in before the commits that refer to them
+  if (!receiver.pack_path.empty())
+  {
+    PackStats pack_stats;
+    bool installed = installPack(receiver.pack_path, pack_stats);
+    receiver.pack_path.clear();
+    if (!installed)
+    {
+      return false;
+    }
+    stats.object_count += pack_stats.object_count;
+  }
+
+  for (const auto &[commit, log] : commits)
+  {
+    if (!std::filesystem::exists(".bittrack/commits/" + commit) &&
+        !ErrorHandler::safeWriteFile(".bittrack/commits/" + commit, log))
+    {
+      return false;
+    }
+  }
+  for (const auto &ref : refs)
+  {
+    if (!hasCommitLog(ref.new_commit))
+    {
+      ErrorHandler::printError(
+          ErrorCode::REMOTE_DOWNLOAD_FAILED,
+          "Transfer stream is missing commit " + ref.new_commit,
+          ErrorSeverity::ERROR,
+          "finish_transfer_receiver");
+      return false;
+    }
+  }
+
+  stats.commit_count += commits.size();
+  stats.object_count += receiver.raw_count;
+  stats.byte_count += receiver.byte_count;
+  return true;
+}
+
+static void recordBranchCommits(
+    const std::string &branch_name,
+    const std::string &old_commit,
+    const std::string &new_commit)
+{
+  // Journal the first-parent chain the branch moved over, oldest first
+  std::vector<std::string> boundary;
+  std::vector<std::string> added = findMissingCommits({new_commit}, {old_commit}, boundary);
+  std::unordered_set<std::string> added_commits(added.begin(), added.end());
+  std::vector<std::string> chain;
+  std::string commit = new_commit;
+  while (added_commits.count(commit) > 0)
+  {
+    chain.push_back(commit);
+    std::vector<std::string> parents = getCommitParents(commit);
+    commit = parents.empty() ? "" : parents.front();
+  }
+  for (auto record = chain.rbegin(); record != chain.rend(); ++record)
+  {
+    insertCommitRecordToHistory(*record, branch_name);
+  }
+}
+
+static std::string applyReceivedRef(const TransferRef &ref)
+{
+  std::string branch_name = ref.name.substr(std::string("refs/heads/").size());
+  std::string ref_path = ".bittrack/refs/heads/" + branch_name;
+  std::string current = readRefFile(ref_path);
+  if (current != ref.old_commit)
+  {
+    return "fetch first";
+  }
+  if (current == ref.new_commit)
+  {
+    return "";
+  }
+
+  updateCommitGraph(ref.new_commit);
+  if (!current.empty() && !isAncestor(current, ref.new_commit))
+  {
+    return "non-fast-forward";
+  }
+
+  // A checked-out branch only moves when its working tree can follow
+  if (branch_name == getCurrentBranchName())
+  {
+    if (hasUncommittedChanges())
+    {
+      return "branch is checked out with uncommitted changes";
+    }
+    restoreFilesFromCommit(ref.new_commit, current);
+  }
+
+  if (!ErrorHandler::safeWriteFile(ref_path, ref.new_commit + "\n"))
+  {
+    return "unable to update ref";
+  }
+  recordBranchCommits(branch_name, current, ref.new_commit);
+  return "";
+}
+
+static bool serveUploadPack(
+    const HttpBodySource &input,
+    const HttpBodySink &output)
+{
+  std::string request;
+  if (input && !readBodyText(input, request))
+  {
+    return false;
+  }
+
+  std::set<std::string> wanted_refs;
+  std::vector<std::string> haves;
+  std::istringstream lines(request);
+  std::string line;
+  while (std::getline(lines, line))
+  {
+    if (line.rfind("want ", 0) == 0)
+    {
+      wanted_refs.insert(line.substr(5));
+    }
+    else if (line.rfind("have ", 0) == 0)
+    {
+      haves.push_back(line.substr(5));
+    }
+  }
+
+  // No wants asks for every branch
+  std::vector<TransferRef> refs;
+  std::vector<std::string> wants;
+  for (const auto &ref : getLocalTransferRefs())
+  {
+    if (wanted_refs.empty() || wanted_refs.count(ref.name) > 0)
+    {
+      refs.push_back(ref);
+      wants.push_back(ref.new_commit);
+    }
+  }
+
+  std::vector<std::string> boundary;
+  std::vector<std::string> missing = findMissingCommits(wants, haves, boundary);
+  TransferStats stats;
+  return writeTransferStream(refs, missing, boundary, output, stats);
+}
+
+static bool serveReceivePack(
+    const HttpBodySource &input,
+    const HttpBodySink &output)
+{
+  TransferReceiver receiver;
+  if (!input || !openTransferReceiver(receiver))
+  {
+    return false;
+  }
+
+  std::vector<char> buffer(TRANSFER_CHUNK_SIZE);
+  for (;;)
+  {
+    std::size_t written = 0;
+    if (!input(buffer.data(), buffer.size(), written))
+    {
+      return false;
+    }
+    if (written == 0)
+    {
+      break;
+    }
+    if (!feedTransferReceiver(receiver, buffer.data(), written))
+    {
+      return false;
+    }
+  }
+
+  std::vector<TransferRef> refs;
+  TransferStats stats;
+  if (!finishTransferReceiver(receiver, refs, stats))
+  {
+    return false;
+  }
+
+  std::string report;
+  for (const auto &ref : refs)
+  {
+    std::string reason = applyReceivedRef(ref);
+    report += (reason.empty() ? "ok " + ref.name : "ng " + ref.name + " " + reason) + "\n";
+  }
+  return output(report.data(), report.size());
+}
+
+bool serveTransferRequest(
+    const std::string &service,
+    const HttpBodySource &input,
+    const HttpBodySink &output)
+{
+  if (service == "refs")
+  {
+    std::string advertised;
+    for (const auto &ref : getLocalTransferRefs())
+    {
+      advertised += ref.new_commit + " " + ref.name + "\n";
+    }
+    return advertised.empty() || output(advertised.data(), advertised.size());
+  }
+  if (service == "upload-pack")
+  {
+    return serveUploadPack(input, output);
+  }
+  if (service == "receive-pack")
+  {
+    return serveReceivePack(input, output);
+  }
+  return false;
+}
+
+static bool callFileTransferService(
+    const std::string &path,
+    const std::string &service,
+    const HttpBodySource &input,
+    const HttpBodySink &output)
+{
+  std::error_code error;
+  std::filesystem::path repository = std::filesystem::absolute(path, error);
+  if (error || !std::filesystem::is_directory(repository / ".bittrack"))
+  {
+    ErrorHandler::printError(
+        ErrorCode::INVALID_REMOTE_URL,
+        "Not a BitTrack repository: " + path,
+        ErrorSeverity::ERROR,
+        "call_transfer_service");
+    return false;
+  }
+
+  int fds[2];
+  if (pipe(fds) != 0)
+  {
+    ErrorHandler::printError(
+        ErrorCode::INTERNAL_ERROR,
+        "Unable to create pipe: " + std::string(std::strerror(errno)),
+        ErrorSeverity::ERROR,
+        "call_transfer_service");
+    return false;
+  }
+
+  // The remote side runs in a child inside the other repository, exactly as
+  // the loopback server would run it
+  std::cout.flush();
+  pid_t child = fork();
+  if (child < 0)
+  {
+    close(fds[0]);
+    close(fds[1]);
+    ErrorHandler::printError(
+        ErrorCode::INTERNAL_ERROR,
+        "Unable to start transfer: " + std::string(std::strerror(errno)),
+        ErrorSeverity::ERROR,
+        "call_transfer_service");
+    return false;
+  }
+  if (child == 0)
+  {
+    close(fds[0]);
+    signal(SIGPIPE, SIG_IGN);
+    int write_fd = fds[1];
+    bool served = chdir(repository.c_str()) == 0;
+    if (served)
+    {
+      // Nothing read from this repository's config may carry over to the
+      // other one; fork copies the caches without the chdir resetting them
+      resetPackFiles();
+      resetCompressionLevel();
+      resetWorkerCount();
+      resetHttpConcurrency();
+      served = serveTransferRequest(
+          service,
+          input,
+          [write_fd](const char *data, std::size_t size)
+          { return writeAll(write_fd, data, size); });
+    }
+    std::cout.flush();
+    close(write_fd);
+    _exit(served ? 0 : 1);
+  }
+
+  close(fds[1]);
+  bool ok = true;
+  std::vector<char> buffer(TRANSFER_CHUNK_SIZE);
+  while (ok)
+  {
+    ssize_t count = read(fds[0], buffer.data(), buffer.size());
+    if (count < 0 && errno == EINTR)
+    {
+      continue;
+    }
+    if (count <= 0)
+    {
+      ok = count == 0;
+      break;
+    }
+    ok = output(buffer.data(), static_cast<std::size_t>(count));
+  }
+  close(fds[0]);
+
+  int status = 0;
+  waitpid(child, &status, 0);
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+  {
+    ErrorHandler::printError(
+        ErrorCode::REMOTE_CONNECTION_FAILED,
+        "Remote " + service + " failed in " + repository.string(),
+        ErrorSeverity::ERROR,
+        "call_transfer_service");
+    return false;
+  }
+  return ok;
+}
+
+static bool callHttpTransferService(
+    const std::string &url,
+    const std::string &service,
+    const HttpBodySource &input,
+    const HttpBodySink &output,
+    const HttpBodyRewind &rewind)
+{
+  HttpRequest request;
+  request.url = url;
+  while (!request.url.empty() && request.url.back() == '/')
+  {
+    request.url.pop_back();
+  }
+  request.url += "/" + service;
+  if (input)
+  {
+    request.method = "POST";
+    request.body_source = input;
+    request.body_rewind = rewind;
+  }
+
+  request.body_sink = output;
+  request.headers.push_back("Content-Type: application/octet-stream");
+
+  HttpResponse response = httpPerform(request);
+  if (response.result != CURLE_OK || response.status != 200)
+  {
+    ErrorHandler::printError(
+        ErrorCode::REMOTE_CONNECTION_FAILED,
+        "Transfer request to " + request.url + " failed: " +
+            (response.result != CURLE_OK ? std::string(curl_easy_strerror(response.result))
+                                         : "HTTP " + std::to_string(response.status)),
+        ErrorSeverity::ERROR,
+        "call_transfer_service");
+    return false;
+  }
+  return true;
+}
+
+bool callTransferService(
+    const std::string &url,
+    const std::string &service,
+    const HttpBodySource &input,
+    const HttpBodySink &output,
+    const HttpBodyRewind &rewind)
+{
+  if (url.rfind("file://", 0) == 0)
+  {
+    return callFileTransferService(url.substr(7), service, input, output);
+  }
+  return callHttpTransferService(url, service, input, output, rewind);
+}
+
+// One request on the loopback server, read straight from the socket
+struct TransferConnection
+{
+  int fd;                   // accepted socket
+  std::string buffer;       // bytes received but not consumed yet
+  std::size_t offset;       // first unconsumed byte of buffer
+  bool chunked;             // the body uses chunked transfer encoding
+  uint64_t remaining;       // body bytes left, or bytes left in the current chunk
+  bool body_done;           // the whole body has been consumed
+  bool headers_sent;        // the response status line went out
+
+  TransferConnection(int socket) : fd(socket), offset(0), chunked(false), remaining(0), body_done(false), headers_sent(false) {}
+};
+
+static bool fillConnection(TransferConnection &connection)
+{
+  if (connection.offset < connection.buffer.size())
+  {
+    return true;
+  }
+
+  connection.buffer.resize(TRANSFER_CHUNK_SIZE);
+  connection.offset = 0;
+  for (;;)
+  {
+    ssize_t count = recv(connection.fd, &connection.buffer[0], connection.buffer.size(), 0);
+    if (count < 0 && errno == EINTR)
+    {
+      continue;
+    }
+    connection.buffer.resize(count > 0 ? static_cast<std::size_t>(count) : 0);
+    return count > 0;
+  }
+}
+
+static bool readConnectionLine(
+    TransferConnection &connection,
+    std::string &line)
+{
+  line.clear();
+  while (line.size() < TRANSFER_MAX_REQUEST_HEAD && fillConnection(connection))
+  {
+    std::size_t end = connection.buffer.find('\n', connection.offset);
+    std::size_t stop = end == std::string::npos ? connection.buffer.size() : end + 1;
+    line.append(connection.buffer, connection.offset, stop - connection.offset);
+    connection.offset = stop;
+    if (end != std::string::npos)
+    {
+      line.erase(line.find_last_not_of("\r\n") + 1);
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool readConnectionBody(
+    TransferConnection &connection,
+    char *buffer,
+    std::size_t size,
+    std::size_t &written)
+{
+  written = 0;
+  if (connection.chunked && connection.remaining == 0 && !connection.body_done)
+  {
+    // Each chunk is a hex size line, the data, and a line break
+    std::string line;
+    if (!readConnectionLine(connection, line))
+    {
+      return false;
+    }
+    if (line.empty() && !readConnectionLine(connection, line))
+    {
+      return false;
+    }
+    char *end = nullptr;
+    connection.remaining = std::strtoull(line.c_str(), &end, 16);
+    if (end == line.c_str())
+    {
+      return false;
+    }
+    if (connection.remaining == 0)
+    {
+      while (readConnectionLine(connection, line) && !line.empty())
+      {
+      }
+      connection.body_done = true;
+    }
+  }
+  if (connection.body_done || connection.remaining == 0)
+  {
+    connection.body_done = true;
+    return true;
+  }
+  if (!fillConnection(connection))
+  {
+    return false;
+  }
+
+  std::size_t available = connection.buffer.size() - connection.offset;
+  written = static_cast<std::size_t>(std::min<uint64_t>(std::min(size, available), connection.remaining));
+  std::memcpy(buffer, connection.buffer.data() + connection.offset, written);
+  connection.offset += written;
+  connection.remaining -= written;
+  if (!connection.chunked && connection.remaining == 0)
+  {
+    connection.body_done = true;
+  }
+  return true;
+}
+
+static void sendTransferStatus(
+    TransferConnection &connection,
+    const std::string &status)
+{
+  std::string response = "HTTP/1.1 " + status + "\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+  writeAll(connection.fd, response.data(), response.size());
+  connection.headers_sent = true;
+}
+
+static void handleTransferConnection(int fd)
+{
+  TransferConnection connection(fd);
+  std::string request_line;
+  if (!readConnectionLine(connection, request_line))
+  {
+    return;
+  }
+
+  bool expect_continue = false;
+  bool has_body = false;
+  std::string line;
+  std::size_t head_size = request_line.size();
+  while (readConnectionLine(connection, line) && !line.empty())
+  {
+    head_size += line.size();
+    if (head_size > TRANSFER_MAX_REQUEST_HEAD)
+    {
+      sendTransferStatus(connection, "431 Request Header Fields Too Large");
+      return;
+    }
+
+    std::size_t colon = line.find(':');
+    std::string name = line.substr(0, colon);
+    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+    std::string value = colon == std::string::npos ? "" : line.substr(colon + 1);
+    value.erase(0, value.find_first_not_of(" \t"));
+    std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+    if (name == "content-length")
+    {
+      connection.remaining = std::strtoull(value.c_str(), nullptr, 10);
+      has_body = true;
+    }
+    else if (name == "transfer-encoding" && value.find("chunked") != std::string::npos)
+    {
+      connection.chunked = true;
+      has_body = true;
+    }
+    else if (name == "expect" && value == "100-continue")
+    {
+      expect_continue = true;
+    }
+  }
+
+  // "POST /some/path/receive-pack HTTP/1.1": the service is the last path component
+  std::istringstream request(request_line);
+  std::string method, target;
+  request >> method >> target;
+  target = target.substr(0, target.find('?'));
+  std::string service = target.substr(target.rfind('/') + 1);
+  bool known = (method == "GET" && service == "refs") ||
+               (method == "POST" && (service == "upload-pack" || service == "receive-pack"));
+  if (!known)
+  {
+    sendTransferStatus(connection, "404 Not Found");
+    return;
+  }
+  if (expect_continue)
+  {
+    const std::string proceed = "HTTP/1.1 100 Continue\r\n\r\n";
+    writeAll(fd, proceed.data(), proceed.size());
+  }
+
+  HttpBodySource input;
+  if (has_body)
+  {
+    input = [&connection](char *buffer, std::size_t size, std::size_t &written)
+    { return readConnectionBody(connection, buffer, size, written); };
+  }
+
+  // The length is not known until the stream is done, so the response ends at close
+  HttpBodySink output = [&connection](const char *data, std::size_t size)
+  {
+    if (!connection.headers_sent)
+    {
+      const std::string head = "HTTP/1.1 200 OK\r\nContent-Type: application/octet-stream\r\nConnection: close\r\n\r\n";
+      connection.headers_sent = true;
+      if (!writeAll(connection.fd, head.data(), head.size()))
+      {
+        return false;
+      }
+    }
+    return writeAll(connection.fd, data, size);
+  };
+
+  bool served = serveTransferRequest(service, input, output);
+  std::cout << method << " " << target << (served ? " ok" : " failed") << std::endl;
+  if (!connection.headers_sent)
+  {
+    sendTransferStatus(connection, served ? "200 OK" : "500 Internal Server Error");
+  }
+}
+
+void runTransferServer(int port)
+{
+  int server_fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (server_fd < 0)
+  {
+    throw BitTrackError(
+        ErrorCode::NETWORK_ERROR,
+        "Unable to create socket: " + std::string(std::strerror(errno)),
+        ErrorSeverity::ERROR,
+        "run_transfer_server");
+  }
+
+  // Only this machine can reach the server; it has no authentication of its own
+  int reuse = 1;
+  setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+  sockaddr_in address;
+  std::memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = htons(static_cast<uint16_t>(port));
+  if (bind(server_fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || listen(server_fd, 16) != 0)
+  {
+    std::string reason = std::strerror(errno);
+    close(server_fd);
+    throw BitTrackError(
+        ErrorCode::NETWORK_ERROR,
+        "Unable to listen on 127.0.0.1:" + std::to_string(port) + ": " + reason,
+        ErrorSeverity::ERROR,
+        "run_transfer_server");
+  }
+
+  signal(SIGPIPE, SIG_IGN);
+  std::cout << "Serving " << std::filesystem::current_path().string() << " at http://127.0.0.1:" << port << std::endl;
+
+  // Requests are served one at a time, so ref updates never race each other
+  for (;;)
+  {
+    int client_fd = accept(server_fd, nullptr, nullptr);
+    if (client_fd < 0)
+    {
+      if (errno == EINTR || errno == ECONNABORTED)
+      {
+        continue;
+      }
+      break;
+    }
+    handleTransferConnection(client_fd);
+    close(client_fd);
+  }
+  close(server_fd);
+}
+
+static std::vector<std::string> getTrackingCommits(const std::string &remote_name)
+{
+  std::vector<std::string> commits;
+  for (const auto &branch : ErrorHandler::safeListDirectoryFiles(getTrackingRefDir(remote_name)))
+  {
+    commits.push_back(readRefFile(getTrackingRefDir(remote_name) + "/" + branch.string()));
+  }
+  return commits;
+}
+
+// Remove tracking refs of branches the remote no longer has, and the
+// directories they leave empty
+static void pruneTrackingRefs(
+    const std::string &remote_name,
+    const std::vector<TransferRef> &refs)
+{
+  std::set<std::string> current;
+  for (const auto &ref : refs)
+  {
+    current.insert(ref.name.substr(std::string("refs/heads/").size()));
+  }
+
+  std::filesystem::path root = getTrackingRefDir(remote_name);
+  std::vector<std::filesystem::path> directories;
+  std::error_code error;
+  for (auto entry = std::filesystem::recursive_directory_iterator(root, error);
+       !error && entry != std::filesystem::recursive_directory_iterator();
+       entry.increment(error))
+  {
+    if (entry->is_directory())
+    {
+      directories.push_back(entry->path());
+    }
+    else if (current.count(entry->path().lexically_relative(root).generic_string()) == 0)
+    {
+      std::cout << "Pruned " << remote_name << "/" << entry->path().lexically_relative(root).generic_string() << std::endl;
+      ErrorHandler::safeRemoveFile(entry->path().string());
+    }
+  }
+
+  // Deepest directories come last in iteration order, so remove them first
+  for (auto directory = directories.rbegin(); directory != directories.rend(); ++directory)
+  {
+    if (std::filesystem::is_empty(*directory, error))
+    {
+      std::filesystem::remove(*directory, error);
+    }
+  }
+}
+
+bool fetchNative(
+    const std::string &remote_name,
+    const std::string &url)
+{
+  // Every commit this repository has is a have; the other side skips its ancestors
+  std::string request;
+  for (const auto &ref : getLocalTransferRefs())
+  {
+    request += "have " + ref.new_commit + "\n";
+  }
+  for (const auto &commit : getTrackingCommits(remote_name))
+  {
+    request += "have " + commit + "\n";
+  }
+
+  TransferReceiver receiver;
+  if (!openTransferReceiver(receiver))
+  {
+    return false;
+  }
+  bool received = callTransferService(
+      url,
+      "upload-pack",
+      makeStringBodySource(request),
+      [&receiver](const char *data, std::size_t size)
+      { return feedTransferReceiver(receiver, data, size); });
+
+  std::vector<TransferRef> refs;
+  TransferStats stats;
+  if (!received || !finishTransferReceiver(receiver, refs, stats))
+  {
+    ErrorHandler::printError(
+        ErrorCode::REMOTE_DOWNLOAD_FAILED,
+        "Fetch from " + url + " failed",
+        ErrorSeverity::ERROR,
+        "fetch_native");
+    return false;
+  }
+
+  // No branch was asked for by name, so the stream lists every branch of the
+  // remote and tracking refs missing from it belong to deleted branches
+  pruneTrackingRefs(remote_name, refs);
+  for (const auto &ref : refs)
+  {
+    std::string branch_name = ref.name.substr(std::string("refs/heads/").size());
+    ErrorHandler::safeWriteFile(getTrackingRefDir(remote_name) + "/" + branch_name, ref.new_commit + "\n");
+    updateCommitGraph(ref.new_commit);
+  }
+
+  std::cout << "Fetched " << stats.commit_count << " commits and " << stats.object_count << " objects ("
+            << stats.byte_count << " bytes) from " << url << std::endl;
+  return true;
+}
+
+bool pullNative(
+    const std::string &remote_name,
+    const std::string &url,
+    const std::string &branch_name)
+{
+  // Both a fast-forward and a merge rewrite the working tree, and the merge
+  // commit is built from the merged tree, so local edits would be lost
+  if (hasUncommittedChanges())
+  {
+    ErrorHandler::printError(
+        ErrorCode::UNCOMMITTED_CHANGES,
+        "Uncommitted changes detected. Please commit or stash your changes before pulling.",
+        ErrorSeverity::ERROR,
+        "pull_native");
+    return false;
+  }
+
+  if (!fetchNative(remote_name, url))
+  {
+    return false;
+  }
+
+  std::string target = readRefFile(getTrackingRefDir(remote_name) + "/" + branch_name);
+  if (target.empty())
+  {
+    ErrorHandler::printError(
+        ErrorCode::BRANCH_NOT_FOUND,
+        "Branch '" + branch_name + "' not found on remote '" + remote_name + "'",
+        ErrorSeverity::ERROR,
+        "pull_native");
+    return false;
+  }
+
+  std::string current_branch = getCurrentBranchName();
+  std::string local = getCurrentCommit();
+  if (local == target || (!local.empty() && isAncestor(target, local)))
+  {
+    std::cout << "Already up to date" << std::endl;
+    return true;
+  }
+
+  if (local.empty() || isAncestor(local, target))
+  {
+    restoreFilesFromCommit(target, local);
+    ErrorHandler::safeWriteFile(".bittrack/refs/heads/" + current_branch, target + "\n");
+    recordBranchCommits(current_branch, local, target);
+    std::cout << "Fast-forwarded " << current_branch << " to " << target.substr(0, 8) << std::endl;
+    return true;
+  }
+
+  std::string merge_base = findMergeBase(local, target);
+  if (merge_base.empty())
+  {
+    ErrorHandler::printError(
+        ErrorCode::MERGE_CONFLICT,
+        "No common ancestor with " + remote_name + "/" + branch_name,
+        ErrorSeverity::ERROR,
+        "pull_native");
+    return false;
+  }
+
+  MergeResult result = threeWayMerge(merge_base, local, target);
+  if (!result.success)
+  {
+    std::cout << "Automatic merge failed; fix the conflicts and commit the result" << std::endl;
+    return false;
+  }
+  createMergeCommit("Merge " + remote_name + "/" + branch_name + " into " + current_branch, {local, target}, result.merged_tree);
+  return true;
+}
+
+bool pushNative(
+    const std::string &remote_name,
+    const std::string &url,
+    const std::string &branch_name)
+{
+  std::string local = getBranchLastCommitHash(branch_name);
+  std::string ref_name = "refs/heads/" + branch_name;
+  if (local.empty() || !isValidTransferRef(ref_name))
+  {
+    ErrorHandler::printError(
+        ErrorCode::BRANCH_NOT_FOUND,
+        "Nothing to push on branch '" + branch_name + "'",
+        ErrorSeverity::ERROR,
+        "push_native");
+    return false;
+  }
+
+  // The advertised tips this repository already has are the haves
+  std::string advertised;
+  if (!callTransferService(
+          url,
+          "refs",
+          nullptr,
+          [&advertised](const char *data, std::size_t size)
+          {
+            advertised.append(data, size);
+            return advertised.size() <= TRANSFER_MAX_TEXT;
+          }))
+  {
+    return false;
+  }
+  std::string remote_commit;
+  std::vector<std::string> haves;
+  std::istringstream lines(advertised);
+  std::string commit, name;
+  while (lines >> commit >> name)
+  {
+    if (name == ref_name)
+    {
+      remote_commit = commit;
+    }
+    if (hasCommitLog(commit))
+    {
+      haves.push_back(commit);
+    }
+  }
+
+  if (remote_commit == local)
+  {
+    std::cout << "Everything up to date" << std::endl;
+    return true;
+  }
+  if (!remote_commit.empty() && (!hasCommitLog(remote_commit) || !isAncestor(remote_commit, local)))
+  {
+    ErrorHandler::printError(
+        ErrorCode::REMOTE_UPLOAD_FAILED,
+        "Remote branch '" + branch_name + "' has commits missing locally. Use 'bittrack --pull' first",
+        ErrorSeverity::ERROR,
+        "push_native");
+    return false;
+  }
+
+  // The stream is staged on disk so the request body can be replayed in chunks
+  std::vector<std::string> boundary;
+  std::vector<std::string> missing = findMissingCommits({local}, haves, boundary);
+  std::string stream_path = ".bittrack/tmp_push_" + std::to_string(getpid());
+  TransferStats stats;
+  bool written;
+  {
+    std::ofstream stream(stream_path, std::ios::binary | std::ios::trunc);
+    written = writeTransferStream(
+        {{ref_name, remote_commit, local}},
+        missing,
+        boundary,
+        [&stream](const char *data, std::size_t size)
+        { return static_cast<bool>(stream.write(data, size)); },
+        stats);
+  }
+
+  std::string report;
+  HttpBodyRewind rewind;
+  HttpBodySource body = makeFileBodySource(stream_path, rewind);
+  bool sent = written && callTransferService(
+                             url,
+                             "receive-pack",
+                             body,
+                             [&report](const char *data, std::size_t size)
+                             {
+                               report.append(data, size);
+                               return report.size() <= TRANSFER_MAX_TEXT;
+                             },
+                             rewind);
+  ErrorHandler::safeRemoveFile(stream_path);
+  if (!sent)
+  {
+    ErrorHandler::printError(
+        ErrorCode::REMOTE_UPLOAD_FAILED,
+        "Push to " + url + " failed",
+        ErrorSeverity::ERROR,
+        "push_native");
+    return false;
+  }
+
+  if (report.rfind("ok " + ref_name, 0) != 0)
+  {
+    std::string reason = report.rfind("ng " + ref_name + " ", 0) == 0 ? report.substr(ref_name.size() + 4) : "no report";
+    reason.erase(reason.find_last_not_of("\n") + 1);
+    ErrorHandler::printError(
+        ErrorCode::REMOTE_UPLOAD_FAILED,
+        "Remote rejected " + ref_name + ": " + reason,
+        ErrorSeverity::ERROR,
+        "push_native");
+    return false;
+  }
+
+  ErrorHandler::safeWriteFile(getTrackingRefDir(remote_name) + "/" + branch_name, local + "\n");
+  if (local == getCurrentCommit())
+  {
+    setLastPushedCommit(local);
+  }
+  std::cout << "Pushed " << stats.commit_count << " commits and " << stats.object_count << " objects ("
+            << stats.byte_count << " bytes) to " << url << std::endl;
+  return true;
+}
@@ -8,74 +8,160 @@ std::string formatTimestamp(std::time_t timestamp)
   return std::string(buffer);
 }
 
-std::string base64Encode(const std::string &input)
+std::size_t base64EncodeBlock(
+    const unsigned char *input,
+    std::size_t length,
+    char *output)
 {
-  // Base64 encoding implementation
-  const std::string chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-  std::string result;
-  int val = 0, valb = -6;
+  static const char chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
-  // Encode input string to base64
-  for (unsigned char c : input)
+  // Whole 3-byte groups map to 4 characters with no carried state between
+  // groups, which keeps the loop free of branches
+  std::size_t full = length - length % 3;
+  char *out = output;
+  for (std::size_t i = 0; i < full; i += 3)
   {
-    val = (val << 8) + c; // Shift left and add character
-    valb += 8;            // Increase bit count
-    while (valb >= 0)     // While there are enough bits
-    {
-      // Extract 6 bits and map to base64 character
-      result.push_back(chars[(val >> valb) & 0x3F]);
-      valb -= 6;
-    }
+    uint32_t group = (uint32_t(input[i]) << 16) | (uint32_t(input[i + 1]) << 8) | uint32_t(input[i + 2]);
+    out[0] = chars[(group >> 18) & 0x3F];
+    out[1] = chars[(group >> 12) & 0x3F];
+    out[2] = chars[(group >> 6) & 0x3F];
+    out[3] = chars[group & 0x3F];
+    out += 4;
   }
-  if (valb > -6) // Handle remaining bits
-  {
-    result.push_back(chars[((val << 8) >> (valb + 8)) & 0x3F]);
-  }
-  while (result.size() % 4) // Pad with '=' characters
+
+  // Pad the last partial group with '=' characters
+  std::size_t remaining = length - full;
+  if (remaining > 0)
   {
-    result.push_back('=');
+    uint32_t group = uint32_t(input[full]) << 16;
+    if (remaining == 2)
+    {
+      group |= uint32_t(input[full + 1]) << 8;
+    }
+    out[0] = chars[(group >> 18) & 0x3F];
+    out[1] = chars[(group >> 12) & 0x3F];
+    out[2] = remaining == 2 ? chars[(group >> 6) & 0x3F] : '=';
+    out[3] = '=';
+    out += 4;
   }
+
+  return static_cast<std::size_t>(out - output);
+}
+
+std::string base64Encode(const std::string &input)
+{
+  std::string result((input.size() + 2) / 3 * 4, '\0');
+  base64EncodeBlock(reinterpret_cast<const unsigned char *>(input.data()), input.size(), &result[0]);
   return result;
 }
 
-std::string base64Decode(const std::string &encoded)
+std::string jsonEscape(const std::string &input)
 {
-  const std::string chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-  std::string decoded;
-  int val = 0, valb = -8;
-  int padding = 0;
+  // Escape a string for use inside a JSON string literal
+  std::string escaped;
+  escaped.reserve(input.size());
+  for (unsigned char c : input)
+  {
+    switch (c)
+    {
+    case '"':
+      escaped += "\\\"";
+      break;
+    case '\\':
+      escaped += "\\\\";
+      break;
+    case '\n':
+      escaped += "\\n";
+      break;
+    case '\r':
+      escaped += "\\r";
+      break;
+    case '\t':
+      escaped += "\\t";
+      break;
+    default:
+      if (c < 0x20)
+      {
+        // Other control characters have no short escape
+        char buffer[8];
+        std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+        escaped += buffer;
+      }
+      else
+      {
+        escaped += static_cast<char>(c);
+      }
+    }
+  }
+  return escaped;
+}
 
-  for (char c : encoded)
+bool base64DecodeBlock(
+    const char *input,
+    std::size_t length,
+    unsigned char *output,
+    std::size_t &written,
+    Base64DecodeState &state)
+{
+  // Map every character to its 6-bit value once; -1 marks characters to skip
+  // and -2 characters that cannot appear in base64
+  static const auto values = []()
   {
-    if (c == '=')
+    std::array<int8_t, 256> table;
+    table.fill(-2);
+    const char chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    for (int i = 0; i < 64; i++)
     {
-      padding++;
-      continue;
+      table[static_cast<unsigned char>(chars[i])] = static_cast<int8_t>(i);
     }
-    if (c == '\n' || c == '\r' || c == ' ' || c == '\t')
+    for (unsigned char c : {'=', '\n', '\r', ' ', '\t'})
     {
-      continue; // Skip whitespace and newlines
+      table[c] = -1;
     }
-    size_t pos = chars.find(c);
-    if (pos == std::string::npos)
+    return table;
+  }();
+
+  written = 0;
+  for (std::size_t i = 0; i < length; i++)
+  {
+    int8_t value = values[static_cast<unsigned char>(input[i])];
+    if (value < 0)
     {
-      // Invalid character found, return empty string to indicate error
-      ErrorHandler::printError(
-          ErrorCode::REMOTE_CONNECTION_FAILED,
-          "Invalid character in base64 encoded data",
-          ErrorSeverity::ERROR,
-          "base64Decode");
-      return "";
+      if (value == -2)
+      {
+        return false;
+      }
+      continue;
     }
-    val = (val << 6) + pos;
-    valb += 6;
-    if (valb >= 0)
+
+    state.bits = (state.bits << 6) | static_cast<uint32_t>(value);
+    state.bit_count += 6;
+    if (state.bit_count >= 8)
     {
-      decoded.push_back(char((val >> valb) & 0xFF));
-      valb -= 8;
+      state.bit_count -= 8;
+      output[written++] = static_cast<unsigned char>((state.bits >> state.bit_count) & 0xFF);
     }
   }
+  return true;
+}
+
+std::string base64Decode(const std::string &encoded)
+{
+  std::string decoded(encoded.size() * 3 / 4 + 1, '\0');
+  std::size_t written = 0;
+  Base64DecodeState state;
+  if (!base64DecodeBlock(encoded.data(), encoded.size(), reinterpret_cast<unsigned char *>(&decoded[0]), written, state))
+  {
+    // Invalid character found, return empty string to indicate error
+    ErrorHandler::printError(
+        ErrorCode::REMOTE_CONNECTION_FAILED,
+        "Invalid character in base64 encoded data",
+        ErrorSeverity::ERROR,
+        "base64Decode");
+    return "";
+  }
 
+  decoded.resize(written);
   return decoded;
 }
 
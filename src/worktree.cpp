@@ -0,0 +1,156 @@
+#include "../include/worktree.hpp"
+
+// Directories waiting to be read, shared by all walker threads
+struct WorkingTreeQueue
+{
+  std::mutex mutex;                    // guards every field below
+  std::condition_variable wakeup;      // signalled when directories are queued or the walk ends
+  std::vector<std::string> pending;    // directories still to read, relative to the root
+  std::size_t active;                  // threads currently reading a directory
+  std::vector<WorkingTreeEntry> files; // files found so far
+  std::vector<std::string> unreadable; // directories that could not be opened
+
+  WorkingTreeQueue() : active(0) {}
+};
+
+// Returns false when the directory cannot be opened
+static bool readWorkingTreeDirectory(
+    const std::string &root,
+    const std::string &directory,
+    const std::vector<IgnorePattern> &patterns,
+    std::vector<std::string> &subdirectories,
+    std::vector<WorkingTreeEntry> &files)
+{
+  std::string directory_path = directory.empty() ? root : root + "/" + directory;
+  DIR *handle = opendir(directory_path.c_str());
+  if (handle == nullptr)
+  {
+    return false;
+  }
+
+  while (struct dirent *item = readdir(handle))
+  {
+    std::string name = item->d_name;
+    if (name == "." || name == "..")
+    {
+      continue;
+    }
+
+    std::string relative_path = directory.empty() ? name : directory + "/" + name;
+    std::string full_path = root == "." ? relative_path : root + "/" + relative_path;
+
+    // d_type spares a stat call for directories; symlinks and file systems
+    // that do not report a type fall back to stat
+    bool is_directory = item->d_type == DT_DIR;
+    if (item->d_type == DT_UNKNOWN)
+    {
+      struct stat link_stat;
+      is_directory = lstat(full_path.c_str(), &link_stat) == 0 && S_ISDIR(link_stat.st_mode);
+    }
+
+    if (is_directory)
+    {
+      // Ignored subtrees such as build output are never entered
+      if (!shouldIgnoreDirectory(relative_path, patterns))
+      {
+        subdirectories.push_back(relative_path);
+      }
+      continue;
+    }
+
+    WorkingTreeEntry entry;
+    entry.path = relative_path;
+    if (stat(full_path.c_str(), &entry.file_stat) != 0 || !S_ISREG(entry.file_stat.st_mode) || shouldIgnoreFile(relative_path, patterns))
+    {
+      continue;
+    }
+    files.push_back(entry);
+  }
+  closedir(handle);
+  return true;
+}
+
+std::vector<WorkingTreeEntry> listWorkingTreeFiles(const std::string &root)
+{
+  // Resolve the ignore rules once so the threads never contend on the rule cache
+  std::shared_ptr<const std::vector<IgnorePattern>> patterns = getIgnorePatterns();
+
+  WorkingTreeQueue queue;
+  queue.pending.push_back("");
+
+  // Each thread takes one directory at a time and queues the subdirectories it
+  // finds, so the walk fans out as wide as the tree allows and slow readdir or
+  // stat round trips on network file systems overlap
+  auto worker = [&]()
+  {
+    std::unique_lock<std::mutex> lock(queue.mutex);
+    while (true)
+    {
+      queue.wakeup.wait(lock, [&]()
+                        { return !queue.pending.empty() || queue.active == 0; });
+      if (queue.pending.empty())
+      {
+        return;
+      }
+
+      std::string directory = queue.pending.back();
+      queue.pending.pop_back();
+      queue.active++;
+      lock.unlock();
+
+      std::vector<std::string> subdirectories;
+      std::vector<WorkingTreeEntry> files;
+      bool readable = readWorkingTreeDirectory(root, directory, *patterns, subdirectories, files);
+
+      lock.lock();
+      queue.active--;
+      if (!readable)
+      {
+        queue.unreadable.push_back(directory.empty() ? root : root + "/" + directory);
+      }
+      queue.pending.insert(queue.pending.end(), subdirectories.begin(), subdirectories.end());
+      queue.files.insert(
+          queue.files.end(),
+          std::make_move_iterator(files.begin()),
+          std::make_move_iterator(files.end()));
+
+      // Wake idle threads for the new work, or all of them once the walk is done
+      if (!subdirectories.empty() || (queue.pending.empty() && queue.active == 0))
+      {
+        queue.wakeup.notify_all();
+      }
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (unsigned int i = 1; i < getWorkerCount(); i++)
+  {
+    workers.emplace_back(worker);
+  }
+  worker();
+
+  for (auto &thread : workers)
+  {
+    thread.join();
+  }
+
+  // Warnings are printed here rather than by the threads so they never
+  // interleave, and in path order so they read the same on every run
+  std::sort(queue.unreadable.begin(), queue.unreadable.end());
+  for (const auto &directory_path : queue.unreadable)
+  {
+    ErrorHandler::printError(
+        ErrorCode::FILE_READ_ERROR,
+        "Unable to read directory: " + directory_path,
+        ErrorSeverity::WARNING,
+        "list_working_tree_files");
+  }
+
+  // Sort so callers see the same order regardless of thread scheduling
+  std::sort(
+      queue.files.begin(),
+      queue.files.end(),
+      [](const WorkingTreeEntry &a, const WorkingTreeEntry &b)
+      { return a.path < b.path; });
+  return queue.files;
+}
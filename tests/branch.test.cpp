@@ -148,3 +148,81 @@ bool test_file_restoration_from_commit()
 
   return file_exists;
 }
+
+// checkout only rewrites and deletes files that differ between the two commits
+bool test_branch_checkout_touches_only_delta()
+{
+  std::string alpha = storeBlob("alpha\n");
+  std::string beta = storeBlob("beta\n");
+  std::string beta_changed = storeBlob("beta changed\n");
+  std::string from_commit(64, '7');
+  std::string to_commit(64, '8');
+
+  ErrorHandler::safeWriteFile(
+      ".bittrack/commits/" + from_commit,
+      "Message: checkout from\nFiles: \n"
+      "checkout_dir/keep.txt " + alpha + "\n"
+      "checkout_dir/change.txt " + beta + "\n"
+      "checkout_gone/old.txt " + alpha + "\n");
+  ErrorHandler::safeWriteFile(
+      ".bittrack/commits/" + to_commit,
+      "Message: checkout to\nFiles: \n"
+      "checkout_dir/keep.txt " + alpha + "\n"
+      "checkout_dir/change.txt " + beta_changed + "\n"
+      "checkout_new.txt " + beta + "\n");
+
+  restoreFilesFromCommit(from_commit, "");
+
+  // An old timestamp shows whether the unchanged file gets rewritten
+  auto old_time = std::filesystem::file_time_type::clock::now() - std::chrono::hours(24);
+  std::filesystem::last_write_time("checkout_dir/keep.txt", old_time);
+
+  restoreFilesFromCommit(to_commit, from_commit);
+
+  bool untouched = std::filesystem::last_write_time("checkout_dir/keep.txt") == old_time;
+  bool changed = ErrorHandler::safeReadFile("checkout_dir/change.txt") == "beta changed\n";
+  bool added = ErrorHandler::safeReadFile("checkout_new.txt") == "beta\n";
+  bool removed = !std::filesystem::exists("checkout_gone");
+
+  std::filesystem::remove_all("checkout_dir");
+  std::filesystem::remove_all("checkout_gone");
+  std::filesystem::remove("checkout_new.txt");
+  std::filesystem::remove(".bittrack/commits/" + from_commit);
+  std::filesystem::remove(".bittrack/commits/" + to_commit);
+
+  return untouched && changed && added && removed;
+}
+
+// paths that share a blob each get the full content, and stay independent copies
+bool test_branch_checkout_clones_shared_blobs()
+{
+  std::string shared = storeBlob("shared content\n");
+  std::string other = storeBlob("other content\n");
+  std::string commit(64, '9');
+
+  ErrorHandler::safeWriteFile(
+      ".bittrack/commits/" + commit,
+      "Message: shared blobs\nFiles: \n"
+      "shared_dir/first.txt " + shared + "\n"
+      "shared_dir/nested/second.txt " + shared + "\n"
+      "shared_third.txt " + shared + "\n"
+      "shared_dir/other.txt " + other + "\n");
+
+  restoreFilesFromCommit(commit, "");
+
+  bool restored = ErrorHandler::safeReadFile("shared_dir/first.txt") == "shared content\n" &&
+                  ErrorHandler::safeReadFile("shared_dir/nested/second.txt") == "shared content\n" &&
+                  ErrorHandler::safeReadFile("shared_third.txt") == "shared content\n" &&
+                  ErrorHandler::safeReadFile("shared_dir/other.txt") == "other content\n";
+
+  // Writing one clone leaves the others alone
+  ErrorHandler::safeWriteFile("shared_dir/first.txt", "edited\n");
+  bool independent = ErrorHandler::safeReadFile("shared_dir/nested/second.txt") == "shared content\n" &&
+                     ErrorHandler::safeReadFile("shared_third.txt") == "shared content\n";
+
+  std::filesystem::remove_all("shared_dir");
+  std::filesystem::remove("shared_third.txt");
+  std::filesystem::remove(".bittrack/commits/" + commit);
+
+  return restored && independent;
+}
@@ -0,0 +1,31 @@
+#include "../include/clone.hpp"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+// a clone matches its source in content and mode and replaces a longer existing target
+bool test_clone_file_copies_content_and_mode()
+{
+  std::string content;
+  for (int i = 0; i < 100000; i++)
+  {
+    content += std::to_string(i) + "\n";
+  }
+  std::ofstream("clone_source.txt", std::ios::binary) << content;
+  std::filesystem::permissions("clone_source.txt", std::filesystem::perms(0750));
+  std::ofstream("clone_target.txt", std::ios::binary) << content << content;
+
+  bool cloned = cloneFile("clone_source.txt", "clone_target.txt");
+  std::ifstream target("clone_target.txt", std::ios::binary);
+  std::stringstream target_content;
+  target_content << target.rdbuf();
+  bool same_mode = std::filesystem::status("clone_target.txt").permissions() == std::filesystem::perms(0750);
+
+  // a file cannot be cloned onto itself, and trying leaves it intact
+  bool refused_self = !cloneFile("clone_source.txt", "clone_source.txt") &&
+                      std::filesystem::file_size("clone_source.txt") == content.size();
+
+  std::filesystem::remove("clone_source.txt");
+  std::filesystem::remove("clone_target.txt");
+  return cloned && target_content.str() == content && same_mode && refused_self;
+}
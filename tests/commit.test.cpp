@@ -21,3 +21,43 @@ bool test_commit_staged_files()
 
   return is_committed;
 }
+
+// a legacy newest-first history is converted once, then records are appended
+bool test_commit_history_append_only()
+{
+  std::string saved_history = ErrorHandler::safeReadFile(getHistoryPath());
+  ErrorHandler::safeWriteFile(getHistoryPath(), "legacy_2 history_test\nlegacy_1 history_test\n");
+
+  insertCommitRecordToHistory("appended_3", "history_test");
+
+  std::vector<std::pair<std::string, std::string>> history = readCommitHistory();
+  std::string content = ErrorHandler::safeReadFile(getHistoryPath());
+  bool appended = history.size() == 3 && history[0].first == "legacy_1" && history[2].first == "appended_3" &&
+                  content.substr(content.size() - std::string("appended_3 history_test\n").size()) == "appended_3 history_test\n";
+  bool latest = getLastCommit("history_test") == "appended_3";
+
+  ErrorHandler::safeWriteFile(getHistoryPath(), saved_history);
+  return appended && latest;
+}
+
+// the latest commit of a branch is found across journal blocks
+bool test_commit_history_reverse_scan()
+{
+  std::string saved_history = ErrorHandler::safeReadFile(getHistoryPath());
+
+  std::vector<std::pair<std::string, std::string>> history;
+  history.emplace_back("early_commit", "scan_old");
+  for (int i = 0; i < 5000; i++)
+  {
+    history.emplace_back("filler_commit_" + std::to_string(i), "scan_busy");
+  }
+  writeCommitHistory(history);
+  insertCommitRecordToHistory("latest_commit", "scan_busy");
+
+  bool found = getLastCommit("scan_old") == "early_commit" &&
+               getLastCommit("scan_busy") == "latest_commit" &&
+               getLastCommit("scan_missing").empty();
+
+  ErrorHandler::safeWriteFile(getHistoryPath(), saved_history);
+  return found;
+}
@@ -99,3 +99,43 @@ bool test_diff_unstaged_changes()
 
   return !result.hunks.empty();
 }
+
+// diff of a line inserted at the top is a single addition
+bool test_diff_myers_minimal_edit()
+{
+  std::vector<std::string> old_lines = {"a", "b", "c", "d"};
+  std::vector<std::string> new_lines = {"x", "a", "b", "c", "d"};
+
+  std::vector<DiffLine> lines = computeDiffLines(old_lines, new_lines);
+  int additions = 0;
+  int deletions = 0;
+  for (const auto &line : lines)
+  {
+    additions += line.type == DiffLineType::ADDITION ? 1 : 0;
+    deletions += line.type == DiffLineType::DELETION ? 1 : 0;
+  }
+
+  return lines.size() == 5 && additions == 1 && deletions == 0 &&
+         lines[0].type == DiffLineType::ADDITION && lines[0].content == "x";
+}
+
+// hunks carry context lines and unified header counts
+bool test_diff_hunk_context_and_headers()
+{
+  std::vector<std::string> old_lines;
+  for (int i = 1; i <= 20; i++)
+  {
+    old_lines.push_back("line " + std::to_string(i));
+  }
+  std::vector<std::string> new_lines = old_lines;
+  new_lines[9] = "changed 10";
+  new_lines.push_back("line 21");
+
+  std::vector<DiffHunk> hunks = computeHunks(old_lines, new_lines, 3);
+  std::vector<DiffHunk> empty_old = computeHunks({}, {"only"}, 3);
+
+  return hunks.size() == 2 &&
+         hunks[0].header == "@@ -7,7 +7,7 @@" && hunks[0].lines.size() == 8 &&
+         hunks[1].header == "@@ -18,3 +18,4 @@" &&
+         empty_old.size() == 1 && empty_old[0].header == "@@ -0,0 +1,1 @@";
+}
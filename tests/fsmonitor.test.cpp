@@ -0,0 +1,51 @@
+#include "../include/fsmonitor.hpp"
+#include <fstream>
+#include <thread>
+
+// the monitor state survives a save and load round trip
+bool test_fsmonitor_state_round_trip()
+{
+  FsMonitorState state;
+  state.token = "123-456:42";
+  state.head = std::string(64, 'a');
+  state.index_digest = std::string(64, 'b');
+  state.untracked = {"notes.txt", "dir/with space.txt"};
+
+  FsMonitorState loaded;
+  bool round_trip = saveFsMonitorState(state) && loadFsMonitorState(loaded) &&
+                    loaded.token == state.token &&
+                    loaded.head == state.head &&
+                    loaded.index_digest == state.index_digest &&
+                    loaded.untracked == state.untracked;
+
+  std::filesystem::remove(getFsMonitorStatePath());
+  return round_trip;
+}
+
+// a running monitor reports paths written after a token and nothing else
+bool test_fsmonitor_reports_changes_since_token()
+{
+  FsMonitorChanges unused;
+  if (queryFsMonitor("", unused))
+  {
+    return false;
+  }
+
+  startFsMonitor();
+  std::filesystem::create_directories("fsmonitor_test");
+
+  FsMonitorChanges first;
+  bool started = queryFsMonitor("", first) && first.full_scan;
+
+  std::ofstream("fsmonitor_test/changed.txt") << "changed";
+  FsMonitorChanges second;
+  bool reported = queryFsMonitor(first.token, second) && !second.full_scan &&
+                  std::find(second.paths.begin(), second.paths.end(), "fsmonitor_test/changed.txt") != second.paths.end();
+
+  FsMonitorChanges third;
+  bool quiet = queryFsMonitor(second.token, third) && !third.full_scan && third.paths.empty();
+
+  stopFsMonitor();
+  std::filesystem::remove_all("fsmonitor_test");
+  return started && reported && quiet;
+}
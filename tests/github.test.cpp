@@ -0,0 +1,90 @@
+#include "../include/github.hpp"
+#include <algorithm>
+#include <filesystem>
+
+// recorded blob mappings are read back only for the repository they were pushed to
+bool test_github_blob_mapping_is_scoped_to_repository()
+{
+  std::filesystem::remove(".bittrack/github_blobs");
+  addGithubBlobMappings("owner", "one", {{"local_a", "remote_a"}, {"local_b", "remote_b"}});
+  addGithubBlobMappings("owner", "two", {{"local_a", "remote_c"}});
+
+  std::unordered_map<std::string, std::string> one = getGithubBlobMapping("owner", "one");
+  std::unordered_map<std::string, std::string> two = getGithubBlobMapping("owner", "two");
+  bool empty_elsewhere = getGithubBlobMapping("other", "one").empty();
+
+  std::filesystem::remove(".bittrack/github_blobs");
+  return one.size() == 2 && one["local_a"] == "remote_a" && one["local_b"] == "remote_b" &&
+         two.size() == 1 && two["local_a"] == "remote_c" && empty_elsewhere;
+}
+
+// a recursive tree listing fed in small pieces yields its blobs and truncated flag
+bool test_github_tree_listing_streams_entries()
+{
+  std::string body =
+      "{\"sha\":\"t0\",\"url\":\"https://api.github.com/repos/o/r/git/trees/t0\",\"tree\":["
+      "{\"path\":\"README.md\",\"mode\":\"100644\",\"type\":\"blob\",\"sha\":\"b1\",\"size\":12,\"url\":\"u1\"},"
+      "{\"path\":\"src\",\"mode\":\"040000\",\"type\":\"tree\",\"sha\":\"t1\",\"url\":\"u2\"},"
+      "{\"path\":\"src/main.cpp\",\"mode\":\"100644\",\"type\":\"blob\",\"sha\":\"b2\",\"size\":3401,\"url\":\"u3\"},"
+      "{\"path\":\"lib\",\"mode\":\"160000\",\"type\":\"commit\",\"sha\":\"c1\"},"
+      "{\"path\":\"src/a \\\"quoted\\\" name.txt\",\"mode\":\"100644\",\"type\":\"blob\",\"sha\":\"b3\",\"size\":0,\"url\":\"u4\"}"
+      "],\"truncated\":true}";
+
+  std::vector<std::pair<std::string, std::string>> files;
+  GithubTreeListing listing;
+  listing.files = &files;
+  JsonParser parser;
+  parser.handler = [&](JsonEvent event, const std::string &key, const std::string &value, std::size_t depth)
+  {
+    return onGithubTreeEvent(listing, event, key, value, depth);
+  };
+  for (std::size_t i = 0; i < body.size(); i += 7)
+  {
+    feedJson(parser, body.data() + i, std::min<std::size_t>(7, body.size() - i));
+  }
+
+  std::vector<std::pair<std::string, std::string>> expected = {
+      {"README.md", "b1"},
+      {"src/main.cpp", "b2"},
+      {"src/a \"quoted\" name.txt", "b3"}};
+
+  // an error response carries only a message
+  std::vector<std::pair<std::string, std::string>> none;
+  GithubTreeListing refused;
+  refused.files = &none;
+  bool message = parseJson(
+                     "{\"message\":\"Not Found\",\"documentation_url\":\"https://docs.github.com\"}",
+                     [&](JsonEvent event, const std::string &key, const std::string &value, std::size_t depth)
+                     { return onGithubTreeEvent(refused, event, key, value, depth); }) &&
+                 refused.message == "Not Found" && !refused.found_tree;
+
+  return finishJson(parser) && listing.found_tree && listing.truncated && files == expected && message;
+}
+
+// tag refs are read from a single ref object or an array of them, skipping other refs
+bool test_github_tag_refs_follow_ref_depth()
+{
+  std::vector<std::pair<std::string, std::string>> listed;
+  bool array = parseGithubTagRefs(
+      "[{\"ref\":\"refs/tags/v1.0\",\"node_id\":\"n1\",\"url\":\"u1\","
+      "\"object\":{\"sha\":\"s1\",\"type\":\"commit\",\"url\":\"o1\"}},"
+      "{\"ref\":\"refs/heads/main\",\"object\":{\"sha\":\"s2\",\"type\":\"commit\"}},"
+      "{\"object\":{\"type\":\"tag\",\"sha\":\"s3\"},\"ref\":\"refs/tags/v2.0\"}]",
+      listed);
+
+  std::vector<std::pair<std::string, std::string>> single;
+  bool object = parseGithubTagRefs(
+      "{\"ref\":\"refs/tags/solo\",\"object\":{\"sha\":\"s4\",\"type\":\"commit\"}}",
+      single);
+
+  std::vector<std::pair<std::string, std::string>> missing;
+  bool not_found = parseGithubTagRefs("{\"message\":\"Not Found\"}", missing);
+
+  std::vector<std::pair<std::string, std::string>> broken;
+  bool malformed = parseGithubTagRefs("[{\"ref\":\"refs/tags/x\"", broken);
+
+  return array && listed == std::vector<std::pair<std::string, std::string>>{{"v1.0", "s1"}, {"v2.0", "s3"}} &&
+         object && single == std::vector<std::pair<std::string, std::string>>{{"solo", "s4"}} &&
+         not_found && missing.empty() &&
+         !malformed;
+}
@@ -0,0 +1,152 @@
+#include "../include/graph.hpp"
+#include "../include/merge.hpp"
+#include <fstream>
+#include <filesystem>
+
+static void writeGraphTestCommit(
+    const std::string &commit_hash,
+    const std::vector<std::string> &parents)
+{
+  std::ofstream log(".bittrack/commits/" + commit_hash);
+  log << "Author: graph test\n";
+  log << "Timestamp: 2024-01-01 12:00:00\n";
+  for (const auto &parent : parents)
+  {
+    log << "Parent: " << parent << "\n";
+  }
+  log << "Message: graph test\n";
+  log << "Files: \n";
+  log.close();
+}
+
+static void removeGraphTestCommits(const std::vector<std::string> &commit_hashes)
+{
+  for (const auto &commit_hash : commit_hashes)
+  {
+    std::filesystem::remove(".bittrack/commits/" + commit_hash);
+  }
+  std::filesystem::remove(getCommitGraphPath());
+  std::filesystem::remove(getCommitGraphTailPath());
+}
+
+// merge base and ancestry follow generation numbers through a merge commit
+bool test_graph_merge_base_and_ancestry()
+{
+  std::string root(64, '1');
+  std::string base(64, '2');
+  std::string left(64, '3');
+  std::string right(64, '4');
+  std::string right_tip(64, '5');
+  std::string merge(64, '6');
+  std::vector<std::string> commits = {root, base, left, right, right_tip, merge};
+
+  std::filesystem::remove(getCommitGraphPath());
+  writeGraphTestCommit(root, {});
+  writeGraphTestCommit(base, {root});
+  writeGraphTestCommit(left, {base});
+  writeGraphTestCommit(right, {base});
+  writeGraphTestCommit(right_tip, {right});
+  writeGraphTestCommit(merge, {left, right_tip});
+
+  // Queries build the missing graph on demand
+  bool merge_base_ok = findMergeBase(left, right_tip) == base && findMergeBase(merge, right) == right;
+  bool ancestry_ok = isAncestor(root, merge) && isAncestor(right, merge) && !isAncestor(left, right_tip) &&
+                     !isAncestor(merge, root) && isFastForward(merge, left);
+
+  CommitGraph graph;
+  bool loaded = loadCommitGraph(graph);
+  int64_t merge_position = findGraphCommit(graph, merge);
+  bool generation_ok = loaded && merge_position >= 0 &&
+                       getGraphGeneration(graph, static_cast<uint32_t>(merge_position)) == 5 &&
+                       getGraphParents(graph, static_cast<uint32_t>(merge_position)).size() == 2;
+
+  removeGraphTestCommits(commits);
+  return merge_base_ok && ancestry_ok && generation_ok;
+}
+
+// new commits are added to an existing graph, including octopus merges
+bool test_graph_incremental_update()
+{
+  std::string root(64, 'a');
+  std::string first(64, 'b');
+  std::string second(64, 'c');
+  std::string third(40, 'd');
+  std::string octopus(64, 'e');
+  std::vector<std::string> commits = {root, first, second, third, octopus};
+
+  std::filesystem::remove(getCommitGraphPath());
+  writeGraphTestCommit(root, {});
+  writeGraphTestCommit(first, {root});
+  writeGraphTestCommit(second, {root});
+  writeGraphTestCommit(third, {root});
+  bool built = writeCommitGraph();
+
+  writeGraphTestCommit(octopus, {first, second, third});
+  bool updated = updateCommitGraph(octopus);
+
+  CommitGraph graph;
+  bool loaded = loadCommitGraph(graph);
+  int64_t octopus_position = findGraphCommit(graph, octopus);
+  std::vector<uint32_t> parents;
+  if (octopus_position >= 0)
+  {
+    parents = getGraphParents(graph, static_cast<uint32_t>(octopus_position));
+  }
+
+  bool parents_ok = parents.size() == 3 &&
+                    getGraphCommitHash(graph, parents[0]) == first &&
+                    getGraphCommitHash(graph, parents[2]) == third;
+  bool merge_base_ok = graphMergeBase(first, third) == root && graphMergeBase(octopus, second) == second;
+
+  removeGraphTestCommits(commits);
+  return built && updated && loaded && parents_ok && merge_base_ok;
+}
+
+// new commits go to the tail without rewriting the graph file, and the tail is folded back in
+bool test_graph_appends_commits_to_tail()
+{
+  std::vector<std::string> commits;
+  auto chain_commit = [&](std::size_t index)
+  {
+    std::string commit_hash = sha256Hash("graph tail test " + std::to_string(index));
+    writeGraphTestCommit(commit_hash, commits.empty() ? std::vector<std::string>() : std::vector<std::string>{commits.back()});
+    commits.push_back(commit_hash);
+    return commit_hash;
+  };
+
+  std::filesystem::remove(getCommitGraphPath());
+  std::filesystem::remove(getCommitGraphTailPath());
+  std::string root = chain_commit(0);
+  bool built = writeCommitGraph();
+  std::string graph_file = ErrorHandler::safeReadFile(getCommitGraphPath());
+
+  chain_commit(1);
+  std::string tip = chain_commit(2);
+  bool appended = updateCommitGraph(tip) &&
+                  ErrorHandler::safeReadFile(getCommitGraphPath()) == graph_file &&
+                  std::filesystem::exists(getCommitGraphTailPath());
+
+  CommitGraph graph;
+  int64_t tip_position = loadCommitGraph(graph) ? findGraphCommit(graph, tip) : -1;
+  bool tail_ok = tip_position >= 0 &&
+                 getGraphGeneration(graph, static_cast<uint32_t>(tip_position)) == 3 &&
+                 getGraphCommitHash(graph, static_cast<uint32_t>(tip_position)) == tip &&
+                 graphIsAncestor(root, tip) && !graphIsAncestor(tip, root) &&
+                 graphMergeBase(tip, commits[1]) == commits[1];
+
+  // a rewrite takes the tail into the graph file
+  bool rewritten = writeCommitGraph() && !std::filesystem::exists(getCommitGraphTailPath()) &&
+                   loadCommitGraph(graph) && graph.file_count == graph.count && findGraphCommit(graph, tip) >= 0;
+
+  // so does an update that would grow the tail past its limit
+  for (std::size_t i = 3; i < 600; i++)
+  {
+    chain_commit(i);
+  }
+  bool folded = updateCommitGraph(commits.back()) && !std::filesystem::exists(getCommitGraphTailPath()) &&
+                loadCommitGraph(graph) && graph.file_count == graph.count &&
+                getGraphGeneration(graph, static_cast<uint32_t>(findGraphCommit(graph, commits.back()))) == 600;
+
+  removeGraphTestCommits(commits);
+  return built && appended && tail_ok && rewritten && folded;
+}
@@ -0,0 +1,41 @@
+#include "../include/hash.hpp"
+#include <fstream>
+#include <filesystem>
+
+// streaming a file larger than one chunk hashes the same as its content
+bool test_hash_file_matches_content_hash()
+{
+  std::string content;
+  for (int i = 0; i < 300000; i++)
+  {
+    content += "hash streaming line " + std::to_string(i) + "\n";
+  }
+
+  std::ofstream file("hash_stream_test.txt", std::ios::binary);
+  file << content;
+  file.close();
+
+  bool matches = hashFile("hash_stream_test.txt") == sha256Hash(content);
+  std::filesystem::remove("hash_stream_test.txt");
+
+  return matches;
+}
+
+// empty files hash like empty content and missing files yield no hash
+bool test_hash_file_empty_and_missing()
+{
+  std::ofstream file("hash_empty_test.txt");
+  file.close();
+
+  bool empty_matches = hashFile("hash_empty_test.txt") == sha256Hash("");
+  std::filesystem::remove("hash_empty_test.txt");
+
+  return empty_matches && hashFile("hash_missing_test.txt").empty();
+}
+
+// blob hashes match the ones git and GitHub assign to the same content
+bool test_git_blob_hash_matches_git()
+{
+  return gitBlobHash("hello") == "b6fc4c620b67d95f953a5c1c1230aaab5db5a1b0" &&
+         gitBlobHash("") == "e69de29bb2d1d6434b8b29ae775ad8c2e48c5391";
+}
@@ -0,0 +1,36 @@
+#include "../include/http.hpp"
+#include <filesystem>
+#include <fstream>
+
+// a batch of requests comes back complete and in request order
+bool test_http_perform_all_keeps_request_order()
+{
+  std::filesystem::create_directories("http_test");
+  std::vector<HttpRequest> requests;
+  std::vector<std::string> contents;
+  for (int i = 0; i < 20; i++)
+  {
+    std::string path = "http_test/file" + std::to_string(i) + ".txt";
+    contents.push_back(std::string(static_cast<std::size_t>(i) * 1000, static_cast<char>('a' + i)));
+    std::ofstream(path, std::ios::binary) << contents.back();
+
+    HttpRequest request;
+    request.url = "file://" + std::filesystem::absolute(path).string();
+    requests.push_back(request);
+  }
+
+  std::vector<HttpResponse> responses = httpPerformAll(requests);
+  bool all_match = responses.size() == requests.size();
+  for (std::size_t i = 0; all_match && i < responses.size(); i++)
+  {
+    all_match = responses[i].result == CURLE_OK && responses[i].body == contents[i];
+  }
+
+  // a missing file fails its own request only
+  HttpRequest missing;
+  missing.url = "file://" + std::filesystem::absolute("http_test/missing.txt").string();
+  bool missing_failed = httpPerform(missing).result != CURLE_OK;
+
+  std::filesystem::remove_all("http_test");
+  return all_match && missing_failed;
+}
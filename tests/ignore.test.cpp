@@ -0,0 +1,29 @@
+#include "../include/ignore.hpp"
+
+// compiled literal and glob rules agree with gitignore semantics, including negation and anchoring
+bool test_ignore_compiled_patterns()
+{
+  std::vector<IgnorePattern> patterns = parseIgnorePatterns({
+      "*.o",
+      "build/",
+      "docs/**/*.tmp",
+      "/TODO",
+      "!keep.o",
+      "file?.log",
+  });
+
+  return isFileIgnoredByIgnorePatterns("main.o", patterns) &&
+         isFileIgnoredByIgnorePatterns("src/deep/util.O", patterns) &&
+         !isFileIgnoredByIgnorePatterns("keep.o", patterns) &&
+         isFileIgnoredByIgnorePatterns("build/out/app", patterns) &&
+         isFileIgnoredByIgnorePatterns("src/build/app", patterns) &&
+         !isFileIgnoredByIgnorePatterns("builder/app", patterns) &&
+         isFileIgnoredByIgnorePatterns("docs/a/b/c.tmp", patterns) &&
+         isFileIgnoredByIgnorePatterns("docs/c.tmp", patterns) &&
+         !isFileIgnoredByIgnorePatterns("src/docs.tmp", patterns) &&
+         isFileIgnoredByIgnorePatterns("TODO", patterns) &&
+         !isFileIgnoredByIgnorePatterns("src/TODO", patterns) &&
+         isFileIgnoredByIgnorePatterns("file1.log", patterns) &&
+         !isFileIgnoredByIgnorePatterns("file12.log", patterns) &&
+         !isFileIgnoredByIgnorePatterns("main.cpp", patterns);
+}
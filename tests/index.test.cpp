@@ -0,0 +1,88 @@
+#include "../include/index.hpp"
+#include "../include/stage.hpp"
+#include <fstream>
+#include <filesystem>
+
+// entries survive a save and load of the binary index
+bool test_index_save_and_load()
+{
+  std::map<std::string, IndexEntry> original = loadIndex();
+
+  std::map<std::string, IndexEntry> index;
+  IndexEntry staged;
+  staged.hash = sha256Hash("staged content");
+  staged.size = 14;
+  staged.inode = 42;
+  staged.mode = 0100644;
+  staged.staged = true;
+  index["dir/staged file.txt"] = staged;
+
+  IndexEntry deleted;
+  deleted.staged = true;
+  index["deleted.txt"] = deleted;
+
+  saveIndex(index);
+  std::map<std::string, IndexEntry> loaded = loadIndex();
+  std::vector<std::string> staged_files = getStagedFiles();
+  saveIndex(original);
+
+  return loaded.size() == 2 &&
+         loaded["dir/staged file.txt"].hash == staged.hash &&
+         loaded["dir/staged file.txt"].size == 14 &&
+         loaded["dir/staged file.txt"].inode == 42 &&
+         loaded["dir/staged file.txt"].mode == 0100644 &&
+         loaded["deleted.txt"].hash.empty() &&
+         std::find(staged_files.begin(), staged_files.end(), "deleted.txt (deleted)") != staged_files.end();
+}
+
+// a file whose stat data is unchanged is not re-hashed
+bool test_index_cached_hash_reused()
+{
+  std::ofstream file("index_cache_test.txt");
+  file << "cached content" << std::endl;
+  file.close();
+
+  // Move the mtime out of the racy window so the stat data is trusted
+  std::filesystem::last_write_time(
+      "index_cache_test.txt",
+      std::filesystem::file_time_type::clock::now() - std::chrono::hours(1));
+
+  std::map<std::string, IndexEntry> index;
+  IndexEntry entry;
+  readFileStat("index_cache_test.txt", entry);
+  entry.hash = sha256Hash("not the real content");
+  index["index_cache_test.txt"] = entry;
+
+  bool index_changed = false;
+  bool reused = getCachedFileHash("index_cache_test.txt", index, index_changed) == entry.hash && !index_changed;
+
+  // Touching the file invalidates the cached hash
+  std::ofstream append("index_cache_test.txt", std::ios::app);
+  append << "more" << std::endl;
+  append.close();
+  bool rehashed = getCachedFileHash("index_cache_test.txt", index, index_changed) == hashFile("index_cache_test.txt") && index_changed;
+
+  std::filesystem::remove("index_cache_test.txt");
+
+  return reused && rehashed;
+}
+
+// a legacy text index is read as staged entries
+bool test_index_load_legacy_text()
+{
+  std::map<std::string, IndexEntry> original = loadIndex();
+
+  std::ofstream index_file(getIndexPath(), std::ios::trunc);
+  index_file << "legacy.txt " << sha256Hash("legacy") << std::endl;
+  index_file << "gone.txt (deleted) " << std::endl;
+  index_file.close();
+
+  std::map<std::string, IndexEntry> loaded = loadIndex();
+  saveIndex(original);
+
+  return loaded.size() == 2 &&
+         loaded["legacy.txt"].staged &&
+         loaded["legacy.txt"].hash == sha256Hash("legacy") &&
+         loaded["gone.txt"].staged &&
+         loaded["gone.txt"].hash.empty();
+}
@@ -0,0 +1,127 @@
+#include "../include/json.hpp"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+static std::vector<std::string> collectJsonEvents(
+    const std::string &json,
+    std::size_t chunk_size)
+{
+  std::vector<std::string> events;
+  JsonParser parser;
+  parser.handler = [&](JsonEvent event, const std::string &key, const std::string &value, std::size_t depth)
+  {
+    events.push_back(std::to_string(static_cast<int>(event)) + "|" + key + "|" + value + "|" + std::to_string(depth));
+    return true;
+  };
+  for (std::size_t i = 0; i < json.size(); i += chunk_size)
+  {
+    feedJson(parser, json.data() + i, std::min(chunk_size, json.size() - i));
+  }
+  if (!finishJson(parser))
+  {
+    events.push_back("failed");
+  }
+  return events;
+}
+
+// feeding a document one byte at a time yields the same events as feeding it whole
+bool test_json_parser_handles_split_input()
+{
+  std::string json = "{\"tree\":[{\"path\":\"a \\\"b\\\"\\n.txt\",\"size\":-12.5e3,\"x\":true},"
+                     "{\"path\":\"\\u00e9\\ud83d\\ude00\",\"y\":null}],\"truncated\":false,\"empty\":{}}";
+  std::vector<std::string> whole = collectJsonEvents(json, json.size());
+  std::vector<std::string> bytes = collectJsonEvents(json, 1);
+  std::string path;
+  parseJson(
+      json,
+      [&](JsonEvent event, const std::string &key, const std::string &value, std::size_t depth)
+      {
+        if (event == JsonEvent::STRING && key == "path" && depth == 3)
+        {
+          path += value + ";";
+        }
+        return true;
+      });
+
+  return whole == bytes &&
+         whole.size() == 16 &&
+         path == "a \"b\"\n.txt;\xc3\xa9\xf0\x9f\x98\x80;" &&
+         collectJsonEvents("42", 1).size() == 1;
+}
+
+// lookups follow member paths, and malformed documents are rejected
+bool test_json_lookup_and_rejection()
+{
+  std::string commit = "{\"sha\":\"c1\",\"tree\":{\"url\":\"u\",\"sha\":\"t1\"},\"parents\":[{\"sha\":\"p1\"}]}";
+  bool lookups = findJsonString(commit, "sha") == "c1" &&
+                 getJsonString(commit, {"tree", "sha"}) == "t1" &&
+                 getJsonString(commit, {"sha"}) == "c1" &&
+                 getJsonString("{\"parents\":[{\"sha\":\"p1\"}]}", {"sha"}).empty() &&
+                 getJsonString("{\"a\":{\"sha\":\"x\"},\"tree\":{\"sha\":\"t2\"}}", {"tree", "sha"}) == "t2" &&
+                 findJsonString("{\"message\":\"Not Found\"}", "sha").empty();
+
+  auto accepts = [](const std::string &json)
+  {
+    return parseJson(json, [](JsonEvent, const std::string &, const std::string &, std::size_t)
+                     { return true; });
+  };
+  return lookups &&
+         accepts("[1, -0.5, \"s\", [], {}]") &&
+         !accepts("{\"a\":1") &&
+         !accepts("{\"a\" 1}") &&
+         !accepts("[1,]x") &&
+         !accepts("[tru]") &&
+         !accepts("[\"bad \\q escape\"]") &&
+         !accepts("{\"a\":1}}") &&
+         !accepts("[1] 2") &&
+         accepts("[0, -0, 10.25, 1e5, 2E-3, -0.5e+10]") &&
+         !accepts("[01]") &&
+         !accepts("[1.]") &&
+         !accepts("[-.5]") &&
+         !accepts("[-]") &&
+         !accepts("[1e]") &&
+         !accepts("[1.e3]") &&
+         !accepts("[1-2]");
+}
+
+// a streamed string arrives unescaped in pieces whatever the spacing and chunking of the document
+bool test_json_parser_streams_string_values()
+{
+  std::string json = "{ \"sha\" : \"abc\",\n  \"content\"  :\n \"aGVs\\nbG8\\/\\u0041\",\"encoding\" : \"base64\" }";
+  auto stream = [&](std::size_t chunk_size, std::string &streamed, std::string &event_value, std::string &encoding)
+  {
+    JsonParser parser;
+    parser.stream_key = "content";
+    parser.chunk_handler = [&](const char *data, std::size_t size)
+    {
+      streamed.append(data, size);
+      return true;
+    };
+    parser.handler = [&](JsonEvent event, const std::string &key, const std::string &value, std::size_t)
+    {
+      if (event == JsonEvent::STRING && key == "content")
+      {
+        event_value = value;
+      }
+      if (event == JsonEvent::STRING && key == "encoding")
+      {
+        encoding = value;
+      }
+      return true;
+    };
+    for (std::size_t i = 0; i < json.size(); i += chunk_size)
+    {
+      feedJson(parser, json.data() + i, std::min(chunk_size, json.size() - i));
+    }
+    return finishJson(parser);
+  };
+
+  std::string whole, whole_value = "unset", whole_encoding;
+  std::string bytes, bytes_value = "unset", bytes_encoding;
+  return stream(json.size(), whole, whole_value, whole_encoding) &&
+         stream(1, bytes, bytes_value, bytes_encoding) &&
+         whole == "aGVs\nbG8/A" && bytes == whole &&
+         whole_value.empty() && bytes_value.empty() &&
+         whole_encoding == "base64" && bytes_encoding == "base64";
+}
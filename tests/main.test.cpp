@@ -64,6 +64,60 @@ extern bool test_error_handler_safe_read_file();
 extern bool test_error_handler_validate_repository();
 extern bool test_error_handler_validate_branch_exists();
 extern bool test_error_handler_validate_no_uncommitted();
+extern bool test_object_store_and_read_blob();
+extern bool test_object_deduplicate_blob();
+extern bool test_object_commit_tree_blob();
+extern bool test_object_compress_blob();
+extern bool test_index_save_and_load();
+extern bool test_index_cached_hash_reused();
+extern bool test_index_load_legacy_text();
+extern bool test_parallel_for_each_runs_all_tasks();
+extern bool test_parallel_hash_files_in_order();
+extern bool test_hash_file_matches_content_hash();
+extern bool test_hash_file_empty_and_missing();
+extern bool test_diff_myers_minimal_edit();
+extern bool test_diff_hunk_context_and_headers();
+extern bool test_graph_merge_base_and_ancestry();
+extern bool test_graph_incremental_update();
+extern bool test_commit_history_append_only();
+extern bool test_commit_history_reverse_scan();
+extern bool test_branch_checkout_touches_only_delta();
+extern bool test_ignore_compiled_patterns();
+extern bool test_worktree_walk_prunes_ignored_directories();
+extern bool test_worktree_parallel_walk_is_complete_and_sorted();
+extern bool test_fsmonitor_state_round_trip();
+extern bool test_fsmonitor_reports_changes_since_token();
+extern bool test_pack_delta_round_trip();
+extern bool test_pack_repack_reads_objects_back();
+extern bool test_maintenance_gc_grace_period();
+extern bool test_maintenance_reachability_follows_parents_and_tags();
+extern bool test_clone_file_copies_content_and_mode();
+extern bool test_http_perform_all_keeps_request_order();
+extern bool test_git_blob_hash_matches_git();
+extern bool test_github_blob_mapping_is_scoped_to_repository();
+extern bool test_object_blob_reader_streams_content();
+extern bool test_object_blob_writer_stores_chunks();
+extern bool test_transfer_fetch_from_file_remote();
+extern bool test_transfer_rejects_unsafe_ref_names();
+extern bool test_json_parser_handles_split_input();
+extern bool test_json_lookup_and_rejection();
+extern bool test_merge_file_contents_combines_separate_changes();
+extern bool test_merge_file_contents_minimal_conflict();
+extern bool test_merge_three_way_commits_merged_tree();
+extern bool test_transfer_prunes_deleted_remote_branches();
+extern bool test_object_stored_blob_git_hash();
+extern bool test_branch_checkout_clones_shared_blobs();
+extern bool test_github_tree_listing_streams_entries();
+extern bool test_github_tag_refs_follow_ref_depth();
+extern bool test_maintenance_repack_keeps_packed_object_age();
+extern bool test_merge_fast_forward_moves_target_branch();
+extern bool test_object_migrates_legacy_snapshots();
+extern bool test_maintenance_gc_unpacks_recent_packed_objects();
+extern bool test_pack_reads_whole_object_in_chunks();
+extern bool test_transfer_receives_raw_objects();
+extern bool test_object_records_blob_size();
+extern bool test_json_parser_streams_string_values();
+extern bool test_graph_appends_commits_to_tail();
 
 int main(int argc, char **argv)
 {
@@ -390,3 +444,273 @@ TEST(t96_error, validate_no_uncommitted_test)
 {
   EXPECT_TRUE(test_error_handler_validate_no_uncommitted());
 }
+
+TEST(t97_object, store_and_read_blob_test)
+{
+  EXPECT_TRUE(test_object_store_and_read_blob());
+}
+
+TEST(t98_object, deduplicate_blob_test)
+{
+  EXPECT_TRUE(test_object_deduplicate_blob());
+}
+
+TEST(t99_object, commit_tree_blob_test)
+{
+  EXPECT_TRUE(test_object_commit_tree_blob());
+}
+
+TEST(t100_object, compress_blob_test)
+{
+  EXPECT_TRUE(test_object_compress_blob());
+}
+
+TEST(t101_index, save_and_load_test)
+{
+  EXPECT_TRUE(test_index_save_and_load());
+}
+
+TEST(t102_index, cached_hash_reused_test)
+{
+  EXPECT_TRUE(test_index_cached_hash_reused());
+}
+
+TEST(t103_index, load_legacy_text_test)
+{
+  EXPECT_TRUE(test_index_load_legacy_text());
+}
+
+TEST(t104_parallel, for_each_runs_all_tasks_test)
+{
+  EXPECT_TRUE(test_parallel_for_each_runs_all_tasks());
+}
+
+TEST(t105_parallel, hash_files_in_order_test)
+{
+  EXPECT_TRUE(test_parallel_hash_files_in_order());
+}
+
+TEST(t106_hash, file_matches_content_hash_test)
+{
+  EXPECT_TRUE(test_hash_file_matches_content_hash());
+}
+
+TEST(t107_hash, file_empty_and_missing_test)
+{
+  EXPECT_TRUE(test_hash_file_empty_and_missing());
+}
+
+TEST(t108_diff, myers_minimal_edit_test)
+{
+  EXPECT_TRUE(test_diff_myers_minimal_edit());
+}
+
+TEST(t109_diff, hunk_context_and_headers_test)
+{
+  EXPECT_TRUE(test_diff_hunk_context_and_headers());
+}
+
+TEST(t110_graph, merge_base_and_ancestry_test)
+{
+  EXPECT_TRUE(test_graph_merge_base_and_ancestry());
+}
+
+TEST(t111_graph, incremental_update_test)
+{
+  EXPECT_TRUE(test_graph_incremental_update());
+}
+
+TEST(t112_commit, history_append_only_test)
+{
+  EXPECT_TRUE(test_commit_history_append_only());
+}
+
+TEST(t113_commit, history_reverse_scan_test)
+{
+  EXPECT_TRUE(test_commit_history_reverse_scan());
+}
+
+TEST(t114_branch, checkout_touches_only_delta_test)
+{
+  EXPECT_TRUE(test_branch_checkout_touches_only_delta());
+}
+
+TEST(t115_ignore, compiled_patterns_test)
+{
+  EXPECT_TRUE(test_ignore_compiled_patterns());
+}
+
+TEST(t116_worktree, walk_prunes_ignored_directories_test)
+{
+  EXPECT_TRUE(test_worktree_walk_prunes_ignored_directories());
+}
+
+TEST(t117_worktree, parallel_walk_is_complete_and_sorted_test)
+{
+  EXPECT_TRUE(test_worktree_parallel_walk_is_complete_and_sorted());
+}
+
+TEST(t118_fsmonitor, state_round_trip_test)
+{
+  EXPECT_TRUE(test_fsmonitor_state_round_trip());
+}
+
+TEST(t119_fsmonitor, reports_changes_since_token_test)
+{
+  EXPECT_TRUE(test_fsmonitor_reports_changes_since_token());
+}
+
+TEST(t120_pack, delta_round_trip_test)
+{
+  EXPECT_TRUE(test_pack_delta_round_trip());
+}
+
+TEST(t121_pack, repack_reads_objects_back_test)
+{
+  EXPECT_TRUE(test_pack_repack_reads_objects_back());
+}
+
+TEST(t122_maintenance, gc_grace_period_test)
+{
+  EXPECT_TRUE(test_maintenance_gc_grace_period());
+}
+
+TEST(t123_maintenance, reachability_follows_parents_and_tags_test)
+{
+  EXPECT_TRUE(test_maintenance_reachability_follows_parents_and_tags());
+}
+
+TEST(t124_clone, file_copies_content_and_mode_test)
+{
+  EXPECT_TRUE(test_clone_file_copies_content_and_mode());
+}
+
+TEST(t125_http, perform_all_keeps_request_order_test)
+{
+  EXPECT_TRUE(test_http_perform_all_keeps_request_order());
+}
+
+TEST(t126_hash, git_blob_hash_matches_git_test)
+{
+  EXPECT_TRUE(test_git_blob_hash_matches_git());
+}
+
+TEST(t127_github, blob_mapping_is_scoped_to_repository_test)
+{
+  EXPECT_TRUE(test_github_blob_mapping_is_scoped_to_repository());
+}
+
+TEST(t128_object, blob_reader_streams_content_test)
+{
+  EXPECT_TRUE(test_object_blob_reader_streams_content());
+}
+
+TEST(t129_object, blob_writer_stores_chunks_test)
+{
+  EXPECT_TRUE(test_object_blob_writer_stores_chunks());
+}
+
+TEST(t130_transfer, fetch_from_file_remote_test)
+{
+  EXPECT_TRUE(test_transfer_fetch_from_file_remote());
+}
+
+TEST(t131_transfer, rejects_unsafe_ref_names_test)
+{
+  EXPECT_TRUE(test_transfer_rejects_unsafe_ref_names());
+}
+
+TEST(t132_json, parser_handles_split_input_test)
+{
+  EXPECT_TRUE(test_json_parser_handles_split_input());
+}
+
+TEST(t133_json, lookup_and_rejection_test)
+{
+  EXPECT_TRUE(test_json_lookup_and_rejection());
+}
+
+TEST(t134_merge, file_contents_combines_separate_changes_test)
+{
+  EXPECT_TRUE(test_merge_file_contents_combines_separate_changes());
+}
+
+TEST(t135_merge, file_contents_minimal_conflict_test)
+{
+  EXPECT_TRUE(test_merge_file_contents_minimal_conflict());
+}
+
+TEST(t136_merge, three_way_commits_merged_tree_test)
+{
+  EXPECT_TRUE(test_merge_three_way_commits_merged_tree());
+}
+
+TEST(t137_transfer, prunes_deleted_remote_branches_test)
+{
+  EXPECT_TRUE(test_transfer_prunes_deleted_remote_branches());
+}
+
+TEST(t138_object, stored_blob_git_hash_test)
+{
+  EXPECT_TRUE(test_object_stored_blob_git_hash());
+}
+
+TEST(t139_branch, checkout_clones_shared_blobs_test)
+{
+  EXPECT_TRUE(test_branch_checkout_clones_shared_blobs());
+}
+
+TEST(t140_github, tree_listing_streams_entries_test)
+{
+  EXPECT_TRUE(test_github_tree_listing_streams_entries());
+}
+
+TEST(t141_github, tag_refs_follow_ref_depth_test)
+{
+  EXPECT_TRUE(test_github_tag_refs_follow_ref_depth());
+}
+
+TEST(t142_maintenance, repack_keeps_packed_object_age_test)
+{
+  EXPECT_TRUE(test_maintenance_repack_keeps_packed_object_age());
+}
+
+TEST(t143_merge, fast_forward_moves_target_branch_test)
+{
+  EXPECT_TRUE(test_merge_fast_forward_moves_target_branch());
+}
+
+TEST(t144_object, migrates_legacy_snapshots_test)
+{
+  EXPECT_TRUE(test_object_migrates_legacy_snapshots());
+}
+
+TEST(t145_maintenance, gc_unpacks_recent_packed_objects_test)
+{
+  EXPECT_TRUE(test_maintenance_gc_unpacks_recent_packed_objects());
+}
+
+TEST(t146_pack, reads_whole_object_in_chunks_test)
+{
+  EXPECT_TRUE(test_pack_reads_whole_object_in_chunks());
+}
+
+TEST(t147_transfer, receives_raw_objects_test)
+{
+  EXPECT_TRUE(test_transfer_receives_raw_objects());
+}
+
+TEST(t148_object, records_blob_size_test)
+{
+  EXPECT_TRUE(test_object_records_blob_size());
+}
+
+TEST(t149_json, parser_streams_string_values_test)
+{
+  EXPECT_TRUE(test_json_parser_streams_string_values());
+}
+
+TEST(t150_graph, appends_commits_to_tail_test)
+{
+  EXPECT_TRUE(test_graph_appends_commits_to_tail());
+}
@@ -61,4 +61,144 @@ bool test_maintenance_find_duplicates()
 {
   findDuplicateFiles();
   return true;
-}
\ No newline at end of file
+}
+
+// gc sweeps unreachable objects only once they are older than the grace period
+bool test_maintenance_gc_grace_period()
+{
+  std::string old_blob = storeBlob("unreachable object older than the grace period\n");
+  std::string recent_blob = storeBlob("unreachable object inside the grace period\n");
+  std::filesystem::last_write_time(
+      getBlobPath(old_blob),
+      std::filesystem::file_time_type::clock::now() - std::chrono::hours(24 * 30));
+
+  std::vector<std::string> unreachable = getUnreachableObjects(14 * 24 * 60 * 60);
+  bool old_swept = std::find(unreachable.begin(), unreachable.end(), old_blob) != unreachable.end();
+  bool recent_kept = std::find(unreachable.begin(), unreachable.end(), recent_blob) == unreachable.end();
+
+  std::vector<std::string> all_unreachable = getUnreachableObjects(0);
+  bool recent_prunable = std::find(all_unreachable.begin(), all_unreachable.end(), recent_blob) != all_unreachable.end();
+
+  std::filesystem::remove(getBlobPath(old_blob));
+  std::filesystem::remove(getBlobPath(recent_blob));
+  return old_swept && recent_kept && recent_prunable;
+}
+
+// objects reached only through a tag and a parent link are marked reachable
+bool test_maintenance_reachability_follows_parents_and_tags()
+{
+  std::string blob = storeBlob("content only an older tagged commit refers to\n");
+  std::filesystem::create_directories(".bittrack/commits");
+  ErrorHandler::safeWriteFile(".bittrack/commits/gc_test_parent", "Message: parent\nFiles: \nkept.txt " + blob + "\n");
+  ErrorHandler::safeWriteFile(".bittrack/commits/gc_test_child", "Parent: gc_test_parent\nMessage: child\nFiles: \n");
+
+  Tag tag;
+  tag.name = "gc_test_tag";
+  tag.commit_hash = "gc_test_child";
+  tagSave(tag);
+
+  std::set<std::string> reachable = getReachableObjects();
+  bool found = reachable.count(blob) > 0;
+
+  deleteTagFile("gc_test_tag");
+  std::filesystem::remove(".bittrack/commits/gc_test_parent");
+  std::filesystem::remove(".bittrack/commits/gc_test_child");
+  std::filesystem::remove(getBlobPath(blob));
+  return found;
+}
+
+// a packed object keeps its pack's age through a repack that unpacks it
+bool test_maintenance_repack_keeps_packed_object_age()
+{
+  std::string blob = storeBlob("unreachable object packed a month ago\n");
+  std::set<std::string> existing_packs;
+  for (const auto &pack : getPackFiles())
+  {
+    existing_packs.insert(pack->pack_path);
+  }
+
+  std::filesystem::create_directories(getPackDir());
+  PackStats stats;
+  std::string pack_path = getPackDir() + "/gc_age_test.pack";
+  if (!writePack({{blob, ""}}, pack_path, stats) || !installPack(pack_path, stats))
+  {
+    return false;
+  }
+  std::filesystem::remove(getBlobPath(blob));
+
+  // date back only the new pack; the others stay as recent as they are
+  auto month_ago = std::filesystem::file_time_type::clock::now() - std::chrono::hours(24 * 30);
+  for (const auto &pack : getPackFiles())
+  {
+    if (existing_packs.count(pack->pack_path) == 0)
+    {
+      std::filesystem::last_write_time(pack->pack_path, month_ago);
+    }
+  }
+
+  auto swept = [&]()
+  {
+    std::vector<std::string> unreachable = getUnreachableObjects(14 * 24 * 60 * 60);
+    return std::find(unreachable.begin(), unreachable.end(), blob) != unreachable.end();
+  };
+  bool packed_swept = swept();
+
+  repackRepository();
+  bool unpacked = std::filesystem::exists(getBlobPath(blob));
+  bool unpacked_swept = swept();
+
+  std::filesystem::remove(getBlobPath(blob));
+  return packed_swept && unpacked && unpacked_swept;
+}
+
+// gc unpacks unreachable objects still inside the grace period instead of repacking them
+bool test_maintenance_gc_unpacks_recent_packed_objects()
+{
+  // pack each object on its own and date the pack; one is past the default
+  // grace period, the other ten days into it
+  auto pack_aged = [](const std::string &blob, int days)
+  {
+    std::set<std::string> existing_packs;
+    for (const auto &pack : getPackFiles())
+    {
+      existing_packs.insert(pack->pack_path);
+    }
+
+    std::filesystem::create_directories(getPackDir());
+    PackStats stats;
+    std::string pack_path = getPackDir() + "/gc_unpack_test.pack";
+    if (!writePack({{blob, ""}}, pack_path, stats) || !installPack(pack_path, stats))
+    {
+      return false;
+    }
+    std::filesystem::remove(getBlobPath(blob));
+
+    auto dated = std::filesystem::file_time_type::clock::now() - std::chrono::hours(24 * days);
+    for (const auto &pack : getPackFiles())
+    {
+      if (existing_packs.count(pack->pack_path) == 0)
+      {
+        std::filesystem::last_write_time(pack->pack_path, dated);
+      }
+    }
+    return true;
+  };
+
+  std::string old_blob = storeBlob("unreachable packed object older than the grace period\n");
+  std::string recent_blob = storeBlob("unreachable packed object inside the grace period\n");
+  if (!pack_aged(old_blob, 30) || !pack_aged(recent_blob, 10))
+  {
+    return false;
+  }
+
+  garbageCollect();
+  bool old_removed = !hasPackedObject(old_blob) && !std::filesystem::exists(getBlobPath(old_blob));
+  bool recent_unpacked = !hasPackedObject(recent_blob) && std::filesystem::exists(getBlobPath(recent_blob));
+
+  // the unpacked object still ages from its pack's time, so a five day grace period sweeps it
+  std::vector<std::string> unreachable = getUnreachableObjects(5 * 24 * 60 * 60);
+  bool age_kept = std::find(unreachable.begin(), unreachable.end(), recent_blob) != unreachable.end();
+
+  std::filesystem::remove(getBlobPath(recent_blob));
+  return old_removed && recent_unpacked && age_kept;
+}
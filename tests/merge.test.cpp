@@ -161,3 +161,137 @@ bool test_merge_fast_forward()
 
   return true;
 }
+
+// changes to different lines of a file merge without a conflict
+bool test_merge_file_contents_combines_separate_changes()
+{
+  std::string base = "one\ntwo\nthree\nfour\nfive\nsix\n";
+  std::string ours = "zero\none\nTWO\nthree\nfour\nfive\nsix\n";
+  std::string theirs = "one\ntwo\nthree\nfour\nsix\nseven";
+  std::string merged;
+  bool clean = mergeFileContents(base, ours, theirs, merged);
+
+  std::string same;
+  bool same_change = mergeFileContents(base, ours, ours, same);
+
+  return clean && merged == "zero\none\nTWO\nthree\nfour\nsix\nseven" &&
+         same_change && same == ours;
+}
+
+// overlapping changes conflict only on the lines the two sides disagree on
+bool test_merge_file_contents_minimal_conflict()
+{
+  std::string base = "a\nb\nc\nd\ne\n";
+  std::string ours = "a\nb\nX\nsame\ne\nours tail\n";
+  std::string theirs = "A\nb\nY\nsame\ne\n";
+  std::string merged;
+  bool clean = mergeFileContents(base, ours, theirs, merged);
+
+  std::string binary;
+  bool binary_clean = mergeFileContents("x\n", std::string("y\0", 2), "z\n", binary);
+
+  return !clean &&
+         merged == "A\nb\n<<<<<<< HEAD\nX\n=======\nY\n>>>>>>> theirs\nsame\ne\nours tail\n" &&
+         !binary_clean && binary.empty();
+}
+
+// the merge commit is built from blob hashes: untouched files keep our blob, merged files get a stored one
+bool test_merge_three_way_commits_merged_tree()
+{
+  std::filesystem::create_directories("merge_fast_test");
+  std::string same = storeBlob("same on every side\n");
+  std::string base_text = storeBlob("1\n2\n3\n4\n5\n");
+  std::string our_text = storeBlob("1\nours\n3\n4\n5\n");
+  std::string their_text = storeBlob("1\n2\n3\n4\ntheirs\n");
+  std::string their_only = storeBlob("changed by them\n");
+
+  auto writeCommit = [](const std::string &name, const std::string &files)
+  {
+    std::string hash = sha256Hash(name);
+    ErrorHandler::safeWriteFile(
+        ".bittrack/commits/" + hash,
+        "Author: tester\nBranch: main\nTimestamp: 2024-01-01 00:00:00\nMessage: " + name + "\nFiles: \n" + files);
+    return hash;
+  };
+  std::string base = writeCommit("merge fast base",
+                                 "merge_fast_test/same.txt " + same + "\nmerge_fast_test/both.txt " + base_text +
+                                     "\nmerge_fast_test/theirs.txt " + same + "\nmerge_fast_test/gone.txt " + same + "\n");
+  std::string ours = writeCommit("merge fast ours",
+                                 "merge_fast_test/same.txt " + same + "\nmerge_fast_test/both.txt " + our_text +
+                                     "\nmerge_fast_test/theirs.txt " + same + "\nmerge_fast_test/gone.txt " + same + "\n");
+  std::string theirs = writeCommit("merge fast theirs",
+                                   "merge_fast_test/same.txt " + same + "\nmerge_fast_test/both.txt " + their_text +
+                                       "\nmerge_fast_test/theirs.txt " + their_only + "\n");
+
+  // the working tree holds our commit
+  ErrorHandler::safeWriteFile("merge_fast_test/same.txt", readBlob(same));
+  ErrorHandler::safeWriteFile("merge_fast_test/both.txt", readBlob(our_text));
+  ErrorHandler::safeWriteFile("merge_fast_test/theirs.txt", readBlob(same));
+  ErrorHandler::safeWriteFile("merge_fast_test/gone.txt", readBlob(same));
+
+  MergeResult result = threeWayMerge(base, ours, theirs);
+
+  std::string branch_ref = ".bittrack/refs/heads/" + getCurrentBranchName();
+  std::string branch_tip = ErrorHandler::safeReadFile(branch_ref);
+  createMergeCommit("merge fast test", {ours, theirs}, result.merged_tree);
+  std::map<std::string, std::string> tree = getCommitTree(getCurrentCommit());
+  ErrorHandler::safeWriteFile(branch_ref, branch_tip);
+
+  bool ok = result.success && !result.has_conflicts &&
+            tree.size() == 3 && tree.count("merge_fast_test/gone.txt") == 0 &&
+            tree["merge_fast_test/same.txt"] == same &&
+            tree["merge_fast_test/theirs.txt"] == their_only &&
+            readBlob(tree["merge_fast_test/both.txt"]) == "1\nours\n3\n4\ntheirs\n" &&
+            ErrorHandler::safeReadFile("merge_fast_test/both.txt") == "1\nours\n3\n4\ntheirs\n" &&
+            !std::filesystem::exists("merge_fast_test/gone.txt");
+
+  for (const auto &commit : {base, ours, theirs})
+  {
+    std::filesystem::remove(".bittrack/commits/" + commit);
+  }
+  std::filesystem::remove_all("merge_fast_test");
+  return ok;
+}
+
+// a fast-forward moves the target branch and its files, and merging an
+// ancestor into its descendant changes nothing
+bool test_merge_fast_forward_moves_target_branch()
+{
+  std::filesystem::path original = std::filesystem::current_path();
+  std::filesystem::path repo = std::filesystem::absolute("merge_ff_test");
+  std::filesystem::create_directories(repo / ".bittrack/commits");
+  std::filesystem::create_directories(repo / ".bittrack/refs/heads");
+  std::filesystem::current_path(repo);
+
+  // base holds shared.txt, feature adds feature.txt on top of it
+  std::string shared = storeBlob("shared\n");
+  std::string feature_only = storeBlob("feature\n");
+  std::string base = sha256Hash("merge ff base");
+  std::string feature = sha256Hash("merge ff feature");
+  ErrorHandler::safeWriteFile(
+      ".bittrack/commits/" + base,
+      "Author: tester\nBranch: main\nTimestamp: 2024-01-01 00:00:00\nMessage: base\nFiles: \nshared.txt " + shared + "\n");
+  ErrorHandler::safeWriteFile(
+      ".bittrack/commits/" + feature,
+      "Author: tester\nBranch: feature\nTimestamp: 2024-01-02 00:00:00\nParent: " + base +
+          "\nMessage: feature\nFiles: \nshared.txt " + shared + "\nfeature.txt " + feature_only + "\n");
+  ErrorHandler::safeWriteFile(".bittrack/HEAD", "main\n");
+  ErrorHandler::safeWriteFile(".bittrack/refs/heads/main", base + "\n");
+  ErrorHandler::safeWriteFile(".bittrack/refs/heads/feature", feature + "\n");
+  ErrorHandler::safeWriteFile(".bittrack/refs/heads/old", base + "\n");
+  ErrorHandler::safeWriteFile("shared.txt", "shared\n");
+
+  MergeResult forward = mergeBranches("feature", "main");
+  bool moved = forward.success && forward.message == "Fast-forward merge" &&
+               getBranchLastCommitHash("main") == feature &&
+               ErrorHandler::safeReadFile("feature.txt") == "feature\n";
+
+  // main is now ahead of old, so there is nothing to merge
+  MergeResult behind = mergeBranches("old", "main");
+  bool unchanged = behind.success && behind.message == "Already up to date" &&
+                   getBranchLastCommitHash("main") == feature;
+
+  std::filesystem::current_path(original);
+  std::filesystem::remove_all(repo);
+  return moved && unchanged;
+}
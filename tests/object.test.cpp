@@ -0,0 +1,201 @@
+#include "../include/object.hpp"
+#include "../include/utils.hpp"
+#include "../include/commit.hpp"
+#include "../include/stage.hpp"
+#include <fstream>
+#include <filesystem>
+
+// store a blob and read the same content back by its hash
+bool test_object_store_and_read_blob()
+{
+  std::string content = "blob store roundtrip content\n";
+  std::string blob_hash = storeBlob(content);
+
+  return blob_hash == sha256Hash(content) &&
+         blobExists(blob_hash) &&
+         readBlob(blob_hash) == content;
+}
+
+// identical content is stored once under the same hash
+bool test_object_deduplicate_blob()
+{
+  std::string first_hash = storeBlob("deduplicated content\n");
+  std::string second_hash = storeBlob("deduplicated content\n");
+  std::vector<std::string> blobs = listBlobs();
+
+  return first_hash == second_hash &&
+         std::count(blobs.begin(), blobs.end(), first_hash) == 1;
+}
+
+// compressible content is stored deflated and inflated back unchanged
+bool test_object_compress_blob()
+{
+  std::string content;
+  for (int i = 0; i < 20000; i++)
+  {
+    content += "line " + std::to_string(i) + " of a highly repetitive text file\n";
+  }
+
+  std::string blob_hash = storeBlob(content);
+  std::string restored_path = "object_restore_test.txt";
+  bool restored = restoreBlobToFile(blob_hash, restored_path);
+  bool matches = restored && hashFile(restored_path) == blob_hash;
+  std::filesystem::remove(restored_path);
+
+  return matches &&
+         readBlob(blob_hash) == content &&
+         std::filesystem::file_size(getBlobPath(blob_hash)) < content.size() / 3;
+}
+
+// a committed file is recorded in the commit tree with its blob hash
+bool test_object_commit_tree_blob()
+{
+  std::ofstream file("object_test.txt");
+  file << "content for object test" << std::endl;
+  file.close();
+
+  stage("object_test.txt");
+  commitChanges("test_user", "object test commit");
+
+  std::map<std::string, std::string> tree = getCommitTree(getCurrentCommit());
+  bool has_blob = tree.count("object_test.txt") > 0 &&
+                  tree["object_test.txt"] == hashFile("object_test.txt") &&
+                  blobExists(tree["object_test.txt"]);
+
+  std::filesystem::remove("object_test.txt");
+
+  return has_blob;
+}
+
+// a blob read back in chunks matches the stored content and encodes like the whole string
+bool test_object_blob_reader_streams_content()
+{
+  std::string content;
+  for (int i = 0; i < 30000; i++)
+  {
+    content += "streamed line " + std::to_string(i) + "\n";
+  }
+  std::string blob_hash = storeBlob(content);
+
+  BlobReader reader;
+  if (!openBlobReader(blob_hash, reader))
+  {
+    return false;
+  }
+
+  // read in blocks of a multiple of 3 so each one encodes on its own
+  std::string streamed;
+  std::string encoded;
+  unsigned char buffer[3000];
+  char output[4000];
+  std::size_t read = 0;
+  while ((read = readBlobChunk(reader, buffer, sizeof(buffer))) > 0)
+  {
+    streamed.append(reinterpret_cast<const char *>(buffer), read);
+    encoded.append(output, base64EncodeBlock(buffer, read, output));
+  }
+
+  return !reader.failed &&
+         streamed == content &&
+         encoded == base64Encode(content) &&
+         jsonEscape("a \"b\"\\\n\t\x01") == "a \\\"b\\\"\\\\\\n\\t\\u0001";
+}
+
+// content written to a blob writer in pieces is stored under the hash of the whole
+bool test_object_blob_writer_stores_chunks()
+{
+  std::string content;
+  for (int i = 0; i < 20000; i++)
+  {
+    content += "written line " + std::to_string(i) + "\n";
+  }
+
+  BlobWriter writer;
+  if (!openBlobWriter(writer))
+  {
+    return false;
+  }
+  const unsigned char *data = reinterpret_cast<const unsigned char *>(content.data());
+  for (std::size_t offset = 0; offset < content.size(); offset += 1000)
+  {
+    if (!writeBlobChunk(writer, data + offset, std::min<std::size_t>(1000, content.size() - offset)))
+    {
+      return false;
+    }
+  }
+  std::string temp_path = writer.temp_path;
+  std::string blob_hash = finishBlobWriter(writer);
+
+  return blob_hash == sha256Hash(content) &&
+         readBlob(blob_hash) == content &&
+         !std::filesystem::exists(temp_path);
+}
+
+// a stored blob is sized and Git-hashed from the object store as its content would be
+bool test_object_stored_blob_git_hash()
+{
+  std::string content;
+  for (int i = 0; i < 30000; i++)
+  {
+    content += "stored line " + std::to_string(i) + "\n";
+  }
+  std::string blob_hash = storeBlob(content);
+  std::string empty_hash = storeBlob("");
+
+  return getBlobSize(blob_hash) == static_cast<int64_t>(content.size()) &&
+         gitBlobHashStored(blob_hash) == gitBlobHash(content) &&
+         gitBlobHashStored(empty_hash) == "e69de29bb2d1d6434b8b29ae775ad8c2e48c5391" &&
+         getBlobSize("missing") == -1 &&
+         gitBlobHashStored("missing").empty();
+}
+
+// snapshots in the old per-commit layout become blobs named as their commit logs expect
+bool test_object_migrates_legacy_snapshots()
+{
+  std::string commit = sha256Hash("legacy layout commit");
+  std::string legacy_dir = getObjectsDir() + "/" + commit;
+  ErrorHandler::safeWriteFile(legacy_dir + "/notes.txt", "legacy notes\n");
+  ErrorHandler::safeWriteFile(legacy_dir + "/docs/guide.md", "legacy guide\n");
+
+  std::size_t migrated = migrateLegacyObjects();
+  bool ok = migrated == 2 &&
+            !std::filesystem::exists(legacy_dir) &&
+            readBlob(sha256Hash("legacy notes\n")) == "legacy notes\n" &&
+            readBlob(sha256Hash("legacy guide\n")) == "legacy guide\n" &&
+            blobExists(sha256Hash("")) &&
+            migrateLegacyObjects() == 0;
+
+  std::filesystem::remove(getBlobPath(sha256Hash("legacy notes\n")));
+  std::filesystem::remove(getBlobPath(sha256Hash("legacy guide\n")));
+  return ok;
+}
+
+// new objects record their size up front, and objects written before that still read back
+bool test_object_records_blob_size()
+{
+  std::string content = "content whose size is recorded with the object\n";
+  std::string blob_hash = storeBlob(content);
+  BlobReader reader;
+  bool recorded = openBlobReader(blob_hash, reader) && reader.size == static_cast<int64_t>(content.size());
+
+  // an object in the older layout is a bare zlib stream
+  std::string legacy = "content stored before sizes were recorded\n";
+  std::string legacy_hash = sha256Hash(legacy);
+  mz_ulong stored_size = mz_compressBound(static_cast<mz_ulong>(legacy.size()));
+  std::vector<unsigned char> stored(stored_size);
+  mz_compress(stored.data(), &stored_size, reinterpret_cast<const unsigned char *>(legacy.data()), static_cast<mz_ulong>(legacy.size()));
+  std::filesystem::create_directories(std::filesystem::path(getBlobPath(legacy_hash)).parent_path());
+  std::ofstream file(getBlobPath(legacy_hash), std::ios::binary);
+  file.write(reinterpret_cast<const char *>(stored.data()), stored_size);
+  file.close();
+
+  BlobReader legacy_reader;
+  bool legacy_unsized = openBlobReader(legacy_hash, legacy_reader) && legacy_reader.size == -1;
+  bool legacy_read = readBlob(legacy_hash) == legacy &&
+                     getBlobSize(legacy_hash) == static_cast<int64_t>(legacy.size()) &&
+                     gitBlobHashStored(legacy_hash) == gitBlobHash(legacy);
+
+  std::filesystem::remove(getBlobPath(blob_hash));
+  std::filesystem::remove(getBlobPath(legacy_hash));
+  return recorded && legacy_unsized && legacy_read;
+}
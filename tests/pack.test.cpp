@@ -0,0 +1,103 @@
+#include "../include/pack.hpp"
+#include <string>
+
+// a delta rebuilds the target from its base and refuses to exceed its size budget
+bool test_pack_delta_round_trip()
+{
+  std::string base;
+  for (int i = 0; i < 2000; i++)
+  {
+    base += "line " + std::to_string(i) + " of the original revision\n";
+  }
+  std::string target = base;
+  target.insert(target.size() / 3, "an inserted paragraph\n");
+  target.erase(target.size() / 2, 300);
+  target += "appended at the end\n";
+
+  std::string delta = createDelta(base, target, target.size());
+  std::string rebuilt;
+  if (delta.empty() || delta.size() > target.size() / 20 || !applyDelta(base, delta, rebuilt) || rebuilt != target)
+  {
+    return false;
+  }
+
+  // unrelated content does not fit a tight budget, and a delta only applies to its own base
+  std::string unrelated(4096, 'x');
+  return createDelta(base, unrelated, 64).empty() && !applyDelta(unrelated, delta, rebuilt);
+}
+
+// packed revisions stay readable through the blob API once their loose copies are gone
+bool test_pack_repack_reads_objects_back()
+{
+  std::string content = "first revision\n";
+  for (int i = 0; i < 500; i++)
+  {
+    content += "shared line " + std::to_string(i) + "\n";
+  }
+  std::vector<std::string> revisions = {content, content + "second revision\n", "second " + content};
+
+  // keep whatever is already packed, the new pack replaces every older one
+  std::vector<PackObject> objects;
+  for (const auto &blob_hash : listPackedObjects())
+  {
+    objects.push_back({blob_hash, ""});
+  }
+  std::vector<std::string> hashes;
+  for (const auto &revision : revisions)
+  {
+    hashes.push_back(storeBlob(revision));
+    objects.push_back({hashes.back(), "pack_test.txt"});
+  }
+
+  PackStats stats;
+  if (!repackObjects(objects, stats) || stats.delta_count < 2)
+  {
+    return false;
+  }
+
+  for (std::size_t i = 0; i < revisions.size(); i++)
+  {
+    if (std::filesystem::exists(getBlobPath(hashes[i])) || !blobExists(hashes[i]) || readBlob(hashes[i]) != revisions[i])
+    {
+      return false;
+    }
+  }
+
+  std::vector<std::string> problems;
+  return verifyPackFiles(problems);
+}
+
+// a whole packed object is inflated from the pack a chunk at a time, even once the pack list is reloaded
+bool test_pack_reads_whole_object_in_chunks()
+{
+  std::string content;
+  for (int i = 0; i < 20000; i++)
+  {
+    content += "streamed line " + std::to_string(i) + "\n";
+  }
+  std::string blob_hash = storeBlob(content);
+
+  std::filesystem::create_directories(getPackDir());
+  PackStats stats;
+  std::string pack_path = getPackDir() + "/chunked_read_test.pack";
+  if (!writePack({{blob_hash, ""}}, pack_path, stats) || !installPack(pack_path, stats))
+  {
+    return false;
+  }
+  std::filesystem::remove(getBlobPath(blob_hash));
+
+  BlobReader reader;
+  if (!openBlobReader(blob_hash, reader) || !reader.packed.empty())
+  {
+    return false;
+  }
+
+  std::string read;
+  unsigned char buffer[4096];
+  while (std::size_t count = readBlobChunk(reader, buffer, sizeof(buffer)))
+  {
+    read.append(reinterpret_cast<char *>(buffer), count);
+    resetPackFiles();
+  }
+  return !reader.failed && reader.packed.empty() && read == content;
+}
@@ -0,0 +1,45 @@
+#include "../include/parallel.hpp"
+#include "../include/hash.hpp"
+#include <fstream>
+#include <filesystem>
+
+// every task index in a batch runs exactly once
+bool test_parallel_for_each_runs_all_tasks()
+{
+  std::vector<std::atomic<int>> runs(1000);
+  parallelForEach(
+      runs.size(),
+      [&](std::size_t i)
+      { runs[i]++; });
+
+  return std::all_of(runs.begin(), runs.end(), [](const std::atomic<int> &count)
+                     { return count == 1; });
+}
+
+// parallel hashing returns the same hashes as sequential hashing, in input order
+bool test_parallel_hash_files_in_order()
+{
+  std::vector<std::string> file_paths;
+  for (int i = 0; i < 32; i++)
+  {
+    std::string file_path = "parallel_hash_test_" + std::to_string(i) + ".txt";
+    std::ofstream file(file_path);
+    file << "parallel content " << i << std::endl;
+    file.close();
+    file_paths.push_back(file_path);
+  }
+
+  std::vector<std::string> hashes = hashFilesParallel(file_paths);
+  bool matches = hashes.size() == file_paths.size();
+  for (std::size_t i = 0; matches && i < file_paths.size(); i++)
+  {
+    matches = hashes[i] == hashFile(file_paths[i]);
+  }
+
+  for (const auto &file_path : file_paths)
+  {
+    std::filesystem::remove(file_path);
+  }
+
+  return matches;
+}
@@ -40,6 +40,20 @@ TEST(RemoteTest, Base64DecodeFailsOnBackslash) {
   std::string decoded = base64Decode(encoded);
   EXPECT_EQ(decoded, "");
 }
+TEST(RemoteTest, Base64DecodeBlockResumesAcrossChunks) {
+  // Splitting the input anywhere decodes to the same bytes as one call
+  std::string encoded = "SGVsbG8g\nV29ybGQ=";
+  for (std::size_t split = 0; split <= encoded.size(); split++) {
+    Base64DecodeState state;
+    unsigned char output[32];
+    std::size_t first = 0;
+    std::size_t second = 0;
+    EXPECT_TRUE(base64DecodeBlock(encoded.data(), split, output, first, state));
+    EXPECT_TRUE(base64DecodeBlock(encoded.data() + split, encoded.size() - split, output + first, second, state));
+    EXPECT_EQ(std::string(reinterpret_cast<char *>(output), first + second), "Hello World");
+  }
+}
+
 TEST(RemoteTest, PullWithInvalidRemoteURL) {
   EXPECT_NO_THROW(pull("invalid_url", "main"));
 }
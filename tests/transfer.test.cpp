@@ -0,0 +1,132 @@
+#include "../include/transfer.hpp"
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+// a file:// fetch brings the other repository's commit, objects and branch tip over in one stream
+bool test_transfer_fetch_from_file_remote()
+{
+  std::filesystem::path original = std::filesystem::current_path();
+  std::filesystem::path remote = std::filesystem::absolute("transfer_test/remote");
+  std::filesystem::create_directories(remote / ".bittrack/commits");
+  std::filesystem::create_directories(remote / ".bittrack/refs/heads");
+
+  // build a one-commit repository by hand inside the remote directory
+  std::string content = "shipped through the transfer stream\n";
+  std::string commit = sha256Hash("transfer test commit");
+  std::filesystem::current_path(remote);
+  std::string blob_hash = storeBlob(content);
+  ErrorHandler::safeWriteFile(
+      ".bittrack/commits/" + commit,
+      "Author: tester\nBranch: main\nTimestamp: 2024-01-01 00:00:00\nMessage: remote commit\nFiles: \nnotes.txt " + blob_hash + "\n");
+  ErrorHandler::safeWriteFile(".bittrack/refs/heads/main", commit + "\n");
+  std::filesystem::current_path(original);
+
+  bool fetched = fetchNative("transfer_test", "file://" + remote.string());
+  std::ifstream tracking(".bittrack/refs/remotes/transfer_test/main");
+  std::string tracked;
+  std::getline(tracking, tracked);
+
+  bool ok = fetched && tracked == commit &&
+            std::filesystem::exists(".bittrack/commits/" + commit) &&
+            getCommitTree(commit)["notes.txt"] == blob_hash &&
+            readBlob(blob_hash) == content;
+
+  std::filesystem::remove_all(".bittrack/refs/remotes/transfer_test");
+  std::filesystem::remove_all("transfer_test");
+  return ok;
+}
+
+// ref names from a peer must stay under refs/heads
+bool test_transfer_rejects_unsafe_ref_names()
+{
+  return isValidTransferRef("refs/heads/main") &&
+         isValidTransferRef("refs/heads/feature/login-v2") &&
+         !isValidTransferRef("refs/heads/") &&
+         !isValidTransferRef("refs/tags/v1") &&
+         !isValidTransferRef("refs/heads/../../config") &&
+         !isValidTransferRef("refs/heads/feature/.hidden") &&
+         !isValidTransferRef("refs/heads//main") &&
+         !isValidTransferRef("refs/heads/main/") &&
+         !isValidTransferRef("refs/heads/bad name");
+}
+
+// a second fetch drops tracking refs of branches deleted on the remote
+bool test_transfer_prunes_deleted_remote_branches()
+{
+  std::filesystem::path original = std::filesystem::current_path();
+  std::filesystem::path remote = std::filesystem::absolute("transfer_prune_test/remote");
+  std::filesystem::create_directories(remote / ".bittrack/commits");
+  std::filesystem::create_directories(remote / ".bittrack/refs/heads/feature");
+
+  std::string commit = sha256Hash("transfer prune test commit");
+  std::filesystem::current_path(remote);
+  std::string blob_hash = storeBlob("pruned branch content\n");
+  ErrorHandler::safeWriteFile(
+      ".bittrack/commits/" + commit,
+      "Author: tester\nBranch: main\nTimestamp: 2024-01-01 00:00:00\nMessage: remote commit\nFiles: \nnotes.txt " + blob_hash + "\n");
+  ErrorHandler::safeWriteFile(".bittrack/refs/heads/main", commit + "\n");
+  ErrorHandler::safeWriteFile(".bittrack/refs/heads/feature/login", commit + "\n");
+  std::filesystem::current_path(original);
+
+  std::string url = "file://" + remote.string();
+  std::string tracking = ".bittrack/refs/remotes/transfer_prune_test";
+  bool first = fetchNative("transfer_prune_test", url) &&
+               std::filesystem::exists(tracking + "/feature/login");
+
+  std::filesystem::remove(remote / ".bittrack/refs/heads/feature/login");
+  bool second = fetchNative("transfer_prune_test", url) &&
+                std::filesystem::exists(tracking + "/main") &&
+                !std::filesystem::exists(tracking + "/feature");
+
+  std::filesystem::remove_all(tracking);
+  std::filesystem::remove_all("transfer_prune_test");
+  return first && second;
+}
+
+// objects sent raw beside the pack are stored however the stream is split into chunks
+bool test_transfer_receives_raw_objects()
+{
+  std::string first = "an object sent outside the pack\n";
+  std::string second = "";
+  auto append_integer = [](std::string &stream, uint64_t value, std::size_t size)
+  {
+    for (std::size_t i = 0; i < size; i++)
+    {
+      stream.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+  };
+
+  // version 2 header with no pack, two raw objects, then no refs and no commits
+  std::string stream = "BTTR";
+  append_integer(stream, 2, 4);
+  append_integer(stream, 0, 8);
+  append_integer(stream, 2, 4);
+  append_integer(stream, first.size(), 8);
+  stream += first;
+  append_integer(stream, second.size(), 8);
+  append_integer(stream, 0, 4);
+  append_integer(stream, 0, 4);
+
+  TransferReceiver receiver;
+  bool fed = openTransferReceiver(receiver);
+  for (std::size_t i = 0; fed && i < stream.size(); i++)
+  {
+    fed = feedTransferReceiver(receiver, stream.data() + i, 1);
+  }
+  std::vector<TransferRef> refs;
+  TransferStats stats;
+  bool finished = fed && finishTransferReceiver(receiver, refs, stats);
+
+  // a stream cut off inside the raw section is rejected
+  TransferReceiver truncated;
+  bool rejected = openTransferReceiver(truncated) &&
+                  feedTransferReceiver(truncated, stream.data(), 16 + 4 + 8 + 5) &&
+                  !finishTransferReceiver(truncated, refs, stats);
+
+  std::string first_hash = sha256Hash(first);
+  std::string second_hash = sha256Hash(second);
+  bool stored = blobExists(first_hash) && readBlob(first_hash) == first && blobExists(second_hash);
+  std::filesystem::remove(getBlobPath(first_hash));
+  return finished && stored && stats.object_count == 2 && refs.empty() && rejected;
+}
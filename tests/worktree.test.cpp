@@ -0,0 +1,70 @@
+#include "../include/worktree.hpp"
+#include <filesystem>
+#include <fstream>
+
+// the walker lists tracked candidates with stat data and never enters ignored or internal directories
+bool test_worktree_walk_prunes_ignored_directories()
+{
+  if (!std::filesystem::exists(".bitignore"))
+  {
+    createDefaultBitignore();
+  }
+
+  std::filesystem::create_directories("worktree_test/src/nested");
+  std::filesystem::create_directories("worktree_test/build/deep");
+  std::ofstream("worktree_test/src/nested/kept.txt") << "kept";
+  std::ofstream("worktree_test/build/deep/skipped.txt") << "skipped";
+  std::ofstream("worktree_test/main.o") << "object";
+
+  bool found_kept = false;
+  bool found_excluded = false;
+  for (const auto &entry : listWorkingTreeFiles())
+  {
+    if (entry.path == "worktree_test/src/nested/kept.txt")
+    {
+      found_kept = entry.file_stat.st_size == 4 && S_ISREG(entry.file_stat.st_mode);
+    }
+    if (entry.path.find("worktree_test/build") == 0 ||
+        entry.path == "worktree_test/main.o" ||
+        entry.path.find(".bittrack/") == 0)
+    {
+      found_excluded = true;
+    }
+  }
+
+  std::filesystem::remove_all("worktree_test");
+  return found_kept && !found_excluded;
+}
+
+// a walk fanned out over many directories finds every file and returns them in path order
+bool test_worktree_parallel_walk_is_complete_and_sorted()
+{
+  std::size_t created = 0;
+  for (int d = 0; d < 24; d++)
+  {
+    std::string directory = "worktree_parallel/d" + std::to_string(d) + "/inner";
+    std::filesystem::create_directories(directory);
+    for (int f = 0; f < 5; f++)
+    {
+      std::ofstream(directory + "/f" + std::to_string(f) + ".txt") << f;
+      created++;
+    }
+  }
+
+  std::vector<WorkingTreeEntry> entries = listWorkingTreeFiles();
+  std::filesystem::remove_all("worktree_parallel");
+
+  std::size_t found = 0;
+  for (std::size_t i = 0; i < entries.size(); i++)
+  {
+    if (i > 0 && !(entries[i - 1].path < entries[i].path))
+    {
+      return false;
+    }
+    if (entries[i].path.find("worktree_parallel/") == 0)
+    {
+      found++;
+    }
+  }
+  return found == created;
+}